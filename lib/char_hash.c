@@ -28,138 +28,206 @@
 #include "uniquestr.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <limits.h>
+#include <stdint.h>
 #include <string.h>
-#include <math.h>
 
 #include "mem.h"
+#include "mem_arena.h"
 
-typedef struct string_link_tag string_link_t;
-
-struct string_link_tag
+// Slots of the table keep the hash and the length of the string so most
+// mismatches are discarded without touching the string itself and
+// rehashes never need to walk the string again
+typedef struct string_slot_tag
 {
-    unsigned int hash;
+    uint32_t hash;
+    uint32_t length;
     const char *string;
-    string_link_t *next;
-};
+} string_slot_t;
 
-enum { HASH_LENGTH = 76003 };
+enum { INITIAL_CAPACITY = 4096 };
 
-static string_link_t *hash_table[HASH_LENGTH];
+static string_slot_t *hash_table = NULL;
+static uint32_t table_capacity = 0;
+static uint32_t number_of_strings = 0;
 static unsigned long long int bytes_used = 0;
 
+// Strings are never freed so they are kept in an arena
+static mem_arena_t *string_arena = NULL;
+
+// uniquestr may be called from several threads. Lookups are short so a
+// spin lock is enough and does not require linking a threads library
+static volatile int table_lock = 0;
+
+static inline void lock_table(void)
+{
+    while (__sync_lock_test_and_set(&table_lock, 1))
+    {
+        while (table_lock)
+        {
+            // Spin
+        }
+    }
+}
+
+static inline void unlock_table(void)
+{
+    __sync_lock_release(&table_lock);
+}
+
 unsigned long long int char_trie_used_memory(void)
 {
     return bytes_used;
 }
 
-static unsigned int hash_string(const char *string)
+// FNV-1a with a final avalanche, so the low bits used to index the table
+// depend on all the characters
+static uint32_t hash_string(const char *string, size_t length)
 {
-    unsigned int hash = 0;
-    const char *p;
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)string[i];
+        hash *= 16777619u;
+    }
 
-    for (p = string; *p; p++)
-        hash = ((hash << 5) + hash) ^ *p;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
 
     return hash;
 }
 
-const char *uniquestr(const char *string)
+static void grow_table(void)
 {
-    if (string == NULL)
-        return NULL;
+    uint32_t old_capacity = table_capacity;
+    string_slot_t *old_table = hash_table;
 
-    unsigned int hash = hash_string(string);
-    unsigned int hash_index = hash % (sizeof(hash_table) / sizeof(hash_table[0]));
-    string_link_t *p, *p_prev = 0, *new_link;
+    table_capacity = (old_capacity == 0) ? INITIAL_CAPACITY : 2 * old_capacity;
+    hash_table = NEW_VEC0(string_slot_t, table_capacity);
 
-    for (p = hash_table[hash_index]; p; p_prev = p, p = p->next)
+    uint32_t mask = table_capacity - 1;
+    uint32_t i;
+    for (i = 0; i < old_capacity; i++)
     {
-        if (p->hash == hash && !strcmp(p->string, string))
-        {
-            if (p != hash_table[hash_index])
-            {
-                p_prev->next = p->next;
-                p->next = hash_table[hash_index];
-                hash_table[hash_index] = p;
-            }
-
-            return p->string;
-        }
-    }
+        if (old_table[i].string == NULL)
+            continue;
+
+        uint32_t index = old_table[i].hash & mask;
+        while (hash_table[index].string != NULL)
+            index = (index + 1) & mask;
 
-    bytes_used += sizeof(string_link_t) + strlen(string) + 1;
+        hash_table[index] = old_table[i];
+    }
 
-    new_link = NEW(string_link_t);
-    new_link->string = xstrdup(string); 
-    new_link->hash = hash; 
-    new_link->next = hash_table[hash_index];
-    hash_table[hash_index] = new_link; 
+    DELETE(old_table);
 
-    return new_link->string;
+    bytes_used += (unsigned long long)(table_capacity - old_capacity) * sizeof(string_slot_t);
 }
 
-void uniquestr_stats(void)
+static const char *uniquestr_locked(const char *string, size_t length)
 {
-    unsigned long long bucket_length[HASH_LENGTH];
-    unsigned long long number_of_strings = 0;
-    unsigned long long number_of_bytes = 0;
+    if (length > UINT32_MAX)
+        abort();
 
-    int i, j;
-    for (i = 0; i < HASH_LENGTH; i++)
-    {
-        string_link_t *p = hash_table[i];
+    uint32_t hash = hash_string(string, length);
 
-        j = 0;
-        while (p != NULL)
-        {
-            // fprintf(stderr, "%d.%d |%s|\n", i, j, p->string);
-            number_of_strings++;
-            number_of_bytes += strlen(p->string) + 1; // +1 for NULL
+    // Maximum load factor is 3/4
+    if (4 * (number_of_strings + 1) > 3 * table_capacity)
+        grow_table();
 
-            p = p->next;
-            j++;
+    uint32_t mask = table_capacity - 1;
+    uint32_t index = hash & mask;
+
+    // Linear probing
+    while (hash_table[index].string != NULL)
+    {
+        string_slot_t *slot = &hash_table[index];
+        if (slot->hash == hash
+                && slot->length == length
+                && memcmp(slot->string, string, length) == 0)
+        {
+            return slot->string;
         }
 
-        bucket_length[i] = j;
+        index = (index + 1) & mask;
     }
 
-    unsigned long long max_bucket = 0;
-    unsigned long long min_bucket = ULLONG_MAX;
-    unsigned long long sum_buckets = 0;
-    unsigned long long num_empty_buckets = 0;
+    if (string_arena == NULL)
+        string_arena = mem_arena_new(/* chunk_size */ 0);
 
-    for (i = 0; i < HASH_LENGTH; i++)
-    {
-        if (bucket_length[i] >= max_bucket)
-            max_bucket = bucket_length[i];
-        if (bucket_length[i] <= min_bucket)
-            min_bucket = bucket_length[i];
+    size_t size = length + 1;
+    char *interned = (char*)mem_arena_alloc(string_arena, size);
+    memcpy(interned, string, length);
+    interned[length] = '\0';
 
-        sum_buckets += bucket_length[i];
+    hash_table[index].hash = hash;
+    hash_table[index].length = length;
+    hash_table[index].string = interned;
 
-        num_empty_buckets += (bucket_length[i] == 0);
-    }
+    number_of_strings++;
+    bytes_used += size;
+
+    return interned;
+}
 
-    float avg_bucket = 0.0f;
-    avg_bucket = ((float)sum_buckets / (float)HASH_LENGTH);
+const char *uniquestrn(const char *string, size_t length)
+{
+    if (string == NULL)
+        return NULL;
+
+    lock_table();
+    const char* result = uniquestr_locked(string, length);
+    unlock_table();
 
-    float stddev_bucket = 0.0f;
-    for (i = 0; i < HASH_LENGTH; i++)
+    return result;
+}
+
+const char *uniquestr(const char *string)
+{
+    if (string == NULL)
+        return NULL;
+
+    return uniquestrn(string, strlen(string));
+}
+
+void uniquestr_stats(void)
+{
+    lock_table();
+
+    unsigned long long number_of_bytes = 0;
+    unsigned long long sum_probes = 0;
+    unsigned long long max_probe = 0;
+
+    uint32_t mask = table_capacity - 1;
+    uint32_t i;
+    for (i = 0; i < table_capacity; i++)
     {
-        stddev_bucket += fabsf(bucket_length[i] - avg_bucket);
+        if (hash_table[i].string == NULL)
+            continue;
+
+        number_of_bytes += hash_table[i].length + 1; // +1 for NULL
+
+        // Number of slots examined by a lookup of this string
+        unsigned long long probe = ((i - hash_table[i].hash) & mask) + 1;
+        sum_probes += probe;
+        if (probe > max_probe)
+            max_probe = probe;
     }
-    stddev_bucket = sqrtf(stddev_bucket / (float)(HASH_LENGTH - 1));
 
     fprintf(stderr, "String table statistics\n");
     fprintf(stderr, "=======================\n\n");
 
-    fprintf(stderr, "Size of hash: %d\n", HASH_LENGTH);
-    fprintf(stderr, "Number of strings: %llu\n", number_of_strings);
+    fprintf(stderr, "Size of hash: %u\n", table_capacity);
+    fprintf(stderr, "Number of strings: %u\n", number_of_strings);
     fprintf(stderr, "Number of bytes taken by the strings: %llu\n", number_of_bytes);
-    fprintf(stderr, "Number of empty buckets: %llu\n", num_empty_buckets);
-    fprintf(stderr, "Minimum bucket length: %llu\n", min_bucket);
-    fprintf(stderr, "Maximum bucket length: %llu\n", max_bucket);
-    fprintf(stderr, "Average bucket length: %.2f\n", avg_bucket);
-    fprintf(stderr, "StdDev  bucket length: %.2f\n", stddev_bucket);
+    fprintf(stderr, "Number of bytes used by the string table: %llu\n", bytes_used);
+    fprintf(stderr, "Load factor: %.2f\n",
+            table_capacity == 0 ? 0.0 : (double)number_of_strings / (double)table_capacity);
+    fprintf(stderr, "Average probe length: %.2f\n",
+            number_of_strings == 0 ? 0.0 : (double)sum_probes / (double)number_of_strings);
+    fprintf(stderr, "Maximum probe length: %llu\n", max_probe);
+
+    unlock_table();
 }
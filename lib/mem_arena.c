@@ -0,0 +1,159 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#include <stdint.h>
+#include <string.h>
+
+#include "mem_arena.h"
+#include "mem.h"
+
+#define MEM_ARENA_DEFAULT_CHUNK_SIZE (1024 * 1024)
+
+// Objects are aligned like a pair of pointers, which is what malloc does
+#define MEM_ARENA_ALIGNMENT (2 * sizeof(void*))
+#define MEM_ARENA_ALIGN(x) (((x) + MEM_ARENA_ALIGNMENT - 1) & ~(MEM_ARENA_ALIGNMENT - 1))
+
+typedef struct mem_arena_chunk_tag
+{
+    struct mem_arena_chunk_tag* next;
+    size_t size;
+} mem_arena_chunk_t;
+
+#define MEM_ARENA_CHUNK_HEADER MEM_ARENA_ALIGN(sizeof(mem_arena_chunk_t))
+
+struct mem_arena_tag
+{
+    size_t chunk_size;
+
+    // Chunks in reverse order of creation
+    mem_arena_chunk_t* chunks;
+    char* current;
+    char* end;
+
+    size_t allocated;
+    size_t reserved;
+    int num_chunks;
+};
+
+mem_arena_t* mem_arena_new(size_t chunk_size)
+{
+    mem_arena_t* arena = NEW0(mem_arena_t);
+    arena->chunk_size = (chunk_size == 0) ? MEM_ARENA_DEFAULT_CHUNK_SIZE : chunk_size;
+    return arena;
+}
+
+void mem_arena_destroy(mem_arena_t* arena)
+{
+    if (arena == NULL)
+        return;
+
+    mem_arena_chunk_t* chunk = arena->chunks;
+    while (chunk != NULL)
+    {
+        mem_arena_chunk_t* next = chunk->next;
+        DELETE(chunk);
+        chunk = next;
+    }
+
+    DELETE(arena);
+}
+
+static mem_arena_chunk_t* mem_arena_new_chunk(mem_arena_t* arena, size_t size)
+{
+    mem_arena_chunk_t* chunk = (mem_arena_chunk_t*)xmalloc(MEM_ARENA_CHUNK_HEADER + size);
+    chunk->size = size;
+
+    arena->reserved += size;
+    arena->num_chunks++;
+
+    return chunk;
+}
+
+void* mem_arena_alloc(mem_arena_t* arena, size_t size)
+{
+    size = MEM_ARENA_ALIGN(size == 0 ? 1 : size);
+    arena->allocated += size;
+
+    if (size <= (size_t)(arena->end - arena->current))
+    {
+        void* result = arena->current;
+        arena->current += size;
+        return result;
+    }
+
+    // Big objects get their own chunk so the current one is not wasted
+    if (size > arena->chunk_size / 4)
+    {
+        mem_arena_chunk_t* chunk = mem_arena_new_chunk(arena, size);
+        if (arena->chunks == NULL)
+        {
+            chunk->next = NULL;
+            arena->chunks = chunk;
+        }
+        else
+        {
+            chunk->next = arena->chunks->next;
+            arena->chunks->next = chunk;
+        }
+        return (char*)chunk + MEM_ARENA_CHUNK_HEADER;
+    }
+
+    mem_arena_chunk_t* chunk = mem_arena_new_chunk(arena, arena->chunk_size);
+    chunk->next = arena->chunks;
+    arena->chunks = chunk;
+
+    arena->current = (char*)chunk + MEM_ARENA_CHUNK_HEADER;
+    arena->end = arena->current + arena->chunk_size;
+
+    void* result = arena->current;
+    arena->current += size;
+    return result;
+}
+
+void* mem_arena_alloc0(mem_arena_t* arena, size_t size)
+{
+    void* result = mem_arena_alloc(arena, size);
+    memset(result, 0, size);
+    return result;
+}
+
+size_t mem_arena_get_allocated(mem_arena_t* arena)
+{
+    return arena->allocated;
+}
+
+size_t mem_arena_get_reserved(mem_arena_t* arena)
+{
+    return arena->reserved;
+}
+
+int mem_arena_get_num_chunks(mem_arena_t* arena)
+{
+    return arena->num_chunks;
+}
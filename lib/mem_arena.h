@@ -0,0 +1,63 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Region of memory where objects are allocated by bumping a pointer. They
+// cannot be freed one by one, only all at once when the arena is
+// destroyed
+
+typedef struct mem_arena_tag mem_arena_t;
+
+// chunk_size is the size of every block requested to the system, 0 uses
+// a default size
+mem_arena_t* mem_arena_new(size_t chunk_size);
+void mem_arena_destroy(mem_arena_t*);
+
+// The memory is suitably aligned for any object
+void* mem_arena_alloc(mem_arena_t*, size_t size);
+void* mem_arena_alloc0(mem_arena_t*, size_t size);
+
+// Bytes requested by allocations and bytes obtained from the system
+size_t mem_arena_get_allocated(mem_arena_t*);
+size_t mem_arena_get_reserved(mem_arena_t*);
+int mem_arena_get_num_chunks(mem_arena_t*);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_ARENA_H
@@ -0,0 +1,465 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "ohash_ptr.h"
+#include "mem.h"
+
+// Every slot has a control byte. Empty and deleted slots have the high bit
+// set, full slots keep 7 bits of the hash of their key. A query compares
+// the control bytes of a group of slots with those 7 bits and only looks
+// at the keys of the slots that match
+enum
+{
+    CTRL_EMPTY = 0x80,
+    CTRL_DELETED = 0xFE,
+};
+
+enum { GROUP_WIDTH = 16 };
+// Capacities are powers of two not smaller than a group
+enum { MIN_CAPACITY = GROUP_WIDTH };
+
+typedef uint32_t group_mask_t;
+
+// Pointer keys are stored as integers so both kinds of table share the
+// implementation
+typedef
+struct slot_tag
+{
+    uint64_t key;
+    void* info;
+} slot_t;
+
+typedef
+struct ohash_table_tag
+{
+    // capacity + GROUP_WIDTH control bytes. The last GROUP_WIDTH are a copy
+    // of the first ones so a group can always be loaded from any position
+    uint8_t* ctrl;
+    slot_t* slots;
+    uint32_t capacity;
+    uint32_t num_items;
+    // Slots that can still be used before the table must be rehashed
+    uint32_t growth_left;
+} ohash_table_t;
+
+struct ohash_ptr_tag
+{
+    ohash_table_t table;
+};
+
+struct ohash_u64_tag
+{
+    ohash_table_t table;
+};
+
+static inline uint64_t hash_key(uint64_t h)
+{
+    // Finalizer of splitmix64: uniquestr pointers only differ in a few
+    // middle bits
+    h ^= h >> 30;
+    h *= UINT64_C(0xbf58476d1ce4e5b9);
+    h ^= h >> 27;
+    h *= UINT64_C(0x94d049bb133111eb);
+    h ^= h >> 31;
+    return h;
+}
+
+static inline uint64_t key_of_pointer(const char* key)
+{
+    return (uint64_t)(uintptr_t)key;
+}
+
+static inline uint32_t hash_h1(uint64_t h) { return (uint32_t)(h >> 7); }
+static inline uint8_t hash_h2(uint64_t h) { return (uint8_t)(h & 0x7F); }
+
+// Bit i of the result is set if byte i of the group equals b
+static inline group_mask_t group_match(const uint8_t* group, uint8_t b)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (group_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)b)));
+#else
+    group_mask_t result = 0;
+    int i;
+    for (i = 0; i < GROUP_WIDTH; i++)
+    {
+        if (group[i] == b)
+            result |= ((group_mask_t)1 << i);
+    }
+    return result;
+#endif
+}
+
+// Bit i of the result is set if byte i of the group is empty or deleted
+static inline group_mask_t group_match_free(const uint8_t* group)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (group_mask_t)_mm_movemask_epi8(ctrl);
+#else
+    group_mask_t result = 0;
+    int i;
+    for (i = 0; i < GROUP_WIDTH; i++)
+    {
+        if (group[i] & 0x80)
+            result |= ((group_mask_t)1 << i);
+    }
+    return result;
+#endif
+}
+
+static inline int lowest_bit(group_mask_t m)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(m);
+#else
+    int i = 0;
+    while (!(m & 1))
+    {
+        m >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+static inline void set_ctrl(ohash_table_t* table, uint32_t i, uint8_t b)
+{
+    table->ctrl[i] = b;
+    if (i < GROUP_WIDTH)
+        table->ctrl[table->capacity + i] = b;
+}
+
+static inline uint32_t max_items(uint32_t capacity)
+{
+    // Maximum load factor is 7/8
+    return capacity - capacity / 8;
+}
+
+static void table_allocate(ohash_table_t* table, uint32_t capacity)
+{
+    table->capacity = capacity;
+    table->ctrl = NEW_VEC(uint8_t, capacity + GROUP_WIDTH);
+    memset(table->ctrl, CTRL_EMPTY, capacity + GROUP_WIDTH);
+    table->slots = NEW_VEC(slot_t, capacity);
+    table->growth_left = max_items(capacity) - table->num_items;
+}
+
+static uint32_t capacity_for(uint32_t num_items)
+{
+    uint32_t capacity = MIN_CAPACITY;
+    while (max_items(capacity) < num_items)
+    {
+        if (capacity >= (UINT32_C(1) << 31))
+            abort();
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+static void table_init(ohash_table_t* table, int initial_size)
+{
+    if (initial_size < 0) abort();
+
+    // Most scopes are small or empty so no table is allocated until the
+    // first insertion unless a size has been requested explicitly
+    if (initial_size > MIN_CAPACITY)
+    {
+        table_allocate(table, capacity_for(initial_size));
+    }
+}
+
+static void table_release(ohash_table_t* table)
+{
+    DELETE(table->ctrl);
+    DELETE(table->slots);
+}
+
+// Returns the slot of key or -1 if it is not in the table
+static inline int64_t table_find(ohash_table_t* table, uint64_t key, uint64_t h)
+{
+    uint32_t mask = table->capacity - 1;
+    uint32_t pos = hash_h1(h) & mask;
+    uint8_t h2 = hash_h2(h);
+    uint32_t stride = 0;
+
+    for (;;)
+    {
+        const uint8_t* group = &table->ctrl[pos];
+
+        group_mask_t m = group_match(group, h2);
+        while (m != 0)
+        {
+            uint32_t i = (pos + lowest_bit(m)) & mask;
+            if (table->slots[i].key == key)
+                return i;
+            m &= m - 1;
+        }
+
+        // An empty slot ends the probe sequence
+        if (group_match(group, CTRL_EMPTY) != 0)
+            return -1;
+
+        // Triangular probing visits every group when capacity is a power
+        // of two
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+// First empty or deleted slot in the probe sequence of h
+static inline uint32_t table_find_free(ohash_table_t* table, uint64_t h)
+{
+    uint32_t mask = table->capacity - 1;
+    uint32_t pos = hash_h1(h) & mask;
+    uint32_t stride = 0;
+
+    for (;;)
+    {
+        group_mask_t m = group_match_free(&table->ctrl[pos]);
+        if (m != 0)
+            return (pos + lowest_bit(m)) & mask;
+
+        stride += GROUP_WIDTH;
+        pos = (pos + stride) & mask;
+    }
+}
+
+static inline void* table_query(ohash_table_t* table, uint64_t key)
+{
+    if (table->num_items == 0)
+        return NULL;
+
+    int64_t i = table_find(table, key, hash_key(key));
+    if (i < 0)
+        return NULL;
+
+    return table->slots[i].info;
+}
+
+static void table_rehash(ohash_table_t* table, uint32_t new_capacity)
+{
+    uint8_t* old_ctrl = table->ctrl;
+    slot_t* old_slots = table->slots;
+    uint32_t old_capacity = table->capacity;
+
+    table_allocate(table, new_capacity);
+
+    uint32_t i;
+    for (i = 0; i < old_capacity; i++)
+    {
+        if (old_ctrl[i] & 0x80)
+            continue;
+
+        uint64_t h = hash_key(old_slots[i].key);
+        uint32_t j = table_find_free(table, h);
+        set_ctrl(table, j, hash_h2(h));
+        table->slots[j] = old_slots[i];
+    }
+
+    DELETE(old_ctrl);
+    DELETE(old_slots);
+}
+
+// Sets the info of key and returns the one it had, NULL if key was not in
+// the table
+static void* table_insert(ohash_table_t* table, uint64_t key, void* info)
+{
+    if (info == NULL) abort();
+
+    uint64_t h = hash_key(key);
+
+    if (table->capacity == 0)
+    {
+        table_allocate(table, MIN_CAPACITY);
+    }
+    else
+    {
+        int64_t i = table_find(table, key, h);
+        if (i >= 0)
+        {
+            // Update
+            void* previous = table->slots[i].info;
+            table->slots[i].info = info;
+            return previous;
+        }
+    }
+
+    uint32_t i = table_find_free(table, h);
+    if (table->growth_left == 0
+            && table->ctrl[i] == CTRL_EMPTY)
+    {
+        // If most of the used slots are deleted keep the capacity and just
+        // drop the tombstones
+        uint32_t new_capacity = table->capacity;
+        if (table->num_items >= max_items(table->capacity) / 2)
+            new_capacity *= 2;
+        table_rehash(table, new_capacity);
+        i = table_find_free(table, h);
+    }
+
+    // Reusing a deleted slot does not use up the table
+    if (table->ctrl[i] == CTRL_EMPTY)
+        table->growth_left--;
+
+    set_ctrl(table, i, hash_h2(h));
+    table->slots[i].key = key;
+    table->slots[i].info = info;
+    table->num_items++;
+
+    return NULL;
+}
+
+static void table_remove(ohash_table_t* table, uint64_t key)
+{
+    if (table->num_items == 0)
+        return;
+
+    int64_t i = table_find(table, key, hash_key(key));
+    if (i < 0)
+        return;
+
+    set_ctrl(table, i, CTRL_DELETED);
+    table->slots[i].key = 0;
+    table->slots[i].info = NULL;
+    table->num_items--;
+}
+
+ohash_ptr_t* ohash_ptr_new(int initial_size)
+{
+    ohash_ptr_t* result = NEW0(ohash_ptr_t);
+    table_init(&result->table, initial_size);
+    return result;
+}
+
+void ohash_ptr_destroy(ohash_ptr_t* ohash)
+{
+    table_release(&ohash->table);
+    DELETE(ohash);
+}
+
+int ohash_ptr_get_num_items(ohash_ptr_t* ohash)
+{
+    return ohash->table.num_items;
+}
+
+void* ohash_ptr_query(ohash_ptr_t* ohash, const char* key)
+{
+    if (key == NULL) abort();
+
+    return table_query(&ohash->table, key_of_pointer(key));
+}
+
+void ohash_ptr_insert(ohash_ptr_t* ohash, const char* key, ohash_ptr_info_t info)
+{
+    if (key == NULL) abort();
+
+    table_insert(&ohash->table, key_of_pointer(key), info);
+}
+
+void ohash_ptr_remove(ohash_ptr_t* ohash, const char* key)
+{
+    if (key == NULL) abort();
+
+    table_remove(&ohash->table, key_of_pointer(key));
+}
+
+void ohash_ptr_walk(ohash_ptr_t* ohash, ohash_ptr_walk_fn walk_fn, void *walk_info)
+{
+    ohash_table_t* table = &ohash->table;
+    uint32_t i;
+    for (i = 0; i < table->capacity; i++)
+    {
+        if (table->ctrl[i] & 0x80)
+            continue;
+
+        walk_fn((const char*)(uintptr_t)table->slots[i].key,
+                table->slots[i].info, walk_info);
+    }
+}
+
+ohash_u64_t* ohash_u64_new(int initial_size)
+{
+    ohash_u64_t* result = NEW0(ohash_u64_t);
+    table_init(&result->table, initial_size);
+    return result;
+}
+
+void ohash_u64_destroy(ohash_u64_t* ohash)
+{
+    table_release(&ohash->table);
+    DELETE(ohash);
+}
+
+int ohash_u64_get_num_items(ohash_u64_t* ohash)
+{
+    return ohash->table.num_items;
+}
+
+void* ohash_u64_query(ohash_u64_t* ohash, uint64_t key)
+{
+    return table_query(&ohash->table, key);
+}
+
+void ohash_u64_insert(ohash_u64_t* ohash, uint64_t key, void* info)
+{
+    table_insert(&ohash->table, key, info);
+}
+
+void* ohash_u64_push(ohash_u64_t* ohash, uint64_t key, void* info)
+{
+    return table_insert(&ohash->table, key, info);
+}
+
+void ohash_u64_remove(ohash_u64_t* ohash, uint64_t key)
+{
+    table_remove(&ohash->table, key);
+}
+
+void ohash_u64_walk(ohash_u64_t* ohash, ohash_u64_walk_fn walk_fn, void *walk_info)
+{
+    ohash_table_t* table = &ohash->table;
+    uint32_t i;
+    for (i = 0; i < table->capacity; i++)
+    {
+        if (table->ctrl[i] & 0x80)
+            continue;
+
+        walk_fn(table->slots[i].key, table->slots[i].info, walk_info);
+    }
+}
@@ -0,0 +1,88 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+
+
+#ifndef OHASH_PTR_H
+#define OHASH_PTR_H
+
+// Open addressing hash keyed on pointers (e.g. strings from uniquestr)
+//
+// Same interface as dhash_ptr but the keys and values are stored inline in
+// the table and the control bytes of a group of slots are probed at once.
+// The table grows without limit
+//
+// ohash_u64 is the same table keyed on 64-bit integers, e.g. hashes of
+// composite keys. Caches whose entries may share a key chain them through
+// the entries themselves and use ohash_u64_push to add one to the front
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* ohash_ptr_info_t;
+
+typedef struct ohash_ptr_tag ohash_ptr_t;
+
+ohash_ptr_t* ohash_ptr_new(int initial_size);
+void ohash_ptr_destroy(ohash_ptr_t*);
+void* ohash_ptr_query(ohash_ptr_t*, const char* key);
+void ohash_ptr_insert(ohash_ptr_t*, const char* key, ohash_ptr_info_t info);
+void ohash_ptr_remove(ohash_ptr_t*, const char* key);
+int ohash_ptr_get_num_items(ohash_ptr_t*);
+
+typedef void ohash_ptr_walk_fn(const char* key, void* info, void *walk_info);
+
+// The table must not be modified while it is walked
+void ohash_ptr_walk(ohash_ptr_t*, ohash_ptr_walk_fn walk_fn, void* walk_info);
+
+typedef struct ohash_u64_tag ohash_u64_t;
+
+ohash_u64_t* ohash_u64_new(int initial_size);
+void ohash_u64_destroy(ohash_u64_t*);
+void* ohash_u64_query(ohash_u64_t*, uint64_t key);
+void ohash_u64_insert(ohash_u64_t*, uint64_t key, void* info);
+// Like ohash_u64_insert but returns the info key had, NULL if none. The
+// caller links it from the new info to keep every entry of the key
+void* ohash_u64_push(ohash_u64_t*, uint64_t key, void* info);
+void ohash_u64_remove(ohash_u64_t*, uint64_t key);
+int ohash_u64_get_num_items(ohash_u64_t*);
+
+typedef void ohash_u64_walk_fn(uint64_t key, void* info, void *walk_info);
+
+// The table must not be modified while it is walked
+void ohash_u64_walk(ohash_u64_t*, ohash_u64_walk_fn walk_fn, void* walk_info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OHASH_PTR_H
@@ -0,0 +1,144 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+
+
+
+// Microbenchmark of the hashes used for the symbols of a scope
+//
+// Usage: ohash-ptr-bench [max-symbols]
+//
+// For synthetic scopes of 10^3 up to max-symbols (10^6 by default) interned
+// names it measures the insertion of all the names, the query of all of
+// them and the query of the same number of names that are not in the scope
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "uniquestr.h"
+#include "dhash_ptr.h"
+#include "ohash_ptr.h"
+#include "mem.h"
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static const char** make_names(const char* prefix, int n)
+{
+    const char** names = NEW_VEC(const char*, n);
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        char c[64];
+        snprintf(c, sizeof(c), "%s_%d", prefix, i);
+        names[i] = uniquestr(c);
+    }
+    return names;
+}
+
+typedef
+struct bench_result_tag
+{
+    double insert;
+    double query_hit;
+    double query_miss;
+} bench_result_t;
+
+// Million of operations per second
+static double mops(int n, double seconds)
+{
+    return seconds > 0 ? (n / seconds) / 1e6 : 0;
+}
+
+#define BENCH_HASH(kind, names, absent, n, result) \
+do { \
+    volatile long found = 0; \
+    double start = now(); \
+    kind##_t* h = kind##_new(5); \
+    int i; \
+    for (i = 0; i < (n); i++) \
+        kind##_insert(h, (names)[i], (void*)(names)[i]); \
+    (result).insert = now() - start; \
+    start = now(); \
+    for (i = 0; i < (n); i++) \
+        found += (kind##_query(h, (names)[i]) != NULL); \
+    (result).query_hit = now() - start; \
+    start = now(); \
+    for (i = 0; i < (n); i++) \
+        found += (kind##_query(h, (absent)[i]) != NULL); \
+    (result).query_miss = now() - start; \
+    if (found != (n)) \
+    { \
+        fprintf(stderr, #kind ": wrong number of names found\n"); \
+        exit(EXIT_FAILURE); \
+    } \
+    kind##_destroy(h); \
+} while (0)
+
+int main(int argc, char* argv[])
+{
+    int max_symbols = 1000000;
+    if (argc > 1)
+        max_symbols = atoi(argv[1]);
+
+    if (max_symbols < 1000)
+    {
+        fprintf(stderr, "usage: %s [max-symbols >= 1000]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char** names = make_names("sym", max_symbols);
+    const char** absent = make_names("absent", max_symbols);
+
+    printf("%10s %-10s %12s %12s %12s   (Mops/s)\n",
+            "symbols", "hash", "insert", "query hit", "query miss");
+
+    int n;
+    for (n = 1000; n <= max_symbols; n *= 10)
+    {
+        bench_result_t dhash, ohash;
+        BENCH_HASH(dhash_ptr, names, absent, n, dhash);
+        BENCH_HASH(ohash_ptr, names, absent, n, ohash);
+
+        printf("%10d %-10s %12.2f %12.2f %12.2f\n", n, "dhash_ptr",
+                mops(n, dhash.insert), mops(n, dhash.query_hit), mops(n, dhash.query_miss));
+        printf("%10d %-10s %12.2f %12.2f %12.2f\n", n, "ohash_ptr",
+                mops(n, ohash.insert), mops(n, ohash.query_hit), mops(n, ohash.query_miss));
+    }
+
+    DELETE(names);
+    DELETE(absent);
+
+    return EXIT_SUCCESS;
+}
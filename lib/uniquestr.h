@@ -30,6 +30,7 @@
 #ifndef UNIQUESTR_H
 #define UNIQUESTR_H
 
+#include <stddef.h>
 #include "libutils-common.h"
 
 #ifdef __cplusplus
@@ -39,6 +40,10 @@ extern "C" {
 #define uniqstr uniquestr
 LIBUTILS_EXTERN const char *uniquestr(const char*);
 
+// Interns the first length characters of the string, which does not have
+// to be NULL-ended
+LIBUTILS_EXTERN const char *uniquestrn(const char*, size_t length);
+
 #define UNIQUESTR_LITERAL(literal) \
   ({ static const char* _cached_uniquestr = NULL; \
      if (_cached_uniquestr == NULL)  _cached_uniquestr = uniquestr(literal); \
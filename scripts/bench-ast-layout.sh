@@ -0,0 +1,252 @@
+#!/bin/bash
+
+# Measures the memory and the walk time of the trees alone, without parsing.
+#
+# Usage: bench-ast-layout.sh [-s size] builddir...
+#
+# For every build directory given (e.g. one configured from a tree before and
+# one after a change of the layout of the nodes) a small program is linked
+# with the objects of the frontend already compiled there. It builds, in the
+# arena of a translation unit, the trees of the function bodies generated by
+# bench-ast.sh and walks them with the child and parent accessors and with
+# ast_check. Unlike bench-ast.sh it does not need a working lexer, so it
+# also works on partial builds.
+
+size=200000
+
+while getopts "s:" opt;
+do
+    case $opt in
+        s) size=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-s size] builddir..." 1>&2
+    exit 1
+fi
+
+CC=${CC:-gcc}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+# debug_options is defined by an object generated with gperf
+cat > $workdir/stub.c <<'EOF_STUB'
+#include "config.h"
+#include "cxx-driver-decls.h"
+debug_options_t debug_options;
+EOF_STUB
+
+cat > $workdir/bench.c <<'EOF_BENCH'
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "cxx-ast.h"
+#include "mem_arena.h"
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static long rss_kb(void)
+{
+    FILE* f = fopen("/proc/self/status", "r");
+    char line[256];
+    long v = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (sscanf(line, "VmRSS: %ld", &v) == 1)
+            break;
+    }
+    fclose(f);
+    return v;
+}
+
+static unsigned long num_nodes = 0;
+static unsigned long num_nodes_by_children[5];
+
+static AST make(node_t kind, int n, AST s0, AST s1, AST s2, AST s3, const char* text)
+{
+    num_nodes++;
+    num_nodes_by_children[n]++;
+    return ast_make(kind, n, s0, s1, s2, s3, NULL, text);
+}
+
+static AST list(AST l, AST e)
+{
+    num_nodes++;
+    if (l == NULL)
+    {
+        num_nodes_by_children[1]++;
+        return ASTListLeaf(e);
+    }
+    num_nodes_by_children[2]++;
+    return ASTList(l, e);
+}
+
+#define LEAF(k, t) make(k, 0, NULL, NULL, NULL, NULL, t)
+#define MAKE1(k, a) make(k, 1, a, NULL, NULL, NULL, NULL)
+#define MAKE2(k, a, b) make(k, 2, a, b, NULL, NULL, NULL)
+#define MAKE3(k, a, b, c) make(k, 3, a, b, c, NULL, NULL)
+
+static AST sym(void)
+{
+    return LEAF(AST_SYMBOL, "x");
+}
+
+static AST lit(void)
+{
+    return LEAF(AST_DECIMAL_LITERAL, "1");
+}
+
+static AST member(void)
+{
+    return MAKE2(AST_CLASS_MEMBER_ACCESS, sym(), sym());
+}
+
+static AST call(int num_args)
+{
+    AST args = NULL;
+    int i;
+    for (i = 0; i < num_args; i++)
+        args = list(args, sym());
+    return MAKE2(AST_FUNCTION_CALL, member(), args);
+}
+
+// r = 0;
+// for (i = 0; i < n; i++)
+// {
+//     if ((i & 1) == 0 && s.y < n) r += s.g(i) * 2 - (s.x << 1);
+//     else r -= s.f(i, r) / (i + 1) + s.y % 7;
+// }
+// return r;
+static AST body(void)
+{
+    AST cond = MAKE2(AST_LOGICAL_AND,
+            MAKE2(AST_EQUAL, MAKE2(AST_BITWISE_AND, sym(), lit()), lit()),
+            MAKE2(AST_LOWER_THAN, member(), sym()));
+    AST then = MAKE1(AST_EXPRESSION_STATEMENT,
+            MAKE2(AST_ADD_ASSIGNMENT, sym(),
+                MAKE2(AST_MINUS,
+                    MAKE2(AST_MUL, call(1), lit()),
+                    MAKE2(AST_BITWISE_SHL, member(), lit()))));
+    AST otherwise = MAKE1(AST_EXPRESSION_STATEMENT,
+            MAKE2(AST_SUB_ASSIGNMENT, sym(),
+                MAKE2(AST_ADD,
+                    MAKE2(AST_DIV, call(2), MAKE2(AST_ADD, sym(), lit())),
+                    MAKE2(AST_MOD, member(), lit()))));
+    AST if_else = MAKE3(AST_IF_ELSE_STATEMENT, MAKE1(AST_CONDITION, cond), then, otherwise);
+    AST loop = MAKE2(AST_FOR_STATEMENT,
+            MAKE3(AST_LOOP_CONTROL,
+                MAKE1(AST_EXPRESSION_STATEMENT, MAKE2(AST_ASSIGNMENT, sym(), lit())),
+                MAKE2(AST_LOWER_THAN, sym(), sym()),
+                MAKE1(AST_POSTINCREMENT, sym())),
+            MAKE1(AST_COMPOUND_STATEMENT, list(NULL, if_else)));
+
+    AST statements = list(NULL, MAKE1(AST_EXPRESSION_STATEMENT, MAKE2(AST_ASSIGNMENT, sym(), lit())));
+    statements = list(statements, loop);
+    statements = list(statements, MAKE1(AST_RETURN_STATEMENT, sym()));
+    return MAKE1(AST_COMPOUND_STATEMENT, statements);
+}
+
+static unsigned long walk(AST a)
+{
+    if (a == NULL)
+        return 0;
+
+    unsigned long n = 1 + (ASTParent(a) != NULL);
+    n += walk(ASTSon0(a));
+    n += walk(ASTSon1(a));
+    n += walk(ASTSon2(a));
+    n += walk(ASTSon3(a));
+    return n;
+}
+
+int main(int argc, char* argv[])
+{
+    int size = atoi(argv[1]);
+
+    long rss_at_start = rss_kb();
+    mem_arena_t* arena = mem_arena_new(/* chunk_size */ 0);
+    ast_set_arena(arena);
+
+    double start = now();
+    AST tree = NULL;
+    int i;
+    for (i = 0; i < size; i++)
+        tree = list(tree, body());
+    double build_time = now() - start;
+    long rss_growth = rss_kb() - rss_at_start;
+
+    // Best of five walks
+    double walk_time = 0.0, check_time = 0.0;
+    unsigned long visited = 0;
+    for (i = 0; i < 5; i++)
+    {
+        start = now();
+        visited = walk(tree);
+        double t = now() - start;
+        if (i == 0 || t < walk_time)
+            walk_time = t;
+
+        start = now();
+        if (!ast_check(tree))
+        {
+            fprintf(stderr, "ast_check failed\n");
+            return 1;
+        }
+        t = now() - start;
+        if (i == 0 || t < check_time)
+            check_time = t;
+    }
+
+    printf("%lu nodes (with 0, 1, 2, 3 children: %lu %lu %lu %lu), %lu visits\n",
+            num_nodes,
+            num_nodes_by_children[0], num_nodes_by_children[1],
+            num_nodes_by_children[2], num_nodes_by_children[3],
+            visited);
+    printf("arena: %zu bytes, %.1f bytes per node, RSS growth: %ld KB\n",
+            mem_arena_get_allocated(arena),
+            (double)mem_arena_get_allocated(arena) / num_nodes,
+            rss_growth);
+    printf("build: %.3f s, walk: %.3f s, ast_check: %.3f s\n",
+            build_time, walk_time, check_time);
+    return 0;
+}
+EOF_BENCH
+
+# Lists of declarations are walked recursively
+ulimit -s unlimited
+
+for builddir in "$@";
+do
+    builddir=$(cd $builddir && pwd)
+    srcdir=$(sed -n 's/^abs_top_srcdir = //p' $builddir/Makefile)
+
+    rm -f $workdir/libfrontend.a
+    ar rcs $workdir/libfrontend.a \
+        $(find $builddir/src/frontend $builddir/lib -path "*/.libs/*.o")
+
+    if ! $CC -O2 -std=gnu99 -DHAVE_CONFIG_H \
+        -I$builddir -I$srcdir -I$srcdir/lib -I$srcdir/src/driver \
+        -I$srcdir/src/frontend -I$srcdir/src/frontend/fortran \
+        -I$srcdir/support/gperf -I$builddir/src/frontend \
+        -I$builddir/src/frontend/fortran -I$builddir/support/gperf \
+        -o $workdir/bench $workdir/bench.c $workdir/stub.c $workdir/libfrontend.a \
+        -lm -ldl -lpthread;
+    then
+        echo "cannot link the benchmark with the objects of $builddir" 1>&2
+        exit 1
+    fi
+
+    echo "== $builddir"
+    $workdir/bench $size
+done
@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# Measures the memory used by the trees of a large translation unit and the
+# time of a walk over them.
+#
+# Usage: bench-ast.sh [-n repetitions] [-s size] compiler...
+#
+# Every compiler given (e.g. a build before and one after a change of the
+# layout of the nodes) compiles the same generated file. The peak RSS of the
+# compiler, the number of nodes of the parsed tree and of the nodecl tree and
+# the time of walking each of them, as written by --report, are shown for the
+# fastest run.
+
+repetitions=5
+size=2000
+
+while getopts "n:s:" opt;
+do
+    case $opt in
+        n) repetitions=$OPTARG ;;
+        s) size=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-n repetitions] [-s size] compiler..." 1>&2
+    exit 1
+fi
+
+PYTHON=${PYTHON:-python3}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+input=$workdir/ast.cpp
+
+# Many small classes and functions whose bodies are mostly expressions, so
+# the trees are large compared to the symbols and types
+{
+    echo "struct B { int x; int f(int a, int b) const { return a * x + b; } };"
+    for i in $(seq 1 $size);
+    do
+        echo "struct S$i : B { int y$i; int g(int k) { return f(k, y$i) + (k > 0 ? g(k - 1) : 0); } };"
+        echo "int h$i(S$i& s, int n)"
+        echo "{"
+        echo "    int r = 0;"
+        echo "    for (int i = 0; i < n; i++)"
+        echo "    {"
+        echo "        if ((i & 1) == 0 && s.y$i < n) r += s.g(i) * 2 - (s.x << 1);"
+        echo "        else r -= s.f(i, r) / (i + 1) + s.y$i % 7;"
+        echo "    }"
+        echo "    return r;"
+        echo "}"
+    done
+} > $input
+
+printf "%-40s %12s %14s %12s %14s %12s %14s\n" "compiler" "wall (s)" "peak RSS (KB)" \
+    "ast nodes" "ast walk (us)" "nodecl nodes" "nodecl walk (us)"
+for compiler in "$@";
+do
+    reports=""
+    for i in $(seq 1 $repetitions);
+    do
+        report=$workdir/report-$i.json
+        if ! $compiler -y --report=$report -o $workdir/ast.out.cpp $input > /dev/null 2>&1;
+        then
+            echo "$compiler failed to compile the benchmark" 1>&2
+            exit 1
+        fi
+        reports="$reports $report"
+    done
+
+    $PYTHON - "$compiler" $reports <<'PYEOF'
+import json, sys
+
+compiler = sys.argv[1]
+reports = [json.load(open(f)) for f in sys.argv[2:]]
+
+best = min(reports, key=lambda r: r["wall_time"])
+counters = {}
+for tu in best["translation_units"]:
+    counters = tu["counters"]
+
+print("%-40s %12.4f %14d %12s %14s %12s %14s" % (compiler,
+    best["wall_time"],
+    best["peak_rss_kb"],
+    counters.get("ast_nodes", "-"),
+    counters.get("ast_walk_us", "-"),
+    counters.get("nodecl_nodes", "-"),
+    counters.get("nodecl_walk_us", "-")))
+PYEOF
+done
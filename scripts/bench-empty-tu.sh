@@ -0,0 +1,76 @@
+#!/bin/bash
+
+# Measures the startup cost of a compiler on an empty translation unit.
+#
+# Usage: bench-empty-tu.sh [-n repetitions] [-x c|c++] compiler...
+#
+# Every compiler given (e.g. the one installed before and after a change) is
+# run on an empty translation unit with --report and the best wall time, the
+# peak resident memory and the number of symbols and types created are shown.
+
+repetitions=10
+language=c
+
+while getopts "n:x:" opt;
+do
+    case $opt in
+        n) repetitions=$OPTARG ;;
+        x) language=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-n repetitions] [-x c|c++] compiler..." 1>&2
+    exit 1
+fi
+
+PYTHON=${PYTHON:-python3}
+
+case $language in
+    c) suffix=c ;;
+    c++) suffix=cpp ;;
+    *) echo "unknown language '$language'" 1>&2; exit 1 ;;
+esac
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+input=$workdir/empty.$suffix
+: > $input
+
+printf "%-40s %12s %12s %10s %10s\n" "compiler" "wall (s)" "rss (KiB)" "symbols" "types"
+for compiler in "$@";
+do
+    reports=""
+    for i in $(seq 1 $repetitions);
+    do
+        report=$workdir/report-$i.json
+        if ! $compiler -y --report=$report -o $workdir/empty.out.$suffix $input > /dev/null 2>&1;
+        then
+            echo "$compiler failed to compile an empty translation unit" 1>&2
+            exit 1
+        fi
+        reports="$reports $report"
+    done
+
+    $PYTHON - "$compiler" $reports <<'EOF'
+import json, sys
+
+compiler = sys.argv[1]
+reports = [json.load(open(f)) for f in sys.argv[2:]]
+
+best = min(reports, key=lambda r: r["wall_time"])
+counters = {}
+for tu in best["translation_units"]:
+    counters = tu["counters"]
+
+print("%-40s %12.4f %12d %10s %10s" % (compiler,
+    best["wall_time"],
+    max(r["peak_rss_kb"] for r in reports),
+    counters.get("symbols", "-"),
+    counters.get("types", "-")))
+EOF
+done
@@ -0,0 +1,89 @@
+#!/bin/bash
+
+# Measures the throughput of the lexer of C on a translation unit made mostly
+# of whitespace, identifiers, numeric literals and comments.
+#
+# Usage: bench-lexer.sh [-n repetitions] [-s size] compiler...
+#
+# Every compiler given (e.g. a build before and one after a change of the
+# lexer) compiles the same generated file. The best wall time of the parsing
+# stage and the bytes parsed per second are shown.
+
+repetitions=5
+size=20000
+
+while getopts "n:s:" opt;
+do
+    case $opt in
+        n) repetitions=$OPTARG ;;
+        s) size=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-n repetitions] [-s size] compiler..." 1>&2
+    exit 1
+fi
+
+PYTHON=${PYTHON:-python3}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+input=$workdir/lexer.c
+
+# Declarations are cheap to check so most of the time goes to the lexer
+{
+    for i in $(seq 1 $size);
+    do
+        echo "/* Variable number $i of the benchmark, initialized with an"
+        echo "   expression of integer and floating literals */"
+        echo "static   int    variable_$i   =   $i + 0x${i}f + ${i}u;    // the ${i}th"
+        echo "static double   other_variable_$i = ${i}.5e-3 + .25f;"
+        echo ""
+    done
+} > $input
+
+bytes=$(wc -c < $input)
+
+printf "%-40s %12s %12s\n" "compiler" "parse (s)" "MiB/s"
+for compiler in "$@";
+do
+    reports=""
+    for i in $(seq 1 $repetitions);
+    do
+        report=$workdir/report-$i.json
+        if ! $compiler -y --report=$report -o $workdir/lexer.out.c $input > /dev/null 2>&1;
+        then
+            echo "$compiler failed to compile the benchmark" 1>&2
+            exit 1
+        fi
+        reports="$reports $report"
+    done
+
+    $PYTHON - "$compiler" "$bytes" $reports <<'PYEOF'
+import json, sys
+
+compiler = sys.argv[1]
+size = int(sys.argv[2])
+reports = [json.load(open(f)) for f in sys.argv[3:]]
+
+def parsing_time(report):
+    for tu in report["translation_units"]:
+        for stage in tu["stages"]:
+            if stage["stage"] == "parsing":
+                return stage["wall_time"]
+    return None
+
+times = [t for t in (parsing_time(r) for r in reports) if t is not None]
+if not times:
+    print("%-40s %12s %12s" % (compiler, "-", "-"))
+else:
+    best = min(times)
+    print("%-40s %12.4f %12.2f" % (compiler,
+        best, size / (1024.0 * 1024.0) / best if best > 0 else 0.0))
+PYEOF
+done
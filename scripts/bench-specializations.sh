@@ -0,0 +1,97 @@
+#!/bin/bash
+
+# Measures the cost of looking up the specializations of a template on a
+# translation unit that names many specializations of the same template.
+#
+# Usage: bench-specializations.sh [-n repetitions] [-s size] compiler...
+#
+# Every compiler given is run with and without the index of specializations
+# (see --debug-flags=disable_specialization_index) and the best wall time,
+# the number of types created and the hits of the index are shown.
+
+repetitions=5
+size=10000
+
+while getopts "n:s:" opt;
+do
+    case $opt in
+        n) repetitions=$OPTARG ;;
+        s) size=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-n repetitions] [-s size] compiler..." 1>&2
+    exit 1
+fi
+
+PYTHON=${PYTHON:-python3}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+input=$workdir/specializations.cpp
+
+# Every specialization is named several times, with type and nontype
+# template arguments, and only some of them are instantiated
+{
+    echo "template <typename T, int N> struct A { T v[N]; };"
+    echo "struct S { };"
+    for i in $(seq 1 $size);
+    do
+        echo "A<int, $i>* p$i; A<int, $i>* q$i; A<S*, $i>* r$i;"
+    done
+    echo "void g()"
+    echo "{"
+    for i in $(seq 1 10 $size);
+    do
+        echo "    A<int, $i> a$i; p$i = &a$i; q$i = p$i;"
+    done
+    echo "}"
+} > $input
+
+printf "%-40s %-8s %12s %10s %12s\n" "compiler" "index" "wall (s)" "types" "index hits"
+for compiler in "$@";
+do
+    for index in on off;
+    do
+        flags=""
+        if [ $index = off ];
+        then
+            flags="--debug-flags=disable_specialization_index"
+        fi
+
+        reports=""
+        for i in $(seq 1 $repetitions);
+        do
+            report=$workdir/report-$index-$i.json
+            if ! $compiler -y $flags --report=$report -o $workdir/specializations.out.cpp $input > /dev/null 2>&1;
+            then
+                echo "$compiler failed to compile the benchmark" 1>&2
+                exit 1
+            fi
+            reports="$reports $report"
+        done
+
+        $PYTHON - "$compiler" "$index" $reports <<'PYEOF'
+import json, sys
+
+compiler = sys.argv[1]
+index = sys.argv[2]
+reports = [json.load(open(f)) for f in sys.argv[3:]]
+
+best = min(reports, key=lambda r: r["wall_time"])
+counters = {}
+for tu in best["translation_units"]:
+    counters = tu["counters"]
+
+print("%-40s %-8s %12.4f %10s %12s" % (compiler, index,
+    best["wall_time"],
+    counters.get("types", "-"),
+    counters.get("specialization_index_hits", "-")))
+PYEOF
+    done
+done
@@ -0,0 +1,115 @@
+#!/bin/bash
+
+# Measures the memory used by the symbols of a large C++ and a large Fortran
+# translation unit.
+#
+# Usage: bench-symbols.sh [-s size] compiler...
+#
+# Every compiler given (e.g. a build before and one after a change of the
+# layout of the symbols) compiles both generated files. The number of
+# symbols and the bytes they use, including their records of rarely used
+# attributes, are shown as written by --report.
+
+size=2000
+
+while getopts "s:" opt;
+do
+    case $opt in
+        s) size=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-s size] compiler..." 1>&2
+    exit 1
+fi
+
+PYTHON=${PYTHON:-python3}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+cxx_input=$workdir/symbols.cpp
+fortran_input=$workdir/symbols.f90
+
+# Classes with members, templates and their instantiations, so most kinds
+# of C++ symbols appear
+{
+    echo "template <typename T> struct W { T v; T get() const { return v; } static int n; };"
+    for i in $(seq 1 $size);
+    do
+        echo "namespace N$i {"
+        echo "    struct S { int a, b; double c; virtual int f(int x = $i) { return x + a; } static const int k = $i; };"
+        echo "    enum E { E1, E2, E3 };"
+        echo "    typedef W<S> WS;"
+        echo "    inline int g(const WS& w, E e) { return w.get().f() + e; }"
+        echo "}"
+    done
+} > $cxx_input
+
+# Modules with variables, derived types and procedures
+{
+    for i in $(seq 1 $size);
+    do
+        echo "MODULE M$i"
+        echo "    IMPLICIT NONE"
+        echo "    TYPE T"
+        echo "        INTEGER :: A, B"
+        echo "        REAL :: C(10)"
+        echo "    END TYPE T"
+        echo "    INTEGER, PARAMETER :: K = $i"
+        echo "    TYPE(T), SAVE :: V"
+        echo "CONTAINS"
+        echo "    INTEGER FUNCTION F(X, Y)"
+        echo "        INTEGER, INTENT(IN) :: X"
+        echo "        TYPE(T), INTENT(INOUT), OPTIONAL :: Y"
+        echo "        F = X + K"
+        echo "        IF (PRESENT(Y)) Y % A = F"
+        echo "    END FUNCTION F"
+        echo "END MODULE M$i"
+    done
+} > $fortran_input
+
+printf "%-40s %-8s %12s %14s %16s\n" "compiler" "language" "symbols" "symbol bytes" "bytes per symbol"
+for compiler in "$@";
+do
+    for language in cxx fortran;
+    do
+        if [ $language = cxx ];
+        then
+            input=$cxx_input
+            flags="--profile=plaincxx"
+        else
+            input=$fortran_input
+            flags="--profile=plainfc"
+        fi
+
+        report=$workdir/report-$language.json
+        if ! (cd $workdir && $compiler $flags -y --report=$report -o $input.out $input > /dev/null 2>&1);
+        then
+            echo "$compiler failed to compile the $language benchmark" 1>&2
+            exit 1
+        fi
+
+        $PYTHON - "$compiler" "$language" $report <<'PYEOF'
+import json, sys
+
+compiler = sys.argv[1]
+language = sys.argv[2]
+report = json.load(open(sys.argv[3]))
+
+counters = {}
+for tu in report["translation_units"]:
+    counters = tu["counters"]
+
+symbols = counters.get("symbols", 0)
+symbol_bytes = counters.get("symbol_bytes", 0)
+print("%-40s %-8s %12d %14d %16.1f" % (compiler, language,
+    symbols, symbol_bytes,
+    float(symbol_bytes) / symbols if symbols else 0.0))
+PYEOF
+    done
+done
@@ -0,0 +1,100 @@
+#!/bin/bash
+
+# Measures the cost of the type system on a translation unit that creates and
+# compares many function and template types.
+#
+# Usage: bench-types.sh [-n repetitions] [-s size] compiler...
+#
+# Every compiler given is run with and without the type caches (see
+# --debug-flags=disable_overload_cache) and the best wall time, the number of
+# types created and the hits of the caches of equivalent types and standard
+# conversions are shown.
+
+repetitions=5
+size=200
+
+while getopts "n:s:" opt;
+do
+    case $opt in
+        n) repetitions=$OPTARG ;;
+        s) size=$OPTARG ;;
+        *) exit 1 ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -eq 0 ];
+then
+    echo "usage: $0 [-n repetitions] [-s size] compiler..." 1>&2
+    exit 1
+fi
+
+PYTHON=${PYTHON:-python3}
+
+workdir=$(mktemp -d)
+trap "rm -rf $workdir" EXIT
+
+input=$workdir/types.cpp
+
+# Many overloads of the same name with signatures built from the same few
+# types, redeclared and called from several places
+{
+    echo "template <typename T, int N> struct A { typedef T type; T v[N]; };"
+    for i in $(seq 1 $size);
+    do
+        echo "struct S$i { int m(A<S$i, $i>&, const int*, double (*)(S$i)); };"
+        echo "void f(S$i, A<S$i, $i>::type*, int (S$i::*)(A<S$i, $i>&, const int*, double (*)(S$i)));"
+        echo "void f(S$i, A<S$i, $i>::type*, int (S$i::*)(A<S$i, $i>&, const int*, double (*)(S$i)));"
+    done
+    echo "void g()"
+    echo "{"
+    for i in $(seq 1 $size);
+    do
+        echo "    S$i s$i; f(s$i, &s$i, &S$i::m); f(s$i, 0, &S$i::m);"
+    done
+    echo "}"
+} > $input
+
+printf "%-40s %-8s %12s %10s %12s %12s\n" "compiler" "caches" "wall (s)" "types" "equiv hits" "conv hits"
+for compiler in "$@";
+do
+    for caches in on off;
+    do
+        flags=""
+        if [ $caches = off ];
+        then
+            flags="--debug-flags=disable_overload_cache"
+        fi
+
+        reports=""
+        for i in $(seq 1 $repetitions);
+        do
+            report=$workdir/report-$caches-$i.json
+            if ! $compiler -y $flags --report=$report -o $workdir/types.out.cpp $input > /dev/null 2>&1;
+            then
+                echo "$compiler failed to compile the benchmark" 1>&2
+                exit 1
+            fi
+            reports="$reports $report"
+        done
+
+        $PYTHON - "$compiler" "$caches" $reports <<'PYEOF'
+import json, sys
+
+compiler = sys.argv[1]
+caches = sys.argv[2]
+reports = [json.load(open(f)) for f in sys.argv[3:]]
+
+best = min(reports, key=lambda r: r["wall_time"])
+counters = {}
+for tu in best["translation_units"]:
+    counters = tu["counters"]
+
+print("%-40s %-8s %12.4f %10s %12s %12s" % (compiler, caches,
+    best["wall_time"],
+    counters.get("types", "-"),
+    counters.get("equivalent_types_cache_hits", "-"),
+    counters.get("standard_conversion_cache_hits", "-")))
+PYEOF
+    done
+done
@@ -258,6 +258,42 @@ int config_set_preprocessor_uses_stdout(struct compilation_configuration_tag * c
     return 0;
 }
 
+int config_set_preprocessor_uses_pipe(struct compilation_configuration_tag * config, const char* index, const char *value)
+{
+    int bool_value = -1;
+
+    parse_boolean(value, &bool_value);
+
+    if (bool_value == -1)
+    {
+        fprintf(stderr, "Warning: value given for 'preprocessor_uses_pipe' is not a valid boolean value. Skipping\n");
+    }
+    else
+    {
+        config->preprocessor_uses_pipe = bool_value;
+    }
+
+    return 0;
+}
+
+int config_set_compiler_uses_pipe(struct compilation_configuration_tag * config, const char* index, const char *value)
+{
+    int bool_value = -1;
+
+    parse_boolean(value, &bool_value);
+
+    if (bool_value == -1)
+    {
+        fprintf(stderr, "Warning: value given for 'compiler_uses_pipe' is not a valid boolean value. Skipping\n");
+    }
+    else
+    {
+        config->native_compiler_uses_pipe = bool_value;
+    }
+
+    return 0;
+}
+
 int config_set_prescanner_options(struct compilation_configuration_tag* config, const char* index, const char* value)
 {
     int num;
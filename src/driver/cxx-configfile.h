@@ -46,6 +46,8 @@ option_function_t config_set_options;
 option_function_t config_set_preprocessor_name;
 option_function_t config_set_preprocessor_options;
 option_function_t config_set_preprocessor_uses_stdout;
+option_function_t config_set_preprocessor_uses_pipe;
+option_function_t config_set_compiler_uses_pipe;
 option_function_t config_set_prescanner_options;
 option_function_t config_set_compiler_name;
 option_function_t config_set_compiler_options;
@@ -0,0 +1,659 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifdef HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include "cxx-driver-cache.h"
+#include "cxx-driver-build-info.h"
+#include "cxx-driver-utils.h"
+#include "cxx-typeenviron-decls.h"
+#include "cxx-utils.h"
+#include "uniquestr.h"
+#include "filename.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#if defined(HAVE_DL_ITERATE_PHDR)
+#include <link.h>
+#endif
+
+// Two independent 64-bit lanes. The first one is FNV-1a, the second one
+// uses a different multiplier and a xorshift so collisions of the first
+// one are not collisions of the second one
+typedef struct cache_hash_tag
+{
+    uint64_t a;
+    uint64_t b;
+} cache_hash_t;
+
+static void cache_hash_init(cache_hash_t* h)
+{
+    h->a = 0xcbf29ce484222325ULL;
+    h->b = 0x6a09e667f3bcc908ULL;
+}
+
+static void cache_hash_bytes(cache_hash_t* h, const void* data, size_t length)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    uint64_t a = h->a, b = h->b;
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        a ^= p[i];
+        a *= 0x100000001b3ULL;
+
+        b += p[i];
+        b *= 0x9e3779b97f4a7c15ULL;
+        b ^= b >> 29;
+    }
+    h->a = a;
+    h->b = b;
+}
+
+static void cache_hash_string(cache_hash_t* h, const char* str)
+{
+    if (str == NULL)
+        str = "";
+    // Include the terminator so consecutive strings cannot be confused
+    cache_hash_bytes(h, str, strlen(str) + 1);
+}
+
+static void cache_hash_int(cache_hash_t* h, int value)
+{
+    cache_hash_bytes(h, &value, sizeof(value));
+}
+
+static void cache_hash_string_array(cache_hash_t* h, const char** array)
+{
+    int n = count_null_ended_array((void**)array);
+    cache_hash_int(h, n);
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        cache_hash_string(h, array[i]);
+    }
+}
+
+static char cache_hash_file(cache_hash_t* h, const char* filename)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+        return 0;
+
+    char buffer[65536];
+    size_t actually_read;
+    while ((actually_read = fread(buffer, 1, sizeof(buffer), f)) != 0)
+    {
+        cache_hash_bytes(h, buffer, actually_read);
+    }
+
+    char ok = !ferror(f);
+    fclose(f);
+
+    return ok;
+}
+
+#if defined(HAVE_DL_ITERATE_PHDR)
+static char is_phase_library(compilation_configuration_t* configuration, const char* library_name)
+{
+    const char* basename = give_basename(library_name);
+
+    // Codegen phases are always loaded
+    if (strcmp(basename, "libcodegen-cxx.so") == 0
+            || strcmp(basename, "libcodegen-fortran.so") == 0)
+        return 1;
+
+    int i;
+    for (i = 0; i < configuration->num_compiler_phases; i++)
+    {
+        if (strcmp(basename, give_basename(configuration->phase_loader[i]->data)) == 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+#define NOTE_ALIGN(x) (((x) + 3) & ~(size_t)3)
+
+static void cache_hash_build_id(cache_hash_t* h, struct dl_phdr_info* info)
+{
+    int i;
+    for (i = 0; i < info->dlpi_phnum; i++)
+    {
+        const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type != PT_NOTE)
+            continue;
+
+        const char* p = (const char*)(info->dlpi_addr + phdr->p_vaddr);
+        const char* end = p + phdr->p_memsz;
+        while (p + sizeof(ElfW(Nhdr)) <= end)
+        {
+            const ElfW(Nhdr)* note = (const ElfW(Nhdr)*)p;
+            const char* name = p + sizeof(*note);
+            const char* desc = name + NOTE_ALIGN(note->n_namesz);
+
+            if (note->n_type == NT_GNU_BUILD_ID
+                    && note->n_namesz == sizeof("GNU")
+                    && memcmp(name, "GNU", sizeof("GNU")) == 0)
+            {
+                cache_hash_int(h, note->n_descsz);
+                cache_hash_bytes(h, desc, note->n_descsz);
+                return;
+            }
+
+            p = desc + NOTE_ALIGN(note->n_descsz);
+        }
+    }
+}
+
+#undef NOTE_ALIGN
+
+static int cache_hash_phase_library(struct dl_phdr_info* info, size_t size UNUSED_PARAMETER, void* data)
+{
+    cache_hash_t* h = (cache_hash_t*)data;
+
+    if (info->dlpi_name == NULL
+            || info->dlpi_name[0] == '\0'
+            || !is_phase_library(CURRENT_CONFIGURATION, info->dlpi_name))
+        return 0;
+
+    cache_hash_string(h, give_basename(info->dlpi_name));
+
+    struct stat st;
+    if (stat(info->dlpi_name, &st) == 0)
+    {
+        unsigned long long size_and_mtime[] = {
+            (unsigned long long)st.st_size,
+            (unsigned long long)st.st_mtime,
+        };
+        cache_hash_bytes(h, size_and_mtime, sizeof(size_and_mtime));
+    }
+
+    cache_hash_build_id(h, info);
+
+    return 0;
+}
+#endif
+
+// A rebuilt phase may generate different code even if its name is the same
+static void cache_hash_phase_libraries(cache_hash_t* h)
+{
+#if defined(HAVE_DL_ITERATE_PHDR)
+    dl_iterate_phdr(cache_hash_phase_library, h);
+#endif
+}
+
+static void cache_hash_configuration(cache_hash_t* h, compilation_configuration_t* configuration)
+{
+    cache_hash_string(h, configuration->configuration_name);
+    cache_hash_int(h, configuration->source_language);
+
+    // Compiler phases and their parameters
+    cache_hash_int(h, configuration->num_compiler_phases);
+    int i;
+    for (i = 0; i < configuration->num_compiler_phases; i++)
+    {
+        cache_hash_string(h, configuration->phase_loader[i]->data);
+    }
+    cache_hash_int(h, configuration->num_external_vars);
+    for (i = 0; i < configuration->num_external_vars; i++)
+    {
+        cache_hash_string(h, configuration->external_vars[i]->name);
+        cache_hash_string(h, configuration->external_vars[i]->value);
+    }
+    cache_hash_int(h, configuration->num_pragma_custom_prefix);
+    for (i = 0; i < configuration->num_pragma_custom_prefix; i++)
+    {
+        cache_hash_string(h, configuration->pragma_custom_prefix[i]);
+    }
+
+    // Native compiler, it determines the object
+    cache_hash_string(h, configuration->native_compiler_name);
+    cache_hash_string_array(h, configuration->native_compiler_options);
+    cache_hash_int(h, configuration->native_vendor);
+    cache_hash_int(h, configuration->generate_assembler);
+
+    if (configuration->type_environment != NULL)
+        cache_hash_string(h, configuration->type_environment->environ_id);
+
+    // Flags that change the generated code
+    char flags[] = {
+        configuration->enable_openmp,
+        configuration->warnings_as_errors,
+        configuration->disable_gxx_type_traits,
+        configuration->enable_ms_builtin_types,
+        configuration->enable_intel_builtins_syntax,
+        configuration->enable_intel_intrinsics,
+        configuration->enable_intel_vector_types,
+        configuration->explicit_instantiation,
+        configuration->disable_sizeof,
+        configuration->disable_float128_token,
+        configuration->code_shape.short_enums,
+        configuration->enable_upc,
+        configuration->enable_c11,
+        configuration->enable_cxx11,
+        configuration->enable_cxx14,
+        configuration->enable_cuda,
+        configuration->enable_opencl,
+        configuration->preserve_parentheses,
+        configuration->line_markers,
+    };
+    cache_hash_bytes(h, flags, sizeof(flags));
+    cache_hash_string(h, configuration->upc_threads);
+    cache_hash_string(h, configuration->opencl_build_options);
+
+    // Debug flags that change the generated code or what the phases print
+    char debug_flags[] = {
+        debug_options.enable_debug_code,
+        debug_options.debug_sizeof,
+        debug_options.analysis_verbose,
+        debug_options.ranges_verbose,
+        debug_options.tdg_verbose,
+        debug_options.analysis_perf,
+        debug_options.analysis_info,
+        debug_options.print_pcfg,
+        debug_options.print_pcfg_w_context,
+        debug_options.print_pcfg_w_analysis,
+        debug_options.print_pcfg_full,
+        debug_options.print_tdg,
+        debug_options.tdg_to_json,
+        debug_options.print_dt,
+        debug_options.show_template_packs,
+        debug_options.vectorization_verbose,
+        debug_options.stats_ambiguities,
+    };
+    cache_hash_bytes(h, debug_flags, sizeof(debug_flags));
+}
+
+const char* driver_cache_compute_key(translation_unit_t* translation_unit,
+        const char* parsed_filename)
+{
+    cache_hash_t h;
+    cache_hash_init(&h);
+
+    // Version of the compiler
+    cache_hash_string(&h, PACKAGE " " VERSION " (" MCXX_BUILD_VERSION ")");
+
+    // The input filename ends in the generated code
+    cache_hash_string(&h, translation_unit->input_filename);
+    if (!cache_hash_file(&h, parsed_filename))
+        return NULL;
+
+    // Symbols of a precompiled header are not emitted again
+    if (compilation_process.pch_filename != NULL
+            && !cache_hash_file(&h, compilation_process.pch_filename))
+        return NULL;
+
+    cache_hash_configuration(&h, CURRENT_CONFIGURATION);
+    cache_hash_phase_libraries(&h);
+
+    const char* result = NULL;
+    uniquestr_sprintf(&result, "%016llx%016llx",
+            (unsigned long long)h.a,
+            (unsigned long long)h.b);
+
+    return result;
+}
+
+const char* driver_cache_compute_configuration_key(void)
+{
+    cache_hash_t h;
+    cache_hash_init(&h);
+
+    cache_hash_string(&h, PACKAGE " " VERSION " (" MCXX_BUILD_VERSION ")");
+    cache_hash_configuration(&h, CURRENT_CONFIGURATION);
+    cache_hash_phase_libraries(&h);
+
+    // Macros defined on the command line change what the headers declare
+    cache_hash_string(&h, CURRENT_CONFIGURATION->preprocessor_name);
+    cache_hash_string_array(&h, CURRENT_CONFIGURATION->preprocessor_options);
+
+    const char* result = NULL;
+    uniquestr_sprintf(&result, "%016llx%016llx",
+            (unsigned long long)h.a,
+            (unsigned long long)h.b);
+
+    return result;
+}
+
+static const char* cache_entry_filename(const char* key, const char* kind)
+{
+    const char* result = NULL;
+    uniquestr_sprintf(&result, "%s%s%s.%s",
+            compilation_process.cache_directory, DIR_SEPARATOR, key, kind);
+    return result;
+}
+
+void driver_cache_init(void)
+{
+    if (mkdir(compilation_process.cache_directory, 0755) != 0
+            && errno != EEXIST)
+    {
+        fprintf(stderr, "%s: warning: cannot create cache directory '%s' (%s). Cache disabled\n",
+                compilation_process.exec_basename,
+                compilation_process.cache_directory,
+                strerror(errno));
+        compilation_process.cache_directory = NULL;
+    }
+}
+
+char driver_cache_lookup(const char* key, const char* kind, const char* dest_filename)
+{
+    const char* entry = cache_entry_filename(key, kind);
+
+    if (access(entry, R_OK) != 0)
+        return 0;
+
+    if (copy_file(entry, dest_filename) != 0)
+        return 0;
+
+    // Recently used entries are the last ones to be evicted
+    utime(entry, NULL);
+
+    return 1;
+}
+
+char driver_cache_contains(const char* key, const char* kind)
+{
+    return access(cache_entry_filename(key, kind), R_OK) == 0;
+}
+
+char driver_cache_replay(const char* key, const char* kind, FILE* f)
+{
+    const char* entry = cache_entry_filename(key, kind);
+
+    if (append_file(entry, f) != 0)
+        return 0;
+
+    utime(entry, NULL);
+
+    return 1;
+}
+
+typedef struct cache_entry_info_tag
+{
+    const char* filename;
+    time_t mtime;
+    unsigned long long size;
+} cache_entry_info_t;
+
+static int compare_cache_entries_by_age(const void* p1, const void* p2)
+{
+    const cache_entry_info_t* e1 = (const cache_entry_info_t*)p1;
+    const cache_entry_info_t* e2 = (const cache_entry_info_t*)p2;
+
+    if (e1->mtime < e2->mtime)
+        return -1;
+    else if (e1->mtime > e2->mtime)
+        return 1;
+    return 0;
+}
+
+static char is_cache_entry(const char* name)
+{
+    const char* ext = strrchr(name, '.');
+    return ext != NULL
+        && (strcmp(ext + 1, DRIVER_CACHE_KIND_PRETTYPRINTED) == 0
+                || strcmp(ext + 1, DRIVER_CACHE_KIND_OBJECT) == 0
+                || strcmp(ext + 1, DRIVER_CACHE_KIND_PRETTYPRINTED_DIAGNOSTICS) == 0
+                || strcmp(ext + 1, DRIVER_CACHE_KIND_OBJECT_DIAGNOSTICS) == 0);
+}
+
+// Removes the least recently used entries until the cache fits in 90% of
+// its maximum size
+static void cache_trim(void)
+{
+    DIR* dir = opendir(compilation_process.cache_directory);
+    if (dir == NULL)
+        return;
+
+    int num_entries = 0;
+    cache_entry_info_t* entries = NULL;
+    unsigned long long total_size = 0;
+
+    struct dirent* dir_entry;
+    while ((dir_entry = readdir(dir)) != NULL)
+    {
+        if (!is_cache_entry(dir_entry->d_name))
+            continue;
+
+        const char* filename = strappend(compilation_process.cache_directory,
+                strappend(DIR_SEPARATOR, dir_entry->d_name));
+
+        struct stat st;
+        if (stat(filename, &st) != 0)
+            continue;
+
+        cache_entry_info_t entry_info;
+        entry_info.filename = filename;
+        entry_info.mtime = st.st_mtime;
+        entry_info.size = st.st_size;
+        P_LIST_ADD(entries, num_entries, entry_info);
+
+        total_size += st.st_size;
+    }
+    closedir(dir);
+
+    if (total_size > compilation_process.cache_max_size)
+    {
+        qsort(entries, num_entries, sizeof(*entries), compare_cache_entries_by_age);
+
+        unsigned long long limit = compilation_process.cache_max_size / 10 * 9;
+        int i;
+        for (i = 0; i < num_entries && total_size > limit; i++)
+        {
+            // Another process may have removed it already
+            if (unlink(entries[i].filename) == 0
+                    || errno == ENOENT)
+            {
+                total_size -= entries[i].size;
+            }
+        }
+    }
+
+    DELETE(entries);
+}
+
+void driver_cache_store(const char* key, const char* kind, const char* source_filename)
+{
+    const char* entry = cache_entry_filename(key, kind);
+
+    // Copy under a unique name and then rename so concurrent compilations
+    // never see a partially written entry
+    const char* partial_entry = NULL;
+    uniquestr_sprintf(&partial_entry, "%s.%d.tmp", entry, (int)getpid());
+
+    if (copy_file(source_filename, partial_entry) != 0)
+    {
+        unlink(partial_entry);
+        return;
+    }
+
+    if (rename(partial_entry, entry) != 0)
+    {
+        unlink(partial_entry);
+        return;
+    }
+
+    cache_trim();
+}
+
+typedef struct cache_statistics_tag
+{
+    unsigned long long hits;
+    unsigned long long misses;
+} cache_statistics_t;
+
+// Statistics are kept in the cache directory so they are shared by all the
+// compilations that use it
+static void cache_update_statistics(unsigned long long hits, unsigned long long misses)
+{
+    const char* stats_filename = strappend(compilation_process.cache_directory,
+            strappend(DIR_SEPARATOR, "stats"));
+
+    int fd = open(stats_filename, O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        return;
+
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    while (fcntl(fd, F_SETLKW, &lock) != 0
+            && errno == EINTR)
+    {
+    }
+
+    cache_statistics_t stats = { 0, 0 };
+    char buffer[128];
+    ssize_t n = read(fd, buffer, sizeof(buffer) - 1);
+    if (n > 0)
+    {
+        buffer[n] = '\0';
+        sscanf(buffer, "hits %llu misses %llu", &stats.hits, &stats.misses);
+    }
+
+    stats.hits += hits;
+    stats.misses += misses;
+
+    int length = snprintf(buffer, sizeof(buffer), "hits %llu misses %llu\n",
+            stats.hits, stats.misses);
+    if (lseek(fd, 0, SEEK_SET) == 0
+            && ftruncate(fd, 0) == 0)
+    {
+        if (write(fd, buffer, length) != length)
+        {
+            // Nothing sensible can be done, statistics are not essential
+        }
+    }
+
+    // Closing releases the lock
+    close(fd);
+}
+
+void driver_cache_record_hit(void)
+{
+    cache_update_statistics(1, 0);
+}
+
+void driver_cache_record_miss(void)
+{
+    cache_update_statistics(0, 1);
+}
+
+void driver_cache_print_statistics(FILE* f)
+{
+    cache_update_statistics(0, 0);
+
+    const char* stats_filename = strappend(compilation_process.cache_directory,
+            strappend(DIR_SEPARATOR, "stats"));
+
+    cache_statistics_t stats = { 0, 0 };
+    FILE* stats_file = fopen(stats_filename, "r");
+    if (stats_file != NULL)
+    {
+        if (fscanf(stats_file, "hits %llu misses %llu", &stats.hits, &stats.misses) != 2)
+        {
+            stats.hits = stats.misses = 0;
+        }
+        fclose(stats_file);
+    }
+
+    unsigned long long total_size = 0;
+    int num_entries = 0;
+    DIR* dir = opendir(compilation_process.cache_directory);
+    if (dir != NULL)
+    {
+        struct dirent* dir_entry;
+        while ((dir_entry = readdir(dir)) != NULL)
+        {
+            if (!is_cache_entry(dir_entry->d_name))
+                continue;
+
+            struct stat st;
+            if (stat(strappend(compilation_process.cache_directory,
+                            strappend(DIR_SEPARATOR, dir_entry->d_name)), &st) == 0)
+            {
+                total_size += st.st_size;
+                num_entries++;
+            }
+        }
+        closedir(dir);
+    }
+
+    unsigned long long total = stats.hits + stats.misses;
+    fprintf(f, "Cache directory      %s\n", compilation_process.cache_directory);
+    fprintf(f, "Cache hits           %llu\n", stats.hits);
+    fprintf(f, "Cache misses         %llu\n", stats.misses);
+    fprintf(f, "Hit rate             %.2f %%\n", total == 0 ? 0.0 : (100.0 * stats.hits) / total);
+    fprintf(f, "Number of entries    %d\n", num_entries);
+    fprintf(f, "Cache size           %.2f MB\n", total_size / (1024.0 * 1024.0));
+    fprintf(f, "Maximum cache size   %.2f MB\n", compilation_process.cache_max_size / (1024.0 * 1024.0));
+}
+
+unsigned long long driver_cache_parse_size(const char* str)
+{
+    char* suffix = NULL;
+    unsigned long long result = strtoull(str, &suffix, 10);
+
+    if (suffix == str)
+        return 0;
+
+    switch (*suffix)
+    {
+        case '\0':
+            break;
+        case 'k': case 'K':
+            result *= 1024ULL;
+            suffix++;
+            break;
+        case 'm': case 'M':
+            result *= 1024ULL * 1024ULL;
+            suffix++;
+            break;
+        case 'g': case 'G':
+            result *= 1024ULL * 1024ULL * 1024ULL;
+            suffix++;
+            break;
+        default:
+            return 0;
+    }
+
+    if (*suffix != '\0')
+        return 0;
+
+    return result;
+}
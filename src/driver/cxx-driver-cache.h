@@ -0,0 +1,77 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_DRIVER_CACHE_H
+#define CXX_DRIVER_CACHE_H
+
+#include "cxx-macros.h"
+#include "cxx-driver-decls.h"
+
+#include <stdio.h>
+
+MCXX_BEGIN_DECLS
+
+// Content-addressed cache of the source-to-source step. Entries are stored
+// in compilation_process.cache_directory as '<key>.<kind>' files
+#define DRIVER_CACHE_KIND_PRETTYPRINTED "pp"
+#define DRIVER_CACHE_KIND_OBJECT "obj"
+// What was written to stderr while generating each of the entries above.
+// A hit replays it
+#define DRIVER_CACHE_KIND_PRETTYPRINTED_DIAGNOSTICS "ppdiag"
+#define DRIVER_CACHE_KIND_OBJECT_DIAGNOSTICS "objdiag"
+
+#define DRIVER_CACHE_DEFAULT_MAX_SIZE (1024ULL * 1024ULL * 1024ULL)
+
+void driver_cache_init(void);
+
+// Returns NULL if the key cannot be computed (e.g. the file cannot be read)
+const char* driver_cache_compute_key(translation_unit_t* translation_unit,
+        const char* parsed_filename);
+
+// Key of the current configuration only, it does not depend on any file
+const char* driver_cache_compute_configuration_key(void);
+
+// Copies the cached entry into dest_filename. Returns nonzero on success
+char driver_cache_lookup(const char* key, const char* kind, const char* dest_filename);
+char driver_cache_contains(const char* key, const char* kind);
+// Writes the cached entry to f. Returns nonzero on success
+char driver_cache_replay(const char* key, const char* kind, FILE* f);
+void driver_cache_store(const char* key, const char* kind, const char* source_filename);
+
+void driver_cache_record_hit(void);
+void driver_cache_record_miss(void);
+
+void driver_cache_print_statistics(FILE* f);
+
+// Parses sizes like 500M or 2G. Returns zero if invalid
+unsigned long long driver_cache_parse_size(const char* str);
+
+MCXX_END_DECLS
+
+#endif // CXX_DRIVER_CACHE_H
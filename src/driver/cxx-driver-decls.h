@@ -152,6 +152,23 @@ typedef struct translation_unit_tag
 
     // Opaque pointer used when running compiler phases
     void *dto;
+
+    // The code generator output has been fed directly to the native compiler
+    char natively_compiled_through_pipe;
+
+    // Key of this translation unit in the compilation cache, NULL if it
+    // must not be cached
+    const char* cache_key;
+    // What the frontend and the native compiler wrote to stderr for this
+    // translation unit. It is stored in the cache along with the outputs
+    const char* cache_diagnostics_filename;
+    const char* native_stderr_filename;
+
+    // The headers have been loaded from a precompiled header
+    char uses_pch;
+
+    // Arena of the trees of this translation unit, NULL if they use malloc
+    struct mem_arena_tag* arena;
 } translation_unit_t;
 
 struct compilation_configuration_tag;
@@ -205,6 +222,12 @@ typedef struct debug_options_tag
     char show_template_packs;
     char vectorization_verbose;
     char stats_string_table;
+    char stats_ambiguities;
+    char disable_tu_arena;
+    char disable_class_lookup_cache;
+    char disable_overload_cache;
+    char disable_constexpr_cache;
+    char disable_specialization_index;
 } debug_options_t;
 
 extern debug_options_t debug_options;
@@ -299,6 +322,30 @@ typedef struct compilation_process_tag
 
     // Flags
     char parallel_process; // enables features allowing parallel compilation
+
+    // Maximum number of translation units compiled concurrently (-j)
+    int num_jobs;
+
+    // Maximum number of native compilations running in the background
+    int num_native_jobs;
+
+    // Maximum number of steps of a constexpr evaluation (--constexpr-steps),
+    // the default limit is used if it is zero
+    int constexpr_steps;
+
+    // Compilation cache, disabled if the directory is NULL
+    const char* cache_directory;
+    unsigned long long cache_max_size;
+
+    // Precompiled header used (--pch) or created (--pch-create), C only
+    const char* pch_filename;
+    const char* pch_create_filename;
+
+    // Machine-readable report of the compilation (--report), NULL if disabled
+    const char* report_filename;
+    // Called around every compiler phase when there is a report
+    void (*report_phase_begin)(translation_unit_t* translation_unit, const char* phase_name);
+    void (*report_phase_end)(translation_unit_t* translation_unit, const char* phase_name);
 } compilation_process_t;
 
 typedef struct compilation_configuration_conditional_flags
@@ -416,6 +463,8 @@ typedef struct compilation_configuration_tag
     const char* preprocessor_name;
     const char** preprocessor_options;
     char preprocessor_uses_stdout;
+    // Feed the output of the preprocessor directly to the scanner
+    char preprocessor_uses_pipe;
 
     // Fortran preprocessor
     const char* fortran_preprocessor_name;
@@ -465,6 +514,8 @@ typedef struct compilation_configuration_tag
 
     const char* native_compiler_name;
     const char** native_compiler_options;
+    // Feed the generated code directly to the native compiler
+    char native_compiler_uses_pipe;
 
     const char* linker_name;
 
@@ -0,0 +1,711 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifdef HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include "cxx-driver-pch.h"
+#include "cxx-driver-cache.h"
+#include "cxx-driver-report.h"
+#include "cxx-driver-utils.h"
+#include "cxx-pch.h"
+#include "cxx-diagnostic.h"
+#include "cxx-utils.h"
+#include "uniquestr.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+// The precompiled header used by the current translation unit
+static pch_file_t* used_pch = NULL;
+// Preprocessed code of the headers, emitted before the generated code
+static const char* used_pch_prefix_filename = NULL;
+
+typedef struct source_includes_tag
+{
+    int num_includes;
+    const char** includes;
+    int* lines;
+    // The file does not contain anything else
+    char only_includes;
+} source_includes_t;
+
+static const char* trim_line(char* line)
+{
+    while (*line == ' ' || *line == '\t')
+        line++;
+
+    char* end = line + strlen(line);
+    while (end > line
+            && (end[-1] == ' ' || end[-1] == '\t'
+                || end[-1] == '\n' || end[-1] == '\r'))
+        end--;
+    *end = '\0';
+
+    return line;
+}
+
+// Removes the comments of line, which may start inside a block comment.
+// A block comment becomes a blank like the preprocessor does
+static void remove_comments(char* line, char* in_block_comment)
+{
+    char* read = line;
+    char* write = line;
+    char quote = '\0';
+    while (*read != '\0')
+    {
+        if (*in_block_comment)
+        {
+            if (read[0] == '*' && read[1] == '/')
+            {
+                *in_block_comment = 0;
+                *write++ = ' ';
+                read += 2;
+            }
+            else
+            {
+                read++;
+            }
+        }
+        else if (quote != '\0')
+        {
+            if (*read == '\\' && read[1] != '\0')
+                *write++ = *read++;
+            else if (*read == quote)
+                quote = '\0';
+            *write++ = *read++;
+        }
+        else if (read[0] == '/' && read[1] == '*')
+        {
+            *in_block_comment = 1;
+            read += 2;
+        }
+        else if (read[0] == '/' && read[1] == '/')
+        {
+            break;
+        }
+        else
+        {
+            if (*read == '"' || *read == '\'')
+                quote = *read;
+            *write++ = *read++;
+        }
+    }
+    *write = '\0';
+}
+
+// Returns what follows '#<name>' in line or NULL if line is not that directive
+static const char* match_directive(const char* line, const char* name)
+{
+    if (line[0] != '#')
+        return NULL;
+    line++;
+    while (*line == ' ' || *line == '\t')
+        line++;
+
+    size_t length = strlen(name);
+    if (strncmp(line, name, length) != 0)
+        return NULL;
+    line += length;
+    if (*line == '_'
+            || (*line >= 'a' && *line <= 'z')
+            || (*line >= 'A' && *line <= 'Z')
+            || (*line >= '0' && *line <= '9'))
+        return NULL;
+
+    while (*line == ' ' || *line == '\t')
+        line++;
+    return line;
+}
+
+typedef enum include_guard_tag
+{
+    INCLUDE_GUARD_NONE = 0,
+    // #ifndef seen, the #define must follow
+    INCLUDE_GUARD_TESTED,
+    INCLUDE_GUARD_OPEN,
+    // Its #endif has been seen, nothing else may follow
+    INCLUDE_GUARD_CLOSED,
+} include_guard_t;
+
+// Reads the #include directives at the beginning of filename. Blank
+// lines, comments, #pragma once and an include guard around the
+// directives are ignored
+static void read_source_includes(const char* filename, source_includes_t* result)
+{
+    memset(result, 0, sizeof(*result));
+    result->only_includes = 1;
+
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+    {
+        result->only_includes = 0;
+        return;
+    }
+
+    char in_block_comment = 0;
+    include_guard_t include_guard = INCLUDE_GUARD_NONE;
+    const char* guard_name = NULL;
+
+    char line[4096];
+    int line_number = 0;
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        line_number++;
+
+        // Too long for an #include we want to handle
+        if (strchr(line, '\n') == NULL
+                && !feof(f))
+        {
+            result->only_includes = 0;
+            break;
+        }
+
+        remove_comments(line, &in_block_comment);
+        const char* trimmed = trim_line(line);
+        if (trimmed[0] == '\0')
+            continue;
+
+        const char* argument;
+        if (include_guard == INCLUDE_GUARD_TESTED)
+        {
+            argument = match_directive(trimmed, "define");
+            if (argument == NULL
+                    || strcmp(argument, guard_name) != 0)
+            {
+                // Not an include guard
+                result->only_includes = 0;
+                break;
+            }
+            include_guard = INCLUDE_GUARD_OPEN;
+        }
+        else if (include_guard != INCLUDE_GUARD_CLOSED
+                && match_directive(trimmed, "include") != NULL)
+        {
+            int num_includes = result->num_includes;
+            P_LIST_ADD(result->includes, num_includes, uniquestr(trimmed));
+            P_LIST_ADD(result->lines, result->num_includes, line_number);
+        }
+        else if (include_guard != INCLUDE_GUARD_CLOSED
+                && (argument = match_directive(trimmed, "pragma")) != NULL
+                && strcmp(argument, "once") == 0)
+        {
+            continue;
+        }
+        else if (include_guard == INCLUDE_GUARD_NONE
+                && result->num_includes == 0
+                && (argument = match_directive(trimmed, "ifndef")) != NULL
+                && argument[0] != '\0')
+        {
+            guard_name = uniquestr(argument);
+            include_guard = INCLUDE_GUARD_TESTED;
+        }
+        else if (include_guard == INCLUDE_GUARD_OPEN
+                && match_directive(trimmed, "endif") != NULL)
+        {
+            include_guard = INCLUDE_GUARD_CLOSED;
+        }
+        else
+        {
+            result->only_includes = 0;
+            break;
+        }
+    }
+
+    if (include_guard == INCLUDE_GUARD_TESTED
+            || include_guard == INCLUDE_GUARD_OPEN)
+        result->only_includes = 0;
+
+    fclose(f);
+}
+
+static void free_source_includes(source_includes_t* source_includes)
+{
+    DELETE(source_includes->includes);
+    DELETE(source_includes->lines);
+}
+
+// Parses a line marker '# <line> "<file>" <flags>' of the preprocessed code
+static char parse_line_marker(const char* line, int* line_number, const char** filename)
+{
+    if (line[0] != '#')
+        return 0;
+    line++;
+    while (*line == ' ')
+        line++;
+
+    if (*line < '0' || *line > '9')
+        return 0;
+    *line_number = strtol(line, (char**)&line, 10);
+
+    while (*line == ' ')
+        line++;
+    if (*line != '"')
+        return 0;
+    line++;
+
+    char name[PATH_MAX];
+    size_t length = 0;
+    while (*line != '"' && *line != '\0')
+    {
+        if (*line == '\\' && line[1] != '\0')
+            line++;
+        if (length + 1 >= sizeof(name))
+            return 0;
+        name[length] = *line;
+        length++;
+        line++;
+    }
+    if (*line != '"')
+        return 0;
+    name[length] = '\0';
+
+    *filename = uniquestr(name);
+    return 1;
+}
+
+typedef struct preprocessed_prefix_tag
+{
+    // Offset where the code after the includes starts, -1 if there is none
+    long tail_offset;
+
+    // Files read in the prefix, as real paths
+    int num_dependences;
+    const char** dependences;
+} preprocessed_prefix_t;
+
+// Finds where the main file continues after the line last_include_line and
+// the files included before
+static char scan_preprocessed_prefix(const char* parsed_filename,
+        int last_include_line,
+        preprocessed_prefix_t* result)
+{
+    memset(result, 0, sizeof(*result));
+    result->tail_offset = -1;
+
+    FILE* f = fopen(parsed_filename, "r");
+    if (f == NULL)
+        return 0;
+
+    const char* main_filename = NULL;
+    const char* last_filename = NULL;
+
+    char line[PATH_MAX + 256];
+    long offset = ftell(f);
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        long line_offset = offset;
+        offset = ftell(f);
+
+        int line_number = 0;
+        const char* filename = NULL;
+        if (!parse_line_marker(line, &line_number, &filename))
+            continue;
+
+        if (main_filename == NULL)
+            main_filename = filename;
+
+        if (filename == main_filename)
+        {
+            if (line_number > last_include_line)
+            {
+                result->tail_offset = line_offset;
+                break;
+            }
+            continue;
+        }
+
+        // <built-in>, <command-line> and the like
+        if (filename[0] == '<'
+                || filename == last_filename)
+            continue;
+        last_filename = filename;
+
+        char real_path[PATH_MAX];
+        if (realpath(filename, real_path) == NULL)
+        {
+            fclose(f);
+            return 0;
+        }
+
+        const char* dependence = uniquestr(real_path);
+        int i;
+        for (i = 0; i < result->num_dependences; i++)
+        {
+            if (result->dependences[i] == dependence)
+                break;
+        }
+        if (i == result->num_dependences)
+        {
+            P_LIST_ADD(result->dependences, result->num_dependences, dependence);
+        }
+    }
+
+    char ok = !ferror(f);
+    fclose(f);
+
+    return ok;
+}
+
+// FNV-1a of the contents of the file
+static char hash_file(const char* filename, uint64_t* hash)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+        return 0;
+
+    uint64_t h = 0xcbf29ce484222325ULL;
+    unsigned char buffer[65536];
+    size_t actually_read;
+    while ((actually_read = fread(buffer, 1, sizeof(buffer), f)) != 0)
+    {
+        size_t i;
+        for (i = 0; i < actually_read; i++)
+        {
+            h ^= buffer[i];
+            h *= 0x100000001b3ULL;
+        }
+    }
+
+    char ok = !ferror(f);
+    fclose(f);
+
+    *hash = h;
+    return ok;
+}
+
+static char dependence_is_up_to_date(const pch_dependence_t* dependence)
+{
+    struct stat st;
+    if (stat(dependence->filename, &st) != 0
+            || (uint64_t)st.st_size != dependence->size)
+        return 0;
+
+    if ((int64_t)st.st_mtime == dependence->mtime)
+        return 1;
+
+    // Touched but maybe not changed
+    uint64_t hash = 0;
+    return hash_file(dependence->filename, &hash)
+        && hash == dependence->hash;
+}
+
+// A warning so -Werror can tell that the precompiled header was not used
+static void pch_not_used(translation_unit_t* translation_unit, const char* reason)
+{
+    warn_printf_at(make_locus(translation_unit->input_filename, 0, 0),
+            "precompiled header '%s' not used: %s\n",
+            compilation_process.pch_filename,
+            reason);
+}
+
+// Splits the preprocessed file in the headers and the rest
+static const char* split_preprocessed_file(const char* parsed_filename, long tail_offset)
+{
+    FILE* f = fopen(parsed_filename, "r");
+    if (f == NULL)
+        return NULL;
+
+    temporal_file_t prefix = new_temporal_file();
+    temporal_file_t tail = new_temporal_file();
+
+    FILE* prefix_file = fopen(prefix->name, "w");
+    FILE* tail_file = fopen(tail->name, "w");
+    if (prefix_file == NULL
+            || tail_file == NULL)
+    {
+        fatal_error("Cannot create temporary file (%s)", strerror(errno));
+    }
+
+    char buffer[65536];
+    long remaining = tail_offset;
+    size_t actually_read;
+    while (remaining > 0
+            && (actually_read = fread(buffer, 1,
+                    remaining < (long)sizeof(buffer) ? (size_t)remaining : sizeof(buffer), f)) != 0)
+    {
+        fwrite(buffer, 1, actually_read, prefix_file);
+        remaining -= actually_read;
+    }
+    while ((actually_read = fread(buffer, 1, sizeof(buffer), f)) != 0)
+    {
+        fwrite(buffer, 1, actually_read, tail_file);
+    }
+
+    char ok = !ferror(f)
+        && !ferror(prefix_file)
+        && !ferror(tail_file);
+    fclose(f);
+    if (fclose(prefix_file) != 0
+            || fclose(tail_file) != 0)
+        ok = 0;
+
+    if (!ok)
+        return NULL;
+
+    used_pch_prefix_filename = prefix->name;
+    return tail->name;
+}
+
+const char* driver_pch_use(translation_unit_t* translation_unit,
+        const char* parsed_filename)
+{
+    // Namespaces and templates cannot be saved
+    if (!IS_C_LANGUAGE)
+        return NULL;
+
+    pch_file_t* pch = pch_open(compilation_process.pch_filename);
+    if (pch == NULL)
+    {
+        pch_not_used(translation_unit, "it is not a valid precompiled header");
+        return NULL;
+    }
+
+    const pch_info_t* info = pch_get_info(pch);
+    const char* reason = NULL;
+
+    source_includes_t source_includes;
+    read_source_includes(translation_unit->input_filename, &source_includes);
+
+    preprocessed_prefix_t prefix;
+    memset(&prefix, 0, sizeof(prefix));
+
+    int i;
+    if (strcmp(info->configuration_key, driver_cache_compute_configuration_key()) != 0)
+    {
+        reason = "it was created with a different configuration";
+    }
+    else if (source_includes.num_includes < info->num_includes
+            || info->num_includes == 0)
+    {
+        reason = "the file does not start with its #include directives";
+    }
+    else
+    {
+        for (i = 0; i < info->num_includes && reason == NULL; i++)
+        {
+            if (strcmp(source_includes.includes[i], info->includes[i]) != 0)
+                reason = "the file does not start with its #include directives";
+        }
+    }
+
+    if (reason == NULL
+            && !scan_preprocessed_prefix(parsed_filename,
+                source_includes.lines[info->num_includes - 1],
+                &prefix))
+    {
+        reason = "the preprocessed file cannot be read";
+    }
+
+    if (reason == NULL)
+    {
+        // The headers may be found in other places now
+        if (prefix.num_dependences != info->num_dependences)
+            reason = "the included headers have changed";
+
+        for (i = 0; i < prefix.num_dependences && reason == NULL; i++)
+        {
+            int j;
+            for (j = 0; j < info->num_dependences; j++)
+            {
+                if (strcmp(prefix.dependences[i], info->dependences[j].filename) == 0)
+                    break;
+            }
+            if (j == info->num_dependences)
+                reason = "the included headers have changed";
+        }
+
+        for (i = 0; i < info->num_dependences && reason == NULL; i++)
+        {
+            if (!dependence_is_up_to_date(&info->dependences[i]))
+                reason = "the included headers have been modified";
+        }
+    }
+
+    const char* scanned_filename = NULL;
+    if (reason == NULL)
+    {
+        if (prefix.tail_offset < 0)
+        {
+            // Only the headers
+            prefix.tail_offset = LONG_MAX;
+        }
+
+        scanned_filename = split_preprocessed_file(parsed_filename, prefix.tail_offset);
+        if (scanned_filename == NULL)
+            reason = "the preprocessed file cannot be read";
+    }
+
+    free_source_includes(&source_includes);
+    DELETE(prefix.dependences);
+
+    if (reason != NULL)
+    {
+        pch_not_used(translation_unit, reason);
+        pch_close(pch);
+        return NULL;
+    }
+
+    pch_load(pch, translation_unit->global_decl_context);
+    used_pch = pch;
+    translation_unit->uses_pch = 1;
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Using precompiled header '%s' for '%s'\n",
+                compilation_process.pch_filename,
+                translation_unit->input_filename);
+    }
+
+    return scanned_filename;
+}
+
+void driver_pch_emit_code(translation_unit_t* translation_unit, FILE* f)
+{
+    if (!translation_unit->uses_pch)
+        return;
+
+    FILE* prefix_file = fopen(used_pch_prefix_filename, "r");
+    if (prefix_file == NULL)
+    {
+        fatal_error("Cannot open temporary file '%s' (%s)",
+                used_pch_prefix_filename, strerror(errno));
+    }
+
+    char buffer[65536];
+    size_t actually_read;
+    while ((actually_read = fread(buffer, 1, sizeof(buffer), prefix_file)) != 0)
+    {
+        fwrite(buffer, 1, actually_read, f);
+    }
+    fclose(prefix_file);
+}
+
+static void create_pch(translation_unit_t* translation_unit,
+        const char* parsed_filename)
+{
+    if (!IS_C_LANGUAGE)
+    {
+        fatal_error("%s: error: precompiled headers can only be created from C files",
+                translation_unit->input_filename);
+    }
+
+    source_includes_t source_includes;
+    read_source_includes(translation_unit->input_filename, &source_includes);
+    if (!source_includes.only_includes
+            || source_includes.num_includes == 0)
+    {
+        fatal_error("%s: error: a precompiled header can only be created from a file with #include directives",
+                translation_unit->input_filename);
+    }
+
+    preprocessed_prefix_t prefix;
+    if (!scan_preprocessed_prefix(parsed_filename, INT_MAX, &prefix))
+    {
+        fatal_error("%s: error: cannot read the preprocessed file '%s'",
+                translation_unit->input_filename, parsed_filename);
+    }
+
+    pch_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.configuration_key = driver_cache_compute_configuration_key();
+    info.num_includes = source_includes.num_includes;
+    info.includes = source_includes.includes;
+
+    info.num_dependences = prefix.num_dependences;
+    info.dependences = NEW_VEC0(pch_dependence_t, prefix.num_dependences);
+    int i;
+    for (i = 0; i < prefix.num_dependences; i++)
+    {
+        pch_dependence_t* dependence = &info.dependences[i];
+        dependence->filename = prefix.dependences[i];
+
+        struct stat st;
+        if (stat(dependence->filename, &st) != 0
+                || !hash_file(dependence->filename, &dependence->hash))
+        {
+            fatal_error("%s: error: cannot read '%s' (%s)",
+                    translation_unit->input_filename,
+                    dependence->filename,
+                    strerror(errno));
+        }
+        dependence->size = st.st_size;
+        dependence->mtime = st.st_mtime;
+    }
+
+    pch_write(compilation_process.pch_create_filename,
+            translation_unit->global_decl_context,
+            &info);
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Precompiled header '%s' created from '%s' (%d headers)\n",
+                compilation_process.pch_create_filename,
+                translation_unit->input_filename,
+                info.num_dependences);
+    }
+
+    DELETE(info.dependences);
+    DELETE(prefix.dependences);
+    free_source_includes(&source_includes);
+}
+
+void driver_pch_finish(translation_unit_t* translation_unit,
+        const char* parsed_filename)
+{
+    if (compilation_process.pch_create_filename != NULL)
+    {
+        create_pch(translation_unit, parsed_filename);
+    }
+
+    if (translation_unit->uses_pch)
+    {
+        if (driver_report_enabled())
+        {
+            driver_report_set_counter(translation_unit, "pch_symbols",
+                    pch_get_num_loaded_symbols());
+        }
+        if (CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "%d symbols loaded from precompiled header '%s'\n",
+                    pch_get_num_loaded_symbols(),
+                    compilation_process.pch_filename);
+        }
+
+        pch_close(used_pch);
+        used_pch = NULL;
+        used_pch_prefix_filename = NULL;
+    }
+}
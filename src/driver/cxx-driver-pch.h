@@ -0,0 +1,62 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_DRIVER_PCH_H
+#define CXX_DRIVER_PCH_H
+
+#include "cxx-macros.h"
+#include "cxx-driver-decls.h"
+
+#include <stdio.h>
+
+MCXX_BEGIN_DECLS
+
+// Precompiled headers of C translation units (--pch and --pch-create)
+//
+// A precompiled header is created from a file that only contains #include
+// directives. A translation unit starting with the same directives uses it
+// if the headers and the configuration have not changed: the preprocessed
+// code of the headers is not parsed again and its declarations are
+// loaded from the precompiled header when they are looked up
+
+// Returns the file that has to be scanned instead of parsed_filename, or
+// NULL if the precompiled header cannot be used in this translation unit
+const char* driver_pch_use(translation_unit_t* translation_unit,
+        const char* parsed_filename);
+
+// Emits the code of the headers not parsed
+void driver_pch_emit_code(translation_unit_t* translation_unit, FILE* f);
+
+// Creates the precompiled header if requested and releases the one used
+void driver_pch_finish(translation_unit_t* translation_unit,
+        const char* parsed_filename);
+
+MCXX_END_DECLS
+
+#endif // CXX_DRIVER_PCH_H
@@ -0,0 +1,547 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifdef HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include "cxx-driver-report.h"
+#include "cxx-driver-build-info.h"
+#include "cxx-process.h"
+#include "cxx-scope.h"
+#include "cxx-typeutils.h"
+#include "cxx-overload.h"
+#include "cxx-exprtype.h"
+#include "cxx-entrylist.h"
+#include "cxx-instantiation.h"
+#include "cxx-utils.h"
+#include "uniquestr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+  #include <sys/resource.h>
+#endif
+
+typedef struct report_stage_tag
+{
+    const char* stage;
+    // Only for compiler phases
+    const char* name;
+
+    double wall_time;
+    double cpu_time;
+    long peak_rss_kb;
+} report_stage_t;
+
+// Caches of the frontend whose hits and misses are reported
+static struct report_cache_tag
+{
+    const char* hits_counter;
+    const char* misses_counter;
+    void (*get_stats)(unsigned long* hits, unsigned long* misses);
+} report_caches[] =
+{
+    { "class_lookup_cache_hits", "class_lookup_cache_misses", get_class_lookup_cache_stats },
+    { "overload_cache_hits", "overload_cache_misses", get_overload_cache_stats },
+    { "standard_conversion_cache_hits", "standard_conversion_cache_misses", get_standard_conversion_cache_stats },
+    { "equivalent_types_cache_hits", "equivalent_types_cache_misses", get_equivalent_types_cache_stats },
+    { "constexpr_call_cache_hits", "constexpr_call_cache_misses", get_constexpr_call_cache_stats },
+    { "specialization_index_hits", "specialization_index_misses", get_specialization_index_stats },
+};
+
+enum { NUM_REPORT_CACHES = sizeof(report_caches) / sizeof(report_caches[0]) };
+
+typedef struct report_counter_tag
+{
+    const char* name;
+    unsigned long value;
+} report_counter_t;
+
+typedef struct report_translation_unit_tag
+{
+    translation_unit_t* translation_unit;
+
+    // Translation units compiled by another process are kept as they were
+    // written by it
+    const char* serialized;
+
+    unsigned long num_symbols_at_start;
+    unsigned long num_types_at_start;
+    unsigned long num_entity_specs_cold_at_start;
+    unsigned long long entry_list_bytes_at_start;
+    unsigned long cache_hits_at_start[NUM_REPORT_CACHES];
+    unsigned long cache_misses_at_start[NUM_REPORT_CACHES];
+
+    int num_stages;
+    report_stage_t* stages;
+
+    int num_counters;
+    report_counter_t* counters;
+
+    // Templates instantiated, most expensive first
+    int num_instantiations;
+    instantiation_stats_t* instantiations;
+
+    // Compiler phase currently running
+    driver_report_measure_t phase_measure;
+} report_translation_unit_t;
+
+static int num_report_translation_units = 0;
+static report_translation_unit_t** report_translation_units = NULL;
+
+static void get_self_usage(double* cpu_time, long* peak_rss_kb)
+{
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+        *cpu_time = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6
+            + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+        // Linux reports it in KB
+        *peak_rss_kb = usage.ru_maxrss;
+        return;
+    }
+#endif
+    *cpu_time = 0.0;
+    *peak_rss_kb = 0;
+}
+
+static report_translation_unit_t* get_report_translation_unit(translation_unit_t* translation_unit)
+{
+    int i;
+    for (i = num_report_translation_units - 1; i >= 0; i--)
+    {
+        if (report_translation_units[i]->translation_unit == translation_unit)
+            return report_translation_units[i];
+    }
+
+    report_translation_unit_t* result = NEW0(report_translation_unit_t);
+    result->translation_unit = translation_unit;
+    result->num_symbols_at_start = get_num_symbols_created();
+    result->num_types_at_start = get_num_types_created();
+    result->num_entity_specs_cold_at_start = get_num_entity_specs_cold_created();
+    result->entry_list_bytes_at_start = get_entry_list_bytes_allocated();
+    for (i = 0; i < NUM_REPORT_CACHES; i++)
+    {
+        report_caches[i].get_stats(&result->cache_hits_at_start[i],
+                &result->cache_misses_at_start[i]);
+    }
+
+    P_LIST_ADD(report_translation_units, num_report_translation_units, result);
+
+    return result;
+}
+
+static void add_stage(translation_unit_t* translation_unit,
+        const char* stage,
+        const char* name,
+        double wall_time,
+        double cpu_time,
+        long peak_rss_kb)
+{
+    report_translation_unit_t* report = get_report_translation_unit(translation_unit);
+
+    report_stage_t new_stage;
+    memset(&new_stage, 0, sizeof(new_stage));
+    new_stage.stage = stage;
+    new_stage.name = name;
+    new_stage.wall_time = wall_time;
+    new_stage.cpu_time = cpu_time;
+    new_stage.peak_rss_kb = peak_rss_kb;
+
+    P_LIST_ADD(report->stages, report->num_stages, new_stage);
+}
+
+static void report_phase_begin(translation_unit_t* translation_unit,
+        const char* phase_name UNUSED_PARAMETER)
+{
+    report_translation_unit_t* report = get_report_translation_unit(translation_unit);
+    driver_report_measure_start(&report->phase_measure);
+}
+
+static void report_phase_end(translation_unit_t* translation_unit,
+        const char* phase_name)
+{
+    report_translation_unit_t* report = get_report_translation_unit(translation_unit);
+    driver_report_measure_end(&report->phase_measure,
+            translation_unit,
+            DRIVER_REPORT_STAGE_PHASE,
+            uniquestr(phase_name));
+}
+
+void driver_report_init(void)
+{
+    compilation_process.report_phase_begin = report_phase_begin;
+    compilation_process.report_phase_end = report_phase_end;
+}
+
+char driver_report_enabled(void)
+{
+    return compilation_process.report_filename != NULL;
+}
+
+void driver_report_begin_translation_unit(translation_unit_t* translation_unit)
+{
+    if (!driver_report_enabled())
+        return;
+
+    get_report_translation_unit(translation_unit);
+}
+
+void driver_report_measure_start(driver_report_measure_t* measure)
+{
+    if (!driver_report_enabled())
+        return;
+
+    long peak_rss_kb;
+    get_self_usage(&measure->cpu_time, &peak_rss_kb);
+    timing_start(&measure->timing);
+}
+
+void driver_report_measure_end(driver_report_measure_t* measure,
+        translation_unit_t* translation_unit,
+        const char* stage,
+        const char* name)
+{
+    if (!driver_report_enabled())
+        return;
+
+    timing_end(&measure->timing);
+
+    double cpu_time;
+    long peak_rss_kb;
+    get_self_usage(&cpu_time, &peak_rss_kb);
+
+    add_stage(translation_unit, stage, name,
+            timing_elapsed(&measure->timing),
+            cpu_time - measure->cpu_time,
+            peak_rss_kb);
+}
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+void driver_report_add_program_stage(translation_unit_t* translation_unit,
+        const char* stage,
+        const timing_t* timing)
+{
+    if (!driver_report_enabled())
+        return;
+
+    double cpu_time;
+    long peak_rss_kb;
+    wait_program_last_usage(&cpu_time, &peak_rss_kb);
+
+    add_stage(translation_unit, stage, /* name */ NULL,
+            timing_elapsed(timing),
+            cpu_time,
+            peak_rss_kb);
+}
+#endif
+
+void driver_report_set_counter(translation_unit_t* translation_unit,
+        const char* counter,
+        unsigned long value)
+{
+    if (!driver_report_enabled())
+        return;
+
+    report_translation_unit_t* report = get_report_translation_unit(translation_unit);
+
+    int i;
+    for (i = 0; i < report->num_counters; i++)
+    {
+        if (strcmp(report->counters[i].name, counter) == 0)
+        {
+            report->counters[i].value = value;
+            return;
+        }
+    }
+
+    report_counter_t new_counter;
+    new_counter.name = counter;
+    new_counter.value = value;
+
+    P_LIST_ADD(report->counters, report->num_counters, new_counter);
+}
+
+void driver_report_set_symbol_counters(translation_unit_t* translation_unit)
+{
+    if (!driver_report_enabled())
+        return;
+
+    report_translation_unit_t* report = get_report_translation_unit(translation_unit);
+
+    driver_report_set_counter(translation_unit, "symbols",
+            get_num_symbols_created() - report->num_symbols_at_start);
+    driver_report_set_counter(translation_unit, "types",
+            get_num_types_created() - report->num_types_at_start);
+    // Memory used by the symbols of this translation unit, including their
+    // records of rarely used attributes
+    driver_report_set_counter(translation_unit, "symbol_bytes",
+            (get_num_symbols_created() - report->num_symbols_at_start) * sizeof(scope_entry_t)
+            + (get_num_entity_specs_cold_created() - report->num_entity_specs_cold_at_start)
+            * sizeof(entity_specifiers_cold_t));
+    driver_report_set_counter(translation_unit, "entry_list_bytes",
+            get_entry_list_bytes_allocated() - report->entry_list_bytes_at_start);
+
+    int i;
+    for (i = 0; i < NUM_REPORT_CACHES; i++)
+    {
+        unsigned long hits, misses;
+        report_caches[i].get_stats(&hits, &misses);
+        driver_report_set_counter(translation_unit, report_caches[i].hits_counter,
+                hits - report->cache_hits_at_start[i]);
+        driver_report_set_counter(translation_unit, report_caches[i].misses_counter,
+                misses - report->cache_misses_at_start[i]);
+    }
+
+    int num_stats = 0;
+    instantiation_stats_t** stats = instantiation_get_stats(&num_stats);
+
+    DELETE(report->instantiations);
+    report->num_instantiations = num_stats;
+    report->instantiations = NEW_VEC(instantiation_stats_t, num_stats);
+    for (i = 0; i < num_stats; i++)
+    {
+        report->instantiations[i] = *stats[i];
+    }
+}
+
+static void write_json_string(FILE* f, const char* str)
+{
+    if (str == NULL)
+    {
+        fprintf(f, "null");
+        return;
+    }
+
+    fputc('"', f);
+    const unsigned char* p;
+    for (p = (const unsigned char*)str; *p != '\0'; p++)
+    {
+        switch (*p)
+        {
+            case '"': fprintf(f, "\\\""); break;
+            case '\\': fprintf(f, "\\\\"); break;
+            case '\n': fprintf(f, "\\n"); break;
+            case '\t': fprintf(f, "\\t"); break;
+            default:
+                {
+                    if (*p < 0x20)
+                        fprintf(f, "\\u%04x", *p);
+                    else
+                        fputc(*p, f);
+                    break;
+                }
+        }
+    }
+    fputc('"', f);
+}
+
+static void write_translation_unit(FILE* f, report_translation_unit_t* report)
+{
+    fprintf(f, "    {\n");
+    fprintf(f, "      \"input\": ");
+    write_json_string(f, report->translation_unit->input_filename);
+    fprintf(f, ",\n");
+    fprintf(f, "      \"output\": ");
+    write_json_string(f, report->translation_unit->output_filename);
+    fprintf(f, ",\n");
+
+    fprintf(f, "      \"stages\": [");
+    int i;
+    for (i = 0; i < report->num_stages; i++)
+    {
+        report_stage_t* stage = &report->stages[i];
+        fprintf(f, "%s\n        { \"stage\": ", (i > 0) ? "," : "");
+        write_json_string(f, stage->stage);
+        if (stage->name != NULL)
+        {
+            fprintf(f, ", \"name\": ");
+            write_json_string(f, stage->name);
+        }
+        fprintf(f, ", \"wall_time\": %.6f, \"cpu_time\": %.6f, \"peak_rss_kb\": %ld }",
+                stage->wall_time, stage->cpu_time, stage->peak_rss_kb);
+    }
+    fprintf(f, "%s],\n", (report->num_stages > 0) ? "\n      " : "");
+
+    fprintf(f, "      \"counters\": {");
+    for (i = 0; i < report->num_counters; i++)
+    {
+        fprintf(f, "%s\n        ", (i > 0) ? "," : "");
+        write_json_string(f, report->counters[i].name);
+        fprintf(f, ": %lu", report->counters[i].value);
+    }
+    fprintf(f, "%s},\n", (report->num_counters > 0) ? "\n      " : "");
+
+    fprintf(f, "      \"instantiations\": [");
+    for (i = 0; i < report->num_instantiations; i++)
+    {
+        instantiation_stats_t* stats = &report->instantiations[i];
+        fprintf(f, "%s\n        { \"template\": ", (i > 0) ? "," : "");
+        write_json_string(f, stats->name);
+        fprintf(f, ", \"kind\": \"%s\", \"count\": %d, \"wall_time\": %.6f, \"bytes\": %llu }",
+                stats->is_class ? "class" : "function",
+                stats->num_instantiations,
+                stats->time,
+                stats->bytes);
+    }
+    fprintf(f, "%s]\n", (report->num_instantiations > 0) ? "\n      " : "");
+    fprintf(f, "    }");
+}
+
+// Writes the translation units separated by commas. Returns the number of
+// translation units written
+static int write_translation_units(FILE* f, char only_this_process)
+{
+    int num_written = 0;
+    int i;
+    for (i = 0; i < num_report_translation_units; i++)
+    {
+        report_translation_unit_t* report = report_translation_units[i];
+        if (report->serialized != NULL
+                && only_this_process)
+            continue;
+
+        if (num_written > 0)
+            fprintf(f, ",\n");
+
+        if (report->serialized != NULL)
+            fprintf(f, "%s", report->serialized);
+        else
+            write_translation_unit(f, report);
+
+        num_written++;
+    }
+
+    return num_written;
+}
+
+void driver_report_save_translation_units(const char* filename)
+{
+    if (!driver_report_enabled())
+        return;
+
+    FILE* f = fopen(filename, "w");
+    if (f == NULL)
+    {
+        fatal_error("error: could not open report file '%s' (%s)",
+                filename, strerror(errno));
+    }
+
+    write_translation_units(f, /* only_this_process */ 1);
+    fclose(f);
+}
+
+void driver_report_load_translation_units(const char* filename)
+{
+    if (!driver_report_enabled())
+        return;
+
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+        return;
+
+    size_t length = 0;
+    size_t capacity = 4096;
+    char* serialized = NEW_VEC(char, capacity);
+
+    size_t actually_read;
+    while ((actually_read = fread(serialized + length, sizeof(char), capacity - length - 1, f)) != 0)
+    {
+        length += actually_read;
+        if (length + 1 == capacity)
+        {
+            capacity *= 2;
+            serialized = NEW_REALLOC(char, serialized, capacity);
+        }
+    }
+    serialized[length] = '\0';
+    fclose(f);
+
+    if (length == 0)
+    {
+        DELETE(serialized);
+        return;
+    }
+
+    report_translation_unit_t* report = NEW0(report_translation_unit_t);
+    report->serialized = serialized;
+
+    P_LIST_ADD(report_translation_units, num_report_translation_units, report);
+}
+
+void driver_report_write(const timing_t* timing_global)
+{
+    if (!driver_report_enabled())
+        return;
+
+    FILE* f = fopen(compilation_process.report_filename, "w");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: could not open report file '%s' (%s)\n",
+                compilation_process.exec_basename,
+                compilation_process.report_filename,
+                strerror(errno));
+        return;
+    }
+
+    double cpu_time;
+    long peak_rss_kb;
+    get_self_usage(&cpu_time, &peak_rss_kb);
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"compiler\": ");
+    write_json_string(f, PACKAGE " " VERSION " (" MCXX_BUILD_VERSION ")");
+    fprintf(f, ",\n");
+    fprintf(f, "  \"profile\": ");
+    write_json_string(f, compilation_process.exec_basename);
+    fprintf(f, ",\n");
+
+    fprintf(f, "  \"command_line\": [");
+    int i;
+    for (i = 0; i < compilation_process.original_argc; i++)
+    {
+        if (i > 0)
+            fprintf(f, ", ");
+        write_json_string(f, compilation_process.original_argv[i]);
+    }
+    fprintf(f, "],\n");
+
+    fprintf(f, "  \"wall_time\": %.6f,\n", timing_elapsed(timing_global));
+    fprintf(f, "  \"cpu_time\": %.6f,\n", cpu_time);
+    fprintf(f, "  \"peak_rss_kb\": %ld,\n", peak_rss_kb);
+
+    fprintf(f, "  \"translation_units\": [\n");
+    if (write_translation_units(f, /* only_this_process */ 0) > 0)
+        fprintf(f, "\n");
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+
+    fclose(f);
+}
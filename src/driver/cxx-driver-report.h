@@ -0,0 +1,94 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_DRIVER_REPORT_H
+#define CXX_DRIVER_REPORT_H
+
+#include "cxx-macros.h"
+#include "cxx-driver-decls.h"
+#include "cxx-driver-utils.h"
+
+MCXX_BEGIN_DECLS
+
+// Machine-readable report of the compilation (--report). For every
+// translation unit it records the wall time, CPU time and peak RSS of each
+// stage and some counters of the trees and the symbol table. It is written
+// in JSON into compilation_process.report_filename at the end of the
+// compilation
+
+#define DRIVER_REPORT_STAGE_PREPROCESSING "preprocessing"
+#define DRIVER_REPORT_STAGE_PARSING "parsing"
+#define DRIVER_REPORT_STAGE_SEMANTIC_ANALYSIS "semantic_analysis"
+#define DRIVER_REPORT_STAGE_PHASE "phase"
+#define DRIVER_REPORT_STAGE_CODEGEN "codegen"
+#define DRIVER_REPORT_STAGE_NATIVE_COMPILATION "native_compilation"
+
+typedef struct driver_report_measure_tag
+{
+    timing_t timing;
+    double cpu_time;
+} driver_report_measure_t;
+
+void driver_report_init(void);
+char driver_report_enabled(void);
+
+// Counters of symbols and types are relative to this point
+void driver_report_begin_translation_unit(translation_unit_t* translation_unit);
+
+// Measures a stage run by this process
+void driver_report_measure_start(driver_report_measure_t* measure);
+void driver_report_measure_end(driver_report_measure_t* measure,
+        translation_unit_t* translation_unit,
+        const char* stage,
+        const char* name);
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Records a stage run by the last program waited. timing must have ended
+void driver_report_add_program_stage(translation_unit_t* translation_unit,
+        const char* stage,
+        const timing_t* timing);
+#endif
+
+void driver_report_set_counter(translation_unit_t* translation_unit,
+        const char* counter,
+        unsigned long value);
+// Sets the counters of symbols and types created since the translation
+// unit began
+void driver_report_set_symbol_counters(translation_unit_t* translation_unit);
+
+// Translation units compiled by another process (-j) are passed to the
+// driver through a file
+void driver_report_save_translation_units(const char* filename);
+void driver_report_load_translation_units(const char* filename);
+
+void driver_report_write(const timing_t* timing_global);
+
+MCXX_END_DECLS
+
+#endif // CXX_DRIVER_REPORT_H
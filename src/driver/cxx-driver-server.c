@@ -0,0 +1,616 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+#ifdef HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include "cxx-driver-server.h"
+#include "cxx-driver-utils.h"
+#include "cxx-utils.h"
+#include "filename.h"
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+// Every request starts with this so stray connections and clients of
+// another version are rejected
+#define DRIVER_SERVER_MAGIC 0x4d435854U
+
+enum driver_server_reply_kind_tag
+{
+    DRIVER_SERVER_REPLY_DECLINED = 0,
+    DRIVER_SERVER_REPLY_ACCEPTED,
+    DRIVER_SERVER_REPLY_EXITED,
+    DRIVER_SERVER_REPLY_SIGNALED,
+};
+
+static char write_all(int fd, const void* buffer, size_t length)
+{
+    const char* p = (const char*)buffer;
+    while (length > 0)
+    {
+        ssize_t written = write(fd, p, length);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        p += written;
+        length -= written;
+    }
+    return 1;
+}
+
+static char read_all(int fd, void* buffer, size_t length)
+{
+    char* p = (char*)buffer;
+    while (length > 0)
+    {
+        ssize_t actually_read = read(fd, p, length);
+        if (actually_read < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        if (actually_read == 0)
+            return 0;
+        p += actually_read;
+        length -= actually_read;
+    }
+    return 1;
+}
+
+static char write_uint32(int fd, uint32_t value)
+{
+    return write_all(fd, &value, sizeof(value));
+}
+
+static char read_uint32(int fd, uint32_t* value)
+{
+    return read_all(fd, value, sizeof(*value));
+}
+
+static char write_string(int fd, const char* str)
+{
+    uint32_t length = strlen(str);
+    return write_uint32(fd, length)
+        && write_all(fd, str, length);
+}
+
+static char read_string(int fd, const char** str)
+{
+    uint32_t length;
+    if (!read_uint32(fd, &length))
+        return 0;
+
+    char* result = NEW_VEC(char, length + 1);
+    if (!read_all(fd, result, length))
+    {
+        DELETE(result);
+        return 0;
+    }
+    result[length] = '\0';
+
+    *str = result;
+    return 1;
+}
+
+static char write_string_array(int fd, int n, const char** array)
+{
+    if (!write_uint32(fd, n))
+        return 0;
+
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        if (!write_string(fd, array[i]))
+            return 0;
+    }
+    return 1;
+}
+
+// The returned array is NULL-ended
+static char read_string_array(int fd, int* n, const char*** array)
+{
+    uint32_t length;
+    // Be sensible with the number of elements
+    if (!read_uint32(fd, &length)
+            || length > (1U << 20))
+        return 0;
+
+    const char** result = NEW_VEC0(const char*, length + 1);
+    uint32_t i;
+    for (i = 0; i < length; i++)
+    {
+        if (!read_string(fd, &result[i]))
+            return 0;
+    }
+
+    *n = length;
+    *array = result;
+    return 1;
+}
+
+// Standard input, output and error of the client are passed to the server
+// so the compilation writes directly to them
+static char send_standard_streams(int fd)
+{
+    int fds[3] = { 0, 1, 2 };
+
+    char payload = 'M';
+    struct iovec iov;
+    iov.iov_base = &payload;
+    iov.iov_len = sizeof(payload);
+
+    char control[CMSG_SPACE(sizeof(fds))];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    ssize_t result;
+    while ((result = sendmsg(fd, &msg, 0)) < 0
+            && errno == EINTR)
+    {
+    }
+
+    return result == sizeof(payload);
+}
+
+static char receive_standard_streams(int fd, int fds[3])
+{
+    char payload;
+    struct iovec iov;
+    iov.iov_base = &payload;
+    iov.iov_len = sizeof(payload);
+
+    char control[CMSG_SPACE(3 * sizeof(int))];
+    memset(control, 0, sizeof(control));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t result;
+    while ((result = recvmsg(fd, &msg, 0)) < 0
+            && errno == EINTR)
+    {
+    }
+
+    if (result != sizeof(payload))
+        return 0;
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL
+            || cmsg->cmsg_level != SOL_SOCKET
+            || cmsg->cmsg_type != SCM_RIGHTS
+            || cmsg->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+        return 0;
+
+    memcpy(fds, CMSG_DATA(cmsg), 3 * sizeof(int));
+    return 1;
+}
+
+static void send_reply(int fd, uint32_t kind, uint32_t value)
+{
+    // If the client is gone there is nobody to tell
+    if (write_uint32(fd, kind))
+        write_uint32(fd, value);
+}
+
+// The client sends nothing after the request, so the connection becomes
+// readable only when the client is gone (e.g. interrupted by the user). In
+// that case the compilation is killed instead of letting it write outputs
+// nobody waits for
+static pid_t wait_compilation_or_client(int connection_fd, pid_t compilation_pid, int* status)
+{
+    char client_gone = 0;
+    for (;;)
+    {
+        pid_t waited = waitpid(compilation_pid, status, client_gone ? 0 : WNOHANG);
+        if (waited != 0)
+        {
+            if (waited < 0 && errno == EINTR)
+                continue;
+            return waited;
+        }
+
+        struct pollfd connection;
+        memset(&connection, 0, sizeof(connection));
+        connection.fd = connection_fd;
+        connection.events = POLLIN;
+
+        // SIGCHLD is not caught, so check the compilation now and then
+        if (poll(&connection, 1, /* timeout ms */ 100) > 0)
+        {
+            client_gone = 1;
+            kill(-compilation_pid, SIGTERM);
+        }
+    }
+}
+
+// Only the user running the server may send requests
+static char is_request_of_same_user(int connection_fd)
+{
+#if defined(SO_PEERCRED)
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+    if (getsockopt(connection_fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0)
+        return 0;
+
+    return credentials.uid == getuid();
+#else
+    // The socket is only reachable through a directory of this user
+    (void)connection_fd;
+    return 1;
+#endif
+}
+
+// This runs in a child of the server for each request. It returns only in
+// the grandchild that performs the compilation
+static void handle_request(int connection_fd,
+        driver_server_accept_request_fun_t accept_request,
+        int *argc, const char*** argv)
+{
+    int fds[3];
+    uint32_t magic = 0;
+    const char* cwd = NULL;
+    uint32_t client_umask = 0;
+    int request_argc = 0;
+    const char** request_argv = NULL;
+    int request_envc = 0;
+    const char** request_env = NULL;
+
+    if (!receive_standard_streams(connection_fd, fds)
+            || !read_uint32(connection_fd, &magic)
+            || magic != DRIVER_SERVER_MAGIC
+            || !read_string(connection_fd, &cwd)
+            || !read_uint32(connection_fd, &client_umask)
+            || !read_string_array(connection_fd, &request_argc, &request_argv)
+            || !read_string_array(connection_fd, &request_envc, &request_env)
+            || request_argc == 0)
+    {
+        _exit(EXIT_FAILURE);
+    }
+
+    if (!accept_request(request_argc, request_argv))
+    {
+        send_reply(connection_fd, DRIVER_SERVER_REPLY_DECLINED, 0);
+        _exit(EXIT_SUCCESS);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t compilation_pid = fork();
+    if (compilation_pid < 0)
+    {
+        send_reply(connection_fd, DRIVER_SERVER_REPLY_DECLINED, 0);
+        _exit(EXIT_FAILURE);
+    }
+
+    // From now on the client cannot fall back to a local compilation
+    if (compilation_pid > 0)
+    {
+        send_reply(connection_fd, DRIVER_SERVER_REPLY_ACCEPTED, 0);
+    }
+    else
+    {
+        close(connection_fd);
+
+        // Its own process group, so it can be killed together with the
+        // programs it runs if the client goes away
+        setpgid(0, 0);
+
+        int i;
+        for (i = 0; i < 3; i++)
+        {
+            if (dup2(fds[i], i) < 0)
+                _exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < 3; i++)
+        {
+            if (fds[i] > 2)
+                close(fds[i]);
+        }
+
+        if (chdir(cwd) != 0)
+        {
+            fprintf(stderr, "error: cannot change to directory '%s' (%s)\n", cwd, strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        // Strings read are never freed, so they can be used as environment
+        environ = (char**)request_env;
+        umask(client_umask & 0777);
+
+        *argc = request_argc;
+        *argv = request_argv;
+        return;
+    }
+
+    // Both parent and child set the group so it exists before any kill
+    setpgid(compilation_pid, compilation_pid);
+
+    int i;
+    for (i = 0; i < 3; i++)
+    {
+        close(fds[i]);
+    }
+
+    int status = 0;
+    pid_t waited = wait_compilation_or_client(connection_fd, compilation_pid, &status);
+
+    if (waited < 0)
+    {
+        send_reply(connection_fd, DRIVER_SERVER_REPLY_EXITED, EXIT_FAILURE);
+    }
+    else if (WIFSIGNALED(status))
+    {
+        send_reply(connection_fd, DRIVER_SERVER_REPLY_SIGNALED, WTERMSIG(status));
+    }
+    else
+    {
+        send_reply(connection_fd, DRIVER_SERVER_REPLY_EXITED, WEXITSTATUS(status));
+    }
+
+    // Do not run the cleanup routines of the server
+    _exit(EXIT_SUCCESS);
+}
+
+static void fill_socket_address(struct sockaddr_un* addr, const char* socket_path)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr->sun_path))
+    {
+        fatal_error("error: socket path '%s' is too long\n", socket_path);
+    }
+    strcpy(addr->sun_path, socket_path);
+}
+
+// Other users must not be able to reach the socket. Its directory is created
+// if it does not exist, otherwise it must be owned by this user and be
+// inaccessible to anybody else
+static void ensure_private_socket_directory(const char* socket_path)
+{
+    const char* directory = give_dirname(socket_path);
+
+    if (mkdir(directory, 0700) != 0
+            && errno != EEXIST)
+    {
+        fatal_error("error: cannot create directory '%s' for the socket (%s)\n",
+                directory, strerror(errno));
+    }
+
+    struct stat st;
+    if (stat(directory, &st) != 0)
+    {
+        fatal_error("error: cannot access directory '%s' of the socket (%s)\n",
+                directory, strerror(errno));
+    }
+
+    if (!S_ISDIR(st.st_mode)
+            || st.st_uid != getuid()
+            || (st.st_mode & 077) != 0)
+    {
+        fatal_error("error: directory '%s' of the socket must be owned by the user "
+                "of the server and only accessible by it (mode 0700)\n", directory);
+    }
+}
+
+void driver_server_run(const char* socket_path,
+        driver_server_accept_request_fun_t accept_request,
+        int *argc, const char*** argv)
+{
+    struct sockaddr_un addr;
+    fill_socket_address(&addr, socket_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0)
+    {
+        fatal_error("error: cannot create socket (%s)\n", strerror(errno));
+    }
+
+    ensure_private_socket_directory(socket_path);
+
+    // Remove a stale socket of a previous server
+    unlink(socket_path);
+
+    // Connecting requires write permission on the socket
+    mode_t old_umask = umask(0177);
+    int bind_result = bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr));
+    int bind_errno = errno;
+    umask(old_umask);
+    if (bind_result != 0)
+    {
+        fatal_error("error: cannot bind socket '%s' (%s)\n", socket_path, strerror(bind_errno));
+    }
+    if (listen(listen_fd, SOMAXCONN) != 0)
+    {
+        fatal_error("error: cannot listen at socket '%s' (%s)\n", socket_path, strerror(errno));
+    }
+
+    // The children of the server are not waited
+    struct sigaction sigchld_action;
+    memset(&sigchld_action, 0, sizeof(sigchld_action));
+    sigchld_action.sa_handler = SIG_IGN;
+    sigchld_action.sa_flags = SA_NOCLDWAIT;
+    sigaction(SIGCHLD, &sigchld_action, /* old_sigaction */ NULL);
+
+    for (;;)
+    {
+        int connection_fd = accept(listen_fd, NULL, NULL);
+        if (connection_fd < 0)
+        {
+            if (errno == EINTR
+                    || errno == ECONNABORTED)
+                continue;
+            fatal_error("error: cannot accept connections at socket '%s' (%s)\n",
+                    socket_path, strerror(errno));
+        }
+
+        if (!is_request_of_same_user(connection_fd))
+        {
+            fprintf(stderr, "warning: rejected a request of another user\n");
+            close(connection_fd);
+            continue;
+        }
+
+        fflush(stdout);
+        fflush(stderr);
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            fprintf(stderr, "warning: cannot fork to handle a request (%s)\n", strerror(errno));
+        }
+        else if (pid == 0)
+        {
+            close(listen_fd);
+
+            // This process and the compilation wait for their children
+            sigchld_action.sa_handler = SIG_DFL;
+            sigchld_action.sa_flags = 0;
+            sigaction(SIGCHLD, &sigchld_action, /* old_sigaction */ NULL);
+
+            handle_request(connection_fd, accept_request, argc, argv);
+            return;
+        }
+
+        close(connection_fd);
+    }
+}
+
+char driver_server_forward_invocation(const char* socket_path, int argc, const char** argv)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path))
+        return 0;
+    strcpy(addr.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return 0;
+
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    char cwd[4096];
+    if (getcwd(cwd, sizeof(cwd)) == NULL)
+    {
+        close(fd);
+        return 0;
+    }
+
+    int envc = count_null_ended_array((void**)environ);
+
+    // Outputs are created with the permissions this invocation would use
+    mode_t current_umask = umask(0);
+    umask(current_umask);
+
+    // If the server goes away we want to know it through the errors
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!send_standard_streams(fd)
+            || !write_uint32(fd, DRIVER_SERVER_MAGIC)
+            || !write_string(fd, cwd)
+            || !write_uint32(fd, current_umask)
+            || !write_string_array(fd, argc, argv)
+            || !write_string_array(fd, envc, (const char**)environ))
+    {
+        close(fd);
+        signal(SIGPIPE, SIG_DFL);
+        return 0;
+    }
+
+    uint32_t kind, value;
+    if (!read_uint32(fd, &kind)
+            || !read_uint32(fd, &value)
+            || kind != DRIVER_SERVER_REPLY_ACCEPTED)
+    {
+        // Declined, or the server could not even start the compilation
+        close(fd);
+        signal(SIGPIPE, SIG_DFL);
+        return 0;
+    }
+
+    if (!read_uint32(fd, &kind)
+            || !read_uint32(fd, &value))
+    {
+        fprintf(stderr, "error: lost connection with the compile server at '%s'\n", socket_path);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+
+    if (kind == DRIVER_SERVER_REPLY_SIGNALED)
+    {
+        // End the same way the compilation did
+        signal(value, SIG_DFL);
+        raise(value);
+        exit(128 + value);
+    }
+
+    exit(value);
+}
+
+#endif // !WIN32_BUILD || __CYGWIN__
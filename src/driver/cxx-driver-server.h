@@ -0,0 +1,61 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_DRIVER_SERVER_H
+#define CXX_DRIVER_SERVER_H
+
+#include "cxx-macros.h"
+
+MCXX_BEGIN_DECLS
+
+// Environment variable that makes the driver forward its invocation to a
+// compile server listening at the given Unix socket
+#define DRIVER_SERVER_ENVIRONMENT_VARIABLE "MCXX_COMPILE_SERVER"
+
+// Returns nonzero if the server accepts a request with these arguments.
+// This is run in a child of the server, before any output is emitted
+typedef char (*driver_server_accept_request_fun_t)(int argc, const char** argv);
+
+// Listens at socket_path and forks a compilation per request. This only
+// returns in the process that must perform the compilation, which already
+// has the working directory, environment and standard streams of the client.
+// The arguments of the request are returned in argc and argv
+void driver_server_run(const char* socket_path,
+        driver_server_accept_request_fun_t accept_request,
+        int *argc, const char*** argv);
+
+// Forwards this invocation to the server listening at socket_path and waits
+// for it. Returns zero if the server cannot be reached or it declined the
+// request, so the compilation must be performed locally. Otherwise this
+// does not return: the process ends as the compilation did
+char driver_server_forward_invocation(const char* socket_path, int argc, const char** argv);
+
+MCXX_END_DECLS
+
+#endif // CXX_DRIVER_SERVER_H
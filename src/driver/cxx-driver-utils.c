@@ -36,6 +36,8 @@
 #include <errno.h>
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
   #include <sys/wait.h>
+  #include <sys/resource.h>
+  #include <fcntl.h>
   #include <libgen.h>
   #include <limits.h>
 #else
@@ -123,6 +125,21 @@ void temporal_files_cleanup(void)
     temporal_file_list = NULL;
 }
 
+void temporal_files_detach(void)
+{
+    temporal_file_list_t iter = temporal_file_list;
+
+    while (iter != NULL)
+    {
+        // Do not free the info itself as somebody may still be holding it
+        temporal_file_list_t prev = iter;
+        iter = iter->next;
+        DELETE(prev);
+    }
+
+    temporal_file_list = NULL;
+}
+
 static char name_is_in_temporal_files(const char* name)
 {
     temporal_file_list_t it = temporal_file_list;
@@ -345,7 +362,10 @@ int execute_program(const char* program_name, const char** arguments)
 }
 
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
-static int execute_program_flags_unix(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
+// If stdin_fd is not negative, the standard input of the program is
+// redirected to it. Likewise for stdout_fd, that takes precedence over stdout_f
+static pid_t spawn_program_flags_unix(const char* program_name, const char** arguments,
+        const char* stdout_f, const char* stderr_f, int stdin_fd, int stdout_fd)
 {
     if (program_name == NULL)
         program_name = "";
@@ -373,7 +393,15 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
             j++;
         }
 
-        if (stdout_f != NULL)
+        if (stdin_fd >= 0)
+        {
+            fprintf(stderr, "0< (pipe) ");
+        }
+        if (stdout_fd >= 0)
+        {
+            fprintf(stderr, "1> (pipe) ");
+        }
+        else if (stdout_f != NULL)
         {
             fprintf(stderr, "1> %s ", stdout_f);
         }
@@ -388,7 +416,9 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
     // This routine is UNIX-only
     pid_t spawned_process;
     if (stdout_f == NULL
-            && stderr_f == NULL)
+            && stderr_f == NULL
+            && stdin_fd < 0
+            && stdout_fd < 0)
     {
         // If no work previous to execvp is requested, vfork is fine
         spawned_process = vfork();
@@ -404,8 +434,24 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
     }
     else if (spawned_process == 0) // I'm the spawned process
     {
-        // Redirect output files as needed
-        if (stdout_f != NULL)
+        // Redirect input and output files as needed
+        if (stdin_fd >= 0)
+        {
+            if (dup2(stdin_fd, 0) < 0)
+            {
+                fatal_error("error: could not duplicate standard input");
+            }
+            close(stdin_fd);
+        }
+        if (stdout_fd >= 0)
+        {
+            if (dup2(stdout_fd, 1) < 0)
+            {
+                fatal_error("error: could not duplicate standard output");
+            }
+            close(stdout_fd);
+        }
+        else if (stdout_f != NULL)
         {
             FILE *new_stdout = fopen(stdout_f, "w");
             if (new_stdout == NULL)
@@ -449,30 +495,134 @@ static int execute_program_flags_unix(const char* program_name, const char** arg
         // Execvp should not return
         fatal_error("error: execution of subprocess '%s' failed (%s)", program_name, strerror(errno));
     }
-    else // I'm the parent
+
+    DELETE(execvp_arguments);
+
+    return spawned_process;
+}
+
+// Resources used by the last subprocess waited
+static struct rusage last_program_usage;
+
+void wait_program_last_usage(double* cpu_time, long* peak_rss_kb)
+{
+    *cpu_time = last_program_usage.ru_utime.tv_sec + last_program_usage.ru_utime.tv_usec / 1e6
+        + last_program_usage.ru_stime.tv_sec + last_program_usage.ru_stime.tv_usec / 1e6;
+    *peak_rss_kb = last_program_usage.ru_maxrss;
+}
+
+static int wait_program_unix(pid_t spawned_process, const char* program_name)
+{
+    // Wait for my son, but only for him since other children
+    // may be running in the background
+    int status;
+    while (wait4(spawned_process, &status, 0, &last_program_usage) < 0)
     {
-        // Wait for my son
-        int status;
-        wait(&status);
-        if (WIFEXITED(status))
+        if (errno != EINTR)
         {
-            return (WEXITSTATUS(status));
+            fatal_error("error: waiting for subprocess '%s' failed (%s)", program_name, strerror(errno));
         }
-        else if (WIFSIGNALED(status))
-        {
-            fprintf(stderr, "Subprocess '%s' was ended with signal %d\n",
-                    program_name, WTERMSIG(status));
+    }
 
-            return 1;
-        }
-        else
-        {
-            internal_error(
-                    "Subprocess '%s' ended but neither by normal exit nor signal", 
-                    program_name);
-        }
+    if (WIFEXITED(status))
+    {
+        return (WEXITSTATUS(status));
+    }
+    else if (WIFSIGNALED(status))
+    {
+        fprintf(stderr, "Subprocess '%s' was ended with signal %d\n",
+                program_name, WTERMSIG(status));
+
+        return 1;
+    }
+    else
+    {
+        internal_error(
+                "Subprocess '%s' ended but neither by normal exit nor signal", 
+                program_name);
     }
 }
+
+static int execute_program_flags_unix(const char* program_name, const char** arguments, const char* stdout_f, const char* stderr_f)
+{
+    if (program_name == NULL)
+        program_name = "";
+
+    pid_t spawned_process = spawn_program_flags_unix(program_name, arguments, stdout_f, stderr_f, /* stdin_fd */ -1, /* stdout_fd */ -1);
+    return wait_program_unix(spawned_process, program_name);
+}
+
+pid_t execute_program_async(const char* program_name, const char** arguments, const char* stderr_f)
+{
+    if (program_name == NULL)
+        program_name = "";
+
+    return spawn_program_flags_unix(program_name, arguments, /* stdout_f */ NULL, stderr_f, /* stdin_fd */ -1, /* stdout_fd */ -1);
+}
+
+FILE* execute_program_read_stdout(const char* program_name, const char** arguments, pid_t* pid)
+{
+    if (program_name == NULL)
+        program_name = "";
+
+    int stdout_pipe[2];
+    if (pipe(stdout_pipe) != 0)
+    {
+        fatal_error("error: could not create pipe for subprocess '%s' (%s)", program_name, strerror(errno));
+    }
+
+    // Other subprocesses must not keep our end of the pipe
+    fcntl(stdout_pipe[0], F_SETFD, FD_CLOEXEC);
+
+    *pid = spawn_program_flags_unix(program_name, arguments,
+            /* stdout_f */ NULL, /* stderr_f */ NULL, /* stdin_fd */ -1, /* stdout_fd */ stdout_pipe[1]);
+    close(stdout_pipe[1]);
+
+    FILE* result = fdopen(stdout_pipe[0], "r");
+    if (result == NULL)
+    {
+        fatal_error("error: could not read output of subprocess '%s' (%s)", program_name, strerror(errno));
+    }
+
+    return result;
+}
+
+FILE* execute_program_write_stdin(const char* program_name, const char** arguments,
+        const char* stderr_f, pid_t* pid)
+{
+    if (program_name == NULL)
+        program_name = "";
+
+    int stdin_pipe[2];
+    if (pipe(stdin_pipe) != 0)
+    {
+        fatal_error("error: could not create pipe for subprocess '%s' (%s)", program_name, strerror(errno));
+    }
+
+    // Other subprocesses must not keep our end of the pipe, otherwise the
+    // program would never see the end of its input
+    fcntl(stdin_pipe[1], F_SETFD, FD_CLOEXEC);
+
+    *pid = spawn_program_flags_unix(program_name, arguments,
+            /* stdout_f */ NULL, stderr_f, /* stdin_fd */ stdin_pipe[0], /* stdout_fd */ -1);
+    close(stdin_pipe[0]);
+
+    FILE* result = fdopen(stdin_pipe[1], "w");
+    if (result == NULL)
+    {
+        fatal_error("error: could not write input of subprocess '%s' (%s)", program_name, strerror(errno));
+    }
+
+    return result;
+}
+
+int wait_program(pid_t pid, const char* program_name)
+{
+    if (program_name == NULL)
+        program_name = "";
+
+    return wait_program_unix(pid, program_name);
+}
 #else
 
 static char* quote_string(const char *c)
@@ -828,6 +978,28 @@ char copy_file(const char* source, const char* dest)
     return 0;
 }
 
+char append_file(const char* source, FILE* dest)
+{
+    FILE* orig_file = fopen(source, "r");
+    if (orig_file == NULL)
+        return -1;
+
+    char c[4096];
+    size_t actually_read;
+    while ((actually_read = fread(c, sizeof(char), sizeof(c), orig_file)) != 0)
+    {
+        if (fwrite(c, sizeof(char), actually_read, dest) < actually_read)
+        {
+            fclose(orig_file);
+            return -1;
+        }
+    }
+
+    char result = ferror(orig_file) ? -1 : 0;
+    fclose(orig_file);
+    return result;
+}
+
 char move_file(const char* source, const char* dest)
 {
     struct stat buf;
@@ -31,6 +31,7 @@
 #define CXX_DRIVERUTILS_H
 
 #include <stdio.h>
+#include <sys/types.h>
 #include <sys/time.h>
 #include <time.h>
 #include "cxx-process.h"
@@ -75,12 +76,34 @@ temporal_file_t new_temporal_file_extension(const char* extension);
 // file is closed and erased.
 void temporal_files_cleanup(void);
 
+// Forgets every temporal file registered so far without removing it.
+// Forked processes use this so they only clean up what they create
+void temporal_files_detach(void);
+
 const char* get_extension_filename(const char* filename);
 
 int execute_program(const char* program_name, const char** arguments);
 int execute_program_flags(const char* program_name, const char** arguments, 
         const char *stdout_f, const char *stderr_f);
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Like execute_program but it does not wait for the program to end.
+// Use wait_program to get its exit status. If stderr_f is not NULL the
+// standard error of the program is written to that file
+pid_t execute_program_async(const char* program_name, const char** arguments, const char* stderr_f);
+int wait_program(pid_t pid, const char* program_name);
+// Like execute_program_async but the standard output of the program can be
+// read from the returned stream. Close it before calling wait_program
+FILE* execute_program_read_stdout(const char* program_name, const char** arguments, pid_t* pid);
+// Like execute_program_async but the returned stream is the standard input
+// of the program. Close it before calling wait_program
+FILE* execute_program_write_stdin(const char* program_name, const char** arguments,
+        const char* stderr_f, pid_t* pid);
+// CPU time (in seconds) and peak resident set size (in KB) of the last
+// program waited by execute_program or wait_program
+void wait_program_last_usage(double* cpu_time, long* peak_rss_kb);
+#endif
+
 // char** routines
 int count_null_ended_array(void** v);
 void remove_string_from_null_ended_string_array(const char** string_arr, const char* to_remove);
@@ -102,6 +125,8 @@ void run_gdb(void);
 
 // Copy a file
 char copy_file(const char* source, const char* dest);
+// Writes the contents of a file at the end of a stream
+char append_file(const char* source, FILE* dest);
 // Like rename but works across filesystems
 char move_file(const char* source, const char* dest);
 
@@ -40,6 +40,7 @@
 #include <string.h>
 #include <libgen.h>
 #include <errno.h>
+#include <limits.h>
 #include <unistd.h>
 
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
@@ -55,9 +56,19 @@
 #include <dirent.h>
 #include <regex.h>
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+#include <fcntl.h>
+#include <sys/wait.h>
+#endif
+
 #include "cxx-utils.h"
 #include "cxx-driver.h"
 #include "cxx-driver-utils.h"
+#include "cxx-driver-cache.h"
+#include "cxx-driver-pch.h"
+#include "mem_arena.h"
+#include "cxx-driver-server.h"
+#include "cxx-driver-report.h"
 #include "cxx-ast.h"
 #include "cxx-ambiguity.h"
 #include "cxx-graphviz.h"
@@ -72,6 +83,7 @@
 #include "cxx-exprtype.h"
 #include "cxx-typededuc.h"
 #include "cxx-overload.h"
+#include "cxx-entrylist.h"
 #include "cxx-lexer.h"
 #include "cxx-parser.h"
 #include "c99-parser.h"
@@ -124,6 +136,33 @@
 "  -y                       File will be parsed but it will not be\n" \
 "                           compiled nor linked\n" \
 "  -x lang                  Override language detection to <lang>\n" \
+"  --cache-dir=<dir>        Enables the compilation cache in <dir>.\n" \
+"                           Files whose preprocessed source and\n" \
+"                           configuration did not change reuse the\n" \
+"                           previously generated code and object\n" \
+"  --cache-size=<size>      Maximum size of the compilation cache.\n" \
+"                           Suffixes K, M and G are allowed.\n" \
+"                           Least recently used entries are removed\n" \
+"                           first. By default 1G\n" \
+"  --cache-stats            Prints the statistics of the compilation\n" \
+"                           cache and exits\n" \
+"  --pch=<file>             Uses the precompiled header <file> in the\n" \
+"                           C files starting with the #include\n" \
+"                           directives it was created from\n" \
+"  --pch-create=<file>      Creates the precompiled header <file> from\n" \
+"                           a C file that only contains #include\n" \
+"                           directives\n" \
+"  --report=<file>          Writes into <file> a JSON report with the\n" \
+"                           wall time, CPU time and peak RSS of every\n" \
+"                           stage and compiler phase, and the number\n" \
+"                           of nodes, symbols and types, of every\n" \
+"                           translation unit\n" \
+"  -j <n>, --jobs=<n>       Compile up to <n> translation units\n" \
+"                           concurrently. Diagnostics are emitted\n" \
+"                           in the order files were given\n" \
+"  --constexpr-steps=<n>    Maximum number of steps of the evaluation\n" \
+"                           of a constexpr call in C++. By default\n" \
+"                           1048576\n" \
 "  -k, --keep-files         Do not remove intermediate files\n" \
 "  -K, --keep-all-files     Do not remove any generated file, including\n" \
 "                           temporary files\n" \
@@ -144,6 +183,13 @@
 "                           compilation\n" \
 "  --fc=<name>              Fortran Compiler <name> will be used for native\n" \
 "                           compilation\n" \
+"  --native-jobs=<n>        Run up to <n> native compilations in the\n" \
+"                           background while the following files are\n" \
+"                           processed. By default 0 (no background)\n" \
+"  --native-pipe            Generated C/C++ code is written directly\n" \
+"                           to the standard input of a gcc-compatible\n" \
+"                           native compiler. Line markers are always\n" \
+"                           emitted. It has no effect along with -k\n" \
 "  --ld=<name>              Linker <name> will be used for linking\n" \
 "  --fpc=<name>             Fortran prescanner <name> will be used\n" \
 "                           for fixed form prescanning\n" \
@@ -219,6 +265,9 @@
 "                           C/C++: .i, .ii\n"\
 "                           Fortran: .f, .f77, .f90, .f95\n"\
 "  --pp-stdout              Preprocessor uses stdout for output\n" \
+"  --pp-pipe                C/C++ preprocessor output is read through a\n" \
+"                           pipe instead of a temporary file. It has\n" \
+"                           no effect along with -E or -K\n" \
 "  --fpp                    An alias for --pp=on\n"\
 "  --fpp=<name>             Preprocessor <name> will be used for\n" \
 "                           preprocessing Fortran source\n" \
@@ -281,6 +330,16 @@
 "                           Instead, keep 'x.mf03' and native 'x.mod'.\n" \
 "  --do-not-warn-config     Do not warn about wrong configuration\n" \
 "                           file names\n" \
+"  --compile-server=<socket>\n" \
+"                           Loads the configuration and listens at\n" \
+"                           Unix socket <socket>. Invocations with\n" \
+"                           MCXX_COMPILE_SERVER=<socket> in their\n" \
+"                           environment are compiled by forked copies\n" \
+"                           of this server. Requests using another\n" \
+"                           profile or configuration directory are\n" \
+"                           compiled by the invoking driver. The\n" \
+"                           directory of <socket> is created if needed\n" \
+"                           and must only be accessible by its owner\n" \
 "  --vector-flavor=<name>   When emitting vector types use given\n" \
 "                           flavor name. By default it is gnu.\n" \
 "                           See --vector-list-flavors\n" \
@@ -383,7 +442,11 @@ typedef enum
     // Keep the following options sorted (but leave OPTION_UNDEFINED as is)
     OPTION_ALWAYS_PREPROCESS,
     OPTION_NATIVE_VENDOR,
+    OPTION_CACHE_DIR,
+    OPTION_CACHE_SIZE,
+    OPTION_CACHE_STATS,
     OPTION_CONFIG_DIR,
+    OPTION_CONSTEXPR_STEPS,
     OPTION_CUDA,
     OPTION_DEBUG_FLAG,
     OPTION_DISABLE_FILE_LOCKING,
@@ -419,6 +482,7 @@ typedef enum
     OPTION_HELP_TARGET_OPTIONS,
     OPTION_INSTANTIATE_TEMPLATES,
     OPTION_ISO_C_FLOATN,
+    OPTION_JOBS,
     OPTION_LINE_MARKERS,
     OPTION_LINKER_NAME,
     OPTION_LIST_ENVIRONMENTS,
@@ -427,6 +491,8 @@ typedef enum
     OPTION_LIST_VECTOR_FLAVORS,
     OPTION_MODULE_OUT_PATTERN,
     OPTION_NATIVE_COMPILER_NAME,
+    OPTION_NATIVE_JOBS,
+    OPTION_NATIVE_PIPE,
     OPTION_NO_CUDA,
     OPTION_NO_OPENCL,
     OPTION_NO_WHOLE_FILE,
@@ -435,10 +501,14 @@ typedef enum
     OPTION_OUTPUT_DIRECTORY,
     OPTION_PARALLEL,
     OPTION_PASS_THROUGH,
+    OPTION_PCH,
+    OPTION_PCH_CREATE,
     OPTION_PREPROCESSOR_NAME,
+    OPTION_PREPROCESSOR_USES_PIPE,
     OPTION_PREPROCESSOR_USES_STDOUT,
     OPTION_PRINT_CONFIG_DIR,
     OPTION_PROFILE,
+    OPTION_REPORT,
     OPTION_SEARCH_INCLUDES,
     OPTION_SEARCH_MODULES,
     OPTION_SET_ENVIRONMENT,
@@ -451,7 +521,7 @@ typedef enum
 
 
 // It mimics getopt
-#define SHORT_OPTIONS_STRING "vVkKcho:EyI:J:L:l:gD:U:x:"
+#define SHORT_OPTIONS_STRING "vVkKcho:EyI:J:L:l:gD:U:x:j:"
 // This one mimics getopt_long but with one less field (the third one is not given)
 struct command_line_long_options command_line_long_options[] =
 {
@@ -481,6 +551,7 @@ struct command_line_long_options command_line_long_options[] =
     {"help-target-options", CLP_NO_ARGUMENT, OPTION_HELP_TARGET_OPTIONS},
     {"variable", CLP_REQUIRED_ARGUMENT, OPTION_EXTERNAL_VAR},
     {"pp-stdout", CLP_NO_ARGUMENT, OPTION_PREPROCESSOR_USES_STDOUT},
+    {"pp-pipe", CLP_NO_ARGUMENT, OPTION_PREPROCESSOR_USES_PIPE},
     {"disable-gxx-traits", CLP_NO_ARGUMENT, OPTION_DISABLE_GXX_TRAITS},
     {"pass-through", CLP_NO_ARGUMENT, OPTION_PASS_THROUGH}, 
     {"disable-sizeof", CLP_NO_ARGUMENT, OPTION_DISABLE_SIZEOF},
@@ -489,6 +560,12 @@ struct command_line_long_options command_line_long_options[] =
     {"list-env", CLP_NO_ARGUMENT, OPTION_LIST_ENVIRONMENTS},
     {"list-environments", CLP_NO_ARGUMENT, OPTION_LIST_ENVIRONMENTS},
     {"print-config-dir", CLP_NO_ARGUMENT, OPTION_PRINT_CONFIG_DIR},
+    {"cache-dir", CLP_REQUIRED_ARGUMENT, OPTION_CACHE_DIR},
+    {"cache-size", CLP_REQUIRED_ARGUMENT, OPTION_CACHE_SIZE},
+    {"cache-stats", CLP_NO_ARGUMENT, OPTION_CACHE_STATS},
+    {"pch", CLP_REQUIRED_ARGUMENT, OPTION_PCH},
+    {"pch-create", CLP_REQUIRED_ARGUMENT, OPTION_PCH_CREATE},
+    {"report", CLP_REQUIRED_ARGUMENT, OPTION_REPORT},
     {"upc", CLP_OPTIONAL_ARGUMENT, OPTION_ENABLE_UPC},
     {"cuda", CLP_NO_ARGUMENT, OPTION_CUDA},
     {"no-cuda", CLP_NO_ARGUMENT, OPTION_NO_CUDA},
@@ -533,9 +610,13 @@ struct command_line_long_options command_line_long_options[] =
     {"disable-locking", CLP_NO_ARGUMENT, OPTION_DISABLE_FILE_LOCKING },
     {"line-markers", CLP_NO_ARGUMENT, OPTION_LINE_MARKERS },
     {"parallel", CLP_NO_ARGUMENT, OPTION_PARALLEL },
+    {"jobs", CLP_REQUIRED_ARGUMENT, OPTION_JOBS },
     {"Xcompiler", CLP_REQUIRED_ARGUMENT, OPTION_XCOMPILER },
     {"iso-c-FloatN", CLP_NO_ARGUMENT, OPTION_ISO_C_FLOATN },
     {"native-vendor", CLP_REQUIRED_ARGUMENT, OPTION_NATIVE_VENDOR },
+    {"native-jobs", CLP_REQUIRED_ARGUMENT, OPTION_NATIVE_JOBS },
+    {"native-pipe", CLP_NO_ARGUMENT, OPTION_NATIVE_PIPE },
+    {"constexpr-steps", CLP_REQUIRED_ARGUMENT, OPTION_CONSTEXPR_STEPS },
     // sentinel
     {NULL, 0, 0}
 };
@@ -574,12 +655,39 @@ static void compiler_phases_pre_execution(
         translation_unit_t* translation_unit,
         const char* parsed_filename);
 static const char* preprocess_translation_unit(translation_unit_t* translation_unit, const char* input_filename);
-static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+// Socket where this driver listens as a compile server
+static const char* compile_server_socket = NULL;
+static char is_compile_server_invocation(int argc, const char** argv);
+static void run_compile_server(const char* default_config_dir);
+static char can_preprocess_through_pipe(void);
+static FILE* start_preprocessor_pipe(const char* input_filename, pid_t* pid, int* drain_fd);
+static char finish_preprocessor_pipe(pid_t pid, int drain_fd);
+static char can_compile_natively_through_pipe(void);
+static FILE* start_native_compilation_through_pipe(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        pid_t* pid,
+        timing_t* timing_compilation);
+static void finish_native_compilation_through_pipe(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        pid_t pid,
+        timing_t timing_compilation);
+#endif
+static char parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
 static void initialize_semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename);
 static void semantic_analysis(translation_unit_t* translation_unit, const char* parsed_filename);
 static const char* codegen_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename);
+static char can_use_compilation_cache(translation_unit_t* translation_unit, char file_not_processed);
+static void start_cache_diagnostics(translation_unit_t* translation_unit);
+static void finish_cache_diagnostics(void);
+static char compilation_cache_lookup(translation_unit_t* translation_unit,
+        const char* parsed_filename,
+        const char** prettyprinted_filename,
+        char *object_reused);
 static void native_compilation(translation_unit_t* translation_unit, 
         const char* prettyprinted_filename, char remove_input);
+static void release_translation_unit_arena(translation_unit_t* translation_unit);
+static void wait_for_background_native_compilations(void);
 
 #if !defined(WIN32_BUILD) || defined(__CYGWIN__)
 static void terminating_signal_handler(int sig);
@@ -587,6 +695,7 @@ static void terminating_signal_handler(int sig);
 static char check_tree(AST a);
 
 static void embed_files(void);
+static void embed_files_of_file_process(compilation_file_process_t* file_process);
 static void link_objects(void);
 
 static void add_to_parameter_list_str(const char*** existing_options, const char* str);
@@ -597,6 +706,9 @@ static void enable_debug_flag(const char* flag);
 static void help_message(void);
 
 static void print_memory_report(void);
+static unsigned long count_tree_nodes(AST a);
+static void report_tree_nodes(translation_unit_t* translation_unit,
+        const char* nodes_counter, const char* walk_counter, AST a);
 static void stats_string_table(void);
 
 static int parse_special_parameters(int *should_advance, int argc, 
@@ -631,17 +743,42 @@ int main(int argc, char* argv[])
     timing_t timing_global;
     timing_start(&timing_global);
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // If there is a compile server, let it do the compilation. This only
+    // returns if the server could not serve this invocation
+    const char* compile_server = getenv(DRIVER_SERVER_ENVIRONMENT_VARIABLE);
+    if (compile_server != NULL
+            && compile_server[0] != '\0'
+            && !is_compile_server_invocation(argc, (const char**)argv))
+    {
+        driver_server_forward_invocation(compile_server, argc, (const char**)argv);
+    }
+#endif
+
     // Initialization of the driver
     driver_initialization(argc, (const char**)argv);
 
     // Default values
     initialize_default_values();
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    const char* default_config_dir = compilation_process.config_dir;
+#endif
+
     // Load configuration files and the profiles defined there. Here we get all
     // the implicit parameters defined in configuration files and we switch to
     // the main profile of the compiler. Profiles are not yet fully populated.
     load_configuration();
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    // In compile server mode this only returns in the process that performs
+    // a compilation requested by a client
+    if (compile_server_socket != NULL)
+    {
+        run_compile_server(default_config_dir);
+    }
+#endif
+
     // Parse arguments just to get the implicit parameters passed in the
     // command line. We need those to properly populate profiles.
     parse_arguments(compilation_process.argc,
@@ -698,6 +835,8 @@ int main(int argc, char* argv[])
                 timing_elapsed(&timing_global));
     }
 
+    driver_report_write(&timing_global);
+
     if (debug_options.print_memory_report)
     {
         print_memory_report();
@@ -915,6 +1054,7 @@ int parse_arguments(int argc, const char* argv[],
     static char E_specified = 0;
     static char y_specified = 0;
     static char v_specified = 0;
+    static char cache_stats_specified = 0;
 
     char native_verbose = 0; // -v
     char native_version = 0; // -V
@@ -1304,6 +1444,30 @@ int parse_arguments(int argc, const char* argv[],
                         show_help_message = 1;
                         return 1;
                     }
+                case 'j' :
+                case OPTION_JOBS :
+                    {
+                        char *error = NULL;
+                        long int num_jobs = 0;
+                        if (parameter_info.argument != NULL)
+                        {
+                            num_jobs = strtol(parameter_info.argument, &error, 10);
+                        }
+
+                        if (parameter_info.argument == NULL
+                                || *error != '\0'
+                                || num_jobs <= 0)
+                        {
+                            fprintf(stderr, "%s: invalid number of jobs '%s'. Ignoring\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument != NULL ? parameter_info.argument : "");
+                        }
+                        else
+                        {
+                            compilation_process.num_jobs = num_jobs;
+                        }
+                        break;
+                    }
                 case OPTION_NATIVE_VENDOR :
                     {
                         CURRENT_CONFIGURATION->native_vendor = compute_native_vendor(parameter_info.argument);
@@ -1319,6 +1483,48 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->native_compiler_name = uniquestr(parameter_info.argument);
                         break;
                     }
+                case OPTION_NATIVE_JOBS :
+                    {
+                        char *error = NULL;
+                        long int num_native_jobs = strtol(parameter_info.argument, &error, 10);
+
+                        if (*error != '\0'
+                                || num_native_jobs < 0)
+                        {
+                            fprintf(stderr, "%s: invalid number of native jobs '%s'. Ignoring\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                        }
+                        else
+                        {
+                            compilation_process.num_native_jobs = num_native_jobs;
+                        }
+                        break;
+                    }
+                case OPTION_CONSTEXPR_STEPS :
+                    {
+                        char *error = NULL;
+                        long int constexpr_steps = strtol(parameter_info.argument, &error, 10);
+
+                        if (*error != '\0'
+                                || constexpr_steps <= 0
+                                || constexpr_steps > INT_MAX)
+                        {
+                            fprintf(stderr, "%s: invalid number of constexpr steps '%s'. Ignoring\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                        }
+                        else
+                        {
+                            compilation_process.constexpr_steps = constexpr_steps;
+                        }
+                        break;
+                    }
+                case OPTION_NATIVE_PIPE :
+                    {
+                        CURRENT_CONFIGURATION->native_compiler_uses_pipe = 1;
+                        break;
+                    }
                 case OPTION_LINKER_NAME :
                     {
                         CURRENT_CONFIGURATION->linker_name = uniquestr(parameter_info.argument);
@@ -1380,6 +1586,11 @@ int parse_arguments(int argc, const char* argv[],
                         CURRENT_CONFIGURATION->preprocessor_uses_stdout = 1;
                         break;
                     }
+                case OPTION_PREPROCESSOR_USES_PIPE :
+                    {
+                        CURRENT_CONFIGURATION->preprocessor_uses_pipe = 1;
+                        break;
+                    }
                 case OPTION_DISABLE_GXX_TRAITS:
                     {
                         CURRENT_CONFIGURATION->disable_gxx_type_traits = 1;
@@ -1500,6 +1711,46 @@ int parse_arguments(int argc, const char* argv[],
                         }
                         break;
                     }
+                case OPTION_CACHE_DIR:
+                    {
+                        compilation_process.cache_directory = uniquestr(parameter_info.argument);
+                        break;
+                    }
+                case OPTION_CACHE_SIZE:
+                    {
+                        unsigned long long cache_max_size = driver_cache_parse_size(parameter_info.argument);
+                        if (cache_max_size == 0)
+                        {
+                            fprintf(stderr, "%s: invalid cache size '%s'. Ignoring\n",
+                                    compilation_process.exec_basename,
+                                    parameter_info.argument);
+                        }
+                        else
+                        {
+                            compilation_process.cache_max_size = cache_max_size;
+                        }
+                        break;
+                    }
+                case OPTION_CACHE_STATS:
+                    {
+                        cache_stats_specified = 1;
+                        break;
+                    }
+                case OPTION_PCH:
+                    {
+                        compilation_process.pch_filename = uniquestr(parameter_info.argument);
+                        break;
+                    }
+                case OPTION_PCH_CREATE:
+                    {
+                        compilation_process.pch_create_filename = uniquestr(parameter_info.argument);
+                        break;
+                    }
+                case OPTION_REPORT:
+                    {
+                        compilation_process.report_filename = uniquestr(parameter_info.argument);
+                        break;
+                    }
                 case OPTION_PRINT_CONFIG_DIR:
                     {
                         printf("Default config directory: %s%s\n", compilation_process.home_directory, DIR_CONFIG_RELATIVE_PATH);
@@ -1731,6 +1982,44 @@ int parse_arguments(int argc, const char* argv[],
         return 0;
     }
 
+    if (compilation_process.pch_filename != NULL
+            && compilation_process.pch_create_filename != NULL)
+    {
+        fprintf(stderr, "%s: --pch and --pch-create cannot be used at the same time\n",
+                compilation_process.exec_basename);
+        return 1;
+    }
+
+    // A precompiled header is created while parsing, so it cannot come
+    // from the cache
+    if (compilation_process.pch_create_filename != NULL)
+    {
+        compilation_process.cache_directory = NULL;
+    }
+
+    if (compilation_process.cache_directory != NULL)
+    {
+        if (compilation_process.cache_max_size == 0)
+            compilation_process.cache_max_size = DRIVER_CACHE_DEFAULT_MAX_SIZE;
+        driver_cache_init();
+    }
+
+    if (compilation_process.report_filename != NULL)
+    {
+        driver_report_init();
+    }
+
+    if (cache_stats_specified)
+    {
+        if (compilation_process.cache_directory == NULL)
+        {
+            fprintf(stderr, "%s: --cache-stats requires --cache-dir\n", compilation_process.exec_basename);
+            return 1;
+        }
+        driver_cache_print_statistics(stdout);
+        exit(EXIT_SUCCESS);
+    }
+
     if (num_input_files == 0
             && !linker_files_seen
             && !v_specified
@@ -2804,7 +3093,7 @@ static void remove_parameter_from_argv(int i)
     compilation_process.argc--;
 }
 
-static void load_configuration(void)
+static void process_configuration_parameters(void)
 {
     int i;
     char restart = 1;
@@ -2844,9 +3133,26 @@ static void load_configuration(void)
                 restart = 1;
                 break;
             }
+            else if (strncmp(compilation_process.argv[i],
+                        "--compile-server=", strlen("--compile-server=")) == 0)
+            {
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+                compile_server_socket =
+                    uniquestr(&(compilation_process.argv[i][strlen("--compile-server=") ]));
+#else
+                fatal_error("Compile server mode is not supported in this platform\n");
+#endif
+
+                remove_parameter_from_argv(i);
+                restart = 1;
+                break;
+            }
         }
     }
+}
 
+static void load_configuration_files(void)
+{
     // Now load all files in the config_dir
     DIR* config_dir = opendir(compilation_process.config_dir);
     if (config_dir == NULL)
@@ -2912,7 +3218,10 @@ static void load_configuration(void)
         }
         closedir(config_dir);
     }
-    
+}
+
+static void select_command_line_configuration(void)
+{
     // Now set the configuration as stated by the basename
     SET_CURRENT_CONFIGURATION(NULL);
     SET_CURRENT_CONFIGURATION(get_compilation_configuration(compilation_process.exec_basename));
@@ -2928,6 +3237,113 @@ static void load_configuration(void)
     compilation_process.command_line_configuration = CURRENT_CONFIGURATION;
 }
 
+static void load_configuration(void)
+{
+    process_configuration_parameters();
+    load_configuration_files();
+    select_command_line_configuration();
+}
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+static char is_compile_server_invocation(int argc, const char** argv)
+{
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--compile-server=", strlen("--compile-server=")) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+// Configuration directory used when --config-dir is not given
+static const char* compile_server_default_config_dir = NULL;
+
+// A request can only be served if it would select the same profile and
+// configuration directory this server has loaded
+static char compile_server_accepts_request(int argc, const char** argv)
+{
+    if (argc < 1
+            || is_compile_server_invocation(argc, argv))
+        return 0;
+
+    const char* exec_basename = give_basename(argv[0]);
+    const char* config_dir = compile_server_default_config_dir;
+
+    int i;
+    for (i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--config-dir=", strlen("--config-dir=")) == 0)
+        {
+            config_dir = &(argv[i][strlen("--config-dir=")]);
+        }
+        else if (strncmp(argv[i], "--profile=", strlen("--profile=")) == 0)
+        {
+            exec_basename = &(argv[i][strlen("--profile=")]);
+        }
+    }
+
+    return (strcmp(exec_basename, compilation_process.exec_basename) == 0
+            && strcmp(config_dir, compilation_process.config_dir) == 0);
+}
+
+// Maps in memory the libraries of the compiler phases named in the
+// configuration files, so forked compilations do not have to load them
+static void preload_compiler_phase_libraries(void)
+{
+    preload_compiler_phase_library("libcodegen-cxx.so");
+    preload_compiler_phase_library("libcodegen-fortran.so");
+
+    int i;
+    for (i = 0; i < compilation_process.num_configurations; i++)
+    {
+        compilation_configuration_t* configuration = compilation_process.configuration_set[i];
+
+        int j;
+        for (j = 0; j < configuration->num_configuration_lines; j++)
+        {
+            struct compilation_configuration_line* line = configuration->configuration_lines[j];
+
+            // Values using variables are expanded at commit time
+            if (strcmp(line->name, "compiler_phase") == 0
+                    && strchr(line->value, '$') == NULL)
+            {
+                preload_compiler_phase_library(line->value);
+            }
+        }
+    }
+}
+
+static void run_compile_server(const char* default_config_dir)
+{
+    compile_server_default_config_dir = default_config_dir;
+
+    preload_compiler_phase_libraries();
+
+    int argc = 0;
+    const char** argv = NULL;
+    driver_server_run(compile_server_socket, compile_server_accepts_request, &argc, &argv);
+
+    // From here we are a compilation requested by a client
+    compile_server_socket = NULL;
+
+    compilation_process.argc = argc;
+    compilation_process.argv = NEW_VEC(const char*, argc);
+    memcpy((void*)compilation_process.argv, argv, sizeof(const char*) * argc);
+
+    compilation_process.original_argc = argc;
+    compilation_process.original_argv = NEW_VEC(const char*, argc);
+    memcpy((void*)compilation_process.original_argv, argv, sizeof(const char*) * argc);
+
+    compilation_process.exec_basename = give_basename(argv[0]);
+
+    // Configuration files are already loaded but the profile may have
+    // been given in the command line of the client
+    process_configuration_parameters();
+    select_command_line_configuration();
+}
+#endif
+
 static void add_std_flag_to_configurations()
 {
     int i;
@@ -3214,12 +3630,24 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
             fprintf(stderr, "Compiling file '%s'\n", translation_unit->input_filename);
         }
 
+        driver_report_begin_translation_unit(translation_unit);
+
         const char* parsed_filename = translation_unit->input_filename;
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+        // Preprocessor whose output is being read by the scanner
+        FILE* preprocessed_stream = NULL;
+        pid_t preprocessor_pid = 0;
+        int preprocessor_drain_fd = -1;
+#endif
         // If the file is not preprocessed or we've ben told to preprocess it
         if (((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
                     || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
                     && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_PREPROCESSED))
-                && !CURRENT_CONFIGURATION->pass_through)
+                && !CURRENT_CONFIGURATION->pass_through
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+                && !(can_preprocess_through_pipe() && !file_not_processed)
+#endif
+                )
         {
             timing_t timing_preprocessing;
 
@@ -3232,10 +3660,16 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 CURRENT_CONFIGURATION->preprocessor_options = CURRENT_CONFIGURATION->fortran_preprocessor_options;
             }
 
+            driver_report_measure_t report_preprocessing;
+            driver_report_measure_start(&report_preprocessing);
+
             timing_start(&timing_preprocessing);
             parsed_filename = preprocess_translation_unit(translation_unit, translation_unit->input_filename);
             timing_end(&timing_preprocessing);
 
+            driver_report_measure_end(&report_preprocessing, translation_unit,
+                    DRIVER_REPORT_STAGE_PREPROCESSING, /* name */ NULL);
+
             FORTRAN_LANGUAGE()
             {
                 CURRENT_CONFIGURATION->preprocessor_name = old_preprocessor_name;
@@ -3255,6 +3689,19 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 fatal_error("Preprocess failed for file '%s'", translation_unit->input_filename);
             }
         }
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+        else if ((BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_NOT_PREPROCESSED)
+                    || BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_NOT_PREPROCESSED))
+                && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_PREPROCESSED)
+                && can_preprocess_through_pipe()
+                && !file_not_processed)
+        {
+            // The scanner will read the output of the preprocessor while
+            // it is being generated
+            preprocessed_stream = start_preprocessor_pipe(translation_unit->input_filename,
+                    &preprocessor_pid, &preprocessor_drain_fd);
+        }
+#endif
 
         char is_fixed_form  = (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
                 // We prescan from fixed to free if 
@@ -3265,10 +3712,21 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 && !BITMAP_TEST(CURRENT_CONFIGURATION->force_source_kind, SOURCE_KIND_FREE_FORM)
                 && !CURRENT_CONFIGURATION->pass_through);
 
+        // * Look up the compilation cache
+        char cache_hit = 0;
+        char cache_object_reused = 0;
+        const char* cached_prettyprinted_filename = NULL;
+        if (can_use_compilation_cache(translation_unit, file_not_processed))
+        {
+            cache_hit = compilation_cache_lookup(translation_unit, parsed_filename,
+                    &cached_prettyprinted_filename, &cache_object_reused);
+        }
+
         if (!CURRENT_CONFIGURATION->do_not_parse)
         {
             if (!CURRENT_CONFIGURATION->pass_through
-                    && !file_not_processed)
+                    && !file_not_processed
+                    && !cache_hit)
             {
                 // * Do this before open for scan since we might to internally parse some sources
                 mcxx_flex_debug = mc99_flex_debug = debug_options.debug_lexer;
@@ -3281,24 +3739,64 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
 
                 // Initialize diagnostics
                 diagnostics_reset();
+                start_cache_diagnostics(translation_unit);
+
+                // * Trees of this translation unit are released all at once
+                if (!debug_options.disable_tu_arena)
+                {
+                    translation_unit->arena = mem_arena_new(/* chunk_size */ 0);
+                    ast_set_arena(translation_unit->arena);
+                }
 
                 // Fill the context with initial information
                 initialize_semantic_analysis(translation_unit, parsed_filename);
 
+                // * Use a precompiled header, the code of its headers is not scanned
+                const char* scanned_filename = parsed_filename;
+                if (compilation_process.pch_filename != NULL)
+                {
+                    const char* stripped_filename = driver_pch_use(translation_unit, parsed_filename);
+                    if (stripped_filename != NULL)
+                        scanned_filename = stripped_filename;
+                }
+
                 // * Open file
-                CXX_LANGUAGE()
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+                if (preprocessed_stream != NULL)
                 {
-                    if (mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                    CXX_LANGUAGE()
                     {
-                        fatal_error("Could not open file '%s'", parsed_filename);
+                        if (mcxx_open_stream_for_scanning(preprocessed_stream, parsed_filename, translation_unit->input_filename) != 0)
+                        {
+                            fatal_error("Could not open file '%s'", parsed_filename);
+                        }
                     }
-                }
 
-                C_LANGUAGE()
+                    C_LANGUAGE()
+                    {
+                        if (mc99_open_stream_for_scanning(preprocessed_stream, parsed_filename, translation_unit->input_filename) != 0)
+                        {
+                            fatal_error("Could not open file '%s'", parsed_filename);
+                        }
+                    }
+                }
+                else
+#endif
                 {
-                    if (mc99_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                    CXX_LANGUAGE()
                     {
-                        fatal_error("Could not open file '%s'", parsed_filename);
+                        if (mcxx_open_file_for_scanning(parsed_filename, translation_unit->input_filename) != 0)
+                        {
+                            fatal_error("Could not open file '%s'", parsed_filename);
+                        }
+                    }
+
+                    C_LANGUAGE()
+                    {
+                        if (mc99_open_file_for_scanning(scanned_filename, translation_unit->input_filename) != 0)
+                        {
+                            fatal_error("Could not open file '%s'", scanned_filename);
+                        }
                     }
                 }
 
@@ -3310,9 +3808,35 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                     }
                 }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+                // Parse diagnostics are held back until we know whether
+                // the preprocessor succeeded. Otherwise the errors of a
+                // truncated output would come before the real one
+                if (preprocessed_stream != NULL)
+                {
+                    diagnostic_context_push_buffered();
+                }
+#endif
+
                 // * Parse file
-                parse_translation_unit(translation_unit, parsed_filename);
+                char parse_succeeded = parse_translation_unit(translation_unit, parsed_filename);
                 // The scanner automatically closes the file
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+                if (preprocessed_stream != NULL)
+                {
+                    if (!finish_preprocessor_pipe(preprocessor_pid, preprocessor_drain_fd))
+                    {
+                        // What was parsed is not the whole file
+                        diagnostic_context_pop_and_discard();
+                        fatal_error("Preprocess failed for file '%s'", translation_unit->input_filename);
+                    }
+                    diagnostic_context_pop_and_commit();
+                }
+#endif
+                if (!parse_succeeded)
+                {
+                    fatal_error("Compilation failed for file '%s'\n", translation_unit->input_filename);
+                }
 
                 if (debug_options.print_ast_graphviz)
                 {
@@ -3330,6 +3854,19 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 // * Semantic analysis
                 semantic_analysis(translation_unit, parsed_filename);
 
+                if (debug_options.stats_ambiguities)
+                {
+                    ambiguity_stats_t ambiguity_stats;
+                    get_ambiguity_stats(&ambiguity_stats);
+                    fprintf(stderr, "%s: %lu ambiguities, %lu interpretations checked, "
+                            "%lu rejected by name lookup, %lu nested ambiguities not solved again\n",
+                            translation_unit->input_filename,
+                            ambiguity_stats.num_ambiguities,
+                            ambiguity_stats.num_trial_checks,
+                            ambiguity_stats.num_rejected_by_lookup,
+                            ambiguity_stats.num_memo_hits);
+                }
+
                 // * Check nodecl generated by semantic analysis
                 timing_t timing_check_tree;
                 if (CURRENT_CONFIGURATION->verbose)
@@ -3354,6 +3891,13 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 // * TL::run and TL::phase_cleanup
                 compiler_phases_execution(CURRENT_CONFIGURATION, translation_unit, parsed_filename);
 
+                if (driver_report_enabled())
+                {
+                    report_tree_nodes(translation_unit, "nodecl_nodes", "nodecl_walk_us",
+                            nodecl_get_ast(translation_unit->nodecl));
+                    driver_report_set_symbol_counters(translation_unit);
+                }
+
                 // * print ast if requested
                 if (debug_options.print_nodecl_graphviz)
                 {
@@ -3381,8 +3925,42 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
             if (!file_not_processed
                     && !debug_options.do_not_codegen)
             {
-                prettyprinted_filename
-                    = codegen_translation_unit(translation_unit, parsed_filename);
+                if (cache_hit)
+                {
+                    prettyprinted_filename = cached_prettyprinted_filename;
+                }
+                else
+                {
+                    // Files that generate other files cannot be reused
+                    if (file_process->num_secondary_translation_units != 0)
+                        translation_unit->cache_key = NULL;
+
+                    prettyprinted_filename
+                        = codegen_translation_unit(translation_unit, parsed_filename);
+                    finish_cache_diagnostics();
+
+                    if (translation_unit->cache_key != NULL
+                            && prettyprinted_filename != NULL
+                            && !translation_unit->natively_compiled_through_pipe)
+                    {
+                        // The diagnostics go first so a cached file never
+                        // lacks them
+                        driver_cache_store(translation_unit->cache_key,
+                                DRIVER_CACHE_KIND_PRETTYPRINTED_DIAGNOSTICS,
+                                translation_unit->cache_diagnostics_filename);
+                        driver_cache_store(translation_unit->cache_key,
+                                DRIVER_CACHE_KIND_PRETTYPRINTED,
+                                prettyprinted_filename);
+                    }
+                }
+            }
+
+            // * Precompiled headers
+            if (!CURRENT_CONFIGURATION->pass_through
+                    && !file_not_processed
+                    && !cache_hit)
+            {
+                driver_pch_finish(translation_unit, parsed_filename);
             }
 
             timing_t timing_free_tree;
@@ -3394,7 +3972,10 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 }
             }
             timing_start(&timing_free_tree);
-            nodecl_free(translation_unit->nodecl);
+            // With an arena the tree is released after the secondary
+            // translation units, which may have been built in it
+            if (translation_unit->arena == NULL)
+                nodecl_free(translation_unit->nodecl);
             timing_end(&timing_free_tree);
             if (CURRENT_CONFIGURATION->verbose)
             {
@@ -3423,7 +4004,12 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
                 }
             }
 
-            // * Hide all the wrap modules lest they were found by the native compiler
+            if (translation_unit->arena != NULL)
+            {
+                release_translation_unit_arena(translation_unit);
+            }
+
+            // * Hide all the wrap modules lest they were found by the native compiler
             if (current_extension->source_language == SOURCE_LANGUAGE_FORTRAN
                     && !CURRENT_CONFIGURATION->do_not_compile)
             {
@@ -3433,7 +4019,11 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
             if (!BITMAP_TEST(current_extension->source_kind, SOURCE_KIND_DO_NOT_COMPILE))
             {
                 // * Native compilation
-                if (!file_not_processed)
+                if (cache_object_reused)
+                {
+                    // Nothing to do, the cached object is already in place
+                }
+                else if (!file_not_processed)
                 {
                     native_compilation(translation_unit, prettyprinted_filename, /* remove_input */ 1);
                 }
@@ -3485,10 +4075,332 @@ static void compile_every_translation_unit_aux_(int num_translation_units,
 #undef return
 }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+typedef struct compilation_job_tag
+{
+    compilation_file_process_t* file_process;
+
+    pid_t pid;
+    // Reading end of the pipe where the worker writes the output filename
+    int result_fd;
+
+    // Diagnostics of the worker, replayed in order by the driver
+    const char* stdout_filename;
+    const char* stderr_filename;
+    // Report of the worker (--report)
+    const char* report_filename;
+
+    char started;
+    char finished;
+    int exit_status;
+} compilation_job_t;
+
+// Returns nonzero if the translation units can be compiled in any order
+static char can_compile_translation_units_concurrently(int num_translation_units,
+        compilation_file_process_t** translation_units)
+{
+    int i;
+    for (i = 0; i < num_translation_units; i++)
+    {
+        translation_unit_t* translation_unit = translation_units[i]->translation_unit;
+
+        // Fortran translation units may depend on modules of previous ones
+        if (translation_units[i]->compilation_configuration->source_language
+                == SOURCE_LANGUAGE_FORTRAN)
+            return 0;
+
+        const char* extension = get_extension_filename(translation_unit->input_filename);
+        if (extension != NULL)
+        {
+            struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+            if (current_extension != NULL
+                    && current_extension->source_language == SOURCE_LANGUAGE_FORTRAN)
+                return 0;
+        }
+
+        // Intermediate and object files are named after the basename of the
+        // input so two files with the same basename would clobber each other
+        int j;
+        for (j = 0; j < i; j++)
+        {
+            if (strcmp(give_basename(translation_units[j]->translation_unit->input_filename),
+                        give_basename(translation_unit->input_filename)) == 0)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void replay_job_output(const char* filename, FILE* dest)
+{
+    FILE* f = fopen(filename, "r");
+    if (f == NULL)
+        return;
+
+    char buffer[4096];
+    size_t actually_read;
+    while ((actually_read = fread(buffer, sizeof(char), sizeof(buffer), f)) != 0)
+    {
+        fwrite(buffer, sizeof(char), actually_read, dest);
+    }
+    fclose(f);
+    fflush(dest);
+}
+
+static void redirect_stream(FILE* stream, const char* filename)
+{
+    int fd = open(filename, O_WRONLY | O_TRUNC);
+    if (fd < 0
+            || dup2(fd, fileno(stream)) < 0)
+    {
+        fatal_error("error: could not redirect output to '%s' (%s)",
+                filename, strerror(errno));
+    }
+    close(fd);
+}
+
+static void start_compilation_job(compilation_job_t* job)
+{
+    temporal_file_t stdout_file = new_temporal_file();
+    temporal_file_t stderr_file = new_temporal_file();
+    job->stdout_filename = stdout_file->name;
+    job->stderr_filename = stderr_file->name;
+    if (driver_report_enabled())
+    {
+        job->report_filename = new_temporal_file()->name;
+    }
+
+    int result_pipe[2];
+    if (pipe(result_pipe) != 0)
+    {
+        fatal_error("error: could not create pipe (%s)", strerror(errno));
+    }
+
+    // Do not let the worker flush what we have buffered so far
+    fflush(NULL);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        fatal_error("error: could not fork to compile '%s' (%s)",
+                job->file_process->translation_unit->input_filename,
+                strerror(errno));
+    }
+    else if (pid == 0)
+    {
+        // I'm the worker
+        close(result_pipe[0]);
+
+        // The driver owns every file created so far
+        temporal_files_detach();
+
+        redirect_stream(stdout, job->stdout_filename);
+        redirect_stream(stderr, job->stderr_filename);
+
+        compile_every_translation_unit_aux_(1, &job->file_process);
+        wait_for_background_native_compilations();
+
+        // Secondary translation units exist only in this process
+        SET_CURRENT_FILE_PROCESS(job->file_process);
+        SET_CURRENT_CONFIGURATION(job->file_process->compilation_configuration);
+        embed_files_of_file_process(job->file_process);
+
+        if (job->report_filename != NULL)
+        {
+            driver_report_save_translation_units(job->report_filename);
+        }
+
+        const char* output_filename = job->file_process->translation_unit->output_filename;
+        if (output_filename != NULL)
+        {
+            size_t length = strlen(output_filename);
+            if (write(result_pipe[1], output_filename, length) != (ssize_t)length)
+            {
+                fatal_error("error: could not report output of '%s' (%s)",
+                        job->file_process->translation_unit->input_filename,
+                        strerror(errno));
+            }
+        }
+        close(result_pipe[1]);
+
+        exit(EXIT_SUCCESS);
+    }
+
+    // I'm the driver
+    close(result_pipe[1]);
+
+    job->pid = pid;
+    job->result_fd = result_pipe[0];
+    job->started = 1;
+}
+
+static void finish_compilation_job(compilation_job_t* job, int status)
+{
+    job->finished = 1;
+
+    if (WIFEXITED(status))
+    {
+        job->exit_status = WEXITSTATUS(status);
+    }
+    else
+    {
+        if (WIFSIGNALED(status))
+        {
+            fprintf(stderr, "%s: compilation of '%s' was ended with signal %d\n",
+                    compilation_process.exec_basename,
+                    job->file_process->translation_unit->input_filename,
+                    WTERMSIG(status));
+        }
+        job->exit_status = EXIT_FAILURE;
+    }
+
+    char output_filename[4096];
+    size_t length = 0;
+    ssize_t actually_read;
+    while (length < sizeof(output_filename) - 1
+            && (actually_read = read(job->result_fd,
+                    output_filename + length,
+                    sizeof(output_filename) - 1 - length)) > 0)
+    {
+        length += actually_read;
+    }
+    output_filename[length] = '\0';
+    close(job->result_fd);
+
+    if (job->exit_status == 0)
+    {
+        if (length > 0)
+        {
+            job->file_process->translation_unit->output_filename = uniquestr(output_filename);
+        }
+        job->file_process->already_compiled = 1;
+    }
+}
+
+// Compiles every translation unit in a separate process, running at most
+// compilation_process.num_jobs of them at the same time. The frontend relies
+// on global state so a process per translation unit is the simplest way to
+// keep them apart.
+static void compile_every_translation_unit_in_parallel(int num_translation_units,
+        compilation_file_process_t** translation_units)
+{
+    compilation_job_t jobs[num_translation_units];
+    memset(jobs, 0, sizeof(jobs));
+
+    int i;
+    for (i = 0; i < num_translation_units; i++)
+    {
+        jobs[i].file_process = translation_units[i];
+    }
+
+    int next_job = 0;
+    int next_to_replay = 0;
+    int num_running = 0;
+    char failed = 0;
+
+    while (next_to_replay < num_translation_units)
+    {
+        while (!failed
+                && num_running < compilation_process.num_jobs
+                && next_job < num_translation_units)
+        {
+            if (!jobs[next_job].file_process->already_compiled)
+            {
+                start_compilation_job(&jobs[next_job]);
+                num_running++;
+            }
+            next_job++;
+        }
+
+        // Replay, in order, the output of the jobs that have finished
+        while (next_to_replay < next_job)
+        {
+            compilation_job_t* job = &jobs[next_to_replay];
+            if (job->started
+                    && !job->finished)
+                break;
+
+            if (job->started)
+            {
+                replay_job_output(job->stdout_filename, stdout);
+                replay_job_output(job->stderr_filename, stderr);
+
+                if (job->report_filename != NULL
+                        && job->exit_status == 0)
+                {
+                    driver_report_load_translation_units(job->report_filename);
+                }
+
+                if (job->exit_status != 0)
+                {
+                    // Behave like the sequential compilation and stop at
+                    // the first translation unit that failed
+                    while (num_running > 0)
+                    {
+                        int status;
+                        if (wait(&status) > 0)
+                            num_running--;
+                    }
+                    exit(job->exit_status);
+                }
+            }
+            next_to_replay++;
+        }
+
+        if (num_running == 0)
+            continue;
+
+        int status = 0;
+        pid_t pid = wait(&status);
+        if (pid < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            fatal_error("error: waiting for compilation jobs failed (%s)", strerror(errno));
+        }
+
+        for (i = 0; i < num_translation_units; i++)
+        {
+            if (jobs[i].started
+                    && !jobs[i].finished
+                    && jobs[i].pid == pid)
+            {
+                finish_compilation_job(&jobs[i], status);
+                num_running--;
+                failed = failed || (jobs[i].exit_status != 0);
+                break;
+            }
+        }
+    }
+}
+#endif
+
 static void compile_every_translation_unit(void)
 {
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    if (compilation_process.num_jobs > 1
+            && compilation_process.num_translation_units > 1)
+    {
+        if (can_compile_translation_units_concurrently(
+                    compilation_process.num_translation_units,
+                    compilation_process.translation_units))
+        {
+            compile_every_translation_unit_in_parallel(compilation_process.num_translation_units,
+                    compilation_process.translation_units);
+            return;
+        }
+        else if (CURRENT_CONFIGURATION->verbose)
+        {
+            fprintf(stderr, "Translation units cannot be compiled concurrently. Compiling them one after the other\n");
+        }
+    }
+#endif
     compile_every_translation_unit_aux_(compilation_process.num_translation_units,
             compilation_process.translation_units);
+
+    // Objects must be available for embedding and linking
+    wait_for_background_native_compilations();
 }
 
 static void compiler_phases_pre_execution(
@@ -3527,7 +4439,40 @@ static void compiler_phases_execution(
     }
 }
 
-static void parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename)
+static unsigned long count_tree_nodes(AST a)
+{
+    if (a == NULL)
+        return 0;
+
+    unsigned long result = 1;
+
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        result += count_tree_nodes(ASTChild(a, i));
+    }
+
+    return result;
+}
+
+// Counting the nodes is a plain walk of the tree, so its time in
+// microseconds is reported as well to compare layouts of the nodes
+static void report_tree_nodes(translation_unit_t* translation_unit,
+        const char* nodes_counter, const char* walk_counter, AST a)
+{
+    timing_t timing_walk;
+    timing_start(&timing_walk);
+    unsigned long num_nodes = count_tree_nodes(a);
+    timing_end(&timing_walk);
+
+    driver_report_set_counter(translation_unit, nodes_counter, num_nodes);
+    driver_report_set_counter(translation_unit, walk_counter,
+            (unsigned long)(timing_elapsed(&timing_walk) * 1e6));
+}
+
+// Returns zero if the file could not be parsed. The errors have already
+// been diagnosed
+static char parse_translation_unit(translation_unit_t* translation_unit, const char* parsed_filename)
 {
     timing_t timing_parsing;
 
@@ -3537,6 +4482,9 @@ static void parse_translation_unit(translation_unit_t* translation_unit, const c
                 translation_unit->input_filename, parsed_filename);
     }
 
+    driver_report_measure_t report_parsing;
+    driver_report_measure_start(&report_parsing);
+
     timing_start(&timing_parsing);
 
     AST parsed_tree = NULL;
@@ -3559,7 +4507,7 @@ static void parse_translation_unit(translation_unit_t* translation_unit, const c
 
     if (parse_result != 0)
     {
-        fatal_error("Compilation failed for file '%s'\n", translation_unit->input_filename);
+        return 0;
     }
 
     // Store the parsed tree as the unique child of AST_TRANSLATION_UNIT
@@ -3571,6 +4519,14 @@ static void parse_translation_unit(translation_unit_t* translation_unit, const c
     
     timing_end(&timing_parsing);
 
+    driver_report_measure_end(&report_parsing, translation_unit,
+            DRIVER_REPORT_STAGE_PARSING, /* name */ NULL);
+    if (driver_report_enabled())
+    {
+        report_tree_nodes(translation_unit, "ast_nodes", "ast_walk_us",
+                translation_unit->parsed_tree);
+    }
+
     if (CURRENT_CONFIGURATION->verbose)
     {
         fprintf(stderr, "File '%s' ('%s') parsed in %.2f seconds\n", 
@@ -3579,6 +4535,7 @@ static void parse_translation_unit(translation_unit_t* translation_unit, const c
                 timing_elapsed(&timing_parsing));
     }
 
+    return 1;
 }
 
 static AST get_translation_unit_node(void)
@@ -3609,6 +4566,9 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
 {
     timing_t timing_semantic;
 
+    driver_report_measure_t report_semantic;
+    driver_report_measure_start(&report_semantic);
+
     timing_start(&timing_semantic);
     nodecl_t nodecl;
     if (IS_C_LANGUAGE
@@ -3627,6 +4587,9 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
     }
     timing_end(&timing_semantic);
 
+    driver_report_measure_end(&report_semantic, translation_unit,
+            DRIVER_REPORT_STAGE_SEMANTIC_ANALYSIS, /* name */ NULL);
+
     // This may have been extended during prerun
     nodecl_t nodecl_old_list = nodecl_get_child(translation_unit->nodecl, 0);
 
@@ -3691,113 +4654,153 @@ static void semantic_analysis(translation_unit_t* translation_unit, const char*
     }
 }
 
-static const char* codegen_translation_unit(translation_unit_t* translation_unit, 
-        const char* parsed_filename UNUSED_PARAMETER)
+// Name of the file generated for a translation unit that is going to be
+// natively compiled
+static const char* native_prettyprinted_filename(translation_unit_t* translation_unit)
 {
-    if (CURRENT_CONFIGURATION->do_not_prettyprint)
-    {
-        return NULL;
-    }
-
-    FILE* prettyprint_file = NULL;
     const char* output_filename = NULL;
 
-    if (CURRENT_CONFIGURATION->do_not_compile
-            && CURRENT_CONFIGURATION->do_not_link)
+    const char* input_filename_basename = NULL;
+    input_filename_basename = give_basename(translation_unit->input_filename);
+
+    const char* preffix = strappend(compilation_process.exec_basename, "_");
+
+    const char* output_filename_basename = NULL; 
+
+    if (IS_FORTRAN_LANGUAGE
+            || CURRENT_CONFIGURATION->native_vendor == NATIVE_VENDOR_PGI)
     {
-        if (strcmp(translation_unit->output_filename, "-") == 0)
+        // Change the extension to be .f90 always
+        const char * ext = strrchr(input_filename_basename, '.');
+        ERROR_CONDITION(ext == NULL, "Expecting extension", 0);
+
+        char c[strlen(input_filename_basename) + 1];
+        memset(c, 0, sizeof(c));
+
+        strncpy(c, input_filename_basename, (size_t)(ext - input_filename_basename));
+        c[ext - input_filename_basename + 1] = '\0';
+        if (IS_FORTRAN_LANGUAGE)
         {
-            prettyprint_file = stdout;
-            output_filename = "(stdout)";
+            // Change the extension to be .f90 always
+            input_filename_basename = strappend(c, ".f90");
+        }
+        else if(CURRENT_CONFIGURATION->native_vendor == NATIVE_VENDOR_PGI)
+        {
+            // We only get here when the language is C/C++ and the native vendor is PGI.
+            // We need to change the extension of the original file to .i for C and C++
+            // (note that .ii is not supported) because every time we call the pgi compiler
+            // it preprocesses our file adding some internal headers. Thus, we end up having
+            // two definitions of the same symbols: one introduced by the call to the preprocessor
+            // and another one when PGI tries to compile the generated output.
+            input_filename_basename = strappend(c, ".i");
         }
         else
         {
-            output_filename = translation_unit->output_filename;
+            internal_error("unreachable code\n", 0);
         }
     }
-    else
-    {
-        const char* input_filename_basename = NULL;
-        input_filename_basename = give_basename(translation_unit->input_filename);
 
-        const char* preffix = strappend(compilation_process.exec_basename, "_");
+    output_filename_basename = strappend(preffix, input_filename_basename);
 
-        const char* output_filename_basename = NULL; 
-
-        if (IS_FORTRAN_LANGUAGE
-                || CURRENT_CONFIGURATION->native_vendor == NATIVE_VENDOR_PGI)
-        {
-            // Change the extension to be .f90 always
-            const char * ext = strrchr(input_filename_basename, '.');
-            ERROR_CONDITION(ext == NULL, "Expecting extension", 0);
+    if (compilation_process.parallel_process)
+    {
+        const char * ext = strrchr(output_filename_basename, '.');
+        ERROR_CONDITION(ext == NULL, "Expecting extension", 0);
 
-            char c[strlen(input_filename_basename) + 1];
-            memset(c, 0, sizeof(c));
+        char c[strlen(output_filename_basename) + 1];
+        memset(c, 0, sizeof(c));
 
-            strncpy(c, input_filename_basename, (size_t)(ext - input_filename_basename));
-            c[ext - input_filename_basename + 1] = '\0';
-            if (IS_FORTRAN_LANGUAGE)
-            {
-                // Change the extension to be .f90 always
-                input_filename_basename = strappend(c, ".f90");
-            }
-            else if(CURRENT_CONFIGURATION->native_vendor == NATIVE_VENDOR_PGI)
-            {
-                // We only get here when the language is C/C++ and the native vendor is PGI.
-                // We need to change the extension of the original file to .i for C and C++
-                // (note that .ii is not supported) because every time we call the pgi compiler
-                // it preprocesses our file adding some internal headers. Thus, we end up having
-                // two definitions of the same symbols: one introduced by the call to the preprocessor
-                // and another one when PGI tries to compile the generated output.
-                input_filename_basename = strappend(c, ".i");
-            }
-            else
-            {
-                internal_error("unreachable code\n", 0);
-            }
-        }
+        strncpy(c, output_filename_basename, (size_t)(ext - output_filename_basename));
+        c[ext - output_filename_basename + 1] = '\0';
 
-        output_filename_basename = strappend(preffix, input_filename_basename);
+        const char* pid_str = 0;
+        // We assume that pid_t can be represented by signed int
+        uniquestr_sprintf(&pid_str, "_%d", (int)getpid());
+        // append _pid
+        output_filename_basename = strappend(c, pid_str);
+        // append original extension
+        output_filename_basename = strappend(output_filename_basename, ext);
 
-        if (compilation_process.parallel_process)
+        if (CURRENT_CONFIGURATION->keep_files)
         {
-            const char * ext = strrchr(output_filename_basename, '.');
-            ERROR_CONDITION(ext == NULL, "Expecting extension", 0);
+            fprintf(stderr, "Generated file will be left in '%s'\n", output_filename_basename);
+        }
+    }
 
-            char c[strlen(output_filename_basename) + 1];
-            memset(c, 0, sizeof(c));
+    if (CURRENT_CONFIGURATION->output_directory != NULL)
+    {
+        output_filename = strappend(CURRENT_CONFIGURATION->output_directory, "/");
+        output_filename = strappend(output_filename, output_filename_basename);
+    }
+    else
+    {
+        output_filename = output_filename_basename;
+    }
 
-            strncpy(c, output_filename_basename, (size_t)(ext - output_filename_basename));
-            c[ext - output_filename_basename + 1] = '\0';
+    return output_filename;
+}
 
-            const char* pid_str = 0;
-            // We assume that pid_t can be represented by signed int
-            uniquestr_sprintf(&pid_str, "_%d", (int)getpid());
-            // append _pid
-            output_filename_basename = strappend(c, pid_str);
-            // append original extension
-            output_filename_basename = strappend(output_filename_basename, ext);
+static const char* codegen_translation_unit(translation_unit_t* translation_unit, 
+        const char* parsed_filename UNUSED_PARAMETER)
+{
+    if (CURRENT_CONFIGURATION->do_not_prettyprint)
+    {
+        return NULL;
+    }
 
-            if (CURRENT_CONFIGURATION->keep_files)
-            {
-                fprintf(stderr, "Generated file will be left in '%s'\n", output_filename_basename);
-            }
-        }
+    FILE* prettyprint_file = NULL;
+    const char* output_filename = NULL;
 
-        if (CURRENT_CONFIGURATION->output_directory != NULL)
+    if (CURRENT_CONFIGURATION->do_not_compile
+            && CURRENT_CONFIGURATION->do_not_link)
+    {
+        if (strcmp(translation_unit->output_filename, "-") == 0)
         {
-            output_filename = strappend(CURRENT_CONFIGURATION->output_directory, "/");
-            output_filename = strappend(output_filename, output_filename_basename);
+            prettyprint_file = stdout;
+            output_filename = "(stdout)";
         }
         else
         {
-            output_filename = output_filename_basename;
+            output_filename = translation_unit->output_filename;
         }
     }
+    else
+    {
+        output_filename = native_prettyprinted_filename(translation_unit);
+    }
 
     if (CURRENT_CONFIGURATION->pass_through)
         return output_filename;
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    char through_pipe = 0;
+    pid_t native_compiler_pid = 0;
+    timing_t timing_native_compilation;
+    char old_line_markers = CURRENT_CONFIGURATION->line_markers;
+    struct sigaction old_sigpipe_action;
+
+    if (prettyprint_file == NULL
+            && can_compile_natively_through_pipe())
+    {
+        through_pipe = 1;
+        prettyprint_file = start_native_compilation_through_pipe(translation_unit,
+                output_filename,
+                &native_compiler_pid,
+                &timing_native_compilation);
+
+        // Diagnostics of the native compiler can only be mapped back
+        // through line markers
+        CURRENT_CONFIGURATION->line_markers = 1;
+
+        // If the native compiler ends prematurely we want to see its exit
+        // status rather than being killed while writing
+        struct sigaction ignore_sigpipe_action;
+        memset(&ignore_sigpipe_action, 0, sizeof(ignore_sigpipe_action));
+        ignore_sigpipe_action.sa_handler = SIG_IGN;
+        sigaction(SIGPIPE, &ignore_sigpipe_action, &old_sigpipe_action);
+    }
+#endif
+
     // Open it, unless was an already opened descriptor
     if (prettyprint_file == NULL)
         prettyprint_file = fopen(output_filename, "w");
@@ -3808,6 +4811,9 @@ static const char* codegen_translation_unit(translation_unit_t* translation_unit
                 strerror(errno));
     }
 
+    driver_report_measure_t report_codegen;
+    driver_report_measure_start(&report_codegen);
+
     timing_t time_print;
     timing_start(&time_print);
 
@@ -3817,6 +4823,8 @@ static const char* codegen_translation_unit(translation_unit_t* translation_unit
     if (IS_C_LANGUAGE
             || IS_CXX_LANGUAGE)
     {
+        // The headers of a precompiled header come first
+        driver_pch_emit_code(translation_unit, prettyprint_file);
         run_codegen_phase(prettyprint_file, translation_unit, output_filename);
     }
     else if (IS_FORTRAN_LANGUAGE)
@@ -3856,11 +4864,27 @@ static const char* codegen_translation_unit(translation_unit_t* translation_unit
         fprintf(stderr, "Prettyprinted into file '%s' in %.2f seconds\n", output_filename, timing_elapsed(&time_print));
     }
 
+    driver_report_measure_end(&report_codegen, translation_unit,
+            DRIVER_REPORT_STAGE_CODEGEN, /* name */ NULL);
+
     if (prettyprint_file != stdout)
     {
         fclose(prettyprint_file);
     }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    if (through_pipe)
+    {
+        sigaction(SIGPIPE, &old_sigpipe_action, /* old_sigaction */ NULL);
+        CURRENT_CONFIGURATION->line_markers = old_line_markers;
+
+        finish_native_compilation_through_pipe(translation_unit,
+                output_filename,
+                native_compiler_pid,
+                timing_native_compilation);
+    }
+#endif
+
     return output_filename;
 }
 
@@ -4055,7 +5079,12 @@ static void warn_preprocessor_flags(
     }
 }
 
-static const char* preprocess_single_file(const char* input_filename, const char* output_filename)
+// Returns a NULL-ended array of arguments for the preprocessor. If
+// stdout_file is not NULL it is set to the file where the standard output
+// of the preprocessor must be redirected
+static const char** build_preprocessor_arguments(const char* input_filename,
+        const char* preprocessed_filename,
+        const char** stdout_file)
 {
     int num_arguments = count_null_ended_array((void**)CURRENT_CONFIGURATION->preprocessor_options);
 
@@ -4080,8 +5109,7 @@ static const char* preprocess_single_file(const char* input_filename, const char
     // NULL
     num_parameters += 1;
 
-    const char* preprocessor_options[num_parameters];
-    memset(preprocessor_options, 0, sizeof(preprocessor_options));
+    const char** preprocessor_options = NEW_VEC0(const char*, num_parameters);
 
     int i;
     for (i = 0; i < num_arguments; i++)
@@ -4112,11 +5140,39 @@ static const char* preprocess_single_file(const char* input_filename, const char
     preprocessor_options[i] = "-D_MERCURIUM";
     i++;
 
-    const char *preprocessed_filename = NULL;
+    if (stdout_file != NULL)
+        *stdout_file = NULL;
 
-    if (!CURRENT_CONFIGURATION->do_not_parse)
+    if (!uses_stdout)
     {
-        temporal_file_t preprocessed_file = new_temporal_file();
+        preprocessor_options[i] = uniquestr("-o"); 
+        i++;
+        preprocessor_options[i] = preprocessed_filename;
+        i++;
+        preprocessor_options[i] = input_filename;
+        i++;
+    }
+    else
+    {
+        if (stdout_file != NULL)
+            *stdout_file = preprocessed_filename;
+
+        preprocessor_options[i] = input_filename;
+        i++;
+    }
+
+    return preprocessor_options;
+}
+
+static const char* preprocess_single_file(const char* input_filename, const char* output_filename)
+{
+    char uses_stdout = CURRENT_CONFIGURATION->preprocessor_uses_stdout;
+
+    const char *preprocessed_filename = NULL;
+
+    if (!CURRENT_CONFIGURATION->do_not_parse)
+    {
+        temporal_file_t preprocessed_file = new_temporal_file();
         preprocessed_filename = preprocessed_file->name;
     }
     else
@@ -4138,31 +5194,18 @@ static const char* preprocess_single_file(const char* input_filename, const char
     }
 
     const char *stdout_file = NULL;
-
-    if (!uses_stdout)
-    {
-        preprocessor_options[i] = uniquestr("-o"); 
-        i++;
-        preprocessor_options[i] = preprocessed_filename;
-        i++;
-        preprocessor_options[i] = input_filename;
-        i++;
-    }
-    else
-    {
-        stdout_file = preprocessed_filename;
-
-        preprocessor_options[i] = input_filename;
-        i++;
-    }
+    const char** preprocessor_options = build_preprocessor_arguments(input_filename,
+            preprocessed_filename, &stdout_file);
     
     if (CURRENT_CONFIGURATION->pass_through)
     {
+        DELETE(preprocessor_options);
         return preprocessed_filename;
     }
 
     int result_preprocess = execute_program_flags(CURRENT_CONFIGURATION->preprocessor_name,
             preprocessor_options, stdout_file, /* stderr_f */ NULL);
+    DELETE(preprocessor_options);
 
     if (result_preprocess == 0)
     {
@@ -4176,6 +5219,77 @@ static const char* preprocess_single_file(const char* input_filename, const char
     }
 }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+static char can_preprocess_through_pipe(void)
+{
+    // The temporary file is still used when it may be kept or it is
+    // not going to be scanned by the C/C++ scanner
+    return CURRENT_CONFIGURATION->preprocessor_uses_pipe
+        && !CURRENT_CONFIGURATION->do_not_parse
+        && !CURRENT_CONFIGURATION->pass_through
+        && !CURRENT_CONFIGURATION->keep_temporaries
+        // The cache needs the preprocessed file before parsing
+        && compilation_process.cache_directory == NULL
+        // Precompiled headers split the preprocessed file
+        && compilation_process.pch_filename == NULL
+        && compilation_process.pch_create_filename == NULL
+        && (IS_C_LANGUAGE || IS_CXX_LANGUAGE);
+}
+
+// Starts the preprocessor and returns a stream with its output. The
+// scanner closes the stream, so drain_fd is another descriptor of the
+// same pipe that finish_preprocessor_pipe uses to read whatever the
+// scanner did not consume
+static FILE* start_preprocessor_pipe(const char* input_filename, pid_t* pid, int* drain_fd)
+{
+    // "-o -" is already what we use for -E when the preprocessor does
+    // not use stdout
+    const char** preprocessor_options = build_preprocessor_arguments(input_filename,
+            CURRENT_CONFIGURATION->preprocessor_uses_stdout ? NULL : uniquestr("-"),
+            /* stdout_file */ NULL);
+
+    FILE* result = execute_program_read_stdout(CURRENT_CONFIGURATION->preprocessor_name,
+            preprocessor_options, pid);
+    DELETE(preprocessor_options);
+
+    *drain_fd = fcntl(fileno(result), F_DUPFD_CLOEXEC, 0);
+    if (*drain_fd < 0)
+    {
+        fatal_error("error: could not duplicate the output of the preprocessor (%s)", strerror(errno));
+    }
+
+    return result;
+}
+
+// Waits for the preprocessor once the parser is done with its output.
+// Returns zero if it failed
+static char finish_preprocessor_pipe(pid_t pid, int drain_fd)
+{
+    // If parsing stopped early the preprocessor may still be writing
+    char buffer[4096];
+    for (;;)
+    {
+        ssize_t num_read = read(drain_fd, buffer, sizeof(buffer));
+        if (num_read > 0
+                || (num_read < 0 && errno == EINTR))
+            continue;
+        break;
+    }
+    close(drain_fd);
+
+    int result_preprocess = wait_program(pid, CURRENT_CONFIGURATION->preprocessor_name);
+
+    if (result_preprocess != 0)
+    {
+        fprintf(stderr, "Preprocessing failed. Returned code %d\n",
+                result_preprocess);
+        return 0;
+    }
+
+    return 1;
+}
+#endif
+
 static const char* preprocess_translation_unit(translation_unit_t* translation_unit,
         const char* input_filename)
 {
@@ -4188,19 +5302,10 @@ const char* preprocess_file(const char* input_filename)
     return preprocess_single_file(input_filename, NULL);
 }
 
-static void native_compilation(translation_unit_t* translation_unit, 
-        const char* prettyprinted_filename, 
-        char remove_input)
+// Sets the output filename of the translation unit to the object file
+// generated by the native compiler
+static const char* native_compilation_output_filename(translation_unit_t* translation_unit)
 {
-    if (CURRENT_CONFIGURATION->do_not_compile
-            || debug_options.do_not_codegen)
-        return;
-
-    if (remove_input)
-    {
-        mark_file_for_cleanup(prettyprinted_filename);
-    }
-
     const char* output_object_filename = NULL;
 
     if (translation_unit->output_filename == NULL
@@ -4224,126 +5329,629 @@ static void native_compilation(translation_unit_t* translation_unit,
             output_object_filename = strappend(temp, ".s");
         }
 
-        translation_unit->output_filename = output_object_filename;
-    }
-    else
+        translation_unit->output_filename = output_object_filename;
+    }
+    else
+    {
+        output_object_filename = translation_unit->output_filename;
+    }
+
+    return output_object_filename;
+}
+
+// Returns a NULL-ended array of arguments for the native compiler. If
+// input_language is not NULL, "-x input_language" is passed right before the
+// input file. The positions of the output and input filenames are returned
+// so they can be replaced later
+static const char** build_native_compilation_arguments(
+        const char* prettyprinted_filename,
+        const char* output_object_filename,
+        const char* input_language,
+        int* output_object_filename_index,
+        int* prettyprinted_filename_index)
+{
+    int num_args_compiler = count_null_ended_array((void**)CURRENT_CONFIGURATION->native_compiler_options);
+
+    int num_arguments = num_args_compiler;
+
+    // This is a directory where we will put the unwrapped native modules
+    if (CURRENT_CONFIGURATION->module_native_dir != NULL)
+    {
+        // -Idir
+        num_arguments += 1;
+    }
+
+    if (CURRENT_CONFIGURATION->module_out_dir != NULL)
+    {
+        ERROR_CONDITION(CURRENT_CONFIGURATION->module_out_pattern == NULL,
+                "Expecting a pattern for the module out parameter",
+                0);
+        int num_commas = 0;
+        int i, N = strlen(CURRENT_CONFIGURATION->module_out_pattern);
+        for (i = 0; i < N; i++)
+        {
+            if (CURRENT_CONFIGURATION->module_out_pattern[i] == ',')
+                num_commas++;
+        }
+        num_arguments += num_commas + 1;
+    }
+
+    // -c -o output input
+    num_arguments += 4;
+    if (input_language != NULL)
+    {
+        // -x language
+        num_arguments += 2;
+    }
+    // NULL
+    num_arguments += 1;
+
+    const char** native_compilation_args = NEW_VEC0(const char*, num_arguments);
+
+    int ipos = 0;
+
+    // Force the unwrapped native module dir to be checked first
+    if (CURRENT_CONFIGURATION->module_native_dir != NULL)
+    {
+        char c[256];
+        snprintf(c, 255, "-I%s", CURRENT_CONFIGURATION->module_native_dir);
+        c[255] = '\0';
+
+        native_compilation_args[ipos] = uniquestr(c);
+        ipos++;
+    }
+
+    if (CURRENT_CONFIGURATION->module_out_dir != NULL)
+    {
+        char already_expanded = 0;
+
+        char *tmp = xstrdup(CURRENT_CONFIGURATION->module_out_pattern);
+
+        char *current_param = strtok(tmp, ",");
+
+        while (current_param != NULL)
+        {
+            char *p = NULL;
+            if (!already_expanded
+                    && (p = strstr(current_param, "%s")) != NULL)
+            {
+                // Expand '%s'
+                int length = strlen(current_param) + strlen(CURRENT_CONFIGURATION->module_out_dir) + 1;
+                char expanded[length];
+                expanded[0] = '\0';
+
+                strncat(expanded, current_param, p - current_param);
+                strcat(expanded, CURRENT_CONFIGURATION->module_out_dir);
+                strcat(expanded, p + 2);
+
+                native_compilation_args[ipos] = uniquestr(expanded);
+
+                already_expanded = 1;
+            }
+            else
+            {
+                native_compilation_args[ipos] = uniquestr(current_param);
+            }
+            ipos++;
+            current_param = strtok(NULL, ",");
+        }
+
+        DELETE(tmp);
+    }
+
+    {
+        int i;
+        for (i = 0; i < num_args_compiler; i++)
+        {
+            native_compilation_args[ipos] = CURRENT_CONFIGURATION->native_compiler_options[i];
+            ipos++;
+        }
+    }
+
+    if (!CURRENT_CONFIGURATION->generate_assembler)
+    {
+        native_compilation_args[ipos] = uniquestr("-c");
+        ipos++;
+    }
+    else
+    {
+        native_compilation_args[ipos] = uniquestr("-S");
+        ipos++;
+    }
+
+    native_compilation_args[ipos] = uniquestr("-o");
+    ipos++;
+    *output_object_filename_index = ipos;
+    native_compilation_args[ipos] = output_object_filename;
+    ipos++;
+    if (input_language != NULL)
+    {
+        native_compilation_args[ipos] = uniquestr("-x");
+        ipos++;
+        native_compilation_args[ipos] = input_language;
+        ipos++;
+    }
+    *prettyprinted_filename_index = ipos;
+    native_compilation_args[ipos] = prettyprinted_filename;
+    ipos++;
+
+    return native_compilation_args;
+}
+
+static void release_translation_unit_arena(translation_unit_t* translation_unit)
+{
+    mem_arena_t* arena = translation_unit->arena;
+
+    if (driver_report_enabled())
+    {
+        driver_report_set_counter(translation_unit, "arena_bytes",
+                mem_arena_get_allocated(arena));
+        driver_report_set_counter(translation_unit, "arena_chunks",
+                mem_arena_get_num_chunks(arena));
+    }
+
+    timing_t timing_release;
+    timing_start(&timing_release);
+
+    ast_release_arena(arena);
+    size_t reserved = mem_arena_get_reserved(arena);
+    int num_chunks = mem_arena_get_num_chunks(arena);
+    mem_arena_destroy(arena);
+    translation_unit->arena = NULL;
+
+    timing_end(&timing_release);
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Released %zu bytes in %d chunks of the trees of '%s' in %.2f seconds\n",
+                reserved, num_chunks,
+                translation_unit->input_filename,
+                timing_elapsed(&timing_release));
+    }
+}
+
+static char can_use_compilation_cache(translation_unit_t* translation_unit, char file_not_processed)
+{
+    return compilation_process.cache_directory != NULL
+        && (IS_C_LANGUAGE || IS_CXX_LANGUAGE)
+        && !file_not_processed
+        && !CURRENT_CONFIGURATION->do_not_parse
+        && !CURRENT_CONFIGURATION->do_not_prettyprint
+        && !CURRENT_CONFIGURATION->pass_through
+        && !debug_options.do_not_codegen
+        && !debug_options.binary_check
+        // Output to stdout
+        && !(CURRENT_CONFIGURATION->do_not_compile
+                && CURRENT_CONFIGURATION->do_not_link
+                && strcmp(translation_unit->output_filename, "-") == 0);
+}
+
+// Stream where the diagnostics of the translation unit being compiled are
+// also written
+static FILE* cache_diagnostics_transcript = NULL;
+
+static void start_cache_diagnostics(translation_unit_t* translation_unit)
+{
+    if (translation_unit->cache_key == NULL)
+        return;
+
+    temporal_file_t diagnostics_file = new_temporal_file();
+    cache_diagnostics_transcript = fopen(diagnostics_file->name, "w");
+    if (cache_diagnostics_transcript == NULL)
+    {
+        // A cached file would lose its diagnostics
+        translation_unit->cache_key = NULL;
+        return;
+    }
+
+    translation_unit->cache_diagnostics_filename = diagnostics_file->name;
+    diagnostics_set_transcript(cache_diagnostics_transcript);
+}
+
+static void finish_cache_diagnostics(void)
+{
+    if (cache_diagnostics_transcript == NULL)
+        return;
+
+    diagnostics_set_transcript(NULL);
+    fclose(cache_diagnostics_transcript);
+    cache_diagnostics_transcript = NULL;
+}
+
+// Writes the diagnostics kept in the cache as if the file had been compiled
+static void replay_cache_diagnostics(translation_unit_t* translation_unit, const char* kind)
+{
+    temporal_file_t diagnostics_file = new_temporal_file();
+    if (!driver_cache_lookup(translation_unit->cache_key, kind, diagnostics_file->name))
+        return;
+
+    translation_unit->cache_diagnostics_filename = diagnostics_file->name;
+    append_file(diagnostics_file->name, stderr);
+}
+
+// Returns nonzero if the translation unit does not have to be compiled. If
+// the object has been reused, *object_reused is set, otherwise
+// *prettyprinted_filename is the file with the cached generated code
+static char compilation_cache_lookup(translation_unit_t* translation_unit,
+        const char* parsed_filename,
+        const char** prettyprinted_filename,
+        char *object_reused)
+{
+    *prettyprinted_filename = NULL;
+    *object_reused = 0;
+
+    translation_unit->cache_key = driver_cache_compute_key(translation_unit, parsed_filename);
+    if (translation_unit->cache_key == NULL)
+        return 0;
+
+    if (!CURRENT_CONFIGURATION->do_not_compile
+            && driver_cache_contains(translation_unit->cache_key, DRIVER_CACHE_KIND_OBJECT_DIAGNOSTICS))
+    {
+        const char* output_object_filename = native_compilation_output_filename(translation_unit);
+        if (driver_cache_lookup(translation_unit->cache_key, DRIVER_CACHE_KIND_OBJECT, output_object_filename))
+        {
+            *object_reused = 1;
+            replay_cache_diagnostics(translation_unit, DRIVER_CACHE_KIND_OBJECT_DIAGNOSTICS);
+        }
+    }
+
+    if (!*object_reused)
+    {
+        const char* output_filename = NULL;
+        if (CURRENT_CONFIGURATION->do_not_compile
+                && CURRENT_CONFIGURATION->do_not_link)
+        {
+            output_filename = translation_unit->output_filename;
+        }
+        else
+        {
+            output_filename = native_prettyprinted_filename(translation_unit);
+        }
+
+        if (driver_cache_contains(translation_unit->cache_key, DRIVER_CACHE_KIND_PRETTYPRINTED_DIAGNOSTICS)
+                && driver_cache_lookup(translation_unit->cache_key, DRIVER_CACHE_KIND_PRETTYPRINTED, output_filename))
+        {
+            *prettyprinted_filename = output_filename;
+            // The native compilation still runs and it will be stored
+            // with these diagnostics
+            replay_cache_diagnostics(translation_unit, DRIVER_CACHE_KIND_PRETTYPRINTED_DIAGNOSTICS);
+        }
+    }
+
+    char hit = (*object_reused || *prettyprinted_filename != NULL);
+    if (hit)
+    {
+        driver_cache_record_hit();
+    }
+    else
+    {
+        driver_cache_record_miss();
+    }
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        if (*object_reused)
+        {
+            fprintf(stderr, "Cache hit for file '%s'. Object '%s' reused\n",
+                    translation_unit->input_filename,
+                    translation_unit->output_filename);
+        }
+        else if (*prettyprinted_filename != NULL)
+        {
+            fprintf(stderr, "Cache hit for file '%s'. Generated code '%s' reused\n",
+                    translation_unit->input_filename,
+                    *prettyprinted_filename);
+        }
+        else
+        {
+            fprintf(stderr, "Cache miss for file '%s'\n",
+                    translation_unit->input_filename);
+        }
+    }
+
+    return hit;
+}
+
+// Standard error of the native compilation of a file that may be cached,
+// NULL otherwise
+static const char* native_compilation_stderr_filename(translation_unit_t* translation_unit)
+{
+    translation_unit->native_stderr_filename = NULL;
+    if (translation_unit->cache_key != NULL)
+    {
+        temporal_file_t stderr_file = new_temporal_file();
+        translation_unit->native_stderr_filename = stderr_file->name;
+    }
+
+    return translation_unit->native_stderr_filename;
+}
+
+// The native compiler wrote its diagnostics to a file, show them as if it
+// had written them directly
+static void native_compilation_finished(translation_unit_t* translation_unit)
+{
+    if (translation_unit->native_stderr_filename != NULL)
+    {
+        fflush(stderr);
+        append_file(translation_unit->native_stderr_filename, stderr);
+    }
+}
+
+static void native_compilation_succeeded(translation_unit_t* translation_unit)
+{
+    if (translation_unit->cache_key == NULL)
+        return;
+
+    // When compiling through a pipe the frontend is still running
+    if (cache_diagnostics_transcript != NULL)
+        fflush(cache_diagnostics_transcript);
+
+    temporal_file_t diagnostics_file = new_temporal_file();
+    FILE* diagnostics = fopen(diagnostics_file->name, "w");
+    if (diagnostics == NULL)
+        return;
+
+    char ok = 1;
+    if (translation_unit->cache_diagnostics_filename != NULL)
+        ok = ok && append_file(translation_unit->cache_diagnostics_filename, diagnostics) == 0;
+    if (translation_unit->native_stderr_filename != NULL)
+        ok = ok && append_file(translation_unit->native_stderr_filename, diagnostics) == 0;
+    ok = (fclose(diagnostics) == 0) && ok;
+
+    if (!ok)
+        return;
+
+    driver_cache_store(translation_unit->cache_key,
+            DRIVER_CACHE_KIND_OBJECT_DIAGNOSTICS,
+            diagnostics_file->name);
+    driver_cache_store(translation_unit->cache_key,
+            DRIVER_CACHE_KIND_OBJECT,
+            translation_unit->output_filename);
+}
+
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+typedef struct background_native_compilation_tag
+{
+    pid_t pid;
+    translation_unit_t* translation_unit;
+    const char* prettyprinted_filename;
+    const char* native_compiler_name;
+    timing_t timing_compilation;
+} background_native_compilation_t;
+
+// Queue of native compilations still running, oldest first
+static int num_background_native_compilations = 0;
+static background_native_compilation_t* background_native_compilations = NULL;
+
+static char can_compile_natively_in_background(void)
+{
+    return compilation_process.num_native_jobs >= 1
+        // Fortran modules are wrapped right after the native compilation
+        && CURRENT_CONFIGURATION->source_language != SOURCE_LANGUAGE_FORTRAN
+        && !debug_options.binary_check;
+}
+
+static void finish_oldest_background_native_compilation(void)
+{
+    ERROR_CONDITION(num_background_native_compilations == 0,
+            "There are no background native compilations", 0);
+
+    background_native_compilation_t current = background_native_compilations[0];
+    num_background_native_compilations--;
+    memmove(&background_native_compilations[0],
+            &background_native_compilations[1],
+            num_background_native_compilations * sizeof(*background_native_compilations));
+
+    int result = wait_program(current.pid, current.native_compiler_name);
+    timing_end(&current.timing_compilation);
+    native_compilation_finished(current.translation_unit);
+
+    driver_report_add_program_stage(current.translation_unit,
+            DRIVER_REPORT_STAGE_NATIVE_COMPILATION,
+            &current.timing_compilation);
+
+    if (result != 0)
     {
-        output_object_filename = translation_unit->output_filename;
+        // Do not leave any compiler running behind us
+        while (num_background_native_compilations > 0)
+        {
+            num_background_native_compilations--;
+            wait_program(background_native_compilations[num_background_native_compilations].pid,
+                    background_native_compilations[num_background_native_compilations].native_compiler_name);
+            native_compilation_finished(
+                    background_native_compilations[num_background_native_compilations].translation_unit);
+        }
+        fatal_error("Native compilation failed for file '%s'. Returned code %d",
+                current.translation_unit->input_filename, result);
     }
 
-    int num_args_compiler = count_null_ended_array((void**)CURRENT_CONFIGURATION->native_compiler_options);
-
-    int num_arguments = num_args_compiler;
+    native_compilation_succeeded(current.translation_unit);
 
-    // This is a directory where we will put the unwrapped native modules
-    if (CURRENT_CONFIGURATION->module_native_dir != NULL)
+    if (CURRENT_CONFIGURATION->verbose)
     {
-        // -Idir
-        num_arguments += 1;
+        fprintf(stderr, "File '%s' ('%s') natively compiled in %.2f seconds\n", 
+                current.translation_unit->input_filename,
+                current.prettyprinted_filename,
+                timing_elapsed(&current.timing_compilation));
     }
+}
 
-    if (CURRENT_CONFIGURATION->module_out_dir != NULL)
+static void wait_for_free_background_native_compilation(void)
+{
+    while (num_background_native_compilations >= compilation_process.num_native_jobs)
     {
-        ERROR_CONDITION(CURRENT_CONFIGURATION->module_out_pattern == NULL,
-                "Expecting a pattern for the module out parameter",
-                0);
-        int num_commas = 0;
-        int i, N = strlen(CURRENT_CONFIGURATION->module_out_pattern);
-        for (i = 0; i < N; i++)
-        {
-            if (CURRENT_CONFIGURATION->module_out_pattern[i] == ',')
-                num_commas++;
-        }
-        num_arguments += num_commas + 1;
+        finish_oldest_background_native_compilation();
     }
+}
 
-    // -c -o output input
-    num_arguments += 4;
-    // NULL
-    num_arguments += 1;
+static void add_background_native_compilation(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        pid_t pid,
+        timing_t timing_compilation)
+{
+    background_native_compilation_t new_compilation;
+    memset(&new_compilation, 0, sizeof(new_compilation));
+
+    new_compilation.translation_unit = translation_unit;
+    new_compilation.prettyprinted_filename = prettyprinted_filename;
+    new_compilation.native_compiler_name = CURRENT_CONFIGURATION->native_compiler_name;
+    new_compilation.timing_compilation = timing_compilation;
+    new_compilation.pid = pid;
+
+    P_LIST_ADD(background_native_compilations,
+            num_background_native_compilations,
+            new_compilation);
+}
 
-    const char* native_compilation_args[num_arguments];
-    memset(native_compilation_args, 0, sizeof(native_compilation_args));
+static void start_background_native_compilation(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        const char** native_compilation_args)
+{
+    wait_for_free_background_native_compilation();
 
-    int ipos = 0;
+    timing_t timing_compilation;
+    timing_start(&timing_compilation);
+    pid_t pid = execute_program_async(CURRENT_CONFIGURATION->native_compiler_name,
+            native_compilation_args,
+            native_compilation_stderr_filename(translation_unit));
+
+    add_background_native_compilation(translation_unit,
+            prettyprinted_filename,
+            pid,
+            timing_compilation);
+}
 
-    // Force the unwrapped native module dir to be checked first
-    if (CURRENT_CONFIGURATION->module_native_dir != NULL)
-    {
-        char c[256];
-        snprintf(c, 255, "-I%s", CURRENT_CONFIGURATION->module_native_dir);
-        c[255] = '\0';
+static char can_compile_natively_through_pipe(void)
+{
+    // Only gcc-like compilers understand '-x language -'
+    return CURRENT_CONFIGURATION->native_compiler_uses_pipe
+        && (IS_C_LANGUAGE || IS_CXX_LANGUAGE)
+        && (CURRENT_CONFIGURATION->native_vendor == NATIVE_VENDOR_GNU
+                || CURRENT_CONFIGURATION->native_vendor == NATIVE_VENDOR_INTEL)
+        && !CURRENT_CONFIGURATION->enable_cuda
+        && !CURRENT_CONFIGURATION->do_not_compile
+        && !CURRENT_CONFIGURATION->pass_through
+        // The generated file is requested
+        && !CURRENT_CONFIGURATION->keep_files
+        && !debug_options.binary_check;
+}
 
-        native_compilation_args[ipos] = uniquestr(c);
-        ipos++;
+// Starts the native compiler reading from its standard input. Returns the
+// stream where the code must be generated
+static FILE* start_native_compilation_through_pipe(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        pid_t* pid,
+        timing_t* timing_compilation)
+{
+    const char* output_object_filename = native_compilation_output_filename(translation_unit);
+
+    int output_object_filename_index = 0;
+    int prettyprinted_filename_index = 0;
+    const char** native_compilation_args = build_native_compilation_arguments(
+            uniquestr("-"),
+            output_object_filename,
+            IS_CXX_LANGUAGE ? uniquestr("c++") : uniquestr("c"),
+            &output_object_filename_index,
+            &prettyprinted_filename_index);
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Performing native compilation of '%s' into '%s' through a pipe\n",
+                prettyprinted_filename, output_object_filename);
     }
 
-    if (CURRENT_CONFIGURATION->module_out_dir != NULL)
+    if (can_compile_natively_in_background())
     {
-        char already_expanded = 0;
+        wait_for_free_background_native_compilation();
+    }
 
-        char *tmp = xstrdup(CURRENT_CONFIGURATION->module_out_pattern);
+    timing_start(timing_compilation);
+    FILE* result = execute_program_write_stdin(CURRENT_CONFIGURATION->native_compiler_name,
+            native_compilation_args,
+            native_compilation_stderr_filename(translation_unit),
+            pid);
+    DELETE(native_compilation_args);
 
-        char *current_param = strtok(tmp, ",");
+    translation_unit->natively_compiled_through_pipe = 1;
 
-        while (current_param != NULL)
-        {
-            char *p = NULL;
-            if (!already_expanded
-                    && (p = strstr(current_param, "%s")) != NULL)
-            {
-                // Expand '%s'
-                int length = strlen(current_param) + strlen(CURRENT_CONFIGURATION->module_out_dir) + 1;
-                char expanded[length];
-                expanded[0] = '\0';
+    return result;
+}
 
-                strncat(expanded, current_param, p - current_param);
-                strcat(expanded, CURRENT_CONFIGURATION->module_out_dir);
-                strcat(expanded, p + 2);
+// The stream returned by start_native_compilation_through_pipe must have
+// been closed
+static void finish_native_compilation_through_pipe(translation_unit_t* translation_unit,
+        const char* prettyprinted_filename,
+        pid_t pid,
+        timing_t timing_compilation)
+{
+    if (can_compile_natively_in_background())
+    {
+        add_background_native_compilation(translation_unit,
+                prettyprinted_filename,
+                pid,
+                timing_compilation);
+        return;
+    }
 
-                native_compilation_args[ipos] = uniquestr(expanded);
+    int result = wait_program(pid, CURRENT_CONFIGURATION->native_compiler_name);
+    native_compilation_finished(translation_unit);
+    if (result != 0)
+    {
+        fatal_error("Native compilation failed for file '%s'", translation_unit->input_filename);
+    }
+    timing_end(&timing_compilation);
 
-                already_expanded = 1;
-            }
-            else
-            {
-                native_compilation_args[ipos] = uniquestr(current_param);
-            }
-            ipos++;
-            current_param = strtok(NULL, ",");
-        }
+    driver_report_add_program_stage(translation_unit,
+            DRIVER_REPORT_STAGE_NATIVE_COMPILATION,
+            &timing_compilation);
 
-        DELETE(tmp);
-    }
+    native_compilation_succeeded(translation_unit);
 
+    if (CURRENT_CONFIGURATION->verbose)
     {
-        int i;
-        for (i = 0; i < num_args_compiler; i++)
-        {
-            native_compilation_args[ipos] = CURRENT_CONFIGURATION->native_compiler_options[i];
-            ipos++;
-        }
+        fprintf(stderr, "File '%s' ('%s') natively compiled in %.2f seconds\n", 
+                translation_unit->input_filename,
+                prettyprinted_filename,
+                timing_elapsed(&timing_compilation));
     }
+}
+#endif
 
-    if (!CURRENT_CONFIGURATION->generate_assembler)
+static void wait_for_background_native_compilations(void)
+{
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    while (num_background_native_compilations > 0)
     {
-        native_compilation_args[ipos] = uniquestr("-c");
-        ipos++;
+        finish_oldest_background_native_compilation();
     }
-    else
+#endif
+}
+
+static void native_compilation(translation_unit_t* translation_unit, 
+        const char* prettyprinted_filename, 
+        char remove_input)
+{
+    if (CURRENT_CONFIGURATION->do_not_compile
+            || debug_options.do_not_codegen)
+        return;
+
+    if (translation_unit->natively_compiled_through_pipe)
+        return;
+
+    if (remove_input)
     {
-        native_compilation_args[ipos] = uniquestr("-S");
-        ipos++;
+        mark_file_for_cleanup(prettyprinted_filename);
     }
 
-    native_compilation_args[ipos] = uniquestr("-o");
-    ipos++;
-    int output_object_filename_index = ipos;
-    native_compilation_args[ipos] = output_object_filename;
-    ipos++;
-    int prettyprinted_filename_index = ipos;
-    native_compilation_args[ipos] = prettyprinted_filename;
-    ipos++;
+    const char* output_object_filename = native_compilation_output_filename(translation_unit);
+
+    int output_object_filename_index = 0;
+    int prettyprinted_filename_index = 0;
+    const char** native_compilation_args = build_native_compilation_arguments(
+            prettyprinted_filename,
+            output_object_filename,
+            /* input_language */ NULL,
+            &output_object_filename_index,
+            &prettyprinted_filename_index);
 
     if (CURRENT_CONFIGURATION->verbose)
     {
@@ -4351,10 +5959,26 @@ static void native_compilation(translation_unit_t* translation_unit,
                 prettyprinted_filename, output_object_filename);
     }
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    if (can_compile_natively_in_background())
+    {
+        start_background_native_compilation(translation_unit,
+                prettyprinted_filename,
+                native_compilation_args);
+        DELETE(native_compilation_args);
+        return;
+    }
+#endif
+
     timing_t timing_compilation;
     timing_start(&timing_compilation);
 
-    if (execute_program(CURRENT_CONFIGURATION->native_compiler_name, native_compilation_args) != 0)
+    int native_result = execute_program_flags(CURRENT_CONFIGURATION->native_compiler_name,
+            native_compilation_args,
+            /* stdout_f */ NULL,
+            native_compilation_stderr_filename(translation_unit));
+    native_compilation_finished(translation_unit);
+    if (native_result != 0)
     {
         // Clean things up if they go wrong here before aborting
         if (CURRENT_CONFIGURATION->source_language == SOURCE_LANGUAGE_FORTRAN)
@@ -4365,6 +5989,14 @@ static void native_compilation(translation_unit_t* translation_unit,
     }
     timing_end(&timing_compilation);
 
+#if !defined(WIN32_BUILD) || defined(__CYGWIN__)
+    driver_report_add_program_stage(translation_unit,
+            DRIVER_REPORT_STAGE_NATIVE_COMPILATION,
+            &timing_compilation);
+#endif
+
+    native_compilation_succeeded(translation_unit);
+
     if (CURRENT_CONFIGURATION->verbose)
     {
         fprintf(stderr, "File '%s' ('%s') natively compiled in %.2f seconds\n", 
@@ -4428,6 +6060,8 @@ static void native_compilation(translation_unit_t* translation_unit,
             fprintf(stderr, "Binary comparison was OK!\n");
         }
     }
+
+    DELETE(native_compilation_args);
 }
 
 static void embed_files(void)
@@ -4450,132 +6084,138 @@ static void embed_files(void)
 
     for (i = 0; i < compilation_process.num_translation_units; i++)
     {
-        int num_secondary_translation_units = 
-            compilation_process.translation_units[i]->num_secondary_translation_units;
-        compilation_file_process_t** secondary_translation_units = 
-            compilation_process.translation_units[i]->secondary_translation_units;
+        embed_files_of_file_process(compilation_process.translation_units[i]);
+    }
+}
 
-        translation_unit_t* translation_unit = compilation_process.translation_units[i]->translation_unit;
-        const char* extension = get_extension_filename(translation_unit->input_filename);
-        struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+static void embed_files_of_file_process(compilation_file_process_t* file_process)
+{
+    int num_secondary_translation_units = file_process->num_secondary_translation_units;
+    compilation_file_process_t** secondary_translation_units = file_process->secondary_translation_units;
+
+    if (num_secondary_translation_units == 0)
+        return;
+
+    translation_unit_t* translation_unit = file_process->translation_unit;
+    const char* extension = get_extension_filename(translation_unit->input_filename);
+    struct extensions_table_t* current_extension = fileextensions_lookup(extension, strlen(extension));
+
+    // We do not have to embed linker data
+    if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
+            // Or languages that we know that cannot be embedded
+            || ((current_extension->source_kind & SOURCE_KIND_DO_NOT_EMBED) == SOURCE_KIND_DO_NOT_EMBED))
+    {
+        return;
+    }
+    const char *output_filename = translation_unit->output_filename;
+
+    if (CURRENT_CONFIGURATION->verbose)
+    {
+        fprintf(stderr, "Embedding secondary files into '%s'\n", output_filename);
+    }
 
-        // We do not have to embed linker data
+#define MAX_EMBED_MODES 8
+    int num_embed_modes_seen = 0;
+    int embed_modes[MAX_EMBED_MODES] = { 0 };
+    void *embed_mode_data[MAX_EMBED_MODES] = { 0 };
+
+    int j;
+    for (j = 0; j < num_secondary_translation_units; j++)
+    {
+        compilation_file_process_t* secondary_compilation_file = secondary_translation_units[j];
+        compilation_configuration_t* secondary_configuration = secondary_compilation_file->compilation_configuration;
+
+        // If a .o file is introduced by a phase, then it will not have an
+        // output filename because we usually compute these very late in
+        // the linking step and we will end using the same name.
+        extension = get_extension_filename(secondary_compilation_file->translation_unit->input_filename);
+        current_extension = fileextensions_lookup(extension, strlen(extension));
         if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
-                // Or languages that we know that cannot be embedded
-                || ((current_extension->source_kind & SOURCE_KIND_DO_NOT_EMBED) == SOURCE_KIND_DO_NOT_EMBED))
+                && secondary_compilation_file->translation_unit->output_filename == NULL)
         {
-            continue;
+            secondary_compilation_file->translation_unit->output_filename =
+                secondary_compilation_file->translation_unit->input_filename;
         }
-        const char *output_filename = translation_unit->output_filename;
 
-        if (CURRENT_CONFIGURATION->verbose)
+        target_options_map_t* target_options = get_target_options(secondary_configuration, CURRENT_CONFIGURATION->configuration_name);
+
+        if (target_options == NULL)
         {
-            fprintf(stderr, "Embedding secondary files into '%s'\n", output_filename);
+            fatal_error("During embedding, there are no target options defined from profile '%s' to profile '%s' in the configuration\n",
+                    secondary_configuration->configuration_name,
+                    CURRENT_CONFIGURATION->configuration_name);
         }
 
-#define MAX_EMBED_MODES 8
-        int num_embed_modes_seen = 0;
-        int embed_modes[MAX_EMBED_MODES] = { 0 };
-        void *embed_mode_data[MAX_EMBED_MODES] = { 0 };
-
-        int j;
-        for (j = 0; j < num_secondary_translation_units; j++)
-        {
-            compilation_file_process_t* secondary_compilation_file = secondary_translation_units[j];
-            compilation_configuration_t* secondary_configuration = secondary_compilation_file->compilation_configuration;
-
-            // If a .o file is introduced by a phase, then it will not have an
-            // output filename because we usually compute these very late in
-            // the linking step and we will end using the same name.
-            extension = get_extension_filename(secondary_compilation_file->translation_unit->input_filename);
-            current_extension = fileextensions_lookup(extension, strlen(extension));
-            if (current_extension->source_language == SOURCE_LANGUAGE_LINKER_DATA
-                    && secondary_compilation_file->translation_unit->output_filename == NULL)
-            {
-                secondary_compilation_file->translation_unit->output_filename =
-                    secondary_compilation_file->translation_unit->input_filename;
-            }
+        if (!target_options->do_embedding)
+        {
+            // Do nothing if we are told not to embed
+            continue;
+        }
 
-            target_options_map_t* target_options = get_target_options(secondary_configuration, CURRENT_CONFIGURATION->configuration_name);
+        // Remember the embed mode to run the collective embed procedure later
+        ERROR_CONDITION(num_embed_modes_seen == MAX_EMBED_MODES, "Too many embed modes. Max is %d", MAX_EMBED_MODES);
+        int k; 
+        char found = 0;
 
-            if (target_options == NULL)
-            {
-                fatal_error("During embedding, there are no target options defined from profile '%s' to profile '%s' in the configuration\n",
-                        secondary_configuration->configuration_name,
-                        CURRENT_CONFIGURATION->configuration_name);
-            }
+        void **embed_data = NULL;
 
-            if (!target_options->do_embedding)
+        for (k = 0;  k < num_embed_modes_seen && !found; k++)
+        {
+            if (embed_modes[k] == target_options->embedding_mode)
             {
-                // Do nothing if we are told not to embed
-                continue;
+                found = 1;
+                break;
             }
+        }
+        if (!found)
+        {
+            embed_modes[num_embed_modes_seen] = target_options->embedding_mode;
+            embed_data = &(embed_mode_data[num_embed_modes_seen]);
+            num_embed_modes_seen++;
+        }
+        else
+        {
+            embed_data = &(embed_mode_data[k]);
+        }
 
-            // Remember the embed mode to run the collective embed procedure later
-            ERROR_CONDITION(num_embed_modes_seen == MAX_EMBED_MODES, "Too many embed modes. Max is %d", MAX_EMBED_MODES);
-            int k; 
-            char found = 0;
-
-            void **embed_data = NULL;
-
-            for (k = 0;  k < num_embed_modes_seen && !found; k++)
-            {
-                if (embed_modes[k] == target_options->embedding_mode)
+        // Single embed
+        switch (target_options->embedding_mode)
+        {
+            case EMBEDDING_MODE_BFD:
                 {
-                    found = 1;
+                    multifile_embed_bfd_single(embed_data, secondary_compilation_file);
                     break;
                 }
-            }
-            if (!found)
-            {
-                embed_modes[num_embed_modes_seen] = target_options->embedding_mode;
-                embed_data = &(embed_mode_data[num_embed_modes_seen]);
-                num_embed_modes_seen++;
-            }
-            else
-            {
-                embed_data = &(embed_mode_data[k]);
-            }
-
-            // Single embed
-            switch (target_options->embedding_mode)
-            {
-                case EMBEDDING_MODE_BFD:
-                    {
-                        multifile_embed_bfd_single(embed_data, secondary_compilation_file);
-                        break;
-                    }
-                case EMBEDDING_MODE_PARTIAL_LINKING:
-                    {
-                        multifile_embed_partial_linking_single(
-                                embed_data, secondary_compilation_file, output_filename);
-                        break;
-                    }
-                default:
-                    internal_error("Unknown embedding mode", 0);
-            }
-
+            case EMBEDDING_MODE_PARTIAL_LINKING:
+                {
+                    multifile_embed_partial_linking_single(
+                            embed_data, secondary_compilation_file, output_filename);
+                    break;
+                }
+            default:
+                internal_error("Unknown embedding mode", 0);
         }
 
-        // Collective embed
-        for (j = 0; j < num_embed_modes_seen; j++)
+    }
+
+    // Collective embed
+    for (j = 0; j < num_embed_modes_seen; j++)
+    {
+        switch (embed_modes[j])
         {
-            switch (embed_modes[j])
-            {
-                case EMBEDDING_MODE_BFD:
-                    {
-                        multifile_embed_bfd_collective(&(embed_mode_data[j]), output_filename);
-                        break;
-                    }
-                case EMBEDDING_MODE_PARTIAL_LINKING:
-                    {
-                        // We don't need to do anything, secondary translation units
-                        // are already embedded in the output linker object
-                        break;
-                    }
-                default:
-                    internal_error("Unknown embedding mode", 0);
-            }
+            case EMBEDDING_MODE_BFD:
+                {
+                    multifile_embed_bfd_collective(&(embed_mode_data[j]), output_filename);
+                    break;
+                }
+            case EMBEDDING_MODE_PARTIAL_LINKING:
+                {
+                    // We don't need to do anything, secondary translation units
+                    // are already embedded in the output linker object
+                    break;
+                }
+            default:
+                internal_error("Unknown embedding mode", 0);
         }
     }
 }
@@ -5294,6 +6934,20 @@ static void stats_string_table(void)
     uniquestr_stats();
 }
 
+static void print_cache_stats(const char* cache_name,
+        void (*get_stats)(unsigned long* hits, unsigned long* misses))
+{
+    unsigned long hits, misses;
+    get_stats(&hits, &misses);
+    fprintf(stderr, "%s cache hits: %lu\n", cache_name, hits);
+    fprintf(stderr, "%s cache misses: %lu\n", cache_name, misses);
+    if (hits + misses > 0)
+    {
+        fprintf(stderr, "%s cache hit rate: %.2f%%\n", cache_name,
+                (100.0 * hits) / (hits + misses));
+    }
+}
+
 static void print_memory_report(void)
 {
     fprintf(stderr, "\n");
@@ -5337,11 +6991,34 @@ static void print_memory_report(void)
             sizeof(scope_entry_t));
     fprintf(stderr, "Size of entity specifiers (bytes): %zd\n",
             sizeof(entity_specifiers_t));
+    fprintf(stderr, "Size of rarely used entity specifiers (bytes): %zd\n",
+            sizeof(entity_specifiers_cold_t));
+
+    char symbol_bytes[256];
+    print_human(symbol_bytes,
+            get_num_symbols_created() * sizeof(scope_entry_t)
+            + get_num_entity_specs_cold_created() * sizeof(entity_specifiers_cold_t));
+    fprintf(stderr, "Symbols created: %lu (%lu with rarely used entity specifiers), using %s\n",
+            get_num_symbols_created(),
+            get_num_entity_specs_cold_created(),
+            symbol_bytes);
     fprintf(stderr, "Size of a context (bytes): %zd\n",
             sizeof(const decl_context_t*));
     fprintf(stderr, "Size of a type (bytes): %zd\n",
             get_type_t_size());
 
+    char entry_list_bytes[256];
+    print_human(entry_list_bytes, get_entry_list_bytes_allocated());
+    fprintf(stderr, "Memory allocated for lists of symbols: %s\n",
+            entry_list_bytes);
+
+    print_cache_stats("Class member lookup", get_class_lookup_cache_stats);
+    print_cache_stats("Overload resolution", get_overload_cache_stats);
+    print_cache_stats("Standard conversion", get_standard_conversion_cache_stats);
+    print_cache_stats("Equivalent types", get_equivalent_types_cache_stats);
+    print_cache_stats("Constexpr calls", get_constexpr_call_cache_stats);
+    print_cache_stats("Template specializations", get_specialization_index_stats);
+
     // -- AST
     fprintf(stderr, "\n");
     fprintf(stderr, "Abstract Syntax Tree(s) breakdown\n");
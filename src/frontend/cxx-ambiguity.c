@@ -29,6 +29,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include "cxx-ast.h"
 #include "cxx-ambiguity.h"
 #include "cxx-typeutils.h"
@@ -42,6 +43,7 @@
 #include "cxx-entrylist.h"
 #include "cxx-overload.h"
 #include "cxx-diagnostic.h"
+#include "ohash_ptr.h"
 
 /*
  * This file performs disambiguation. If a symbol table is passed along the
@@ -50,6 +52,202 @@
  *
  */
 
+// Statistics of the current translation unit
+static ambiguity_stats_t ambiguity_stats;
+static translation_unit_t* ambiguity_stats_translation_unit = NULL;
+
+// Ambiguities that could not be solved by try_to_solve_ambiguity_generic.
+// Interpretations of an ambiguity may share subtrees, so the same nested
+// ambiguity is often tried again while checking the next interpretation.
+// Verdicts are only valid while the outermost ambiguity is being solved,
+// because declarations made afterwards may change them. Checks that depend
+// on extra information are not remembered
+typedef
+struct ambiguity_memo_entry_tag
+{
+    AST a;
+    const decl_context_t* decl_context;
+    ambiguity_check_intepretation_fun_t* check;
+    unsigned int generation;
+
+    struct ambiguity_memo_entry_tag* next;
+} ambiguity_memo_entry_t;
+
+static ohash_u64_t* ambiguity_memo = NULL;
+static int ambiguity_nesting_level = 0;
+static unsigned int ambiguity_generation = 0;
+
+static void ambiguity_memo_free_entries(uint64_t key UNUSED_PARAMETER,
+        void* info, void* walk_info UNUSED_PARAMETER)
+{
+    ambiguity_memo_entry_t* entry = (ambiguity_memo_entry_t*)info;
+    while (entry != NULL)
+    {
+        ambiguity_memo_entry_t* next = entry->next;
+        DELETE(entry);
+        entry = next;
+    }
+}
+
+static void ambiguity_update_translation_unit(void)
+{
+    if (ambiguity_memo == NULL)
+        ambiguity_memo = ohash_u64_new(5);
+
+    // Outside of a translation unit the statistics and the memo are kept.
+    // Stale verdicts in the memo are ignored anyway because of their
+    // generation
+    if (compilation_process.current_file_process == NULL
+            || CURRENT_COMPILED_FILE == NULL
+            || ambiguity_stats_translation_unit == CURRENT_COMPILED_FILE)
+        return;
+
+    memset(&ambiguity_stats, 0, sizeof(ambiguity_stats));
+
+    ohash_u64_walk(ambiguity_memo, ambiguity_memo_free_entries, NULL);
+    ohash_u64_destroy(ambiguity_memo);
+    ambiguity_memo = ohash_u64_new(5);
+
+    ambiguity_stats_translation_unit = CURRENT_COMPILED_FILE;
+}
+
+void get_ambiguity_stats(ambiguity_stats_t* stats)
+{
+    ambiguity_update_translation_unit();
+    *stats = ambiguity_stats;
+}
+
+static void ambiguity_begin(void)
+{
+    ambiguity_update_translation_unit();
+    if (ambiguity_nesting_level == 0)
+        ambiguity_generation++;
+    ambiguity_nesting_level++;
+    ambiguity_stats.num_ambiguities++;
+}
+
+static void ambiguity_end(void)
+{
+    ambiguity_nesting_level--;
+}
+
+static uint64_t ambiguity_memo_key(AST a, const decl_context_t* decl_context)
+{
+    uint64_t h = (uintptr_t)a;
+    h ^= (uint64_t)(uintptr_t)decl_context + UINT64_C(0x9e3779b97f4a7c15) + (h << 6) + (h >> 2);
+    return h;
+}
+
+static ambiguity_memo_entry_t* ambiguity_memo_query(AST a, const decl_context_t* decl_context,
+        ambiguity_check_intepretation_fun_t* check)
+{
+    ambiguity_memo_entry_t* entry = (ambiguity_memo_entry_t*)ohash_u64_query(ambiguity_memo,
+            ambiguity_memo_key(a, decl_context));
+    while (entry != NULL
+            && (entry->a != a
+                || entry->decl_context != decl_context
+                || entry->check != check))
+        entry = entry->next;
+
+    return entry;
+}
+
+static char ambiguity_memo_has_failed(AST a, const decl_context_t* decl_context,
+        ambiguity_check_intepretation_fun_t* check)
+{
+    if (ambiguity_nesting_level == 0)
+        return 0;
+
+    ambiguity_update_translation_unit();
+
+    ambiguity_memo_entry_t* entry = ambiguity_memo_query(a, decl_context, check);
+    if (entry == NULL
+            || entry->generation != ambiguity_generation)
+        return 0;
+
+    ambiguity_stats.num_memo_hits++;
+    return 1;
+}
+
+static void ambiguity_memo_set_failed(AST a, const decl_context_t* decl_context,
+        ambiguity_check_intepretation_fun_t* check)
+{
+    // Only nested ambiguities are remembered
+    if (ambiguity_nesting_level <= 1)
+        return;
+
+    ambiguity_memo_entry_t* entry = ambiguity_memo_query(a, decl_context, check);
+    if (entry == NULL)
+    {
+        uint64_t key = ambiguity_memo_key(a, decl_context);
+
+        entry = NEW0(ambiguity_memo_entry_t);
+        entry->a = a;
+        entry->decl_context = decl_context;
+        entry->check = check;
+
+        entry->next = (ambiguity_memo_entry_t*)ohash_u64_push(ambiguity_memo, key, entry);
+    }
+    entry->generation = ambiguity_generation;
+}
+
+// Rejects, with a lookup of a single name, a cast whose type is an
+// unqualified name none of whose symbols can name a type. Checking the cast
+// would fail anyway but only after checking the casted expression. The kinds
+// accepted are those of the check of simple type specifiers in buildscope
+static char ambiguity_interpretation_is_not_viable(AST interpretation,
+        const decl_context_t* decl_context)
+{
+    if (ASTKind(interpretation) != AST_CAST)
+        return 0;
+
+    AST type_id = ASTSon0(interpretation);
+    if (type_id == NULL
+            || ASTKind(type_id) != AST_TYPE_ID)
+        return 0;
+
+    AST type_specifier_seq = ASTSon0(type_id);
+    if (type_specifier_seq == NULL)
+        return 0;
+
+    AST type_specifier = ASTSon1(type_specifier_seq);
+    if (type_specifier == NULL
+            || ASTKind(type_specifier) != AST_SIMPLE_TYPE_SPEC
+            || ASTKind(ASTSon0(type_specifier)) != AST_SYMBOL)
+        return 0;
+
+    AST symbol = ASTSon0(type_specifier);
+    scope_entry_list_t* entry_list = query_id_expression_flags(decl_context,
+            symbol, NULL, DF_IGNORE_FRIEND_DECL);
+
+    char can_name_a_type = 0;
+    if (entry_list == NULL)
+    {
+        // Some builtin types are only found when the type is checked
+        can_name_a_type = (ASTText(symbol)[0] == '_');
+    }
+    else
+    {
+        scope_entry_list_iterator_t* it = NULL;
+        for (it = entry_list_iterator_begin(entry_list);
+                !entry_list_iterator_end(it) && !can_name_a_type;
+                entry_list_iterator_next(it))
+        {
+            can_name_a_type = symbol_can_name_a_type(
+                    entry_advance_aliases(entry_list_iterator_current(it)),
+                    /* allow_class_template_names */ 1);
+        }
+        entry_list_iterator_free(it);
+        entry_list_free(entry_list);
+    }
+
+    if (can_name_a_type)
+        return 0;
+
+    ambiguity_stats.num_rejected_by_lookup++;
+    return 1;
+}
+
 // Generic routines
 void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
         ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
@@ -59,18 +257,31 @@ void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *in
 {
     ERROR_CONDITION(ASTKind(a) != AST_AMBIGUITY, "Tree is not an ambiguity", 0);
 
+    ambiguity_begin();
+
     int valid_option = -1;
 
     int i, n = ast_get_num_ambiguities(a);
 
     diagnostic_context_t* ambig_diag[n + 1];
+    char not_viable[n + 1];
+    int num_not_viable = 0;
 
     for (i = 0; i < n; i++)
     {
         AST current_interpretation = ast_get_ambiguity(a, i);
 
+        not_viable[i] = ambiguity_interpretation_is_not_viable(current_interpretation, decl_context);
+        if (not_viable[i])
+        {
+            ambig_diag[i] = NULL;
+            num_not_viable++;
+            continue;
+        }
+
         ast_fix_parents_inside_intepretation(current_interpretation);
 
+        ambiguity_stats.num_trial_checks++;
         ambig_diag[i] = diagnostic_context_push_buffered();
         char c = ambiguity_check_intepretation(current_interpretation, decl_context, i, info);
         diagnostic_context_pop();
@@ -117,6 +328,29 @@ void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *in
         }
     }
 
+    // Interpretations rejected by a lookup are only checked when no other
+    // interpretation is valid, so the diagnostics are those of a full check
+    if (valid_option < 0
+            && num_not_viable > 0)
+    {
+        for (i = 0; i < n; i++)
+        {
+            if (!not_viable[i])
+                continue;
+
+            AST current_interpretation = ast_get_ambiguity(a, i);
+            ast_fix_parents_inside_intepretation(current_interpretation);
+
+            ambiguity_stats.num_trial_checks++;
+            ambig_diag[i] = diagnostic_context_push_buffered();
+            char c = ambiguity_check_intepretation(current_interpretation, decl_context, i, info);
+            diagnostic_context_pop();
+
+            if (c && valid_option < 0)
+                valid_option = i;
+        }
+    }
+
     // Fallback, the first one chosen wins
     if (valid_option < 0
             && ambiguity_fallback_interpretation != NULL)
@@ -161,7 +395,11 @@ void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *in
         // Commit the chosen interpretation and discard all others
         for (i = 0; i < n; i++)
         {
-            if (i == valid_option)
+            if (ambig_diag[i] == NULL)
+            {
+                // Not checked
+            }
+            else if (i == valid_option)
             {
                 diagnostic_context_commit(ambig_diag[i]);
             }
@@ -173,23 +411,35 @@ void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *in
     }
 
     ast_replace_with_ambiguity(a, valid_option);
+
+    ambiguity_end();
 }
 
-static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
+static char try_to_solve_ambiguity_generic_(AST a, const decl_context_t* decl_context, void *info,
         ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
         ambiguity_choose_interpretation_fun_t* ambiguity_choose_interpretation
         )
 {
-    ERROR_CONDITION(ASTKind(a) != AST_AMBIGUITY, "Tree is not an ambiguity", 0);
-
     int valid_option = -1;
 
     int i, n = ast_get_num_ambiguities(a);
+    char not_viable[n + 1];
+    int num_not_viable = 0;
+
     for (i = 0; i < n; i++)
     {
         AST current_interpretation = ast_get_ambiguity(a, i);
+
+        not_viable[i] = ambiguity_interpretation_is_not_viable(current_interpretation, decl_context);
+        if (not_viable[i])
+        {
+            num_not_viable++;
+            continue;
+        }
+
         ast_fix_parents_inside_intepretation(current_interpretation);
 
+        ambiguity_stats.num_trial_checks++;
         char c = ambiguity_check_intepretation(current_interpretation, decl_context, i, info);
 
         if (c)
@@ -231,6 +481,25 @@ static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_con
         }
     }
 
+    // Like solve_ambiguity_generic, interpretations rejected by a lookup are
+    // only checked when no other interpretation is valid
+    if (valid_option < 0
+            && num_not_viable > 0)
+    {
+        for (i = 0; i < n && valid_option < 0; i++)
+        {
+            if (!not_viable[i])
+                continue;
+
+            AST current_interpretation = ast_get_ambiguity(a, i);
+            ast_fix_parents_inside_intepretation(current_interpretation);
+
+            ambiguity_stats.num_trial_checks++;
+            if (ambiguity_check_intepretation(current_interpretation, decl_context, i, info))
+                valid_option = i;
+        }
+    }
+
     if (valid_option < 0)
     {
         return 0;
@@ -240,6 +509,32 @@ static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_con
     return 1;
 }
 
+static char try_to_solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
+        ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
+        ambiguity_choose_interpretation_fun_t* ambiguity_choose_interpretation
+        )
+{
+    ERROR_CONDITION(ASTKind(a) != AST_AMBIGUITY, "Tree is not an ambiguity", 0);
+
+    if (info == NULL
+            && ambiguity_memo_has_failed(a, decl_context, ambiguity_check_intepretation))
+        return 0;
+
+    ambiguity_begin();
+
+    char result = try_to_solve_ambiguity_generic_(a, decl_context, info,
+            ambiguity_check_intepretation,
+            ambiguity_choose_interpretation);
+
+    if (!result
+            && info == NULL)
+        ambiguity_memo_set_failed(a, decl_context, ambiguity_check_intepretation);
+
+    ambiguity_end();
+
+    return result;
+}
+
 static int select_node_type(AST a, node_t type);
 static AST recursive_search(AST a, node_t type);
 static AST look_for_node_type_within_ambig(AST a, node_t type, int n);
@@ -2307,6 +2602,12 @@ void solve_ambiguous_expression(AST ambig_expression, const decl_context_t* decl
     int n = ast_get_num_ambiguities(ambig_expression);
 
     nodecl_t nodecl_local_array[n + 1];
+    // Interpretations rejected before checking them have no nodecl
+    int i;
+    for (i = 0; i < n; i++)
+    {
+        nodecl_local_array[i] = nodecl_null();
+    }
 
     struct nodecl_expr_ambiguities_tag nodecl_expr_ambiguities;
     nodecl_expr_ambiguities.chosen = 0;
@@ -2317,7 +2618,6 @@ void solve_ambiguous_expression(AST ambig_expression, const decl_context_t* decl
             solve_ambiguous_expression_choose_interpretation,
             /* solve_ambiguous_expression_fallback */ NULL);
 
-    int i;
     for (i = 0; i < n; i++)
     {
         if (i != nodecl_expr_ambiguities.chosen)
@@ -45,6 +45,22 @@ typedef int ambiguity_choose_interpretation_fun_t(AST current, AST previous,
         const decl_context_t*, void* info);
 typedef char ambiguity_fallback_interpretation_fun_t(AST, const decl_context_t*, int option_idx, void* info);
 
+typedef
+struct ambiguity_stats_tag
+{
+    // Ambiguous nodes being solved
+    unsigned long num_ambiguities;
+    // Interpretations checked
+    unsigned long num_trial_checks;
+    // Interpretations rejected by a lookup before checking them
+    unsigned long num_rejected_by_lookup;
+    // Nested ambiguities not solved again
+    unsigned long num_memo_hits;
+} ambiguity_stats_t;
+
+// Statistics of the current translation unit
+LIBMCXX_EXTERN void get_ambiguity_stats(ambiguity_stats_t* stats);
+
 LIBMCXX_EXTERN void solve_ambiguity_generic(AST a, const decl_context_t* decl_context, void *info,
         ambiguity_check_intepretation_fun_t* ambiguity_check_intepretation,
         ambiguity_choose_interpretation_fun_t* ambiguity_choose_interpretation,
@@ -34,6 +34,18 @@
 
 MCXX_BEGIN_DECLS
 
+// Nodes are allocated in chunks of AST_CHUNK_SIZE nodes and refer to each
+// other using 32-bit indexes: the upper bits select the chunk in
+// ast_node_chunks and the lower bits the node inside it. Index 0 is NULL
+typedef uint32_t ast_index_t;
+
+enum
+{
+    AST_CHUNK_BITS = 10,
+    AST_CHUNK_SIZE = 1 << AST_CHUNK_BITS,
+    AST_CHUNK_MASK = AST_CHUNK_SIZE - 1,
+};
+
 // Definition of the type
 typedef
 struct AST_tag
@@ -44,14 +56,26 @@ struct AST_tag
     // This is a bitmap for the sons
     unsigned int bitmap_sons:MCXX_MAX_AST_CHILDREN;
 
-    // Number of ambiguities of this node
-    int num_ambig;
+    // The node itself has been allocated in the arena of the translation unit
+    unsigned int node_in_arena:1;
+    // The extended data and the ambiguities may be in that arena
+    unsigned int data_in_arena:1;
+
+    // Set by ast_free to visit every node once
+    unsigned int visited:1;
+
+    // The structural hash of this node (see nodecl_structural_hash) and
+    // those of all its descendants are up to date
+    unsigned int structural_hash_valid:1;
+
+    // Index of this node
+    ast_index_t index;
 
     // Parent node
-    struct AST_tag* parent;
+    ast_index_t parent;
 
-    // Node locus
-    const locus_t* locus;
+    // Node locus, see locus_from_id
+    unsigned int locus;
 
     // Textual information linked to the node
     // normally the symbol or the literal
@@ -60,15 +84,34 @@ struct AST_tag
     union
     {
         // The children of this tree (except for AST_AMBIGUITY)
-        struct AST_tag** children;
+        ast_index_t children[MCXX_MAX_AST_CHILDREN];
         // When type == AST_AMBIGUITY, all intepretations are here
-        struct AST_tag** ambig;
+        struct
+        {
+            struct AST_tag** ambig;
+            int num_ambig;
+        };
     };
 
     // This is used by nodecl trees
     struct nodecl_expr_info_tag* expr_info;
 } AST_node_t;
 
+LIBMCXX_EXTERN AST_node_t** ast_node_chunks;
+
+static inline AST ast_node_from_index(ast_index_t index)
+{
+    if (index == 0)
+        return NULL;
+
+    return &ast_node_chunks[index >> AST_CHUNK_BITS][index & AST_CHUNK_MASK];
+}
+
+static inline ast_index_t ast_node_get_index(const_AST a)
+{
+    return a == NULL ? 0 : a->index;
+}
+
 
 static inline node_t ast_get_kind(const_AST a)
 {
@@ -77,7 +120,7 @@ static inline node_t ast_get_kind(const_AST a)
 
 static inline AST ast_get_parent(const_AST a)
 {
-    return a->parent;
+    return ast_node_from_index(a->parent);
 }
 
 static inline unsigned int ast_get_line(const_AST a)
@@ -100,34 +143,32 @@ static inline void ast_set_text(AST a, const char* str)
     a->text = str;
 }
 
-static inline void ast_set_kind(AST a, node_t node_type)
+static inline void ast_invalidate_structural_hash(AST a)
 {
-    a->node_type = node_type;
+    // A node with a valid hash has valid hashes in all its descendants so
+    // the first ancestor without one already has the remaining ones invalid
+    while (a != NULL
+            && a->structural_hash_valid)
+    {
+        a->structural_hash_valid = 0;
+        a = ast_node_from_index(a->parent);
+    }
 }
 
-static inline int ast_bitmap_to_index(unsigned int bitmap, int num)
+static inline char ast_structural_hash_is_valid(const_AST a)
 {
-    ERROR_CONDITION(((1 << num) & bitmap) == 0,
-            "Invalid bitmap!", 0);
-#if HAVE__BUILTIN_POPCOUNT
-    bitmap = bitmap & (~(~0U << num));
-    return __builtin_popcount(bitmap);
-#else
-    int i;
-    int s = 0;
-    for (i = 0; i < num; i++)
-    {
-        s += bitmap & 1;
-        bitmap = bitmap >> 1;
-    }
+    return a->structural_hash_valid;
+}
 
-    return s;
-#endif
+static inline void ast_set_structural_hash_valid(AST a)
+{
+    a->structural_hash_valid = 1;
 }
 
-ALWAYS_INLINE static inline int ast_son_num_to_son_index(const_AST a, int num_son)
+static inline void ast_set_kind(AST a, node_t node_type)
 {
-    return ast_bitmap_to_index(a->bitmap_sons, num_son);
+    ast_invalidate_structural_hash(a);
+    a->node_type = node_type;
 }
 
 ALWAYS_INLINE static inline char ast_has_son(const_AST a, int son)
@@ -139,7 +180,7 @@ ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 {
     if (ast_has_son(a, num_child))
     {
-        return a->children[ast_son_num_to_son_index(a, num_child)];
+        return ast_node_from_index(a->children[num_child]);
     }
     else
     {
@@ -149,7 +190,7 @@ ALWAYS_INLINE static inline AST ast_get_child(const_AST a, int num_child)
 
 static inline void ast_set_parent(AST a, AST parent)
 {
-    a->parent = parent;
+    a->parent = ast_node_get_index(parent);
 }
 
 static inline int ast_count_bitmap(unsigned int bitmap)
@@ -173,37 +214,20 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
         AST child0, AST child1, AST child2, AST child3, 
         const locus_t* location, const char *text)
 {
-    AST result = NEW(AST_node_t);
-    // ERROR_CONDITION(result & 0x1 != 0, "Invalid pointer for AST", 0);
+    // The node is returned zeroed
+    AST result = ast_new_node();
 
     result->node_type = type;
-
-    int num_children = 0;
-    unsigned int bitmap_sons = 0;
-
-    result->bitmap_sons = bitmap_sons;
-    result->parent = NULL;
-    result->locus = location;
-
+    result->locus = locus_get_id(location);
     result->text = text;
 
-    bitmap_sons =
-        (!!child0)
-        | (!!child1 << 1)
-        | (!!child2 << 2)
-        | (!!child3 << 3);
-    num_children = ast_count_bitmap(bitmap_sons);
-
-    result->bitmap_sons = bitmap_sons;
-    result->children = NEW_VEC(AST, num_children);
-
-    int idx = 0;
+    // Children are stored in their own position
 #define ADD_SON(n) \
     if (child##n != NULL) \
     { \
-        result->children[idx] = child##n; \
-        child##n->parent = result; \
-        idx++; \
+        result->bitmap_sons |= (1 << n); \
+        result->children[n] = child##n->index; \
+        child##n->parent = result->index; \
     }
 
     ADD_SON(0);
@@ -212,80 +236,21 @@ static inline AST ast_make(node_t type, int __num_children UNUSED_PARAMETER,
     ADD_SON(3);
 #undef ADD_SON
 
-    result->expr_info = NULL;
-
     return result;
 }
 
-// This function works both for shrinking or widening
-static inline void ast_reallocate_children(AST a, int num_child, AST new_child)
-{
-    // Reallocate childrens
-    // Save the old children array
-    AST* old_children = a->children;
-    // And the old children bitmap
-    unsigned int old_bitmap = a->bitmap_sons;
-
-    // Enable or disable this new son depending on it being null
-    if (new_child != NULL)
-    {
-        a->bitmap_sons = (a->bitmap_sons | (1 << num_child));
-    }
-    else
-    {
-        a->bitmap_sons = (a->bitmap_sons & (~(1 << num_child)));
-    }
-
-    a->children = NEW_VEC(AST, ast_count_bitmap(a->bitmap_sons));
-
-    // Now for every old son, update the new children
-    int i;
-    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
-    {
-        // Note that when shrinking the node ast_has_son
-        // will always return false for num_child.
-        if (ast_has_son(a, i))
-        {
-            if (i == num_child)
-            {
-                // The new son
-                a->children[ast_son_num_to_son_index(a, i)] = new_child;
-            }
-            else
-            {
-                // Old sons that are updated their position
-                a->children[ast_son_num_to_son_index(a, i)] = 
-                    old_children[ast_bitmap_to_index(old_bitmap, i)];
-            }
-        }
-    }
-
-    // Now DELETE the old children (if any)
-    if (old_children != NULL)
-        DELETE(old_children);
-}
-
 static inline void ast_set_child_but_parent(AST a, int num_child, AST new_child)
 {
+    ast_invalidate_structural_hash(a);
     if (new_child == NULL)
     {
-        if (ast_has_son(a, num_child))
-        {
-            // Shrink the node if we have it
-            ast_reallocate_children(a, num_child, new_child);
-        }
+        a->bitmap_sons &= ~(1 << num_child);
+        a->children[num_child] = 0;
     }
     else
     {
-        if (ast_has_son(a, num_child))
-        {
-            a->children[ast_son_num_to_son_index(a, num_child)] = new_child;
-        }
-        else
-        {
-            // This will widen the node
-            ast_reallocate_children(a, num_child, new_child);
-        }
+        a->bitmap_sons |= (1 << num_child);
+        a->children[num_child] = new_child->index;
     }
 }
 
@@ -294,7 +259,7 @@ static inline void ast_set_child(AST a, int num_child, AST new_child)
     ast_set_child_but_parent(a, num_child, new_child);
     if (new_child != NULL)
     {
-        new_child->parent = a;
+        new_child->parent = a->index;
     }
 }
 
@@ -412,7 +377,9 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
             int original_son0 = son0->num_ambig;
 
             son0->num_ambig += son1->num_ambig;
-            son0->ambig = NEW_REALLOC(AST, son0->ambig, son0->num_ambig);
+            son0->ambig = (AST*)ast_realloc_data(son0, son0->ambig,
+                    sizeof(AST) * original_son0,
+                    sizeof(AST) * son0->num_ambig);
 
             int i;
             for (i = 0; i < son1->num_ambig; i++)
@@ -425,7 +392,9 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
         else
         {
             son0->num_ambig++;
-            son0->ambig = NEW_REALLOC(AST, son0->ambig, son0->num_ambig);
+            son0->ambig = (AST*)ast_realloc_data(son0, son0->ambig,
+                    sizeof(AST) * (son0->num_ambig - 1),
+                    sizeof(AST) * son0->num_ambig);
             son0->ambig[son0->num_ambig-1] = son1;
 
             return son0;
@@ -434,7 +403,9 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
     else if (ASTKind(son1) == AST_AMBIGUITY)
     {
         son1->num_ambig++;
-        son1->ambig = NEW_REALLOC(AST, son1->ambig, son1->num_ambig);
+        son1->ambig = (AST*)ast_realloc_data(son1, son1->ambig,
+                sizeof(AST) * (son1->num_ambig - 1),
+                sizeof(AST) * son1->num_ambig);
         son1->ambig[son1->num_ambig-1] = son0;
 
         return son1;
@@ -444,7 +415,7 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
         AST result = ASTLeaf(AST_AMBIGUITY, make_locus("", 0, 0), NULL);
 
         result->num_ambig = 2;
-        result->ambig = NEW_VEC(AST, result->num_ambig);
+        result->ambig = (AST*)ast_alloc_data(result, sizeof(AST) * result->num_ambig);
         result->ambig[0] = son0;
         result->ambig[1] = son1;
         result->locus = son0->locus;
@@ -453,11 +424,6 @@ static inline AST ast_make_ambiguous(AST son0, AST son1)
     }
 }
 
-static inline void ast_replace(AST dest, const_AST src)
-{
-    *dest = *src;
-}
-
 static inline void ast_replace_with_ambiguity(AST a, int n)
 {
     ERROR_CONDITION(n >= ast_get_num_ambiguities(a),
@@ -492,7 +458,7 @@ static inline const locus_t* ast_get_locus(const_AST a)
     if (a == NULL)
         return NULL;
     else if (ASTKind(a) != AST_NODE_LIST)
-        return a->locus;
+        return locus_from_id(a->locus);
     else
         return ast_get_locus(
                 ASTSon1(ast_list_head(a))
@@ -503,7 +469,7 @@ static inline void ast_set_locus(AST a, const locus_t* locus)
 {
     ERROR_CONDITION(ASTKind(a) == AST_NODE_LIST,
             "list nodes do not have locus", 0);
-    a->locus = locus;
+    a->locus = locus_get_id(locus);
 }
 
 static inline const char *ast_get_filename(const_AST a)
@@ -523,6 +489,7 @@ static inline struct nodecl_expr_info_tag* ast_get_expr_info(const_AST a)
 
 static inline void ast_set_expr_info(AST a, struct nodecl_expr_info_tag* expr_info)
 {
+    ast_invalidate_structural_hash(a);
     a->expr_info = expr_info;
 }
 
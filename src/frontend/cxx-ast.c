@@ -45,6 +45,246 @@
 #include "cxx-typeutils.h"
 
 #include "cxx-nodecl-decls.h"
+#include "cxx-nodecl-inline.h"
+
+#include "mem_arena.h"
+
+// Arena of the current translation unit, NULL if nodes use malloc
+static mem_arena_t* ast_arena = NULL;
+// Nodes created while this is nonzero do not use the arena
+static int ast_persistent_level = 0;
+
+// Chunks of nodes, indexed by the upper bits of an ast_index_t. Chunk 0 is
+// never allocated so index 0 can be NULL
+AST_node_t** ast_node_chunks = NULL;
+static uint32_t num_ast_node_chunks = 0;
+static uint32_t capacity_ast_node_chunks = 0;
+
+// Chunk numbers released along with their arena
+static uint32_t* free_ast_node_chunks = NULL;
+static uint32_t num_free_ast_node_chunks = 0;
+
+// Nodes are allocated from a pool. There is one pool for every arena and
+// one for the nodes that are not in an arena, which also reuses the nodes
+// released by ast_free
+typedef
+struct ast_node_pool_tag
+{
+    mem_arena_t* arena;
+
+    // Chunk being filled and its next free node
+    uint32_t current_chunk;
+    int next_node;
+
+    // Chunks of this pool, released with the arena
+    uint32_t* chunks;
+    int num_chunks;
+
+    // Nodes released by ast_free, only for the persistent pool
+    ast_index_t free_list;
+
+    struct ast_node_pool_tag* next;
+} ast_node_pool_t;
+
+static ast_node_pool_t persistent_pool = { NULL, 0, AST_CHUNK_SIZE, NULL, 0, 0, NULL };
+static ast_node_pool_t* arena_pools = NULL;
+static ast_node_pool_t* current_arena_pool = NULL;
+
+static uint32_t ast_new_chunk(ast_node_pool_t* pool)
+{
+    AST_node_t* chunk;
+    if (pool->arena != NULL)
+        chunk = (AST_node_t*)mem_arena_alloc(pool->arena, sizeof(AST_node_t) * AST_CHUNK_SIZE);
+    else
+        chunk = NEW_VEC(AST_node_t, AST_CHUNK_SIZE);
+
+    uint32_t chunk_number;
+    if (num_free_ast_node_chunks > 0)
+    {
+        num_free_ast_node_chunks--;
+        chunk_number = free_ast_node_chunks[num_free_ast_node_chunks];
+    }
+    else
+    {
+        if (num_ast_node_chunks == 0)
+        {
+            // Reserve chunk 0
+            num_ast_node_chunks = 1;
+        }
+
+        ERROR_CONDITION(num_ast_node_chunks > (UINT32_MAX >> AST_CHUNK_BITS),
+                "Too many AST nodes", 0);
+
+        if (num_ast_node_chunks >= capacity_ast_node_chunks)
+        {
+            capacity_ast_node_chunks = (capacity_ast_node_chunks == 0) ? 256 : 2 * capacity_ast_node_chunks;
+            ast_node_chunks = NEW_REALLOC(AST_node_t*, ast_node_chunks, capacity_ast_node_chunks);
+        }
+
+        chunk_number = num_ast_node_chunks;
+        num_ast_node_chunks++;
+    }
+
+    ast_node_chunks[chunk_number] = chunk;
+
+    if (pool->arena != NULL)
+    {
+        pool->num_chunks++;
+        pool->chunks = NEW_REALLOC(uint32_t, pool->chunks, pool->num_chunks);
+        pool->chunks[pool->num_chunks - 1] = chunk_number;
+    }
+
+    return chunk_number;
+}
+
+static AST ast_pool_alloc(ast_node_pool_t* pool)
+{
+    ast_index_t index;
+    if (pool->free_list != 0)
+    {
+        index = pool->free_list;
+        pool->free_list = ast_node_from_index(index)->children[0];
+    }
+    else
+    {
+        if (pool->next_node == AST_CHUNK_SIZE)
+        {
+            pool->current_chunk = ast_new_chunk(pool);
+            pool->next_node = 0;
+        }
+        index = (pool->current_chunk << AST_CHUNK_BITS) | pool->next_node;
+        pool->next_node++;
+    }
+
+    AST result = ast_node_from_index(index);
+    memset(result, 0, sizeof(*result));
+    result->index = index;
+
+    return result;
+}
+
+void ast_set_arena(mem_arena_t* arena)
+{
+    ast_arena = arena;
+    current_arena_pool = NULL;
+
+    if (arena == NULL)
+        return;
+
+    ast_node_pool_t* pool;
+    for (pool = arena_pools; pool != NULL; pool = pool->next)
+    {
+        if (pool->arena == arena)
+        {
+            current_arena_pool = pool;
+            return;
+        }
+    }
+
+    pool = NEW0(ast_node_pool_t);
+    pool->arena = arena;
+    pool->next_node = AST_CHUNK_SIZE;
+    pool->next = arena_pools;
+    arena_pools = pool;
+
+    current_arena_pool = pool;
+}
+
+void ast_release_arena(mem_arena_t* arena)
+{
+    if (ast_arena == arena)
+        ast_set_arena(NULL);
+
+    ast_node_pool_t** p = &arena_pools;
+    while (*p != NULL
+            && (*p)->arena != arena)
+        p = &(*p)->next;
+
+    if (*p == NULL)
+        return;
+
+    ast_node_pool_t* pool = *p;
+    *p = pool->next;
+
+    // The chunk numbers can be used again by other pools
+    free_ast_node_chunks = NEW_REALLOC(uint32_t, free_ast_node_chunks,
+            num_free_ast_node_chunks + pool->num_chunks);
+    int i;
+    for (i = 0; i < pool->num_chunks; i++)
+    {
+        ast_node_chunks[pool->chunks[i]] = NULL;
+        free_ast_node_chunks[num_free_ast_node_chunks] = pool->chunks[i];
+        num_free_ast_node_chunks++;
+    }
+
+    DELETE(pool->chunks);
+    DELETE(pool);
+}
+
+mem_arena_t* ast_get_arena(void)
+{
+    return ast_arena;
+}
+
+void ast_persistent_begin(void)
+{
+    ast_persistent_level++;
+}
+
+void ast_persistent_end(void)
+{
+    ERROR_CONDITION(ast_persistent_level == 0, "Unbalanced ast_persistent_end", 0);
+    ast_persistent_level--;
+}
+
+AST ast_new_node(void)
+{
+    AST result = NULL;
+    if (current_arena_pool != NULL
+            && ast_persistent_level == 0)
+    {
+        result = ast_pool_alloc(current_arena_pool);
+        result->node_in_arena = 1;
+        result->data_in_arena = 1;
+    }
+    else
+    {
+        result = ast_pool_alloc(&persistent_pool);
+    }
+    return result;
+}
+
+void* ast_alloc_data(const_AST a, size_t size)
+{
+    if (size == 0)
+        return NULL;
+
+    if (a->data_in_arena)
+    {
+        ERROR_CONDITION(ast_arena == NULL, "Node %p belongs to an arena already destroyed", a);
+        return mem_arena_alloc(ast_arena, size);
+    }
+
+    return xmalloc(size);
+}
+
+void* ast_realloc_data(const_AST a, void* p, size_t old_size, size_t new_size)
+{
+    if (!a->data_in_arena)
+        return xrealloc(p, new_size);
+
+    void* result = ast_alloc_data(a, new_size);
+    if (p != NULL)
+        memcpy(result, p, old_size < new_size ? old_size : new_size);
+
+    return result;
+}
+
+void ast_free_data(const_AST a, void* p)
+{
+    if (!a->data_in_arena)
+        DELETE(p);
+}
 
 /**
   Checks that nodes are really doubly-linked.
@@ -83,23 +323,24 @@ char ast_check(const_AST root)
         {
             for (i = 0; i < MCXX_MAX_AST_CHILDREN && ok; i++)
             {
-                AST c = ast_get_child(node, i);
-                if (c != NULL)
+                if (!ast_has_son(node, i))
+                    continue;
+
+                // Compare the indexes, no need to find the parent
+                AST c = ast_node_from_index(node->children[i]);
+                if (c->parent != node->index)
                 {
-                    if (ast_get_parent(c) != node)
-                    {
-                        AST wrong_parent = ast_get_parent(c);
-                        fprintf(stderr, "Child %d of %s (%s, %p) does not correctly relink. Instead it points to %s (%s, %p)\n",
-                                i, ast_location(node), ast_print_node_type(ast_get_kind(node)), node,
-                                wrong_parent == NULL ? "(null)" : ast_location(wrong_parent),
-                                wrong_parent == NULL ? "null" : ast_print_node_type(ast_get_kind(wrong_parent)),
-                                wrong_parent);
-                        ok = 0;
-                    }
-                    else
-                    {
-                        PUSH_BACK(c);
-                    }
+                    AST wrong_parent = ast_get_parent(c);
+                    fprintf(stderr, "Child %d of %s (%s, %p) does not correctly relink. Instead it points to %s (%s, %p)\n",
+                            i, ast_location(node), ast_print_node_type(ast_get_kind(node)), node,
+                            wrong_parent == NULL ? "(null)" : ast_location(wrong_parent),
+                            wrong_parent == NULL ? "null" : ast_print_node_type(ast_get_kind(wrong_parent)),
+                            wrong_parent);
+                    ok = 0;
+                }
+                else
+                {
+                    PUSH_BACK(c);
                 }
             }
 
@@ -248,13 +489,12 @@ void ast_free(AST root)
             continue;
 
         // Already visited. See below
-        if (__builtin_expect(((((intptr_t)a->parent) & 0x1) == 0x1), 0))
+        if (__builtin_expect(a->visited, 0))
             continue;
 
         // Tag this node as visited to avoid infinite recursion under the
-        // presence of cycles (note that this works as long as AST pointers are
-        // at least aligned to two bytes)
-        a->parent = (struct AST_tag *)(((intptr_t)a->parent) | 0x1);
+        // presence of cycles
+        a->visited = 1;
 
         if (ast_get_kind(a) == AST_AMBIGUITY)
         {
@@ -273,22 +513,69 @@ void ast_free(AST root)
             }
         }
 
-        DELETE(a->expr_info);
-        DELETE(a->children);
-        // Clear the node for safety
-        // __builtin_memset(a, 0, sizeof(*a));
-        DELETE(a);
+        // Nodes in the arena are released all at once
+        ast_free_data(a, a->expr_info);
+        if (ast_get_kind(a) == AST_AMBIGUITY)
+            ast_free_data(a, a->ambig);
+
+        if (!a->node_in_arena)
+        {
+            // The node keeps being visited until it is allocated again
+            a->children[0] = persistent_pool.free_list;
+            persistent_pool.free_list = a->index;
+        }
     }
 
     DELETE(stack);
 #undef PUSH_BACK
 }
 
+// Copies src into dest but dest keeps living where it was allocated. dest
+// gets its own copy of the extended data of src, allocated with that of dest,
+// and its previous extended data is released
+static void ast_copy_node_contents(AST dest, const_AST src)
+{
+    AST_node_t old_dest = *dest;
+    AST_node_t src_node = *src;
+
+    *dest = src_node;
+    dest->node_in_arena = old_dest.node_in_arena;
+    dest->data_in_arena = old_dest.data_in_arena;
+    dest->index = old_dest.index;
+    dest->structural_hash_valid = 0;
+
+    dest->expr_info = NULL;
+    if (src_node.expr_info != NULL)
+    {
+        dest->expr_info = (nodecl_expr_info_t*)ast_alloc_data(dest, sizeof(*dest->expr_info));
+        *dest->expr_info = *src_node.expr_info;
+    }
+
+    if (src_node.node_type == AST_AMBIGUITY)
+    {
+        dest->ambig = (AST*)ast_alloc_data(dest, sizeof(AST) * src_node.num_ambig);
+        if (src_node.num_ambig > 0)
+            memcpy(dest->ambig, src_node.ambig, sizeof(AST) * src_node.num_ambig);
+    }
+
+    ast_free_data(&old_dest, old_dest.expr_info);
+    if (old_dest.node_type == AST_AMBIGUITY)
+        ast_free_data(&old_dest, old_dest.ambig);
+}
+
+void ast_replace(AST dest, const_AST src)
+{
+    ast_invalidate_structural_hash(dest);
+    ast_copy_node_contents(dest, src);
+}
+
 static void ast_copy_one_node(AST dest, AST orig)
 {
-    *dest = *orig;
+    ast_copy_node_contents(dest, orig);
+    dest->visited = 0;
     dest->bitmap_sons = 0;
-    dest->children = 0;
+    if (dest->node_type != AST_AMBIGUITY)
+        memset(dest->children, 0, sizeof(dest->children));
 }
 
 AST ast_duplicate_one_node(AST orig)
@@ -304,7 +591,7 @@ AST ast_copy(const_AST a)
     if (a == NULL)
         return NULL;
 
-    AST result = NEW0(AST_node_t);
+    AST result = ast_new_node();
 
     ast_copy_one_node(result, (AST)a);
 
@@ -312,8 +599,7 @@ AST ast_copy(const_AST a)
     if (a->node_type == AST_AMBIGUITY
             && a->num_ambig > 0)
     {
-        result->num_ambig = a->num_ambig;
-        result->ambig = NEW_VEC(AST, a->num_ambig);
+        // ast_copy_one_node already gave result its own array
         for (i = 0; i < a->num_ambig; i++)
         {
             result->ambig[i] = ast_copy(a->ambig[i]);
@@ -321,11 +607,6 @@ AST ast_copy(const_AST a)
     }
     else
     {
-        result->bitmap_sons = a->bitmap_sons;
-        int num_children = ast_count_bitmap(result->bitmap_sons);
-
-        result->children = NEW_VEC(AST, num_children);
-
         for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
         {
             AST c = ast_copy(ast_get_child(a, i));
@@ -339,7 +620,7 @@ AST ast_copy(const_AST a)
         result->text = a->text;
     }
 
-    result->parent = NULL;
+    result->parent = 0;
 
     return result;
 }
@@ -71,6 +71,12 @@ static inline void ast_set_text(AST a, const char* str);
 // Sets the kind
 static inline void ast_set_kind(AST a, node_t node_type);
 
+// Structural hash bookkeeping, see nodecl_structural_hash. Invalidating a
+// node also invalidates all its ancestors
+static inline void ast_invalidate_structural_hash(AST a);
+static inline char ast_structural_hash_is_valid(const_AST a);
+static inline void ast_set_structural_hash_valid(AST a);
+
 // Returns the children 'num_child'. Might be
 // NULL
 static inline AST ast_get_child(const_AST a, int num_child);
@@ -134,6 +140,28 @@ LIBMCXX_EXTERN char ast_check_list_tree(const_AST a);
 // Frees tree.
 LIBMCXX_EXTERN void ast_free(AST a);
 
+struct mem_arena_tag;
+
+// While an arena is set, new nodes and their data are allocated in it and
+// ast_free does not release them. They are all released at once when the
+// arena is destroyed, after setting another one
+LIBMCXX_EXTERN void ast_set_arena(struct mem_arena_tag* arena);
+LIBMCXX_EXTERN struct mem_arena_tag* ast_get_arena(void);
+// Must be called before destroying an arena that has been set. The nodes
+// in it cannot be used anymore
+LIBMCXX_EXTERN void ast_release_arena(struct mem_arena_tag* arena);
+
+// Nodes created between these two calls outlive the arena. Use them for
+// trees kept in caches shared by all translation units
+LIBMCXX_EXTERN void ast_persistent_begin(void);
+LIBMCXX_EXTERN void ast_persistent_end(void);
+
+// Allocation of nodes and of the data they own (children, extended data)
+LIBMCXX_EXTERN AST ast_new_node(void);
+LIBMCXX_EXTERN void* ast_alloc_data(const_AST a, size_t size);
+LIBMCXX_EXTERN void* ast_realloc_data(const_AST a, void* p, size_t old_size, size_t new_size);
+LIBMCXX_EXTERN void ast_free_data(const_AST a, void* p);
+
 // Gives a copy of all the tree but extended data is the same as original trees
 LIBMCXX_EXTERN AST ast_copy(const_AST a);
 
@@ -150,8 +178,9 @@ LIBMCXX_EXTERN AST ast_copy_for_instantiation(const_AST a);
 LIBMCXX_EXTERN void ast_clear_extended_data(AST a);
 
 // This makes a bitwise copy. You must know what you
-// are doing here! *dest = *src
-static inline void ast_replace(AST dest, const_AST src);
+// are doing here! *dest = *src, but dest keeps where it is allocated
+// and gets its own copy of the extended data of src
+LIBMCXX_EXTERN void ast_replace(AST dest, const_AST src);
 
 // Returns a string with a pair 'filename:line'
 static inline const char* ast_location(const_AST a);
@@ -4044,6 +4044,7 @@ static void gather_type_spec_from_friend_elaborated_class_specifier_common(
         // going to change its type
         scope_entry_t* new_dep = NEW0(scope_entry_t);
         *new_dep = *entry;
+        symbol_entity_specs_copy_cold_from(new_dep, entry);
         new_dep->type_information = set_dependent_entry_kind(entry->type_information, class_kind);
         new_dep->decl_context = decl_context;
 
@@ -4865,6 +4866,7 @@ static void gather_type_spec_from_elaborated_class_specifier(AST a,
                 scope_entry_t* old_entry = entry;
                 entry = NEW0(scope_entry_t);
                 *entry = *old_entry;
+                symbol_entity_specs_copy_cold_from(entry, old_entry);
 
                 keep_extra_attributes_in_symbol(entry, &class_gather_info);
             }
@@ -5368,6 +5370,24 @@ static scope_entry_list_t *query_flexible_builtin_type(
     return NULL;
 }
 
+char symbol_can_name_a_type(scope_entry_t* entry, char allow_class_template_names)
+{
+    return entry->kind == SK_ENUM
+        || entry->kind == SK_CLASS
+        || entry->kind == SK_TYPEDEF
+        || entry->kind == SK_TEMPLATE_TYPE_PARAMETER
+        || entry->kind == SK_TEMPLATE_TYPE_PARAMETER_PACK
+        || (allow_class_template_names
+                && entry->kind == SK_TEMPLATE
+                // Do not allow template-names of template functions
+                && named_type_get_symbol(template_type_get_primary_type(entry->type_information))->kind != SK_FUNCTION)
+        || (allow_class_template_names && entry->kind == SK_TEMPLATE_TEMPLATE_PARAMETER)
+        || (allow_class_template_names && entry->kind == SK_TEMPLATE_TEMPLATE_PARAMETER_PACK)
+        || entry->kind == SK_GCC_BUILTIN_TYPE
+        || entry->kind == SK_USING_TYPENAME
+        || entry->kind == SK_TEMPLATE_ALIAS;
+}
+
 static void common_gather_type_spec_from_simple_type_specifier(AST a,
         const decl_context_t* decl_context UNUSED_PARAMETER,
         type_t** type_info, gather_decl_spec_t* gather_info, scope_entry_list_t* query_results)
@@ -5395,20 +5415,7 @@ static void common_gather_type_spec_from_simple_type_specifier(AST a,
             entry_list_iterator_next(it))
     {
         scope_entry_t* entry = entry_advance_aliases(entry_list_iterator_current(it));
-        if (entry->kind != SK_ENUM
-                && entry->kind != SK_CLASS
-                && entry->kind != SK_TYPEDEF
-                && entry->kind != SK_TEMPLATE_TYPE_PARAMETER
-                && entry->kind != SK_TEMPLATE_TYPE_PARAMETER_PACK
-                && (!gather_info->allow_class_template_names
-                    || entry->kind != SK_TEMPLATE
-                    // Do not allow template-names of template functions
-                    || named_type_get_symbol(template_type_get_primary_type(entry->type_information))->kind == SK_FUNCTION)
-                && (!gather_info->allow_class_template_names || entry->kind != SK_TEMPLATE_TEMPLATE_PARAMETER)
-                && (!gather_info->allow_class_template_names || entry->kind != SK_TEMPLATE_TEMPLATE_PARAMETER_PACK)
-                && entry->kind != SK_GCC_BUILTIN_TYPE
-                && entry->kind != SK_USING_TYPENAME
-                && entry->kind != SK_TEMPLATE_ALIAS)
+        if (!symbol_can_name_a_type(entry, gather_info->allow_class_template_names))
         {
             error_printf_at(ast_get_locus(a), "identifier '%s' does not name a type\n",
                     prettyprint_in_buffer(a));
@@ -10364,6 +10371,7 @@ void gather_type_spec_from_class_specifier(AST a, type_t** type_info,
                     class_entry->symbol_name);
 
             *injected_symbol = *class_entry;
+            symbol_entity_specs_copy_cold_from(injected_symbol, class_entry);
             // the injected class name is logically in the class-scope
             injected_symbol->decl_context = inner_decl_context;
             injected_symbol->do_not_print = 1;
@@ -113,6 +113,10 @@ LIBMCXX_EXTERN void finish_class_type(struct type_tag* class_type, struct type_t
 
 LIBMCXX_EXTERN scope_entry_t* finish_anonymous_class(scope_entry_t* class_symbol, const decl_context_t* decl_context);
 
+// Whether entry, with its aliases advanced, can be named by a simple type
+// specifier
+LIBMCXX_EXTERN char symbol_can_name_a_type(scope_entry_t* entry, char allow_class_template_names);
+
 LIBMCXX_EXTERN void gather_type_spec_information(AST a, struct type_tag** type_info,
         gather_decl_spec_t *gather_info, const decl_context_t* dctx, nodecl_t* nodecl_output);
 
@@ -1739,10 +1739,15 @@ nodecl_t const_value_to_nodecl_with_basic_type(const_value_t* v,
     return const_value_to_nodecl_(v, basic_type, /* cached */ 0);
 }
 
+// Cached trees are shared by all translation units
 nodecl_t const_value_to_nodecl_with_basic_type_cached(const_value_t* v, 
         type_t* basic_type)
 {
-    return const_value_to_nodecl_(v, basic_type, /* cached */ 1);
+    ast_persistent_begin();
+    nodecl_t result = const_value_to_nodecl_(v, basic_type, /* cached */ 1);
+    ast_persistent_end();
+
+    return result;
 }
 
 nodecl_t const_value_to_nodecl(const_value_t* v)
@@ -1752,7 +1757,11 @@ nodecl_t const_value_to_nodecl(const_value_t* v)
 
 nodecl_t const_value_to_nodecl_cached(const_value_t* v)
 {
-    return const_value_to_nodecl_(v, /* basic_type */ NULL, /* cached */ 1);
+    ast_persistent_begin();
+    nodecl_t result = const_value_to_nodecl_(v, /* basic_type */ NULL, /* cached */ 1);
+    ast_persistent_end();
+
+    return result;
 }
 
 char const_value_is_integer(const_value_t* v)
@@ -74,9 +74,18 @@ struct diagnostic_context_stderr_tag
     diagnostic_context_t _base;
 };
 
+static FILE* diagnostic_transcript = NULL;
+
+void diagnostics_set_transcript(FILE* f)
+{
+    diagnostic_transcript = f;
+}
+
 static void diagnose_to_stderr(diagnostic_context_stderr_t* ctx, diagnostic_severity_t severity, const char* message)
 {
     fputs(message, stderr);
+    if (diagnostic_transcript != NULL)
+        fputs(message, diagnostic_transcript);
 
     switch (severity)
     {
@@ -30,6 +30,8 @@
 #include "cxx-macros.h"
 #include "cxx-locus.h"
 
+#include <stdio.h>
+
 MCXX_BEGIN_DECLS
 
 struct diagnostic_context_tag;
@@ -39,6 +41,10 @@ void diagnostics_reset(void);
 int diagnostics_get_error_count(void);
 int diagnostics_get_warn_count(void);
 
+// Diagnostics that reach stderr are also written to this stream unless it
+// is NULL. The compilation cache keeps them to replay them on a hit
+void diagnostics_set_transcript(FILE*);
+
 void error_printf_at(const locus_t*, const char* format, ...) CHECK_PRINTF(2,3);
 void warn_printf_at(const locus_t*, const char* format, ...)  CHECK_PRINTF(2,3);
 void info_printf_at(const locus_t*, const char* format, ...)  CHECK_PRINTF(2,3);
@@ -31,284 +31,190 @@
 #include <string.h>
 #include <stdint.h>
 
-#define NUM_IMMEDIATE 4
+// Most lists hold one or two entries, those are stored in the list itself.
+// Larger lists keep their entries in a contiguous buffer that grows by
+// doubling
+#define NUM_INLINE_ENTRIES 2
 
 unsigned long long _bytes_entry_lists;
 
-struct scope_entry_list_node_tag
-{
-    scope_entry_t* list[NUM_IMMEDIATE];
-    scope_entry_list_node_t* next;
-};
-
 struct scope_entry_list_tag
 {
     int num_items_list;
-    scope_entry_list_node_t* next;
+    // Number of slots in items
+    int capacity;
+    // Number of holders of this list. Copies share the list and the first
+    // modification through a shared list makes a private copy of it
+    int num_references;
+    scope_entry_t** items;
+    scope_entry_t* inline_items[NUM_INLINE_ENTRIES];
 };
 
-static scope_entry_list_node_t* entry_list_node_allocate(void)
+unsigned long long get_entry_list_bytes_allocated(void)
 {
-    return NEW0(scope_entry_list_node_t);
-}
-
-static scope_entry_list_t* entry_list_allocate(void)
-{
-    scope_entry_list_t* new_entry_list = NEW0(scope_entry_list_t);
-
-    new_entry_list->next = entry_list_node_allocate();
-
-    return new_entry_list;
+    return _bytes_entry_lists;
 }
 
-scope_entry_list_t* entry_list_new(scope_entry_t* entry)
+static scope_entry_list_t* entry_list_allocate(int capacity)
 {
-    scope_entry_list_t* result = entry_list_allocate();
-    result->num_items_list = 1;
-    result->next->list[0] = entry;
-
-    return result;
-}
+    scope_entry_list_t* result = NEW0(scope_entry_list_t);
+    _bytes_entry_lists += sizeof(*result);
 
-static void entry_list_add_to_pos_rec(scope_entry_list_node_t* list,
-        scope_entry_t* entry, int num_pos)
-{
-    if (num_pos < NUM_IMMEDIATE)
+    result->num_references = 1;
+    if (capacity <= NUM_INLINE_ENTRIES)
     {
-        list->list[num_pos] = entry;
+        result->capacity = NUM_INLINE_ENTRIES;
+        result->items = result->inline_items;
     }
     else
     {
-        if (list->next != NULL)
-        {
-            entry_list_add_to_pos_rec(list->next, entry, num_pos - NUM_IMMEDIATE);
-        }
-        else
-        {
-            // We need to create a new entry_list_node
-            scope_entry_list_node_t* new_node = entry_list_node_allocate();
-            list->next = new_node;
-            entry_list_add_to_pos_rec(list->next, entry, num_pos - NUM_IMMEDIATE);
-        }
+        result->capacity = capacity;
+        result->items = NEW_VEC(scope_entry_t*, capacity);
+        _bytes_entry_lists += capacity * sizeof(*result->items);
     }
+
+    return result;
 }
 
-static scope_entry_list_node_t* entry_list_prepend_rec(scope_entry_list_node_t* list,
-        scope_entry_t* entry,
-        int num_items)
+static void entry_list_reserve(scope_entry_list_t* list, int num_items)
 {
-    if (list == NULL)
+    if (num_items <= list->capacity)
+        return;
+
+    int new_capacity = 2 * list->capacity;
+    while (new_capacity < num_items)
+        new_capacity *= 2;
+
+    if (list->items == list->inline_items)
     {
-        scope_entry_list_node_t* new_entry_list = entry_list_node_allocate();
-        new_entry_list->list[0] = entry;
-        return new_entry_list;
+        list->items = NEW_VEC(scope_entry_t*, new_capacity);
+        memcpy(list->items, list->inline_items, list->num_items_list * sizeof(*list->items));
     }
     else
     {
-        scope_entry_t* last = list->list[NUM_IMMEDIATE - 1];
-        int i;
-        // -2 because we do not want to write past the last element
-        for (i = NUM_IMMEDIATE - 2; i >= 0; i--)
-        {
-            list->list[i+1] = list->list[i];
-        }
-        list->list[0] = entry;
-
-        if (num_items >= NUM_IMMEDIATE)
-        {
-            list->next = entry_list_prepend_rec(list->next, last, num_items - NUM_IMMEDIATE);
-        }
-        return list;
+        list->items = NEW_REALLOC(scope_entry_t*, list->items, new_capacity);
     }
+    _bytes_entry_lists += new_capacity * sizeof(*list->items);
+
+    list->capacity = new_capacity;
 }
 
-scope_entry_list_t* entry_list_prepend(scope_entry_list_t* list,
-        scope_entry_t* entry)
+static void entry_list_push(scope_entry_list_t* list, scope_entry_t* entry)
 {
-    scope_entry_list_t* result = NULL;
-    if (list == NULL)
-    {
-        result = entry_list_allocate();
-        result->next->list[0] = entry;
-        result->num_items_list = 1;
-        return result;
-    }
-    else
-    {
-        list->next = entry_list_prepend_rec(list->next, entry, list->num_items_list);
-        list->num_items_list++;
-        return list;
-    }
+    entry_list_reserve(list, list->num_items_list + 1);
+    list->items[list->num_items_list] = entry;
+    list->num_items_list++;
 }
 
-scope_entry_list_t* entry_list_add(scope_entry_list_t* list,
-        scope_entry_t* entry)
+static scope_entry_list_t* entry_list_copy_unshared(const scope_entry_list_t* list)
 {
-    if (list == NULL)
-    {
-        return entry_list_new(entry);
-    }
-    else
-    {
-        entry_list_add_to_pos_rec(list->next, entry, list->num_items_list);
-        list->num_items_list++;
+    scope_entry_list_t* result = entry_list_allocate(list->num_items_list);
+    memcpy(result->items, list->items, list->num_items_list * sizeof(*list->items));
+    result->num_items_list = list->num_items_list;
 
-        return list;
-    }
+    return result;
 }
 
-scope_entry_list_t* entry_list_add_once(scope_entry_list_t* list,
-        scope_entry_t* entry)
+// Returns a list that can be modified in place by the holder of list
+static scope_entry_list_t* entry_list_unshare(scope_entry_list_t* list)
 {
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(list);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        scope_entry_t* current = entry_list_iterator_current(it);
-
-        if (current == entry)
-        {
-            entry_list_iterator_free(it);
-            return list;
-        }
-    }
-    entry_list_iterator_free(it);
+    if (list->num_references == 1)
+        return list;
 
-    return entry_list_add(list, entry);
+    list->num_references--;
+    return entry_list_copy_unshared(list);
 }
 
-static void insert_and_shift_right(scope_entry_list_node_t* entry_list, int pos,
-        scope_entry_t* new_entry)
+scope_entry_list_t* entry_list_new(scope_entry_t* entry)
 {
-    if (entry_list == NULL)
-        return;
+    scope_entry_list_t* result = entry_list_allocate(1);
+    result->num_items_list = 1;
+    result->items[0] = entry;
 
-    scope_entry_t* keep = entry_list->list[NUM_IMMEDIATE-1];
+    return result;
+}
 
-    int j;
-    for (j = NUM_IMMEDIATE - 2; j >= pos; j--)
-    {
-        entry_list->list[j + 1] = entry_list->list[j];
-    }
+scope_entry_list_t* entry_list_prepend(scope_entry_list_t* list,
+        scope_entry_t* entry)
+{
+    if (list == NULL)
+        return entry_list_new(entry);
 
-    entry_list->list[pos] = new_entry;
+    list = entry_list_unshare(list);
+    entry_list_reserve(list, list->num_items_list + 1);
+    memmove(&list->items[1], &list->items[0], list->num_items_list * sizeof(*list->items));
+    list->items[0] = entry;
+    list->num_items_list++;
 
-    if (entry_list->next != NULL)
-    {
-        insert_and_shift_right(entry_list->next, 0, keep);
-    }
-    else if (entry_list->next == NULL && keep != NULL)
-    {
-        entry_list->next = entry_list_node_allocate();
-        entry_list_add_to_pos_rec(entry_list->next, keep, 0);
-    }
+    return list;
 }
 
-static char entry_list_add_after_rec(scope_entry_list_node_t* list,
-        scope_entry_t* position,
+scope_entry_list_t* entry_list_add(scope_entry_list_t* list,
         scope_entry_t* entry)
 {
     if (list == NULL)
-        return 0;
+        return entry_list_new(entry);
 
-    char found = 0;
-    int j;
-    for (j = 0; j < NUM_IMMEDIATE; j++)
-    {
-        if (list->next->list[j] == position)
-        {
-            found = 1;
-            break;
-        }
-    }
+    list = entry_list_unshare(list);
+    entry_list_push(list, entry);
 
-    if (!found)
-    {
-        // The current node does not contain the symbol 'position'.
-        // Try with the next node.
-        return entry_list_add_after_rec(list->next, position, entry);
-    }
+    return list;
+}
 
-    // The symbol 'position' has been found
+scope_entry_list_t* entry_list_add_once(scope_entry_list_t* list,
+        scope_entry_t* entry)
+{
+    if (entry_list_contains(list, entry))
+        return list;
 
-    // If this symbol is not in the last position of the current node we add
-    // entry in the current node
-    if (j < (NUM_IMMEDIATE-1))
-    {
-        insert_and_shift_right(list, j+1, entry);
-    }
-    // Otherwise, the symbol should be added in the next node
-    else
+    return entry_list_add(list, entry);
+}
+
+static int entry_list_find(const scope_entry_list_t* list, scope_entry_t* entry)
+{
+    int i;
+    for (i = 0; i < list->num_items_list; i++)
     {
-        //if the next node exists, we add the 'entry' symbol to its list
-        if (list->next != NULL)
-        {
-            insert_and_shift_right(list->next, 0, entry);
-        }
-        // Otherwise, we create a new node and add 'entry' symbol to its list
-        else
-        {
-            list->next = entry_list_node_allocate();
-            entry_list_add_to_pos_rec(list->next, entry, 0);
-        }
+        if (list->items[i] == entry)
+            return i;
     }
-    return 1;
+    return -1;
 }
 
-scope_entry_list_t* entry_list_add_after(scope_entry_list_t* list,
-        scope_entry_t* position,
+static scope_entry_list_t* entry_list_insert_at(scope_entry_list_t* list,
+        int pos,
         scope_entry_t* entry)
 {
-    char added_an_element = entry_list_add_after_rec(list->next, position, entry);
-
-    if (added_an_element)
-        list->num_items_list++;
+    list = entry_list_unshare(list);
+    entry_list_reserve(list, list->num_items_list + 1);
+    memmove(&list->items[pos + 1], &list->items[pos],
+            (list->num_items_list - pos) * sizeof(*list->items));
+    list->items[pos] = entry;
+    list->num_items_list++;
 
     return list;
 }
 
-static char entry_list_add_before_rec(
-        scope_entry_list_node_t* list,
+scope_entry_list_t* entry_list_add_after(scope_entry_list_t* list,
         scope_entry_t* position,
         scope_entry_t* entry)
 {
-    if (list == NULL)
-        return 0;
-
-    char found = 0;
-    int j;
-    for (j = 0; j < NUM_IMMEDIATE; j++)
-    {
-        if (list->list[j] == position)
-        {
-            found = 1;
-            break;
-        }
-    }
-
-    if (!found)
-    {
-        return entry_list_add_before_rec(list->next, position, entry);
-    }
-
-    // The symbol 'position' has been found
-
-    insert_and_shift_right(list, j, entry);
+    int pos = entry_list_find(list, position);
+    if (pos < 0)
+        return list;
 
-    return 1;
+    return entry_list_insert_at(list, pos + 1, entry);
 }
 
 scope_entry_list_t* entry_list_add_before(scope_entry_list_t* list,
         scope_entry_t* position,
         scope_entry_t* entry)
 {
-    char added_an_element = entry_list_add_before_rec(list->next, position, entry);
-
-    if (added_an_element)
-        list->num_items_list++;
+    int pos = entry_list_find(list, position);
+    if (pos < 0)
+        return list;
 
-    return list;
+    return entry_list_insert_at(list, pos, entry);
 }
 
 scope_entry_list_t* entry_list_copy(const scope_entry_list_t* list)
@@ -316,34 +222,11 @@ scope_entry_list_t* entry_list_copy(const scope_entry_list_t* list)
     if (list == NULL)
         return NULL;
 
-    scope_entry_list_t* result = NEW0(scope_entry_list_t);
-
-    result->num_items_list = list->num_items_list;
-    scope_entry_list_node_t* it = list->next;
-    scope_entry_list_node_t** current = &(result->next);
-
-    while (it != NULL)
-    {
-        *current = NEW0(scope_entry_list_node_t);
-        int i;
-        for (i = 0; i < NUM_IMMEDIATE; i++)
-        {
-            (*current)->list[i] = it->list[i];
-        }
-        current = &((*current)->next);
-        it = it->next;
-    }
+    // Lists are only modified through their holders so the copy can share
+    // the entries until any of them is modified
+    ((scope_entry_list_t*)list)->num_references++;
 
-    return result;
-}
-static void entry_list_node_free(scope_entry_list_node_t* list)
-{
-    if (list == NULL)
-        return;
-
-    entry_list_node_free(list->next);
-    memset(list, 0, sizeof(*list));
-    DELETE(list);
+    return (scope_entry_list_t*)list;
 }
 
 void entry_list_free(scope_entry_list_t* list)
@@ -351,7 +234,12 @@ void entry_list_free(scope_entry_list_t* list)
     if (list == NULL)
         return;
 
-    entry_list_node_free(list->next);
+    list->num_references--;
+    if (list->num_references > 0)
+        return;
+
+    if (list->items != list->inline_items)
+        DELETE(list->items);
     memset(list, 0, sizeof(*list));
     DELETE(list);
 }
@@ -368,7 +256,7 @@ int entry_list_size(const scope_entry_list_t* list)
 
 scope_entry_t* entry_list_head(const scope_entry_list_t* list)
 {
-    return list->next->list[0];
+    return list->items[0];
 }
 
 // -
@@ -376,47 +264,49 @@ scope_entry_t* entry_list_head(const scope_entry_list_t* list)
 struct scope_entry_list_iterator_tag
 {
     int current_pos;
-    int total_pos;
-    const scope_entry_list_node_t* current_list;
-    const scope_entry_list_t* first_list;
+    const scope_entry_list_t* list;
+
+    // Iterators are short lived, freed ones are kept here for reuse
+    scope_entry_list_iterator_t* next_free;
 };
 
+static scope_entry_list_iterator_t* free_iterators = NULL;
+
 static scope_entry_list_iterator_t* entry_list_iterator_allocate(void)
 {
-    return NEW0(scope_entry_list_iterator_t);
+    if (free_iterators == NULL)
+        return NEW0(scope_entry_list_iterator_t);
+
+    scope_entry_list_iterator_t* result = free_iterators;
+    free_iterators = result->next_free;
+    result->next_free = NULL;
+
+    return result;
 }
 
 scope_entry_list_iterator_t* entry_list_iterator_begin(const scope_entry_list_t* list)
 {
     scope_entry_list_iterator_t* result = entry_list_iterator_allocate();
-    result->first_list = list;
-    result->current_list = (list != NULL) ? list->next : NULL;
+    result->list = list;
     result->current_pos = 0;
-    result->total_pos = 0;
 
     return result;
 }
 
 scope_entry_t* entry_list_iterator_current(scope_entry_list_iterator_t* it)
 {
-    return it->current_list->list[it->current_pos];
+    return it->list->items[it->current_pos];
 }
 
 void entry_list_iterator_next(scope_entry_list_iterator_t* it)
 {
     it->current_pos++;
-    it->total_pos++;
-    if (it->current_pos == NUM_IMMEDIATE)
-    {
-        it->current_pos = 0;
-        it->current_list = it->current_list->next;
-    }
 }
 
 char entry_list_iterator_end(scope_entry_list_iterator_t* it)
 {
-    return (it->first_list == NULL
-            || (it->total_pos >= it->first_list->num_items_list));
+    return (it->list == NULL
+            || (it->current_pos >= it->list->num_items_list));
 }
 
 void entry_list_iterator_free(scope_entry_list_iterator_t* it)
@@ -424,7 +314,8 @@ void entry_list_iterator_free(scope_entry_list_iterator_t* it)
     if (it != NULL)
     {
         memset(it, 0, sizeof(*it));
-        DELETE(it);
+        it->next_free = free_iterators;
+        free_iterators = it;
     }
 }
 
@@ -444,45 +335,32 @@ static int ptr_comp(const void* p1, const void* p2)
 scope_entry_list_t* entry_list_merge(const scope_entry_list_t* list1, 
         const scope_entry_list_t* list2)
 {
-    int size1 = (list1 != NULL ? entry_list_size(list1) : 0);
+    int size1 = entry_list_size(list1);
     scope_entry_t** elems1 = NEW_VEC0(scope_entry_t*, size1 + 1);
-    scope_entry_t** p = elems1;
+    if (size1 > 0)
+        memcpy(elems1, list1->items, size1 * sizeof(*elems1));
 
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(list1);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        scope_entry_t* entry = entry_list_iterator_current(it);
-        *p = entry;
-        p++;
-    }
-    entry_list_iterator_free(it);
-
-    int size2 = (list2 != NULL ? entry_list_size(list2) : 0);
+    int size2 = entry_list_size(list2);
     scope_entry_t** elems2 = NEW_VEC0(scope_entry_t*, size2 + 1);
-
-    scope_entry_t** q = elems2;
-
-    for (it = entry_list_iterator_begin(list2);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        scope_entry_t* entry = entry_list_iterator_current(it);
-        *q = entry;
-        q++;
-    }
-    entry_list_iterator_free(it);
+    if (size2 > 0)
+        memcpy(elems2, list2->items, size2 * sizeof(*elems2));
 
     //   void qsort(void *base, size_t nmemb, size_t size,
     //  int(*compar)(const void *, const void *));
     qsort(elems1, size1, sizeof(*elems1), ptr_comp);
     qsort(elems2, size2, sizeof(*elems2), ptr_comp);
 
-    p = elems1;
-    q = elems2;
+    scope_entry_t** p = elems1;
+    scope_entry_t** q = elems2;
 
-    scope_entry_list_t* result = NULL;
+    if (size1 + size2 == 0)
+    {
+        DELETE(elems2);
+        DELETE(elems1);
+        return NULL;
+    }
+
+    scope_entry_list_t* result = entry_list_allocate(size1 + size2);
 
     while (*p != NULL
             && *q != NULL)
@@ -496,18 +374,18 @@ scope_entry_list_t* entry_list_merge(const scope_entry_list_t* list1,
 
         if (*p < *q)
         {
-            result = entry_list_add(result, *p);
+            entry_list_push(result, *p);
             p++;
         }
         else if (*q < *p)
         {
-            result = entry_list_add(result, *q);
+            entry_list_push(result, *q);
             q++;
         }
         else
         {
             // They are equal, add it just once
-            result = entry_list_add(result, *p);
+            entry_list_push(result, *p);
             p++;
             q++;
         }
@@ -515,12 +393,12 @@ scope_entry_list_t* entry_list_merge(const scope_entry_list_t* list1,
 
     while (*p != NULL)
     {
-        result = entry_list_add(result, *p);
+        entry_list_push(result, *p);
         p++;
     }
     while (*q != NULL)
     {
-        result = entry_list_add(result, *q);
+        entry_list_push(result, *q);
         q++;
     }
 
@@ -536,69 +414,75 @@ char entry_list_contains(const scope_entry_list_t* list,
     if (list == NULL)
         return 0;
 
-    char result = 0;
+    return entry_list_find(list, entry) >= 0;
+}
+
+scope_entry_list_t* entry_list_remove(scope_entry_list_t* entry_list, scope_entry_t* entry)
+{
+    if (entry_list == NULL
+            || !entry_list_contains(entry_list, entry))
+        return entry_list;
+
+    entry_list = entry_list_unshare(entry_list);
 
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(list);
-            !entry_list_iterator_end(it) && !result;
-            entry_list_iterator_next(it))
+    int i, j = 0;
+    for (i = 0; i < entry_list->num_items_list; i++)
     {
-        if (entry_list_iterator_current(it) == entry)
+        if (entry_list->items[i] != entry)
         {
-            result = 1;
+            entry_list->items[j] = entry_list->items[i];
+            j++;
         }
     }
-    entry_list_iterator_free(it);
-
-    return result;
-}
-
-static scope_entry_t* shift_left_all_elements_from_pos(scope_entry_list_node_t* entry_list, int pos)
-{
-    if (entry_list == NULL)
-        return NULL;
-
-    int j;
-    scope_entry_t* first_element = entry_list->list[0];
-    for (j = pos + 1; j < NUM_IMMEDIATE; j++)
+    for (i = j; i < entry_list->num_items_list; i++)
     {
-        entry_list->list[j - 1] = entry_list->list[j];
+        entry_list->items[i] = NULL;
     }
+    entry_list->num_items_list = j;
 
-    entry_list->list[NUM_IMMEDIATE - 1] = shift_left_all_elements_from_pos(entry_list->next, 0);
-
-    return first_element;
+    return entry_list;
 }
 
-
-static int entry_list_remove_rec(scope_entry_list_node_t* entry_list, scope_entry_t* entry)
+scope_entry_list_t* entry_list_filter(const scope_entry_list_t* list,
+        char (*f)(scope_entry_t*, void*),
+        void* data)
 {
-    if (entry_list == NULL)
-        return 0;
+    if (list == NULL)
+        return NULL;
 
+    // Nothing is allocated until the first entry is filtered out
+    scope_entry_list_t* result = NULL;
     int i;
-    int number_of_matches = 0;
-    for (i = 0; i < NUM_IMMEDIATE; i++)
+    for (i = 0; i < list->num_items_list; i++)
     {
-        if (entry_list->list[i] == entry)
+        scope_entry_t* entry = list->items[i];
+        char keep = f(entry, data);
+
+        if (result != NULL)
+        {
+            if (keep)
+                entry_list_push(result, entry);
+        }
+        else if (!keep)
         {
-            number_of_matches++;
-            shift_left_all_elements_from_pos(entry_list, i);
+            result = entry_list_allocate(list->num_items_list - 1);
+            memcpy(result->items, list->items, i * sizeof(*list->items));
+            result->num_items_list = i;
         }
     }
 
-    return (entry_list_remove_rec(entry_list->next, entry) + number_of_matches);
-}
-
-scope_entry_list_t* entry_list_remove(scope_entry_list_t* entry_list, scope_entry_t* entry)
-{
-    if (entry_list == NULL)
-        return entry_list;
-
-    int number_of_matches = entry_list_remove_rec(entry_list->next, entry);
+    if (result == NULL)
+    {
+        // Everything has been kept
+        return entry_list_copy(list);
+    }
+    else if (result->num_items_list == 0)
+    {
+        entry_list_free(result);
+        return NULL;
+    }
 
-    entry_list->num_items_list -= number_of_matches;
-    return entry_list;
+    return result;
 }
 
 void entry_list_to_symbol_array(scope_entry_list_t* list, scope_entry_t*** array, int* num_items)
@@ -606,14 +490,9 @@ void entry_list_to_symbol_array(scope_entry_list_t* list, scope_entry_t*** array
     int size = entry_list_size(list);
     *array = NEW_VEC0(scope_entry_t*, size);
 
-    *num_items = 0;
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(list); !entry_list_iterator_end(it); entry_list_iterator_next(it))
-    {
-        (*array)[*num_items] = entry_list_iterator_current(it);
-        (*num_items)++;
-    }
-    entry_list_iterator_free(it);
+    if (size > 0)
+        memcpy(*array, list->items, size * sizeof(**array));
+    *num_items = size;
 }
 
 scope_entry_list_t* entry_list_from_symbol_array(int num_items, scope_entry_t** list)
@@ -623,35 +502,27 @@ scope_entry_list_t* entry_list_from_symbol_array(int num_items, scope_entry_t**
         return NULL;
     }
 
-    scope_entry_list_t* result = entry_list_allocate();
-    int ind;
-    for (ind = 0; ind < num_items; ++ind)
-    {
-        result = entry_list_add(result, list[ind]);
-    }
+    scope_entry_list_t* result = entry_list_allocate(num_items);
+    memcpy(result->items, list, num_items * sizeof(*list));
+    result->num_items_list = num_items;
+
     return result;
 }
 
 scope_entry_list_t* entry_list_concat(const scope_entry_list_t* a, const scope_entry_list_t* b)
 {
-    scope_entry_list_t* result = NULL;
+    int size_a = entry_list_size(a);
+    int size_b = entry_list_size(b);
 
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(a);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        result = entry_list_add(result, entry_list_iterator_current(it));
-    }
-    entry_list_iterator_free(it);
+    if (size_a + size_b == 0)
+        return NULL;
 
-    for (it = entry_list_iterator_begin(b);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        result = entry_list_add(result, entry_list_iterator_current(it));
-    }
-    entry_list_iterator_free(it);
+    scope_entry_list_t* result = entry_list_allocate(size_a + size_b);
+    if (size_a > 0)
+        memcpy(result->items, a->items, size_a * sizeof(*a->items));
+    if (size_b > 0)
+        memcpy(result->items + size_a, b->items, size_b * sizeof(*b->items));
+    result->num_items_list = size_a + size_b;
 
     return result;
 }
@@ -91,6 +91,15 @@ LIBMCXX_EXTERN WARN_UNUSED scope_entry_list_t* entry_list_from_symbol_array(int
 
 LIBMCXX_EXTERN WARN_UNUSED scope_entry_list_t* entry_list_concat(const scope_entry_list_t*, const scope_entry_list_t*);
 
+// Entries of list for which f holds. When all of them hold the result
+// shares list and nothing is allocated
+LIBMCXX_EXTERN WARN_UNUSED scope_entry_list_t* entry_list_filter(const scope_entry_list_t* list,
+        char (*f)(scope_entry_t*, void*),
+        void* data);
+
+// Bytes allocated for entry lists so far
+LIBMCXX_EXTERN unsigned long long get_entry_list_bytes_allocated(void);
+
 MCXX_END_DECLS
 
 #endif // CXX_ENTRYLIST_H
@@ -26607,6 +26607,494 @@ constexpr_function_set_constants_of_arguments(
 #undef ERROR_MESSAGE_THIS
 }
 
+// Values of constexpr function calls in the current translation unit, keyed
+// by the called function and the values of its arguments. Constant values
+// are unique so comparing them is just comparing pointers. Only calls that
+// yield a value are remembered, failed evaluations are always repeated so
+// their diagnostics are emitted again
+typedef
+struct constexpr_call_cache_entry_tag
+{
+    scope_entry_t* function;
+    int num_arguments;
+    const_value_t** arguments;
+    const_value_t* value;
+
+    struct constexpr_call_cache_entry_tag* next;
+} constexpr_call_cache_entry_t;
+
+static ohash_u64_t* constexpr_call_cache = NULL;
+static translation_unit_t* constexpr_call_cache_translation_unit = NULL;
+static unsigned long constexpr_call_cache_hits = 0;
+static unsigned long constexpr_call_cache_misses = 0;
+
+void get_constexpr_call_cache_stats(unsigned long* hits, unsigned long* misses)
+{
+    *hits = constexpr_call_cache_hits;
+    *misses = constexpr_call_cache_misses;
+}
+
+static void constexpr_call_cache_free_entries(uint64_t key UNUSED_PARAMETER,
+        void* info, void* walk_info UNUSED_PARAMETER)
+{
+    constexpr_call_cache_entry_t* entry = (constexpr_call_cache_entry_t*)info;
+    while (entry != NULL)
+    {
+        constexpr_call_cache_entry_t* next = entry->next;
+        DELETE(entry->arguments);
+        DELETE(entry);
+        entry = next;
+    }
+}
+
+static char constexpr_call_can_be_cached(scope_entry_t* entry)
+{
+    // Nonstatic member functions bind 'this' to a new temporary in every call
+    return !debug_options.disable_constexpr_cache
+        && compilation_process.current_file_process != NULL
+        && (!symbol_entity_specs_get_is_member(entry)
+                || symbol_entity_specs_get_is_static(entry)
+                || symbol_entity_specs_get_is_constructor(entry));
+}
+
+static uint64_t constexpr_call_cache_key(scope_entry_t* entry,
+        int num_arguments,
+        const_value_t** arguments)
+{
+    uint64_t h = (uint64_t)(uintptr_t)entry;
+    int i;
+    for (i = 0; i < num_arguments; i++)
+    {
+        h ^= (uint64_t)(uintptr_t)arguments[i] + UINT64_C(0x9e3779b97f4a7c15) + (h << 6) + (h >> 2);
+    }
+    return h;
+}
+
+static constexpr_call_cache_entry_t* constexpr_call_cache_query(scope_entry_t* entry,
+        int num_arguments,
+        const_value_t** arguments,
+        uint64_t* key)
+{
+    if (constexpr_call_cache_translation_unit != CURRENT_COMPILED_FILE)
+    {
+        if (constexpr_call_cache != NULL)
+        {
+            ohash_u64_walk(constexpr_call_cache, constexpr_call_cache_free_entries, NULL);
+            ohash_u64_destroy(constexpr_call_cache);
+        }
+        constexpr_call_cache = ohash_u64_new(5);
+        constexpr_call_cache_translation_unit = CURRENT_COMPILED_FILE;
+    }
+
+    *key = constexpr_call_cache_key(entry, num_arguments, arguments);
+
+    constexpr_call_cache_entry_t* cached =
+        (constexpr_call_cache_entry_t*)ohash_u64_query(constexpr_call_cache, *key);
+    while (cached != NULL
+            && (cached->function != entry
+                || cached->num_arguments != num_arguments
+                || memcmp(cached->arguments, arguments,
+                    num_arguments * sizeof(*arguments)) != 0))
+        cached = cached->next;
+
+    return cached;
+}
+
+// The cache takes ownership of 'arguments'
+static void constexpr_call_cache_insert(scope_entry_t* entry,
+        int num_arguments,
+        const_value_t** arguments,
+        uint64_t key,
+        const_value_t* value)
+{
+    constexpr_call_cache_entry_t* cached = NEW0(constexpr_call_cache_entry_t);
+    cached->function = entry;
+    cached->num_arguments = num_arguments;
+    cached->arguments = arguments;
+    cached->value = value;
+
+    cached->next = (constexpr_call_cache_entry_t*)ohash_u64_push(constexpr_call_cache, key, cached);
+}
+
+// Values of the arguments of a call, fails if any of them is not constant
+static char constexpr_call_get_arguments(nodecl_t converted_arg_list,
+        int *num_arguments,
+        const_value_t*** arguments)
+{
+    nodecl_t* list_of_arguments = nodecl_unpack_list(converted_arg_list, num_arguments);
+    argument_list_remove_default_arguments(list_of_arguments, *num_arguments);
+
+    *arguments = NEW_VEC(const_value_t*, *num_arguments);
+
+    int i;
+    for (i = 0; i < *num_arguments; i++)
+    {
+        (*arguments)[i] = nodecl_get_constant(list_of_arguments[i]);
+        if ((*arguments)[i] == NULL)
+        {
+            DELETE(list_of_arguments);
+            DELETE(*arguments);
+            *arguments = NULL;
+            return 0;
+        }
+    }
+    DELETE(list_of_arguments);
+
+    return 1;
+}
+
+// Every call and every node interpreted is a step of the outermost constexpr
+// evaluation. Once the limit is exceeded the whole evaluation gives up
+static int constexpr_evaluation_nesting = 0;
+static int constexpr_evaluation_steps = 0;
+static char constexpr_evaluation_steps_exceeded = 0;
+
+static int constexpr_evaluation_max_steps(void)
+{
+    if (compilation_process.constexpr_steps > 0)
+        return compilation_process.constexpr_steps;
+    return MCXX_MAX_CONSTEXPR_EVALUATION_STEPS;
+}
+
+static char constexpr_evaluation_step(void)
+{
+    if (constexpr_evaluation_steps_exceeded)
+        return 0;
+
+    constexpr_evaluation_steps++;
+    if (constexpr_evaluation_steps > constexpr_evaluation_max_steps())
+    {
+        DEBUG_CODE()
+        {
+            fprintf(stderr, "EXPRTYPE: Constexpr evaluation exceeded the limit of %d steps\n",
+                    constexpr_evaluation_max_steps());
+        }
+        constexpr_evaluation_steps_exceeded = 1;
+        return 0;
+    }
+
+    return 1;
+}
+
+static const_value_t* constexpr_function_evaluate_returned_expression(
+        scope_entry_t* entry);
+
+// Evaluates a call to a nonmember or static member constexpr function whose
+// arguments are already known. Functions that still have to be instantiated
+// or defined are left to evaluate_constexpr_regular_function_call
+static const_value_t* constexpr_call_evaluate_with_values(scope_entry_t* entry,
+        int num_arguments,
+        const_value_t** arguments)
+{
+    if (!entry->defined
+            || function_may_be_instantiated(entry)
+            || nodecl_is_null(symbol_entity_specs_get_function_code(entry)))
+        return NULL;
+
+    uint64_t key = 0;
+    char can_be_cached = constexpr_call_can_be_cached(entry);
+    if (can_be_cached)
+    {
+        constexpr_call_cache_entry_t* cached = constexpr_call_cache_query(entry,
+                num_arguments, arguments, &key);
+        if (cached != NULL)
+        {
+            constexpr_call_cache_hits++;
+            return cached->value;
+        }
+        constexpr_call_cache_misses++;
+    }
+
+    if (!constexpr_evaluation_step())
+        return NULL;
+
+    stacked_map_of_values_push();
+    int i;
+    for (i = 0; i < num_arguments; i++)
+    {
+        stacked_map_of_values_set_value(
+                symbol_entity_specs_get_related_symbols_num(entry, i),
+                arguments[i]);
+    }
+
+    const_value_t* value = constexpr_function_evaluate_returned_expression(entry);
+    stacked_map_of_values_pop();
+
+    if (can_be_cached
+            && value != NULL)
+    {
+        const_value_t** copied_arguments = NEW_VEC(const_value_t*, num_arguments);
+        memcpy(copied_arguments, arguments, num_arguments * sizeof(*arguments));
+        constexpr_call_cache_insert(entry, num_arguments, copied_arguments, key, value);
+    }
+
+    return value;
+}
+
+// Only scalar values are interpreted, anything else is left to the checker
+static char constexpr_interpreted_type(type_t* t)
+{
+    return t != NULL
+        && !is_any_reference_type(t)
+        && !is_dependent_type(t)
+        && ((is_integral_type(t) && !is_mask_type(t))
+                || is_floating_type(t)
+                || is_enum_type(t));
+}
+
+static const_value_t* constexpr_interpret_expression(nodecl_t n);
+
+static const_value_t* constexpr_interpret_function_call(nodecl_t n)
+{
+    nodecl_t called = nodecl_get_child(n, 0);
+    if (nodecl_get_kind(called) != NODECL_SYMBOL)
+        return NULL;
+
+    scope_entry_t* entry = nodecl_get_symbol(called);
+    if (entry->kind != SK_FUNCTION
+            || !symbol_entity_specs_get_is_constexpr(entry)
+            || symbol_entity_specs_get_is_builtin(entry)
+            || symbol_entity_specs_get_is_constructor(entry)
+            || (symbol_entity_specs_get_is_member(entry)
+                && !symbol_entity_specs_get_is_static(entry))
+            || function_type_get_has_ellipsis(entry->type_information))
+        return NULL;
+
+    int num_arguments = 0;
+    nodecl_t* list_of_arguments = nodecl_unpack_list(nodecl_get_child(n, 1), &num_arguments);
+    argument_list_remove_default_arguments(list_of_arguments, num_arguments);
+
+    if (num_arguments != function_type_get_num_parameters(entry->type_information)
+            || num_arguments > symbol_entity_specs_get_num_related_symbols(entry))
+    {
+        DELETE(list_of_arguments);
+        return NULL;
+    }
+
+    const_value_t** arguments = NEW_VEC(const_value_t*, num_arguments);
+
+    char all_ok = 1;
+    int i;
+    for (i = 0; i < num_arguments && all_ok; i++)
+    {
+        // Reference parameters are bound to objects, not values
+        scope_entry_t* parameter = symbol_entity_specs_get_related_symbols_num(entry, i);
+        arguments[i] = NULL;
+        if (parameter->kind == SK_VARIABLE
+                && !is_any_reference_type(parameter->type_information))
+            arguments[i] = constexpr_interpret_expression(list_of_arguments[i]);
+        all_ok = (arguments[i] != NULL);
+    }
+    DELETE(list_of_arguments);
+
+    const_value_t* value = NULL;
+    if (all_ok)
+        value = constexpr_call_evaluate_with_values(entry, num_arguments, arguments);
+    DELETE(arguments);
+
+    return value;
+}
+
+// Computes the value of an already checked expression of the body of a
+// constexpr function using the values of its parameters. Returns NULL for the
+// expressions it does not handle
+static const_value_t* constexpr_interpret_expression(nodecl_t n)
+{
+    if (!constexpr_evaluation_step())
+        return NULL;
+
+    type_t* t = nodecl_get_type(n);
+    if (!constexpr_interpreted_type(t))
+        return NULL;
+
+    if (nodecl_is_constant(n))
+        return nodecl_get_constant(n);
+
+    const_value_t* (*const_value_bin_fun)(const_value_t*, const_value_t*) = NULL;
+    const_value_t* (*const_value_unary_fun)(const_value_t*) = NULL;
+
+    switch (nodecl_get_kind(n))
+    {
+        case NODECL_CONVERSION:
+            {
+                nodecl_t nest = nodecl_get_child(n, 0);
+                type_t* nest_type = nodecl_get_type(nest);
+                if (!constexpr_interpreted_type(no_ref(nest_type)))
+                    return NULL;
+
+                const_value_t* value = NULL;
+                if (is_any_reference_type(nest_type))
+                {
+                    // Only the values of the parameters are known
+                    if (nodecl_get_kind(nest) != NODECL_SYMBOL)
+                        return NULL;
+
+                    scope_entry_t* entry = nodecl_get_symbol(nest);
+                    if (entry->kind != SK_VARIABLE
+                            || is_any_reference_type(entry->type_information)
+                            || stacked_map_of_values_get_value(entry) == NULL)
+                        return NULL;
+
+                    value = compute_value_of_symbol(entry, nodecl_get_locus(nest));
+                }
+                else
+                {
+                    value = constexpr_interpret_expression(nest);
+                }
+
+                return cxx_nodecl_make_value_conversion(no_ref(nest_type), t, value);
+            }
+        case NODECL_CONDITIONAL_EXPRESSION:
+            {
+                const_value_t* condition = constexpr_interpret_expression(nodecl_get_child(n, 0));
+                if (condition == NULL)
+                    return NULL;
+
+                return constexpr_interpret_expression(
+                        const_value_is_nonzero(condition)
+                        ? nodecl_get_child(n, 1)
+                        : nodecl_get_child(n, 2));
+            }
+        case NODECL_LOGICAL_AND:
+        case NODECL_LOGICAL_OR:
+            {
+                const_value_t* lhs = constexpr_interpret_expression(nodecl_get_child(n, 0));
+                if (lhs == NULL)
+                    return NULL;
+
+                // Like the checker, the rhs takes the value of the lhs when
+                // it does not have to be evaluated
+                if (nodecl_get_kind(n) == NODECL_LOGICAL_AND)
+                {
+                    if (const_value_is_zero(lhs))
+                        return const_value_and(lhs, lhs);
+                    const_value_bin_fun = const_value_and;
+                }
+                else
+                {
+                    if (const_value_is_nonzero(lhs))
+                        return const_value_or(lhs, lhs);
+                    const_value_bin_fun = const_value_or;
+                }
+
+                const_value_t* rhs = constexpr_interpret_expression(nodecl_get_child(n, 1));
+                if (rhs == NULL)
+                    return NULL;
+
+                return const_value_bin_fun(lhs, rhs);
+            }
+        case NODECL_FUNCTION_CALL:
+            {
+                return constexpr_interpret_function_call(n);
+            }
+        case NODECL_ADD: const_value_bin_fun = const_value_generalized_add; break;
+        case NODECL_MINUS: const_value_bin_fun = const_value_generalized_sub; break;
+        case NODECL_MUL: const_value_bin_fun = const_value_mul; break;
+        case NODECL_DIV: const_value_bin_fun = const_value_div; break;
+        case NODECL_MOD: const_value_bin_fun = const_value_mod; break;
+        case NODECL_BITWISE_SHL: const_value_bin_fun = const_value_bitshl; break;
+        case NODECL_ARITHMETIC_SHR:
+        case NODECL_BITWISE_SHR: const_value_bin_fun = const_value_shr; break;
+        case NODECL_BITWISE_AND: const_value_bin_fun = const_value_bitand; break;
+        case NODECL_BITWISE_OR: const_value_bin_fun = const_value_bitor; break;
+        case NODECL_BITWISE_XOR: const_value_bin_fun = const_value_bitxor; break;
+        case NODECL_LOWER_THAN: const_value_bin_fun = const_value_generalized_lt; break;
+        case NODECL_LOWER_OR_EQUAL_THAN: const_value_bin_fun = const_value_generalized_lte; break;
+        case NODECL_GREATER_THAN: const_value_bin_fun = const_value_generalized_gt; break;
+        case NODECL_GREATER_OR_EQUAL_THAN: const_value_bin_fun = const_value_generalized_gte; break;
+        case NODECL_EQUAL: const_value_bin_fun = const_value_generalized_eq; break;
+        case NODECL_DIFFERENT: const_value_bin_fun = const_value_generalized_neq; break;
+        case NODECL_PLUS: const_value_unary_fun = const_value_plus; break;
+        case NODECL_NEG: const_value_unary_fun = const_value_neg; break;
+        case NODECL_BITWISE_NOT: const_value_unary_fun = const_value_bitnot; break;
+        case NODECL_LOGICAL_NOT: const_value_unary_fun = const_value_not; break;
+        default:
+            return NULL;
+    }
+
+    if (const_value_unary_fun != NULL)
+    {
+        nodecl_t op = nodecl_get_child(n, 0);
+        if (!constexpr_interpreted_type(nodecl_get_type(op)))
+            return NULL;
+
+        const_value_t* value = constexpr_interpret_expression(op);
+        if (value == NULL)
+            return NULL;
+
+        return const_value_unary_fun(value);
+    }
+
+    nodecl_t lhs = nodecl_get_child(n, 0);
+    nodecl_t rhs = nodecl_get_child(n, 1);
+    // Pointer arithmetic is left to the checker
+    if (!constexpr_interpreted_type(nodecl_get_type(lhs))
+            || !constexpr_interpreted_type(nodecl_get_type(rhs)))
+        return NULL;
+
+    const_value_t* lhs_value = constexpr_interpret_expression(lhs);
+    if (lhs_value == NULL)
+        return NULL;
+    const_value_t* rhs_value = constexpr_interpret_expression(rhs);
+    if (rhs_value == NULL)
+        return NULL;
+
+    if ((nodecl_get_kind(n) == NODECL_DIV
+                || nodecl_get_kind(n) == NODECL_MOD)
+            && value_not_valid_for_divisor(rhs_value))
+        return NULL;
+
+    return const_value_bin_fun(lhs_value, rhs_value);
+}
+
+// Computes the value of the returned expression of a constexpr function once
+// the values of its parameters have been pushed. The expression is
+// interpreted first and checked again only if the interpreter cannot handle it
+static const_value_t* constexpr_function_evaluate_returned_expression(
+        scope_entry_t* entry)
+{
+    nodecl_t nodecl_function_code = symbol_entity_specs_get_function_code(entry);
+    ERROR_CONDITION(nodecl_is_null(nodecl_function_code), "Function lacks function code", 0);
+
+    nodecl_t nodecl_returned_expression =
+        constexpr_function_get_returned_expression(nodecl_function_code);
+
+    if (nodecl_is_null(nodecl_returned_expression))
+    {
+        DEBUG_CODE()
+        {
+            fprintf(stderr, "EXPRTYPE: Evaluation of regular constexpr did not find the return statement\n");
+        }
+        return NULL;
+    }
+
+    const_value_t* value = NULL;
+    if (!debug_options.disable_constexpr_cache)
+    {
+        value = constexpr_interpret_expression(nodecl_returned_expression);
+    }
+
+    if (value == NULL
+            && !constexpr_evaluation_steps_exceeded)
+    {
+        instantiation_symbol_map_t* instantiation_symbol_map = NULL;
+        if (symbol_entity_specs_get_is_member(entry))
+        {
+            instantiation_symbol_map = symbol_entity_specs_get_instantiation_symbol_map(entry);
+        }
+
+        nodecl_t nodecl_evaluated_expr = instantiate_expression(
+                nodecl_returned_expression,
+                nodecl_retrieve_context(nodecl_returned_expression),
+                instantiation_symbol_map,
+                /* pack_index */ -1);
+
+        value = nodecl_get_constant(nodecl_evaluated_expr);
+    }
+
+    return value;
+}
+
 static const_value_t* evaluate_constexpr_constructor(
         scope_entry_t* entry,
         nodecl_t converted_arg_list,
@@ -26974,38 +27462,8 @@ static const_value_t* evaluate_constexpr_regular_function_call(
         return NULL;
     }
 
-    nodecl_t nodecl_function_code = symbol_entity_specs_get_function_code(entry);
-    ERROR_CONDITION(nodecl_is_null(nodecl_function_code), "Function lacks function code", 0);
-
-    nodecl_t nodecl_returned_expression =
-        constexpr_function_get_returned_expression(nodecl_function_code);
-
-    nodecl_t nodecl_evaluated_expr = nodecl_null();
-    if (!nodecl_is_null(nodecl_returned_expression))
-    {
-        instantiation_symbol_map_t* instantiation_symbol_map = NULL;
-        if (symbol_entity_specs_get_is_member(entry))
-        {
-            instantiation_symbol_map = symbol_entity_specs_get_instantiation_symbol_map(entry);
-        }
-
-        nodecl_evaluated_expr = instantiate_expression(
-                nodecl_returned_expression,
-                nodecl_retrieve_context(nodecl_returned_expression),
-                instantiation_symbol_map,
-                /* pack_index */ -1);
-    }
-
-    DEBUG_CODE()
-    {
-        if (nodecl_is_null(nodecl_returned_expression))
-        {
-            fprintf(stderr, "EXPRTYPE: Evaluation of regular constexpr did not find the return statement\n");
-        }
-    }
-
-    if (nodecl_is_null(nodecl_returned_expression)
-        || !nodecl_is_constant(nodecl_evaluated_expr))
+    const_value_t* cval = constexpr_function_evaluate_returned_expression(entry);
+    if (cval == NULL)
     {
         DEBUG_CODE()
         {
@@ -27019,7 +27477,6 @@ static const_value_t* evaluate_constexpr_regular_function_call(
         }
     }
 
-    const_value_t* cval = nodecl_get_constant(nodecl_evaluated_expr);
     stacked_map_of_values_pop();
     return cval;
 }
@@ -27038,22 +27495,78 @@ static const_value_t* evaluate_constexpr_function_call(
                     get_qualified_symbol_name(entry, entry->decl_context)));
     }
 
+    if (constexpr_evaluation_nesting == 0)
+    {
+        constexpr_evaluation_steps = 0;
+        constexpr_evaluation_steps_exceeded = 0;
+    }
+
+    int num_arguments = 0;
+    const_value_t** arguments = NULL;
+    uint64_t key = 0;
+    char can_be_cached = constexpr_call_can_be_cached(entry)
+        && constexpr_call_get_arguments(converted_arg_list, &num_arguments, &arguments);
+    if (can_be_cached)
+    {
+        constexpr_call_cache_entry_t* cached = constexpr_call_cache_query(entry,
+                num_arguments, arguments, &key);
+        if (cached != NULL)
+        {
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "EXPRTYPE: Reusing the value '%s' of an earlier evaluation of this call\n",
+                        const_value_to_str(cached->value));
+            }
+            constexpr_call_cache_hits++;
+            DELETE(arguments);
+            return cached->value;
+        }
+        constexpr_call_cache_misses++;
+    }
+
     const_value_t* value = NULL;
-    if (symbol_entity_specs_get_is_constructor(entry))
+    constexpr_evaluation_nesting++;
+    if (constexpr_evaluation_step())
     {
-        value = evaluate_constexpr_constructor(
-                entry,
-                converted_arg_list,
-                decl_context,
-                locus);
+        if (symbol_entity_specs_get_is_constructor(entry))
+        {
+            value = evaluate_constexpr_constructor(
+                    entry,
+                    converted_arg_list,
+                    decl_context,
+                    locus);
+        }
+        else
+        {
+            value = evaluate_constexpr_regular_function_call(
+                    entry,
+                    converted_arg_list,
+                    decl_context,
+                    locus);
+        }
+    }
+    constexpr_evaluation_nesting--;
+
+    if (can_be_cached
+            && value != NULL)
+    {
+        constexpr_call_cache_insert(entry, num_arguments, arguments, key, value);
     }
     else
     {
-        value = evaluate_constexpr_regular_function_call(
-                entry,
-                converted_arg_list,
-                decl_context,
-                locus);
+        DELETE(arguments);
+    }
+
+    if (constexpr_evaluation_nesting == 0
+            && constexpr_evaluation_steps_exceeded
+            && check_expr_flags.must_be_constant)
+    {
+        error_printf_at(locus, "evaluation of constexpr %s '%s' exceeded the limit of %d steps, "
+                "use --constexpr-steps=<n> to increase it\n",
+                symbol_entity_specs_get_is_constructor(entry) ? "constructor" : "function",
+                print_decl_type_str(entry->type_information, entry->decl_context,
+                    get_qualified_symbol_name(entry, entry->decl_context)),
+                constexpr_evaluation_max_steps());
     }
 
     return value;
@@ -279,6 +279,10 @@ LIBMCXX_EXTERN char same_functional_expression(
 
 LIBMCXX_EXTERN type_t* clear_special_expr_type_variants(type_t* t);
 
+// Hits and misses of the values of constexpr calls remembered in the current
+// translation unit
+LIBMCXX_EXTERN void get_constexpr_call_cache_stats(unsigned long* hits, unsigned long* misses);
+
 // Used by the lexer
 char* interpret_schar(const char* schar, const locus_t* locus);
 
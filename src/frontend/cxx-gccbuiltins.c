@@ -33,6 +33,7 @@
 #include "cxx-cexpr.h"
 #include "cxx-diagnostic.h"
 #include "cxx-intelsupport.h"
+#include "cxx-lazybuiltins.h"
 #include <string.h>
 #include <math.h>
 
@@ -3641,12 +3642,24 @@ static scope_entry_t* solve_gcc_atomic_builtins_overload_name_generic(
     return NULL;
 }
 
+// Intel architecture gcc builtins
+#include "cxx-gccbuiltins-ia32-lazy.h"
+#include "cxx-gccbuiltins-ia32-deprecated-lazy.h"
+
+static char lazy_gcc_simd_builtins(const decl_context_t* decl_context, const char* name)
+{
+    char signed_in = lazy_builtin_sign_in(&gcc_builtins_ia32,
+            decl_context, name, "(gcc-builtin-ia32)");
+    signed_in = lazy_builtin_sign_in(&gcc_builtins_ia32_deprecated,
+            decl_context, name, "(gcc-builtin-ia32)") || signed_in;
+
+    return signed_in;
+}
+
 static void sign_in_gcc_simd_builtins(const decl_context_t* decl_context)
 {
-    // Intel architecture gcc builtins
-    const locus_t* builtins_locus = make_locus("(gcc-builtin-ia32)", 0, 0);
-#include "cxx-gccbuiltins-ia32.h"
-#include "cxx-gccbuiltins-ia32-deprecated.h"
+    // There are thousands of them, so they are only signed in when used
+    scope_add_lazy_symbols(decl_context, lazy_gcc_simd_builtins);
 }
 
 static void sign_in_simd_builtins(const decl_context_t* decl_context)
@@ -3684,6 +3697,14 @@ static type_t* get_unsigned_16x8_int(void)
 }
 #endif
 
+#include "cxx-gccbuiltins-arm-neon-lazy.h"
+
+static char lazy_gcc_builtins_neon(const decl_context_t* decl_context, const char* name)
+{
+    return lazy_builtin_sign_in(&gcc_builtins_arm_neon,
+            decl_context, name, "(gcc-builtin-arm)");
+}
+
 static void gcc_builtins_neon(const decl_context_t* decl_context)
 {
 
@@ -3798,8 +3819,7 @@ static void gcc_builtins_neon(const decl_context_t* decl_context)
         symbol_entity_specs_set_is_builtin(sym, 1);
     }
 
-    const locus_t* builtins_locus = make_locus("(gcc-builtin-arm)", 0, 0);
-#include "cxx-gccbuiltins-arm-neon.h"
+    scope_add_lazy_symbols(decl_context, lazy_gcc_builtins_neon);
 }
 
 extern void gcc_builtins_arm(const decl_context_t* global_context)
@@ -3821,6 +3841,14 @@ static type_t* query_builtin_typedef(const char* name, const decl_context_t* dec
     return get_user_defined_type(entry);
 }
 
+#include "cxx-gccbuiltins-arm64-neon-lazy.h"
+
+static char lazy_gcc_builtins_neon_arm64(const decl_context_t* decl_context, const char* name)
+{
+    return lazy_builtin_sign_in(&gcc_builtins_arm64_neon,
+            decl_context, name, "(gcc-builtin-aarch64)");
+}
+
 static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
 {
     int i, N;
@@ -3931,8 +3959,7 @@ static void gcc_builtins_neon_arm64(const decl_context_t* decl_context)
     GENERATE_NEON_VECTOR_BUILTINS
 #undef GENERATE_NEON_VECTOR
 
-    const locus_t* builtins_locus = make_locus("(gcc-builtin-aarch64)", 0, 0);
-#include "cxx-gccbuiltins-arm64-neon.h"
+    scope_add_lazy_symbols(decl_context, lazy_gcc_builtins_neon_arm64);
 }
 
 extern void gcc_builtins_arm64(const decl_context_t* global_context)
@@ -30,4 +30,17 @@
 
 typedef struct instantiation_symbol_map_tag instantiation_symbol_map_t;
 
+// Cost of the instantiations of a template in the current translation unit.
+// Time and bytes do not include those of the instantiations triggered by
+// them, which are accounted to their own templates
+typedef
+struct instantiation_stats_tag
+{
+    const char* name;
+    char is_class;
+    int num_instantiations;
+    double time;
+    unsigned long long bytes;
+} instantiation_stats_t;
+
 #endif // CXX_INSTANTIATION_DECLS_H
@@ -28,6 +28,7 @@
 
 
 #include <string.h>
+#include <sys/time.h>
 #include "cxx-utils.h"
 #include "cxx-ast.h"
 #include "cxx-solvetemplate.h"
@@ -44,6 +45,7 @@
 #include "cxx-graphviz.h"
 #include "cxx-diagnostic.h"
 #include "cxx-codegen.h"
+#include "ohash_ptr.h"
 
 #include "cxx-printscope.h"
 
@@ -59,6 +61,7 @@ static scope_entry_t* add_duplicate_member_to_class(
 
     *new_member = *member_of_template;
     symbol_clear_indirect_types(new_member);
+    symbol_entity_specs_copy_cold_from(new_member, member_of_template);
 
     symbol_entity_specs_set_is_member(new_member, 1);
     symbol_entity_specs_set_is_instantiable(new_member, 0);
@@ -1471,6 +1474,7 @@ static void instantiate_dependent_friend_function(
                     scope_entry_t* new_entry = NEW0(scope_entry_t);
                     memcpy(new_entry, current_temp_param->entry, sizeof(*current_temp_param->entry));
                     symbol_clear_indirect_types(new_entry);
+                    symbol_entity_specs_copy_cold_from(new_entry, current_temp_param->entry);
                     symbol_entity_specs_set_template_parameter_nesting(new_entry, 1);
                     current_temp_param->entry = new_entry;
                 }
@@ -1602,6 +1606,7 @@ static void instantiate_class_common(
                 inner_decl_context->current_scope, being_instantiated_sym->symbol_name);
 
         *injected_symbol = *being_instantiated_sym;
+        symbol_entity_specs_copy_cold_from(injected_symbol, being_instantiated_sym);
         // the injected class name is logically in the class-scope
         injected_symbol->decl_context = inner_decl_context;
         injected_symbol->do_not_print = 1;
@@ -1804,6 +1809,177 @@ static void instantiate_class_common(
     push_instantiated_entity(being_instantiated_sym);
 }
 
+static translation_unit_t* instantiation_stats_translation_unit = NULL;
+static ohash_ptr_t* instantiation_stats_index = NULL;
+static instantiation_stats_t** instantiation_stats = NULL;
+static int num_instantiation_stats = 0;
+
+// An instantiation being measured. Nested instantiations add their cost
+// here so it can be removed from the cost of this one
+typedef
+struct instantiation_measure_tag
+{
+    instantiation_stats_t* stats;
+    struct timeval start;
+    unsigned long long bytes_at_start;
+    double nested_time;
+    unsigned long long nested_bytes;
+} instantiation_measure_t;
+
+static instantiation_measure_t* instantiation_measures = NULL;
+static int num_instantiation_measures = 0;
+static int max_instantiation_measures = 0;
+
+static char instantiation_stats_are_enabled(void)
+{
+    return compilation_process.report_filename != NULL
+        && compilation_process.current_file_process != NULL;
+}
+
+static unsigned long long instantiation_bytes_allocated(void)
+{
+    return (unsigned long long)get_num_symbols_created() * sizeof(scope_entry_t)
+        + (unsigned long long)get_num_entity_specs_cold_created() * sizeof(entity_specifiers_cold_t)
+        + (unsigned long long)get_entry_list_bytes_allocated();
+}
+
+static void instantiation_stats_reset(void)
+{
+    int i;
+    for (i = 0; i < num_instantiation_stats; i++)
+    {
+        DELETE(instantiation_stats[i]);
+    }
+    DELETE(instantiation_stats);
+    instantiation_stats = NULL;
+    num_instantiation_stats = 0;
+
+    if (instantiation_stats_index != NULL)
+        ohash_ptr_destroy(instantiation_stats_index);
+    instantiation_stats_index = ohash_ptr_new(5);
+
+    instantiation_stats_translation_unit = CURRENT_COMPILED_FILE;
+}
+
+static instantiation_stats_t* instantiation_stats_get(scope_entry_t* template_sym, char is_class)
+{
+    if (instantiation_stats_translation_unit != CURRENT_COMPILED_FILE)
+        instantiation_stats_reset();
+
+    instantiation_stats_t* stats = (instantiation_stats_t*)ohash_ptr_query(
+            instantiation_stats_index, (const char*)template_sym);
+    if (stats == NULL)
+    {
+        stats = NEW0(instantiation_stats_t);
+        stats->name = get_qualified_symbol_name(template_sym, template_sym->decl_context);
+        stats->is_class = is_class;
+
+        ohash_ptr_insert(instantiation_stats_index, (const char*)template_sym, stats);
+        P_LIST_ADD(instantiation_stats, num_instantiation_stats, stats);
+    }
+
+    return stats;
+}
+
+static void instantiation_stats_begin(scope_entry_t* template_sym, char is_class)
+{
+    if (!instantiation_stats_are_enabled()
+            || template_sym == NULL)
+        return;
+
+    if (num_instantiation_measures == max_instantiation_measures)
+    {
+        max_instantiation_measures = (max_instantiation_measures == 0) ? 16 : 2 * max_instantiation_measures;
+        instantiation_measures = NEW_REALLOC(instantiation_measure_t,
+                instantiation_measures,
+                max_instantiation_measures);
+    }
+
+    instantiation_measure_t* measure = &instantiation_measures[num_instantiation_measures];
+    num_instantiation_measures++;
+
+    measure->stats = instantiation_stats_get(template_sym, is_class);
+    measure->nested_time = 0.0;
+    measure->nested_bytes = 0;
+    measure->bytes_at_start = instantiation_bytes_allocated();
+    gettimeofday(&measure->start, NULL);
+}
+
+static void instantiation_stats_end(scope_entry_t* template_sym)
+{
+    if (!instantiation_stats_are_enabled()
+            || template_sym == NULL)
+        return;
+
+    struct timeval end;
+    gettimeofday(&end, NULL);
+
+    ERROR_CONDITION(num_instantiation_measures == 0, "Unbalanced instantiation measures", 0);
+    num_instantiation_measures--;
+    instantiation_measure_t* measure = &instantiation_measures[num_instantiation_measures];
+
+    double time = (end.tv_sec - measure->start.tv_sec)
+        + (end.tv_usec - measure->start.tv_usec) / 1e6;
+    unsigned long long bytes = instantiation_bytes_allocated() - measure->bytes_at_start;
+
+    measure->stats->num_instantiations++;
+    measure->stats->time += time - measure->nested_time;
+    measure->stats->bytes += bytes - measure->nested_bytes;
+
+    if (num_instantiation_measures > 0)
+    {
+        instantiation_measure_t* enclosing = &instantiation_measures[num_instantiation_measures - 1];
+        enclosing->nested_time += time;
+        enclosing->nested_bytes += bytes;
+    }
+}
+
+static int instantiation_stats_compare(const void* p1, const void* p2)
+{
+    const instantiation_stats_t* s1 = *(instantiation_stats_t* const*)p1;
+    const instantiation_stats_t* s2 = *(instantiation_stats_t* const*)p2;
+
+    if (s1->time > s2->time)
+        return -1;
+    else if (s1->time < s2->time)
+        return 1;
+    else
+        return s2->num_instantiations - s1->num_instantiations;
+}
+
+instantiation_stats_t** instantiation_get_stats(int* num_stats)
+{
+    if (instantiation_stats_translation_unit != CURRENT_COMPILED_FILE)
+    {
+        *num_stats = 0;
+        return NULL;
+    }
+
+    qsort(instantiation_stats, num_instantiation_stats,
+            sizeof(*instantiation_stats),
+            instantiation_stats_compare);
+
+    *num_stats = num_instantiation_stats;
+    return instantiation_stats;
+}
+
+static scope_entry_t* instantiation_stats_template_of_class(scope_entry_t* being_instantiated_sym,
+        scope_entry_t* selected_template_sym)
+{
+    if (is_template_specialized_type(being_instantiated_sym->type_information))
+        return template_type_get_related_symbol(
+                template_specialized_type_get_related_template_type(being_instantiated_sym->type_information));
+    return selected_template_sym;
+}
+
+static scope_entry_t* instantiation_stats_template_of_function(scope_entry_t* entry)
+{
+    if (is_template_specialized_type(entry->type_information))
+        return template_type_get_related_symbol(
+                template_specialized_type_get_related_template_type(entry->type_information));
+    return symbol_entity_specs_get_emission_template(entry);
+}
+
 typedef
 struct instantiate_class_header_message_fun_data_tag
 {
@@ -1858,6 +2034,10 @@ static void instantiate_specialized_template_class(type_t* selected_template,
 
     diagnostic_context_push_instantiation(instantiation_header);
 
+    scope_entry_t* stats_template_sym = instantiation_stats_template_of_class(
+            being_instantiated_sym, selected_template_sym);
+    instantiation_stats_begin(stats_template_sym, /* is_class */ 1);
+
     // Update the template parameter with the deduced template parameters
     decl_context_t* instantiation_context = decl_context_clone(being_instantiated_sym->decl_context);
 
@@ -1907,6 +2087,8 @@ static void instantiate_specialized_template_class(type_t* selected_template,
             inner_decl_context,
             locus);
 
+    instantiation_stats_end(stats_template_sym);
+
     diagnostic_context_pop_and_commit();
 
     DEBUG_CODE()
@@ -2148,6 +2330,9 @@ static void instantiate_nontemplate_member_class_of_template_class(
     }
     diagnostic_context_push_instantiation(instantiation_header);
 
+    scope_entry_t* stats_template_sym = selected_template_sym;
+    instantiation_stats_begin(stats_template_sym, /* is_class */ 1);
+
     instantiation_symbol_map_t* enclosing_instantiation_symbol_map = NULL;
     scope_entry_t* enclosing_class = named_type_get_symbol(symbol_entity_specs_get_class_type(being_instantiated_sym));
     enclosing_instantiation_symbol_map = symbol_entity_specs_get_instantiation_symbol_map(enclosing_class);
@@ -2161,6 +2346,8 @@ static void instantiate_nontemplate_member_class_of_template_class(
             inner_decl_context,
             locus);
 
+    instantiation_stats_end(stats_template_sym);
+
     diagnostic_context_pop_and_commit();
 
     DEBUG_CODE()
@@ -2311,12 +2498,18 @@ struct instantiation_item_tag
 
 static instantiation_item_t** symbols_to_instantiate;
 static int num_symbols_to_instantiate;
+// Symbols already in symbols_to_instantiate, so adding one is not linear
+// in the number of pending functions
+static ohash_ptr_t* pending_symbols_to_instantiate;
 
 void instantiation_init(void)
 {
     nodecl_instantiation_units = nodecl_null();
     symbols_to_instantiate = NULL;
     num_symbols_to_instantiate = 0;
+    if (pending_symbols_to_instantiate != NULL)
+        ohash_ptr_destroy(pending_symbols_to_instantiate);
+    pending_symbols_to_instantiate = ohash_ptr_new(5);
 }
 
 static void instantiate_every_symbol(scope_entry_t* entry,
@@ -2365,6 +2558,11 @@ void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
         num_symbols_to_instantiate = 0;
         symbols_to_instantiate = NULL;
 
+        // Functions of this batch may be requested again by later batches
+        // as it happened before, so forget them now
+        ohash_ptr_destroy(pending_symbols_to_instantiate);
+        pending_symbols_to_instantiate = ohash_ptr_new(5);
+
         int i;
         for (i = 0; i < tmp_num_symbols_to_instantiate; i++)
         {
@@ -2600,30 +2798,20 @@ void instantiation_instantiate_pending_functions(nodecl_t* nodecl_output)
     DELETE(list);
 }
 
-static char compare_instantiate_items(instantiation_item_t* current_item, instantiation_item_t* new_item)
-{
-    return current_item->symbol == new_item->symbol;
-}
-
 void instantiation_add_symbol_to_instantiate(scope_entry_t* entry,
         const locus_t* locus)
 {
+    if (ohash_ptr_query(pending_symbols_to_instantiate, (const char*)entry) != NULL)
+        return;
+
     instantiation_item_t* item = NEW0(instantiation_item_t);
     item->symbol = entry;
     item->locus = locus;
 
-    int old_num = num_symbols_to_instantiate;
-
-    P_LIST_ADD_ONCE_FUN(symbols_to_instantiate,
+    ohash_ptr_insert(pending_symbols_to_instantiate, (const char*)entry, item);
+    P_LIST_ADD(symbols_to_instantiate,
             num_symbols_to_instantiate,
-            item,
-            compare_instantiate_items);
-
-    // Crummy way to know if it was added
-    if (old_num == num_symbols_to_instantiate)
-    {
-        DELETE(item);
-    }
+            item);
 }
 
 static char instantiate_true_template_function(scope_entry_t* entry, const locus_t* locus UNUSED_PARAMETER)
@@ -2848,6 +3036,9 @@ static char instantiate_template_function_internal(scope_entry_t* entry, const l
     }
     diagnostic_context_push_instantiation(instantiation_header);
 
+    scope_entry_t* stats_template_sym = instantiation_stats_template_of_function(entry);
+    instantiation_stats_begin(stats_template_sym, /* is_class */ 0);
+
     char was_instantiated = 0;
 
     if (!symbol_entity_specs_get_is_member(entry)
@@ -2915,6 +3106,8 @@ static char instantiate_template_function_internal(scope_entry_t* entry, const l
         entry->defined = 1;
     }
 
+    instantiation_stats_end(stats_template_sym);
+
     diagnostic_context_pop_and_commit();
 
     num_being_instantiated_now--;
@@ -57,6 +57,10 @@ LIBMCXX_EXTERN void instantiation_instantiate_pending_functions(nodecl_t* nodecl
 LIBMCXX_EXTERN void instantiation_add_symbol_to_instantiate(scope_entry_t* entry,
         const locus_t* locus);
 
+// Only gathered when a report of the compilation has been requested. Sorted
+// by decreasing time and valid until the next translation unit
+LIBMCXX_EXTERN instantiation_stats_t** instantiation_get_stats(int* num_stats);
+
 LIBMCXX_EXTERN char function_may_be_instantiated(scope_entry_t* entry);
 LIBMCXX_EXTERN void instantiate_template_function(scope_entry_t* entry, const locus_t* locus);
 
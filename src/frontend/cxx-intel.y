@@ -8,11 +8,11 @@
 
 primary_expression : INTEL_ASSUME '(' expression ')'
 {
-    $$ = ASTMake1(AST_INTEL_ASSUME, $3, make_locus(@1.first_filename, @1.first_line, @1.first_column), NULL);
+    $$ = ASTMake1(AST_INTEL_ASSUME, $3, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), NULL);
 }
 | INTEL_ASSUME_ALIGNED '(' assignment_expression ',' assignment_expression ')'
 {
-    $$ = ASTMake2(AST_INTEL_ASSUME_ALIGNED, $3, $5, make_locus(@1.first_filename, @1.first_line, @1.first_column), NULL);
+    $$ = ASTMake2(AST_INTEL_ASSUME_ALIGNED, $3, $5, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), NULL);
 }
 ;
 
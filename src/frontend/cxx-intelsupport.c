@@ -34,6 +34,7 @@
 #include "cxx-exprtype.h"
 #include "cxx-diagnostic.h"
 #include "cxx-utils.h"
+#include "cxx-lazybuiltins.h"
 
 void intel_check_assume(
         AST expression,
@@ -561,14 +562,24 @@ char intel_vector_struct_to_intel_vector_struct_reinterpret_type(type_t* orig, t
     return 0;
 }
 
-void sign_in_icc_intrinsics(const decl_context_t* decl_context)
+// Xeon
+#include "cxx-iccbuiltins-lazy.h"
+// Knights Corner (aka MIC)
+#include "cxx-iccbuiltins-knc-lazy.h"
+
+static char lazy_icc_intrinsics(const decl_context_t* decl_context, const char* name)
 {
-    const locus_t* builtins_locus = make_locus("(intel-builtins)", 0, 0);
-    // Xeon
-#include "cxx-iccbuiltins.h"
+    char signed_in = lazy_builtin_sign_in(&icc_builtins,
+            decl_context, name, "(intel-builtins)");
+    signed_in = lazy_builtin_sign_in(&icc_builtins_knc,
+            decl_context, name, "(intel-builtins-knc)") || signed_in;
+
+    return signed_in;
+}
 
-    // Knights Corner (aka MIC)
-    builtins_locus = make_locus("(intel-builtins-knc)", 0, 0);
-#include "cxx-iccbuiltins-knc.h"
+void sign_in_icc_intrinsics(const decl_context_t* decl_context)
+{
+    // There are thousands of them, so they are only signed in when used
+    scope_add_lazy_symbols(decl_context, lazy_icc_intrinsics);
 }
 
@@ -0,0 +1,66 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+#include "cxx-lazybuiltins.h"
+
+#include <string.h>
+
+// This must be the same hash as lazy_builtin_hash in gen-lazy-builtins.py
+static unsigned int lazy_builtin_hash(const char* name, unsigned int seed)
+{
+    unsigned int h = 2166136261U ^ seed;
+
+    const unsigned char* p;
+    for (p = (const unsigned char*)name; *p != '\0'; p++)
+    {
+        h ^= *p;
+        h *= 16777619U;
+    }
+
+    return h;
+}
+
+char lazy_builtin_sign_in(const lazy_builtin_table_t* table,
+        const decl_context_t* decl_context,
+        const char* name,
+        const char* builtins_locus_filename)
+{
+    unsigned int bucket = lazy_builtin_hash(name, 0) % table->num_buckets;
+    unsigned int displacement = table->displacements[bucket];
+    if (displacement == 0)
+        return 0;
+
+    const lazy_builtin_t* slot = &table->slots[lazy_builtin_hash(name, displacement) % table->num_slots];
+    if (slot->name == NULL
+            || strcmp(slot->name, name) != 0)
+        return 0;
+
+    (slot->sign_in)(decl_context, make_locus(builtins_locus_filename, 0, 0));
+
+    return 1;
+}
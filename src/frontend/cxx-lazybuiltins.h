@@ -0,0 +1,71 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2014 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_LAZYBUILTINS_H
+#define CXX_LAZYBUILTINS_H
+
+#include "libmcxx-common.h"
+#include "cxx-buildscope-decls.h"
+#include "cxx-locus.h"
+
+MCXX_BEGIN_DECLS
+
+// Builtins signed in the first time their name is looked up. Tables are
+// generated by gen-lazy-builtins.py from the files of builtin declarations
+// and are indexed by a perfect hash of the name of the builtin
+
+typedef void (*lazy_builtin_sign_in_fun_t)(const decl_context_t* decl_context,
+        const locus_t* builtins_locus);
+
+typedef struct lazy_builtin_tag
+{
+    // NULL for the unused slots
+    const char* name;
+    lazy_builtin_sign_in_fun_t sign_in;
+} lazy_builtin_t;
+
+typedef struct lazy_builtin_table_tag
+{
+    const lazy_builtin_t* slots;
+    unsigned int num_slots;
+
+    const unsigned int* displacements;
+    unsigned int num_buckets;
+} lazy_builtin_table_t;
+
+// Signs in the builtin 'name' if it is in the table. Returns nonzero if it
+// was signed in
+LIBMCXX_EXTERN char lazy_builtin_sign_in(const lazy_builtin_table_t* table,
+        const decl_context_t* decl_context,
+        const char* name,
+        const char* builtins_locus_filename);
+
+MCXX_END_DECLS
+
+#endif // CXX_LAZYBUILTINS_H
@@ -46,6 +46,7 @@ struct token_atrib_tag
 typedef struct parser_location_tag
 {
     const char* first_filename;
+    unsigned int first_file_id;
     int first_line;
     int first_column;
 } parser_location_t;
@@ -55,6 +56,7 @@ typedef struct parser_location_tag
       if (N)                                                            \
         {                                                               \
           (Current).first_filename = YYRHSLOC (Rhs, 1).first_filename;  \
+          (Current).first_file_id  = YYRHSLOC (Rhs, 1).first_file_id;   \
           (Current).first_line     = YYRHSLOC (Rhs, 1).first_line;      \
           (Current).first_column   = YYRHSLOC (Rhs, 1).first_column;    \
         }                                                               \
@@ -62,6 +64,8 @@ typedef struct parser_location_tag
         {                                                               \
           (Current).first_filename   =                                  \
             YYRHSLOC (Rhs, 0).first_filename;                           \
+          (Current).first_file_id   =                                   \
+            YYRHSLOC (Rhs, 0).first_file_id;                            \
           (Current).first_line =                                        \
             YYRHSLOC (Rhs, 0).first_line;                               \
           (Current).first_column =                                      \
@@ -76,6 +80,9 @@ LIBMCXX_EXTERN void update_parser_location(const char* current_text, parser_loca
 LIBMCXX_EXTERN int mcxx_open_file_for_scanning(const char* scanned_filename, const char* input_filename);
 LIBMCXX_EXTERN int mc99_open_file_for_scanning(const char* scanned_filename, const char* input_filename);
 
+LIBMCXX_EXTERN int mcxx_open_stream_for_scanning(FILE* file, const char* scanned_filename, const char* input_filename);
+LIBMCXX_EXTERN int mc99_open_stream_for_scanning(FILE* file, const char* scanned_filename, const char* input_filename);
+
 LIBMCXX_EXTERN int mcxx_prepare_string_for_scanning(const char* str);
 LIBMCXX_EXTERN int mc99_prepare_string_for_scanning(const char* str);
 
@@ -96,6 +96,9 @@ enum
 
     // Max unparenthesized aggregates in initializers
     MCXX_MAX_UNBRACED_AGGREGATES = 64,
+
+    // Steps of a constexpr evaluation unless --constexpr-steps is given
+    MCXX_MAX_CONSTEXPR_EVALUATION_STEPS = 1048576,
 };
 
 #endif // CXX_LIMITS_H
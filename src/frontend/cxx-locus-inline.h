@@ -31,10 +31,29 @@
 
 struct locus_tag
 {
-    const char* filename;
+    unsigned int file_id;
     unsigned int line, col;
+    // See locus_get_id
+    unsigned int id;
 };
 
+enum { LOCUS_POOL_SIZE = 1024 };
+LIBMCXX_EXTERN locus_t** locus_pool_table;
+
+static inline unsigned int locus_get_id(const locus_t* l)
+{
+    return l == NULL ? 0 : l->id;
+}
+
+static inline const locus_t* locus_from_id(unsigned int id)
+{
+    if (id == 0)
+        return NULL;
+
+    id--;
+    return &locus_pool_table[id / LOCUS_POOL_SIZE][id % LOCUS_POOL_SIZE];
+}
+
 static inline const char* locus_to_str(const locus_t* l)
 {
     const char* result = NULL;
@@ -42,9 +61,9 @@ static inline const char* locus_to_str(const locus_t* l)
         return ":0";
 
     if (l->col != 0)
-        uniquestr_sprintf(&result, "%s:%d:%d", l->filename, l->line, l->col);
+        uniquestr_sprintf(&result, "%s:%d:%d", locus_get_filename(l), l->line, l->col);
     else
-        uniquestr_sprintf(&result, "%s:%d", l->filename, l->line);
+        uniquestr_sprintf(&result, "%s:%d", locus_get_filename(l), l->line);
 
     return result;
 }
@@ -53,7 +72,7 @@ static inline const char* locus_get_filename(const locus_t* l)
 {
     if (l == NULL)
         return "";
-    return l->filename;
+    return locus_file_id_get_filename(l->file_id);
 }
 
 static inline unsigned int locus_get_line(const locus_t* l)
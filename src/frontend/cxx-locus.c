@@ -24,127 +24,194 @@
   Cambridge, MA 02139, USA.
 --------------------------------------------------------------------*/
 
+
 #include "cxx-locus.h"
 #include "mem.h"
+#include <stdint.h>
 #include <string.h>
 #include "uniquestr.h"
 #include "string_utils.h"
+#include "ohash_ptr.h"
+#include "cxx-process.h"
 
-// Heavily inspired in lib/char_hash.c contributed by Jan Hoogerbrugge
+// Filenames are mapped to small integers the first time they are seen, so
+// loci can be hashed and compared without looking at the filename
 
-typedef
-struct locus_item_tag
-{
-    unsigned int hash;
-    locus_t *locus;
-} locus_item_t;
+static ohash_ptr_t *file_ids = NULL;
+static const char** file_names = NULL;
+static unsigned int num_file_names = 0;
+static unsigned int capacity_file_names = 0;
 
-typedef
-struct locus_bucket_tag
+unsigned int locus_file_id(const char* filename)
 {
-    int num;
-    int capacity;
-    locus_item_t* items;
-} locus_bucket_t;
+    if (filename == NULL)
+        filename = "";
 
+    filename = uniquestr(filename);
 
-static locus_bucket_t *hash_table[49999];
+    if (file_ids == NULL)
+    {
+        file_ids = ohash_ptr_new(0);
+
+        // Id 0 is the empty filename, so zeroed locations remain empty
+        file_names = NEW_VEC(const char*, 64);
+        capacity_file_names = 64;
+        file_names[0] = uniquestr("");
+        num_file_names = 1;
+        ohash_ptr_insert(file_ids, file_names[0], (void*)1);
+    }
 
-static unsigned int hash_locus(const char *filename, unsigned int line, unsigned int col)
-{
-    unsigned int hash = 0;
-    const char *p;
+    // Ids are stored plus one because the hash does not accept NULL values
+    intptr_t id = (intptr_t)ohash_ptr_query(file_ids, filename);
+    if (id != 0)
+        return id - 1;
 
-    for (p = filename; *p; p++)
-        hash = ((hash << 5) + hash) ^ *p;
+    if (num_file_names == capacity_file_names)
+    {
+        capacity_file_names = (capacity_file_names == 0) ? 64 : 2 * capacity_file_names;
+        file_names = NEW_REALLOC(const char*, file_names, capacity_file_names);
+    }
+
+    id = num_file_names;
+    file_names[num_file_names] = filename;
+    num_file_names++;
 
-    hash = ((hash << 5) + hash) ^ line;
-    hash = ((hash << 5) + hash) ^ col;
+    ohash_ptr_insert(file_ids, filename, (void*)(id + 1));
 
-    return hash;
+    return id;
 }
 
-enum { POOL_SIZE = 1024 };
+const char* locus_file_id_get_filename(unsigned int file_id)
+{
+    if (file_id == 0)
+        return "";
 
-typedef
-struct pool_locus_tag
+    ERROR_CONDITION(file_id >= num_file_names, "Invalid file id %u", file_id);
+
+    return file_names[file_id];
+}
+
+static inline uint32_t hash_locus(unsigned int file_id, unsigned int line, unsigned int col)
 {
-    int num;
-    locus_t* pool;
-    struct pool_locus_tag *prev;
-} pool_locus_t;
+    // Pack the three values into 64 bits (values too large to fit only make
+    // the hash worse) and mix them with the finalizer of MurmurHash3
+    uint64_t key = ((uint64_t)file_id << 44)
+        ^ ((uint64_t)line << 16)
+        ^ (uint64_t)col;
+
+    key ^= key >> 33;
+    key *= UINT64_C(0xff51afd7ed558ccd);
+    key ^= key >> 33;
+    key *= UINT64_C(0xc4ceb9fe1a85ec53);
+    key ^= key >> 33;
+
+    return (uint32_t)key;
+}
 
-static pool_locus_t *pool_locus;
+// Loci are allocated in pools of LOCUS_POOL_SIZE elements. The id of a
+// locus is its position in the pools plus one, so 0 can be used for NULL
+locus_t** locus_pool_table = NULL;
+static unsigned int num_locus_pools = 0;
+static unsigned int capacity_locus_pools = 0;
+static unsigned int num_loci_last_pool = LOCUS_POOL_SIZE;
 
 static locus_t* pool_locus_alloc(void)
 {
-    if (pool_locus == NULL
-            || pool_locus->num == POOL_SIZE)
+    if (num_loci_last_pool == LOCUS_POOL_SIZE)
     {
-        pool_locus_t* new_pool = NEW(pool_locus_t);
-        new_pool->num = 0;
-        new_pool->pool = NEW_VEC(locus_t, POOL_SIZE);
-        new_pool->prev = pool_locus;
+        if (num_locus_pools == capacity_locus_pools)
+        {
+            capacity_locus_pools = (capacity_locus_pools == 0) ? 64 : 2 * capacity_locus_pools;
+            locus_pool_table = NEW_REALLOC(locus_t*, locus_pool_table, capacity_locus_pools);
+        }
 
-        pool_locus = new_pool;
+        locus_pool_table[num_locus_pools] = NEW_VEC(locus_t, LOCUS_POOL_SIZE);
+        num_locus_pools++;
+        num_loci_last_pool = 0;
     }
 
-    locus_t* result = &pool_locus->pool[pool_locus->num];
-    pool_locus->num++;
+    locus_t* result = &locus_pool_table[num_locus_pools - 1][num_loci_last_pool];
+    result->id = (num_locus_pools - 1) * LOCUS_POOL_SIZE + num_loci_last_pool + 1;
+    num_loci_last_pool++;
 
     return result;
 }
 
-const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col)
+typedef
+struct locus_slot_tag
 {
-    if (filename == NULL)
-        filename = "";
+    uint32_t hash;
+    locus_t *locus;
+} locus_slot_t;
+
+// Open addressing with linear probing. The table grows when it is 3/4 full
+enum { INITIAL_CAPACITY = 4096 };
 
-    unsigned int hash = hash_locus(filename, line, col);
-    unsigned int hash_index = hash % (sizeof(hash_table) / sizeof(hash_table[0]));
+static locus_slot_t *hash_table = NULL;
+static uint32_t hash_table_capacity = 0;
+static uint32_t hash_table_num_items = 0;
 
-    if (hash_table[hash_index] == NULL)
+static void grow_hash_table(void)
+{
+    uint32_t old_capacity = hash_table_capacity;
+    locus_slot_t* old_table = hash_table;
+
+    hash_table_capacity = (old_capacity == 0) ? INITIAL_CAPACITY : 2 * old_capacity;
+    hash_table = NEW_VEC0(locus_slot_t, hash_table_capacity);
+
+    uint32_t mask = hash_table_capacity - 1;
+    uint32_t i;
+    for (i = 0; i < old_capacity; i++)
     {
-        hash_table[hash_index] = NEW0(locus_bucket_t);
+        if (old_table[i].locus == NULL)
+            continue;
+
+        uint32_t index = old_table[i].hash & mask;
+        while (hash_table[index].locus != NULL)
+            index = (index + 1) & mask;
+
+        hash_table[index] = old_table[i];
     }
 
-    locus_bucket_t* bucket = hash_table[hash_index];
+    DELETE(old_table);
+}
+
+const locus_t* make_locus_in_file(unsigned int file_id, unsigned int line, unsigned int col)
+{
+    if (4 * (hash_table_num_items + 1) > 3 * hash_table_capacity)
+        grow_hash_table();
 
-    int i, n = bucket->num;
-    locus_item_t *items = bucket->items;
+    uint32_t hash = hash_locus(file_id, line, col);
+    uint32_t mask = hash_table_capacity - 1;
+    uint32_t index = hash & mask;
 
-    for (i = 0; i < n; i++)
+    while (hash_table[index].locus != NULL)
     {
-        if (items[i].hash == hash
-                && strcmp(items[i].locus->filename, filename) == 0
-                && items[i].locus->line == line
-                && items[i].locus->col == col)
+        locus_t* locus = hash_table[index].locus;
+        if (hash_table[index].hash == hash
+                && locus->file_id == file_id
+                && locus->line == line
+                && locus->col == col)
         {
-            return items[i].locus;
+            return locus;
         }
-    }
-
-    if (bucket->num == bucket->capacity)
-    {
-        if (bucket->capacity == 0)
-            bucket->capacity = 16;
-        else
-            bucket->capacity = 2*(bucket->capacity + 1);
-
-        bucket->items =
-            xrealloc(bucket->items, bucket->capacity * sizeof(*(bucket->items)));
 
-        items = bucket->items;
+        index = (index + 1) & mask;
     }
 
-    items[n].hash = hash;
-    items[n].locus = pool_locus_alloc();
-    items[n].locus->filename = uniquestr(filename);
-    items[n].locus->line = line;
-    items[n].locus->col = col;
+    locus_t* locus = pool_locus_alloc();
+    locus->file_id = file_id;
+    locus->line = line;
+    locus->col = col;
 
-    bucket->num++;
+    hash_table[index].hash = hash;
+    hash_table[index].locus = locus;
+    hash_table_num_items++;
 
-    return items[n].locus;
+    return locus;
 }
 
+const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col)
+{
+    return make_locus_in_file(locus_file_id(filename), line, col);
+}
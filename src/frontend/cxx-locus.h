@@ -27,6 +27,7 @@
 #ifndef CXX_LOCUS_H
 #define CXX_LOCUS_H
 
+#include "libmcxx-common.h"
 #include "cxx-macros.h"
 
 MCXX_BEGIN_DECLS
@@ -35,6 +36,18 @@ typedef struct locus_tag locus_t;
 
 const locus_t* make_locus(const char* filename, unsigned int line, unsigned int col);
 
+// Small integer that identifies a filename. Scanners obtain it once every
+// time they switch to another file and then create the loci of the tokens
+// with make_locus_in_file, which does not look at the filename
+unsigned int locus_file_id(const char* filename);
+const char* locus_file_id_get_filename(unsigned int file_id);
+
+const locus_t* make_locus_in_file(unsigned int file_id, unsigned int line, unsigned int col);
+
+// Loci can be identified by a nonzero integer, 0 is the NULL locus
+static inline unsigned int locus_get_id(const locus_t*);
+static inline const locus_t* locus_from_id(unsigned int id);
+
 static inline const char* locus_to_str(const locus_t*);
 static inline const char* locus_get_filename(const locus_t*);
 static inline unsigned int locus_get_line(const locus_t*);
@@ -393,11 +393,11 @@ static void copy_scope(const decl_context_t* new_decl_context, scope_t* original
     closure_info.symbol_deep_copy_map = symbol_deep_copy_map;
 
     // First walk, sign in all the names but leave them empty
-    dhash_ptr_walk(original_scope->dhash, (dhash_ptr_walk_fn*)create_symbols, &closure_info);
-    dhash_ptr_walk(original_scope->dhash, (dhash_ptr_walk_fn*)register_symbols, &closure_info);
+    ohash_ptr_walk(original_scope->hash, (ohash_ptr_walk_fn*)create_symbols, &closure_info);
+    ohash_ptr_walk(original_scope->hash, (ohash_ptr_walk_fn*)register_symbols, &closure_info);
 
     // Gather all the symbols of the scope in closure.symbols
-    dhash_ptr_walk(original_scope->dhash, (dhash_ptr_walk_fn*)gather_all_symbols_in_scope, &closure_info);
+    ohash_ptr_walk(original_scope->hash, (ohash_ptr_walk_fn*)gather_all_symbols_in_scope, &closure_info);
     // And fill them
     fill_symbols(&closure_info);
 
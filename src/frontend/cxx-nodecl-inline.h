@@ -39,6 +39,10 @@ struct nodecl_expr_info_tag
     char is_value_dependent:1;
     char is_type_dependent_expression:1;
 
+    // Cached by nodecl_structural_hash, only meaningful if
+    // ast_structural_hash_is_valid holds for the node
+    unsigned int structural_hash;
+
     type_t* type_info;
 
     const_value_t* const_val;
@@ -94,9 +98,10 @@ static inline nodecl_expr_info_t* nodecl_expr_get_expression_info(AST expr)
     nodecl_expr_info_t* p = ast_get_expr_info(expr);
     if (p == NULL)
     {
-        p = NEW(nodecl_expr_info_t);
+        p = (nodecl_expr_info_t*)ast_alloc_data(expr, sizeof(*p));
         p->is_value_dependent = 0;
         p->is_type_dependent_expression = 0;
+        p->structural_hash = 0;
         p->type_info = NULL;
         p->const_val = NULL;
         p->symbol = NULL;
@@ -108,7 +113,7 @@ static inline nodecl_expr_info_t* nodecl_expr_get_expression_info(AST expr)
     return p;
 }
 
-#define NODECL_EXPR_SET_PTR(type, what, field_name) \
+#define NODECL_EXPR_SET_PTR(type, what, field_name, is_structural) \
 static inline void nodecl_expr_set_##what(AST expr, type * datum) \
 { \
     nodecl_expr_info_t* expr_info; \
@@ -122,23 +127,25 @@ static inline void nodecl_expr_set_##what(AST expr, type * datum) \
     { \
      expr_info = nodecl_expr_get_expression_info(expr); \
     } \
+    if (is_structural) \
+      ast_invalidate_structural_hash(expr); \
     expr_info->field_name = datum; \
 }
 
 // static void nodecl_expr_set_symbol(AST expr, scope_entry_t* entry)
-NODECL_EXPR_SET_PTR(scope_entry_t, symbol, symbol)
+NODECL_EXPR_SET_PTR(scope_entry_t, symbol, symbol, 1)
 
 // static void nodecl_expr_set_type(AST expr, type_t* t)
-NODECL_EXPR_SET_PTR(type_t, type, type_info)
+NODECL_EXPR_SET_PTR(type_t, type, type_info, 0)
 
 // static void nodecl_expr_set_constant(AST expr, const_value_t* const_val)
-NODECL_EXPR_SET_PTR(const_value_t, constant, const_val)
+NODECL_EXPR_SET_PTR(const_value_t, constant, const_val, 1)
     
 // static void nodecl_expr_set_template_parameters(AST expr, template_parameter_list_t* template_params)
-NODECL_EXPR_SET_PTR(template_parameter_list_t, template_parameters, template_parameters)
+NODECL_EXPR_SET_PTR(template_parameter_list_t, template_parameters, template_parameters, 0)
 
 // static void nodecl_expr_set_placeholder(AST expr, AST* template_params)
-NODECL_EXPR_SET_PTR(AST, placeholder, placeholder);
+NODECL_EXPR_SET_PTR(AST, placeholder, placeholder, 0);
 
 
 // Public routines
@@ -34,6 +34,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 
 #include "cxx-nodecl.h"
 #include "cxx-exprtype.h"
@@ -214,6 +215,67 @@ size_t nodecl_hash_table(nodecl_t key)
     return hash;
 }
 
+static unsigned int structural_hash_combine(unsigned int seed, unsigned int value)
+{
+    return seed ^ (value + 0x9e3779b9U + (seed << 6) + (seed >> 2));
+}
+
+static unsigned int structural_hash_pointer(const void* p)
+{
+    uintptr_t v = (uintptr_t)p;
+    v ^= v >> 17;
+    v *= 0x85ebca6bU;
+    v ^= v >> 13;
+    return (unsigned int)v;
+}
+
+unsigned int nodecl_structural_hash(nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return 0;
+
+    AST a = nodecl_get_ast(n);
+    nodecl_expr_info_t* expr_info = nodecl_expr_get_expression_info_noalloc(a);
+    if (expr_info != NULL
+            && ast_structural_hash_is_valid(a))
+        return expr_info->structural_hash;
+
+    unsigned int hash;
+    if (nodecl_get_kind(n) == NODECL_CONVERSION)
+    {
+        // Conversions are not taken into account when comparing
+        hash = nodecl_structural_hash(nodecl_get_child(n, 0));
+    }
+    else
+    {
+        hash = nodecl_get_kind(n) + 1;
+        hash = structural_hash_combine(hash,
+                structural_hash_pointer(nodecl_get_symbol(n)));
+
+        // Objects and addresses are ignored when comparing trees
+        const_value_t* cval = nodecl_get_constant(n);
+        if (cval != NULL
+                && const_value_is_address_or_object(cval))
+            cval = NULL;
+        hash = structural_hash_combine(hash, structural_hash_pointer(cval));
+
+        int i;
+        for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+        {
+            hash = structural_hash_combine(hash,
+                    nodecl_structural_hash(nodecl_get_child(n, i)) + i);
+        }
+    }
+
+    // Nodes without expression info (like lists) are marked as well so
+    // a change below them still invalidates their ancestors
+    if (expr_info != NULL)
+        expr_info->structural_hash = hash;
+    ast_set_structural_hash_valid(a);
+
+    return hash;
+}
+
 // Placeholder
 void nodecl_set_placeholder(nodecl_t n, AST* p)
 {
@@ -156,6 +156,11 @@ void nodecl_replace(nodecl_t old_node, nodecl_t new_node);
 // Hash table
 size_t nodecl_hash_table(nodecl_t key);
 
+// Structural hash: nodes that compare equal in the way the analyses do
+// (same kind, symbol, constant and children, ignoring conversions) have the
+// same hash. It is cached in the nodes and invalidated when they change
+unsigned int nodecl_structural_hash(nodecl_t n);
+
 // Sourceify
 const char* nodecl_stmt_to_source(nodecl_t n);
 const char* nodecl_expr_to_source(nodecl_t n);
@@ -16,19 +16,19 @@ nontype_specifier_without_attribute : opencl_specifiers
 
 opencl_specifiers : OPENCL_GLOBAL
 {
-    $$ = ASTLeaf(AST_OPENCL_GLOBAL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+    $$ = ASTLeaf(AST_OPENCL_GLOBAL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | OPENCL_KERNEL
 {
-    $$ = ASTLeaf(AST_OPENCL_KERNEL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+    $$ = ASTLeaf(AST_OPENCL_KERNEL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | OPENCL_CONSTANT
 {
-    $$ = ASTLeaf(AST_OPENCL_CONSTANT, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+    $$ = ASTLeaf(AST_OPENCL_CONSTANT, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | OPENCL_LOCAL
 {
-    $$ = ASTLeaf(AST_OPENCL_LOCAL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+    $$ = ASTLeaf(AST_OPENCL_LOCAL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 /*!endif*/
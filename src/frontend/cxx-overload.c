@@ -40,8 +40,11 @@
 #include "cxx-gccbuiltins.h"
 #include "cxx-diagnostic.h"
 #include "cxx-intelsupport.h"
+#include "cxx-driver.h"
+#include "ohash_ptr.h"
 
 #include <string.h>
+#include <stdint.h>
 
 typedef
 enum implicit_conversion_sequence_kind_tag
@@ -3274,18 +3277,233 @@ static scope_entry_t* solve_overload_(candidate_t* candidate_set,
     return best_viable_function;
 }
 
+// Results of solve_overload of the current translation unit. The key is
+// the sequence of candidates, each one with its number of default arguments
+// and the types of its arguments (which encode the value category). A result is only valid for the
+// generation of class lookup it was computed in.
+//
+// Only the chosen function is remembered. Checks that depend on the context
+// of the call (like access or deleted functions) are done by the callers
+// after solve_overload so they are not affected
+typedef
+struct overload_cache_entry_tag
+{
+    int key_length;
+    void** key;
+    unsigned long generation;
+
+    scope_entry_t* result;
+
+    struct overload_cache_entry_tag* next;
+} overload_cache_entry_t;
+
+static ohash_u64_t* overload_cache = NULL;
+static translation_unit_t* overload_cache_translation_unit = NULL;
+static unsigned long overload_cache_hits = 0;
+static unsigned long overload_cache_misses = 0;
+
+void get_overload_cache_stats(unsigned long* hits, unsigned long* misses)
+{
+    *hits = overload_cache_hits;
+    *misses = overload_cache_misses;
+}
+
+static void overload_cache_free_entries(uint64_t key UNUSED_PARAMETER,
+        void* info, void* walk_info UNUSED_PARAMETER)
+{
+    overload_cache_entry_t* entry = (overload_cache_entry_t*)info;
+    while (entry != NULL)
+    {
+        overload_cache_entry_t* next = entry->next;
+        DELETE(entry->key);
+        DELETE(entry);
+        entry = next;
+    }
+}
+
+static char candidate_set_can_be_cached(candidate_t* candidate_set)
+{
+    if (candidate_set == NULL
+            || debug_options.disable_overload_cache
+            || compilation_process.current_file_process == NULL)
+        return 0;
+
+    candidate_t* it;
+    for (it = candidate_set; it != NULL; it = it->next)
+    {
+        scope_entry_t* entry = entry_advance_aliases(it->entry);
+
+        // Computed function types modify the arguments
+        if (is_computed_function_type(entry->type_information))
+            return 0;
+
+        int i;
+        for (i = 0; i < it->num_args; i++)
+        {
+            if (!type_conversions_can_be_cached(it->args[i]))
+                return 0;
+        }
+
+        if (is_function_type(entry->type_information))
+        {
+            int num_parameters = function_type_get_num_parameters(entry->type_information);
+            for (i = 0; i < num_parameters; i++)
+            {
+                type_t* parameter_type = function_type_get_parameter_type_num(entry->type_information, i);
+                if (!type_conversions_can_be_cached(parameter_type))
+                    return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+// A redeclaration may add default arguments to a candidate, which makes it
+// viable for fewer arguments without changing any class
+static int candidate_num_default_arguments(scope_entry_t* entry)
+{
+    entry = entry_advance_aliases(entry);
+    if (!is_function_type(entry->type_information))
+        return 0;
+
+    // Like can_be_called_with_number_of_arguments
+    if (is_template_specialized_type(entry->type_information))
+    {
+        entry = named_type_get_symbol(
+                template_type_get_primary_type(
+                    template_specialized_type_get_related_template_type(
+                        entry->type_information)));
+    }
+
+    int num_default_arguments = 0;
+    int i;
+    for (i = symbol_entity_specs_get_num_parameters(entry) - 1; i >= 0; i--)
+    {
+        if (symbol_entity_specs_get_default_argument_info_num(entry, i) == NULL)
+            break;
+        num_default_arguments++;
+    }
+
+    return num_default_arguments;
+}
+
+static void** overload_cache_make_key(candidate_t* candidate_set, int *key_length)
+{
+    int length = 0;
+    candidate_t* it;
+    for (it = candidate_set; it != NULL; it = it->next)
+        length += 3 + it->num_args;
+
+    void** key = NEW_VEC(void*, length);
+    int n = 0;
+    for (it = candidate_set; it != NULL; it = it->next)
+    {
+        key[n++] = it->entry;
+        key[n++] = (void*)(intptr_t)candidate_num_default_arguments(it->entry);
+        key[n++] = (void*)(intptr_t)it->num_args;
+        int i;
+        for (i = 0; i < it->num_args; i++)
+            key[n++] = it->args[i];
+    }
+
+    *key_length = length;
+    return key;
+}
+
+static uint64_t overload_cache_hash_key(void** key, int key_length)
+{
+    uint64_t h = (uint64_t)key_length;
+    int i;
+    for (i = 0; i < key_length; i++)
+        h ^= (uint64_t)(uintptr_t)key[i] + UINT64_C(0x9e3779b97f4a7c15) + (h << 6) + (h >> 2);
+    return h;
+}
+
+static overload_cache_entry_t* overload_cache_query(void** key, int key_length, uint64_t hashed_key)
+{
+    // Results may depend on the language and the configuration of the
+    // translation unit
+    if (overload_cache_translation_unit != CURRENT_COMPILED_FILE)
+    {
+        if (overload_cache != NULL)
+        {
+            ohash_u64_walk(overload_cache, overload_cache_free_entries, NULL);
+            ohash_u64_destroy(overload_cache);
+        }
+        overload_cache = ohash_u64_new(5);
+        overload_cache_translation_unit = CURRENT_COMPILED_FILE;
+    }
+
+    overload_cache_entry_t* entry = (overload_cache_entry_t*)ohash_u64_query(overload_cache, hashed_key);
+    while (entry != NULL
+            && (entry->key_length != key_length
+                || memcmp(entry->key, key, key_length * sizeof(*key)) != 0))
+        entry = entry->next;
+
+    return entry;
+}
+
 scope_entry_t* solve_overload(candidate_t* candidate_set,
         const decl_context_t* decl_context,
         const locus_t* locus)
 {
+    if (!candidate_set_can_be_cached(candidate_set))
+    {
+        char is_ambiguous = 0; // Unused
+        return solve_overload_(candidate_set,
+                decl_context,
+                /* initialization_kind */ IK_INVALID,
+                /* dest */ NULL,
+                locus,
+                // Out
+                &is_ambiguous);
+    }
+
+    int key_length = 0;
+    void** key = overload_cache_make_key(candidate_set, &key_length);
+    uint64_t hashed_key = overload_cache_hash_key(key, key_length);
+
+    overload_cache_entry_t* entry = overload_cache_query(key, key_length, hashed_key);
+    if (entry != NULL
+            && entry->generation == get_class_lookup_generation())
+    {
+        DEBUG_CODE()
+        {
+            fprintf(stderr, "OVERLOAD: Reusing the result of an identical overload resolution\n");
+        }
+        overload_cache_hits++;
+        DELETE(key);
+        return entry->result;
+    }
+    overload_cache_misses++;
+
     char is_ambiguous = 0; // Unused
-    return solve_overload_(candidate_set,
+    scope_entry_t* result = solve_overload_(candidate_set,
             decl_context,
             /* initialization_kind */ IK_INVALID,
             /* dest */ NULL,
             locus,
             // Out
             &is_ambiguous);
+
+    // The resolution may have added entries to the table
+    entry = overload_cache_query(key, key_length, hashed_key);
+    if (entry == NULL)
+    {
+        entry = NEW0(overload_cache_entry_t);
+        entry->key_length = key_length;
+        entry->key = key;
+        entry->next = (overload_cache_entry_t*)ohash_u64_push(overload_cache, hashed_key, entry);
+    }
+    else
+    {
+        DELETE(key);
+    }
+    entry->generation = get_class_lookup_generation();
+    entry->result = result;
+
+    return result;
 }
 
 scope_entry_t* address_of_overloaded_function(
@@ -47,6 +47,9 @@ LIBMCXX_EXTERN scope_entry_t* solve_overload(candidate_t* candidate_set,
         const decl_context_t* decl_context,
         const locus_t* locus);
 
+// Hits and misses of the cache of solve_overload so far, for statistics
+LIBMCXX_EXTERN void get_overload_cache_stats(unsigned long* hits, unsigned long* misses);
+
 LIBMCXX_EXTERN char solve_initialization_of_nonclass_type(
         type_t* orig,
         type_t* dest,
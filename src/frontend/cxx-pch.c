@@ -0,0 +1,1739 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifdef HAVE_CONFIG_H
+  #include <config.h>
+#endif
+
+#include "cxx-pch.h"
+#include "cxx-scope.h"
+#include "cxx-entrylist.h"
+#include "cxx-typeutils.h"
+#include "cxx-cexpr.h"
+#include "cxx-nodecl.h"
+#include "cxx-driver-decls.h"
+#include "cxx-utils.h"
+#include "ohash_ptr.h"
+#include "uniquestr.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+// Layout of a precompiled header
+//
+//   pch_header_t
+//   uint32_t string_offsets[num_strings + 1]   (string 0 is NULL)
+//   char strings[strings_size]                 (padded to 4 bytes)
+//   uint32_t record_offsets[num_records + 2]   (record 0 is NULL)
+//   uint32_t words[num_words]                  (records and then the info)
+//   uint32_t names[num_names][2]               (string, record)
+//
+// Records refer to other records and strings using their index, so they can
+// be rebuilt in any order. Names are the symbols of the global scope sorted
+// by name.
+
+#define PCH_MAGIC "MCXXPCH"
+#define PCH_VERSION 1
+
+typedef struct pch_header_tag
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t num_strings;
+    uint32_t strings_size;
+    uint32_t num_records;
+    uint32_t num_words;
+    uint32_t info_offset;
+    uint32_t num_names;
+} pch_header_t;
+
+enum pch_record_kind
+{
+    PCH_RECORD_INVALID = 0,
+    PCH_RECORD_SYMBOL,
+    // Symbols that the compiler signs in by itself, like builtins
+    PCH_RECORD_PREDEFINED_SYMBOL,
+    PCH_RECORD_TYPE,
+    PCH_RECORD_NODECL,
+    PCH_RECORD_CONST_VALUE,
+    PCH_RECORD_SCOPE,
+    PCH_RECORD_GLOBAL_SCOPE,
+    PCH_RECORD_DECL_CONTEXT,
+};
+
+enum pch_type_kind
+{
+    PCH_TYPE_INVALID = 0,
+    PCH_TYPE_BUILTIN,
+    // cv-qualifiers and attributes on top of another type
+    PCH_TYPE_VARIANT,
+    PCH_TYPE_NAMED,
+    PCH_TYPE_POINTER,
+    PCH_TYPE_LVALUE_REFERENCE,
+    PCH_TYPE_RVALUE_REFERENCE,
+    PCH_TYPE_REBINDABLE_REFERENCE,
+    PCH_TYPE_ARRAY,
+    PCH_TYPE_STRING_LITERAL,
+    PCH_TYPE_FUNCTION,
+    PCH_TYPE_VECTOR,
+    PCH_TYPE_COMPLEX,
+    PCH_TYPE_CLASS,
+    PCH_TYPE_ENUM,
+};
+
+enum pch_const_value_kind
+{
+    PCH_CONST_VALUE_INVALID = 0,
+    PCH_CONST_VALUE_SCALAR,
+    PCH_CONST_VALUE_COMPLEX,
+    PCH_CONST_VALUE_STRUCT,
+    PCH_CONST_VALUE_ARRAY,
+    PCH_CONST_VALUE_VECTOR,
+    PCH_CONST_VALUE_STRING,
+    PCH_CONST_VALUE_RANGE,
+};
+
+// Builtin types are singletons so they are saved as their index here
+static type_t* pch_get_float128_type(void)
+{
+    if (CURRENT_CONFIGURATION->type_environment->float128_info == NULL)
+        return NULL;
+    return get_float128_type();
+}
+
+static type_t* pch_get_float16_type(void)
+{
+    if (CURRENT_CONFIGURATION->type_environment->float16_info == NULL)
+        return NULL;
+    return get_float16_type();
+}
+
+static type_t* (*const pch_builtin_types[])(void) = {
+    get_void_type,
+    get_bool_type,
+    get_char_type,
+    get_signed_char_type,
+    get_unsigned_char_type,
+    get_signed_short_int_type,
+    get_unsigned_short_int_type,
+    get_signed_int_type,
+    get_unsigned_int_type,
+    get_signed_long_int_type,
+    get_unsigned_long_int_type,
+    get_signed_long_long_int_type,
+    get_unsigned_long_long_int_type,
+    get_signed_int128_type,
+    get_unsigned_int128_type,
+    get_float_type,
+    get_double_type,
+    get_long_double_type,
+    pch_get_float128_type,
+    pch_get_float16_type,
+    get_gcc_builtin_va_list_type,
+};
+
+#define PCH_NUM_BUILTIN_TYPES (int)(sizeof(pch_builtin_types) / sizeof(pch_builtin_types[0]))
+
+// Symbols created by the compiler itself are not saved but looked up by
+// name in the translation unit using the precompiled header. Their locus
+// is something like '(global scope)' or '(gcc-builtin)'
+static char pch_symbol_is_predefined(scope_entry_t* entry)
+{
+    return symbol_entity_specs_get_is_builtin(entry)
+        || (entry->locus != NULL
+                && locus_get_filename(entry->locus) != NULL
+                && locus_get_filename(entry->locus)[0] == '(');
+}
+
+// ----------------------------------------------------------------------
+// Writer
+// ----------------------------------------------------------------------
+
+typedef struct pch_pending_tag
+{
+    enum pch_record_kind kind;
+    const void* p;
+} pch_pending_t;
+
+typedef struct pch_name_tag
+{
+    const char* name;
+    uint32_t string;
+    uint32_t record;
+} pch_name_t;
+
+typedef struct pch_writer_tag
+{
+    scope_t* global_scope;
+
+    // Objects already given a record, by address
+    ohash_ptr_t* record_ids;
+    int num_records;
+    pch_pending_t* records;
+    uint32_t* record_offsets;
+
+    ohash_ptr_t* string_ids;
+    int num_strings;
+    const char** strings;
+
+    int num_words;
+    int capacity_words;
+    uint32_t* words;
+
+    int num_names;
+    pch_name_t* names;
+} pch_writer_t;
+
+static void pch_write_word(pch_writer_t* w, uint32_t word)
+{
+    if (w->num_words == w->capacity_words)
+    {
+        w->capacity_words = w->capacity_words == 0 ? 4096 : 2 * w->capacity_words;
+        w->words = NEW_REALLOC(uint32_t, w->words, w->capacity_words);
+    }
+    w->words[w->num_words] = word;
+    w->num_words++;
+}
+
+static void pch_write_wide(pch_writer_t* w, uint64_t value)
+{
+    pch_write_word(w, (uint32_t)value);
+    pch_write_word(w, (uint32_t)(value >> 32));
+}
+
+static uint32_t pch_string_id(pch_writer_t* w, const char* str)
+{
+    if (str == NULL)
+        return 0;
+
+    str = uniquestr(str);
+    intptr_t id = (intptr_t)ohash_ptr_query(w->string_ids, str);
+    if (id == 0)
+    {
+        P_LIST_ADD(w->strings, w->num_strings, str);
+        id = w->num_strings;
+        ohash_ptr_insert(w->string_ids, str, (void*)id);
+    }
+
+    return id;
+}
+
+static uint32_t pch_record_id(pch_writer_t* w, enum pch_record_kind kind, const void* p)
+{
+    if (p == NULL)
+        return 0;
+
+    intptr_t id = (intptr_t)ohash_ptr_query(w->record_ids, (const char*)p);
+    if (id == 0)
+    {
+        pch_pending_t pending = { kind, p };
+        P_LIST_ADD(w->records, w->num_records, pending);
+        id = w->num_records;
+        ohash_ptr_insert(w->record_ids, (const char*)p, (void*)id);
+    }
+
+    return id;
+}
+
+static uint32_t pch_symbol_id(pch_writer_t* w, scope_entry_t* entry)
+{
+    return pch_record_id(w, PCH_RECORD_SYMBOL, entry);
+}
+
+static uint32_t pch_type_id(pch_writer_t* w, type_t* t)
+{
+    return pch_record_id(w, PCH_RECORD_TYPE, t);
+}
+
+static uint32_t pch_nodecl_id(pch_writer_t* w, nodecl_t n)
+{
+    return pch_record_id(w, PCH_RECORD_NODECL, nodecl_get_ast(n));
+}
+
+static uint32_t pch_const_value_id(pch_writer_t* w, const_value_t* v)
+{
+    return pch_record_id(w, PCH_RECORD_CONST_VALUE, v);
+}
+
+static uint32_t pch_scope_id(pch_writer_t* w, scope_t* sc)
+{
+    if (sc == w->global_scope)
+        return pch_record_id(w, PCH_RECORD_GLOBAL_SCOPE, sc);
+    return pch_record_id(w, PCH_RECORD_SCOPE, sc);
+}
+
+static uint32_t pch_decl_context_id(pch_writer_t* w, const decl_context_t* decl_context)
+{
+    return pch_record_id(w, PCH_RECORD_DECL_CONTEXT, decl_context);
+}
+
+static void pch_write_locus(pch_writer_t* w, const locus_t* locus)
+{
+    if (locus == NULL)
+    {
+        pch_write_word(w, 0);
+        pch_write_word(w, 0);
+        pch_write_word(w, 0);
+    }
+    else
+    {
+        pch_write_word(w, pch_string_id(w, locus_get_filename(locus)));
+        pch_write_word(w, locus_get_line(locus));
+        pch_write_word(w, locus_get_column(locus));
+    }
+}
+
+static void pch_write_entity_specs(pch_writer_t* w, scope_entry_t* symbol);
+
+static void pch_write_symbol_record(pch_writer_t* w, scope_entry_t* entry)
+{
+    if (pch_symbol_is_predefined(entry))
+    {
+        pch_write_word(w, PCH_RECORD_PREDEFINED_SYMBOL);
+        pch_write_word(w, pch_string_id(w, entry->symbol_name));
+        pch_write_word(w, entry->kind);
+        return;
+    }
+
+    pch_write_word(w, PCH_RECORD_SYMBOL);
+    pch_write_word(w, pch_string_id(w, entry->symbol_name));
+    pch_write_word(w, entry->kind);
+    pch_write_word(w, entry->defined | (entry->do_not_print << 1));
+    pch_write_word(w, pch_decl_context_id(w, entry->decl_context));
+    pch_write_word(w, pch_decl_context_id(w, entry->related_decl_context));
+    pch_write_locus(w, entry->locus);
+    pch_write_word(w, pch_type_id(w, entry->type_information));
+    pch_write_word(w, pch_nodecl_id(w, entry->value));
+
+    pch_write_entity_specs(w, entry);
+}
+
+static void pch_write_gcc_attributes(pch_writer_t* w, int num_attrs, gcc_attribute_t* attrs)
+{
+    pch_write_word(w, num_attrs);
+    int i;
+    for (i = 0; i < num_attrs; i++)
+    {
+        pch_write_word(w, pch_string_id(w, attrs[i].attribute_name));
+        pch_write_word(w, pch_nodecl_id(w, attrs[i].expression_list));
+    }
+}
+
+static void pch_write_type_record(pch_writer_t* w, type_t* t)
+{
+    pch_write_word(w, PCH_RECORD_TYPE);
+
+    int i;
+    for (i = 0; i < PCH_NUM_BUILTIN_TYPES; i++)
+    {
+        if (t == (pch_builtin_types[i])())
+        {
+            pch_write_word(w, PCH_TYPE_BUILTIN);
+            pch_write_word(w, i);
+            return;
+        }
+    }
+
+    if (!is_array_type(t) || is_named_type(t))
+    {
+        // We do not use get_unqualified_type because it preserves restrict
+        type_t* base = get_cv_qualified_type(t, CV_NONE);
+        if (is_variant_type(base))
+            base = variant_type_get_nonvariant(base);
+
+        if (base != t)
+        {
+            pch_write_word(w, PCH_TYPE_VARIANT);
+            pch_write_word(w, pch_type_id(w, base));
+            pch_write_word(w, get_cv_qualifier(t));
+
+            int num_attrs = 0;
+            gcc_attribute_t* attrs = NULL;
+            variant_type_get_gcc_attributes(t, &num_attrs, &attrs);
+            pch_write_gcc_attributes(w, num_attrs, attrs);
+
+            num_attrs = 0;
+            attrs = NULL;
+            variant_type_get_ms_attributes(t, &num_attrs, &attrs);
+            pch_write_gcc_attributes(w, num_attrs, attrs);
+
+            pch_write_word(w, variant_type_is_atomic(t));
+            return;
+        }
+    }
+
+    if (is_named_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_NAMED);
+        pch_write_word(w, pch_symbol_id(w, named_type_get_symbol(t)));
+        if (!is_indirect_type(t))
+            pch_write_word(w, 0);
+        else if (!is_mutable_indirect_type(t))
+            pch_write_word(w, 1);
+        else
+            pch_write_word(w, 2);
+    }
+    else if (is_pointer_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_POINTER);
+        pch_write_word(w, pch_type_id(w, pointer_type_get_pointee_type(t)));
+    }
+    else if (is_rebindable_reference_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_REBINDABLE_REFERENCE);
+        pch_write_word(w, pch_type_id(w, reference_type_get_referenced_type(t)));
+    }
+    else if (is_lvalue_reference_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_LVALUE_REFERENCE);
+        pch_write_word(w, pch_type_id(w, reference_type_get_referenced_type(t)));
+    }
+    else if (is_rvalue_reference_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_RVALUE_REFERENCE);
+        pch_write_word(w, pch_type_id(w, reference_type_get_referenced_type(t)));
+    }
+    else if (is_array_type(t)
+            && array_type_is_string_literal(t))
+    {
+        nodecl_t array_size = array_type_get_array_size_expr(t);
+        ERROR_CONDITION(!nodecl_is_constant(array_size), "The size of a string literal must be constant", 0);
+
+        pch_write_word(w, PCH_TYPE_STRING_LITERAL);
+        pch_write_word(w, pch_type_id(w, array_type_get_element_type(t)));
+        pch_write_word(w, const_value_cast_to_signed_int(nodecl_get_constant(array_size)));
+    }
+    else if (is_array_type(t)
+            && !array_type_has_region(t))
+    {
+        pch_write_word(w, PCH_TYPE_ARRAY);
+        pch_write_word(w, pch_type_id(w, array_type_get_element_type(t)));
+        pch_write_word(w, pch_nodecl_id(w, array_type_get_array_size_expr(t)));
+        pch_write_word(w, pch_decl_context_id(w, array_type_get_array_size_expr_context(t)));
+    }
+    else if (is_function_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_FUNCTION);
+        pch_write_word(w, pch_type_id(w, function_type_get_return_type(t)));
+
+        int num_parameters = function_type_get_num_parameters(t);
+        pch_write_word(w, function_type_get_lacking_prototype(t));
+        pch_write_word(w, function_type_get_has_ellipsis(t));
+        pch_write_word(w, num_parameters);
+
+        if (!function_type_get_lacking_prototype(t))
+        {
+            if (function_type_get_has_ellipsis(t))
+                num_parameters--;
+
+            for (i = 0; i < num_parameters; i++)
+            {
+                pch_write_word(w, pch_type_id(w, function_type_get_parameter_type_num(t, i)));
+                pch_write_word(w, pch_type_id(w, function_type_get_nonadjusted_parameter_type_num(t, i)));
+            }
+        }
+    }
+    else if (is_vector_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_VECTOR);
+        pch_write_word(w, pch_type_id(w, vector_type_get_element_type(t)));
+        pch_write_word(w, vector_type_get_vector_size_in_bytes(t));
+    }
+    else if (is_complex_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_COMPLEX);
+        pch_write_word(w, pch_type_id(w, complex_type_get_base_type(t)));
+    }
+    else if (is_class_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_CLASS);
+        pch_write_word(w, class_type_get_class_kind(t));
+        pch_write_word(w, pch_decl_context_id(w, class_type_get_context(t)));
+        pch_write_word(w, pch_decl_context_id(w, class_type_get_inner_context(t)));
+        pch_write_word(w, is_complete_type(t));
+        pch_write_word(w, class_type_is_packed(t));
+
+        scope_entry_list_t* members = class_type_get_members(t);
+        pch_write_word(w, entry_list_size(members));
+
+        scope_entry_list_iterator_t* it = NULL;
+        for (it = entry_list_iterator_begin(members);
+                !entry_list_iterator_end(it);
+                entry_list_iterator_next(it))
+        {
+            pch_write_word(w, pch_symbol_id(w, entry_list_iterator_current(it)));
+        }
+        entry_list_iterator_free(it);
+        entry_list_free(members);
+    }
+    else if (is_enum_type(t))
+    {
+        pch_write_word(w, PCH_TYPE_ENUM);
+        pch_write_word(w, is_scoped_enum_type(t));
+        pch_write_word(w, pch_decl_context_id(w, enum_type_get_context(t)));
+        pch_write_word(w, pch_type_id(w, enum_type_get_underlying_type(t)));
+        pch_write_word(w, enum_type_get_underlying_type_is_fixed(t));
+        pch_write_word(w, is_complete_type(t));
+
+        int num_enumerators = enum_type_get_num_enumerators(t);
+        pch_write_word(w, num_enumerators);
+        for (i = 0; i < num_enumerators; i++)
+        {
+            pch_write_word(w, pch_symbol_id(w, enum_type_get_enumerator_num(t, i)));
+        }
+    }
+    else
+    {
+        fatal_error("type '%s' cannot be saved in a precompiled header",
+                print_declarator(t));
+    }
+}
+
+static void pch_write_nodecl_record(pch_writer_t* w, AST a)
+{
+    nodecl_t n = _nodecl_wrap(a);
+
+    pch_write_word(w, PCH_RECORD_NODECL);
+    pch_write_word(w, ast_get_kind(a));
+    // Lists compute their locus from their elements
+    pch_write_locus(w, ast_get_kind(a) != AST_NODE_LIST ? ast_get_locus(a) : NULL);
+    pch_write_word(w, pch_string_id(w, ast_get_text(a)));
+    pch_write_word(w, pch_type_id(w, nodecl_get_type(n)));
+    pch_write_word(w, pch_symbol_id(w, nodecl_get_symbol(n)));
+    pch_write_word(w, pch_const_value_id(w, nodecl_get_constant(n)));
+
+    if (ast_get_kind(a) == NODECL_CONTEXT
+            || ast_get_kind(a) == NODECL_PRAGMA_CONTEXT)
+    {
+        pch_write_word(w, pch_decl_context_id(w, nodecl_get_decl_context(n)));
+    }
+
+    if (nodecl_get_template_parameters(n) != NULL)
+    {
+        fatal_error("templates cannot be saved in a precompiled header");
+    }
+
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        pch_write_word(w, pch_record_id(w, PCH_RECORD_NODECL, ast_get_child(a, i)));
+    }
+}
+
+static void pch_write_const_value_record(pch_writer_t* w, const_value_t* v)
+{
+    pch_write_word(w, PCH_RECORD_CONST_VALUE);
+
+    enum pch_const_value_kind kind = PCH_CONST_VALUE_INVALID;
+    if (const_value_is_integer(v)
+            || const_value_is_float(v)
+            || const_value_is_double(v)
+            || const_value_is_long_double(v)
+#ifdef HAVE_QUADMATH_H
+            || const_value_is_float128(v)
+#endif
+       )
+    {
+        // These do not point to anything
+        pch_write_word(w, PCH_CONST_VALUE_SCALAR);
+
+        size_t size = const_value_get_raw_data_size();
+        uint32_t raw[(size + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+        memset(raw, 0, sizeof(raw));
+        memcpy(raw, v, size);
+
+        unsigned int i;
+        for (i = 0; i < sizeof(raw) / sizeof(raw[0]); i++)
+        {
+            pch_write_word(w, raw[i]);
+        }
+        return;
+    }
+    else if (const_value_is_complex(v))
+        kind = PCH_CONST_VALUE_COMPLEX;
+    else if (const_value_is_structured(v))
+        kind = PCH_CONST_VALUE_STRUCT;
+    else if (const_value_is_array(v))
+        kind = PCH_CONST_VALUE_ARRAY;
+    else if (const_value_is_vector(v))
+        kind = PCH_CONST_VALUE_VECTOR;
+    else if (const_value_is_string(v))
+        kind = PCH_CONST_VALUE_STRING;
+    else if (const_value_is_range(v))
+        kind = PCH_CONST_VALUE_RANGE;
+
+    // Addresses and unknown values are dropped, the tree is still there
+    pch_write_word(w, kind);
+    if (kind == PCH_CONST_VALUE_INVALID)
+        return;
+
+    if (kind == PCH_CONST_VALUE_STRUCT)
+        pch_write_word(w, pch_type_id(w, const_value_get_struct_type(v)));
+
+    int i, num_elements = const_value_get_num_elements(v);
+    pch_write_word(w, num_elements);
+    for (i = 0; i < num_elements; i++)
+    {
+        pch_write_word(w, pch_const_value_id(w, const_value_get_element_num(v, i)));
+    }
+}
+
+typedef struct pch_scope_names_tag
+{
+    int num_names;
+    const char** names;
+    scope_entry_list_t** entries;
+} pch_scope_names_t;
+
+static void pch_collect_scope_names(const char* name, void* info, void* walk_info)
+{
+    pch_scope_names_t* scope_names = (pch_scope_names_t*)walk_info;
+
+    int num_names = scope_names->num_names;
+    P_LIST_ADD(scope_names->names, num_names, name);
+    P_LIST_ADD(scope_names->entries, scope_names->num_names, (scope_entry_list_t*)info);
+}
+
+static void pch_write_scope_record(pch_writer_t* w, scope_t* sc)
+{
+    pch_write_word(w, PCH_RECORD_SCOPE);
+    pch_write_word(w, sc->kind);
+    pch_write_word(w, pch_scope_id(w, sc->contained_in));
+    pch_write_word(w, pch_symbol_id(w, sc->related_entry));
+
+    if (sc->num_used_namespaces != 0)
+    {
+        fatal_error("using directives cannot be saved in a precompiled header");
+    }
+
+    pch_scope_names_t scope_names;
+    memset(&scope_names, 0, sizeof(scope_names));
+    ohash_ptr_walk(sc->hash, pch_collect_scope_names, &scope_names);
+
+    pch_write_word(w, scope_names.num_names);
+    int i;
+    for (i = 0; i < scope_names.num_names; i++)
+    {
+        pch_write_word(w, pch_string_id(w, scope_names.names[i]));
+        pch_write_word(w, entry_list_size(scope_names.entries[i]));
+
+        scope_entry_list_iterator_t* it = NULL;
+        for (it = entry_list_iterator_begin(scope_names.entries[i]);
+                !entry_list_iterator_end(it);
+                entry_list_iterator_next(it))
+        {
+            pch_write_word(w, pch_symbol_id(w, entry_list_iterator_current(it)));
+        }
+        entry_list_iterator_free(it);
+    }
+
+    DELETE(scope_names.names);
+    DELETE(scope_names.entries);
+}
+
+static void pch_write_decl_context_record(pch_writer_t* w, const decl_context_t* decl_context)
+{
+    if (decl_context->template_parameters != NULL)
+    {
+        fatal_error("templates cannot be saved in a precompiled header");
+    }
+
+    pch_write_word(w, PCH_RECORD_DECL_CONTEXT);
+    pch_write_word(w, decl_context->decl_flags);
+    pch_write_word(w, pch_scope_id(w, decl_context->namespace_scope));
+    pch_write_word(w, pch_scope_id(w, decl_context->global_scope));
+    pch_write_word(w, pch_scope_id(w, decl_context->block_scope));
+    pch_write_word(w, pch_scope_id(w, decl_context->class_scope));
+    pch_write_word(w, pch_scope_id(w, decl_context->function_scope));
+    pch_write_word(w, pch_scope_id(w, decl_context->prototype_scope));
+    pch_write_word(w, pch_scope_id(w, decl_context->current_scope));
+}
+
+static void pch_write_record(pch_writer_t* w, pch_pending_t* pending)
+{
+    switch (pending->kind)
+    {
+        case PCH_RECORD_SYMBOL:
+            pch_write_symbol_record(w, (scope_entry_t*)pending->p);
+            break;
+        case PCH_RECORD_TYPE:
+            pch_write_type_record(w, (type_t*)pending->p);
+            break;
+        case PCH_RECORD_NODECL:
+            pch_write_nodecl_record(w, (AST)pending->p);
+            break;
+        case PCH_RECORD_CONST_VALUE:
+            pch_write_const_value_record(w, (const_value_t*)pending->p);
+            break;
+        case PCH_RECORD_SCOPE:
+            pch_write_scope_record(w, (scope_t*)pending->p);
+            break;
+        case PCH_RECORD_GLOBAL_SCOPE:
+            // Its symbols are in the names
+            pch_write_word(w, PCH_RECORD_GLOBAL_SCOPE);
+            break;
+        case PCH_RECORD_DECL_CONTEXT:
+            pch_write_decl_context_record(w, (const decl_context_t*)pending->p);
+            break;
+        default:
+            internal_error("Invalid record kind %d", pending->kind);
+    }
+}
+
+static void pch_add_global_names(const char* name, void* info, void* walk_info)
+{
+    pch_writer_t* w = (pch_writer_t*)walk_info;
+    scope_entry_list_t* entry_list = (scope_entry_list_t*)info;
+
+    scope_entry_list_iterator_t* it = NULL;
+    for (it = entry_list_iterator_begin(entry_list);
+            !entry_list_iterator_end(it);
+            entry_list_iterator_next(it))
+    {
+        scope_entry_t* entry = entry_list_iterator_current(it);
+        if (pch_symbol_is_predefined(entry))
+            continue;
+
+        pch_name_t current_name;
+        current_name.name = uniquestr(name);
+        current_name.string = pch_string_id(w, name);
+        current_name.record = pch_symbol_id(w, entry);
+
+        P_LIST_ADD(w->names, w->num_names, current_name);
+    }
+    entry_list_iterator_free(it);
+}
+
+static int pch_compare_names(const void* p1, const void* p2)
+{
+    const pch_name_t* n1 = (const pch_name_t*)p1;
+    const pch_name_t* n2 = (const pch_name_t*)p2;
+
+    int c = strcmp(n1->name, n2->name);
+    if (c != 0)
+        return c;
+
+    // Keep the order of the scope for the same name
+    if (n1->record < n2->record)
+        return -1;
+    else if (n1->record > n2->record)
+        return 1;
+    return 0;
+}
+
+static void pch_write_info(pch_writer_t* w, const pch_info_t* info)
+{
+    pch_write_word(w, pch_string_id(w, info->configuration_key));
+
+    pch_write_word(w, info->num_includes);
+    int i;
+    for (i = 0; i < info->num_includes; i++)
+    {
+        pch_write_word(w, pch_string_id(w, info->includes[i]));
+    }
+
+    pch_write_word(w, info->num_dependences);
+    for (i = 0; i < info->num_dependences; i++)
+    {
+        pch_write_word(w, pch_string_id(w, info->dependences[i].filename));
+        pch_write_wide(w, info->dependences[i].size);
+        pch_write_wide(w, (uint64_t)info->dependences[i].mtime);
+        pch_write_wide(w, info->dependences[i].hash);
+    }
+}
+
+static void pch_fwrite(const void* p, size_t size, FILE* f, const char* filename)
+{
+    if (size != 0
+            && fwrite(p, size, 1, f) != 1)
+    {
+        fatal_error("error: cannot write precompiled header '%s' (%s)",
+                filename, strerror(errno));
+    }
+}
+
+void pch_write(const char* filename,
+        const decl_context_t* global_decl_context,
+        const pch_info_t* info)
+{
+    pch_writer_t w;
+    memset(&w, 0, sizeof(w));
+
+    w.global_scope = global_decl_context->global_scope;
+    w.record_ids = ohash_ptr_new(5);
+    w.string_ids = ohash_ptr_new(5);
+
+    // Records are written in the order they are first referenced
+    ohash_ptr_walk(w.global_scope->hash, pch_add_global_names, &w);
+
+    int i, num_record_offsets = 0;
+    for (i = 0; i < w.num_records; i++)
+    {
+        P_LIST_ADD(w.record_offsets, num_record_offsets, w.num_words);
+        // Writing a record may add new records and reallocate them
+        pch_pending_t pending = w.records[i];
+        pch_write_record(&w, &pending);
+    }
+
+    uint32_t info_offset = w.num_words;
+    pch_write_info(&w, info);
+
+    qsort(w.names, w.num_names, sizeof(*w.names), pch_compare_names);
+
+    // Strings
+    uint32_t* string_offsets = NEW_VEC(uint32_t, w.num_strings + 1);
+    uint32_t strings_size = 0;
+    string_offsets[0] = 0;
+    for (i = 0; i < w.num_strings; i++)
+    {
+        string_offsets[i + 1] = strings_size;
+        strings_size += strlen(w.strings[i]) + 1;
+    }
+    uint32_t strings_padding = (sizeof(uint32_t) - strings_size % sizeof(uint32_t)) % sizeof(uint32_t);
+
+    // Record 0 is NULL and after the last record comes the info
+    uint32_t* record_offsets = NEW_VEC(uint32_t, w.num_records + 2);
+    record_offsets[0] = 0;
+    for (i = 0; i < w.num_records; i++)
+    {
+        record_offsets[i + 1] = w.record_offsets[i];
+    }
+    record_offsets[w.num_records + 1] = info_offset;
+
+    pch_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PCH_MAGIC, sizeof(PCH_MAGIC));
+    header.version = PCH_VERSION;
+    header.num_strings = w.num_strings;
+    header.strings_size = strings_size;
+    header.num_records = w.num_records;
+    header.num_words = w.num_words;
+    header.info_offset = info_offset;
+    header.num_names = w.num_names;
+
+    // Write in a temporary file first so nobody reads a partial file
+    const char* temporary_filename = NULL;
+    uniquestr_sprintf(&temporary_filename, "%s.%d.tmp", filename, (int)getpid());
+
+    FILE* f = fopen(temporary_filename, "wb");
+    if (f == NULL)
+    {
+        fatal_error("error: cannot create precompiled header '%s' (%s)",
+                temporary_filename, strerror(errno));
+    }
+
+    pch_fwrite(&header, sizeof(header), f, temporary_filename);
+    pch_fwrite(string_offsets, sizeof(uint32_t) * (w.num_strings + 1), f, temporary_filename);
+    for (i = 0; i < w.num_strings; i++)
+    {
+        pch_fwrite(w.strings[i], strlen(w.strings[i]) + 1, f, temporary_filename);
+    }
+    const char padding[sizeof(uint32_t)] = { 0 };
+    pch_fwrite(padding, strings_padding, f, temporary_filename);
+    pch_fwrite(record_offsets, sizeof(uint32_t) * (w.num_records + 2), f, temporary_filename);
+    pch_fwrite(w.words, sizeof(uint32_t) * w.num_words, f, temporary_filename);
+    for (i = 0; i < w.num_names; i++)
+    {
+        uint32_t name[2] = { w.names[i].string, w.names[i].record };
+        pch_fwrite(name, sizeof(name), f, temporary_filename);
+    }
+
+    if (fclose(f) != 0)
+    {
+        fatal_error("error: cannot write precompiled header '%s' (%s)",
+                temporary_filename, strerror(errno));
+    }
+
+    if (rename(temporary_filename, filename) != 0)
+    {
+        fatal_error("error: cannot rename '%s' to '%s' (%s)",
+                temporary_filename, filename, strerror(errno));
+    }
+
+    DELETE(string_offsets);
+    DELETE(record_offsets);
+    DELETE(w.records);
+    DELETE(w.record_offsets);
+    DELETE(w.strings);
+    DELETE(w.words);
+    DELETE(w.names);
+    ohash_ptr_destroy(w.record_ids);
+    ohash_ptr_destroy(w.string_ids);
+}
+
+// ----------------------------------------------------------------------
+// Reader
+// ----------------------------------------------------------------------
+
+struct pch_file_tag
+{
+    const char* filename;
+
+    void* map;
+    size_t map_size;
+
+    const pch_header_t* header;
+    const uint32_t* string_offsets;
+    const char* strings;
+    const uint32_t* record_offsets;
+    const uint32_t* words;
+    const uint32_t* names;
+
+    pch_info_t info;
+
+    // Valid only while loaded
+    const decl_context_t* global_decl_context;
+    void** objects;
+    char* filled;
+    const char** unique_strings;
+};
+
+typedef struct pch_cursor_tag
+{
+    pch_file_t* pch;
+    const uint32_t* current;
+    const uint32_t* end;
+} pch_cursor_t;
+
+// The precompiled header whose names are signed in lazily
+static pch_file_t* current_pch = NULL;
+static int num_loaded_symbols = 0;
+
+static void pch_corrupted(pch_file_t* pch) NORETURN;
+static void pch_corrupted(pch_file_t* pch)
+{
+    fatal_error("error: precompiled header '%s' is corrupted", pch->filename);
+}
+
+static uint32_t pch_read_word(pch_cursor_t* c)
+{
+    if (c->current >= c->end)
+        pch_corrupted(c->pch);
+
+    uint32_t word = *c->current;
+    c->current++;
+    return word;
+}
+
+static uint64_t pch_read_wide(pch_cursor_t* c)
+{
+    uint64_t low = pch_read_word(c);
+    uint64_t high = pch_read_word(c);
+    return low | (high << 32);
+}
+
+static const char* pch_get_raw_string(pch_file_t* pch, uint32_t id)
+{
+    if (id == 0)
+        return NULL;
+    if (id > pch->header->num_strings)
+        pch_corrupted(pch);
+    return pch->strings + pch->string_offsets[id];
+}
+
+static const char* pch_read_string(pch_cursor_t* c)
+{
+    pch_file_t* pch = c->pch;
+    uint32_t id = pch_read_word(c);
+    if (id == 0)
+        return NULL;
+
+    const char* raw = pch_get_raw_string(pch, id);
+    if (pch->unique_strings[id] == NULL)
+        pch->unique_strings[id] = uniquestr(raw);
+
+    return pch->unique_strings[id];
+}
+
+static void pch_init_cursor(pch_file_t* pch, pch_cursor_t* c, uint32_t id)
+{
+    if (id == 0 || id > pch->header->num_records)
+        pch_corrupted(pch);
+
+    c->pch = pch;
+    c->current = pch->words + pch->record_offsets[id];
+    c->end = pch->words + pch->record_offsets[id + 1];
+}
+
+static void* pch_get_record(pch_file_t* pch, uint32_t id);
+
+static scope_entry_t* pch_read_symbol(pch_cursor_t* c)
+{
+    return (scope_entry_t*)pch_get_record(c->pch, pch_read_word(c));
+}
+
+static type_t* pch_read_type(pch_cursor_t* c)
+{
+    return (type_t*)pch_get_record(c->pch, pch_read_word(c));
+}
+
+static nodecl_t pch_read_nodecl(pch_cursor_t* c)
+{
+    return _nodecl_wrap((AST)pch_get_record(c->pch, pch_read_word(c)));
+}
+
+static const_value_t* pch_read_const_value(pch_cursor_t* c)
+{
+    return (const_value_t*)pch_get_record(c->pch, pch_read_word(c));
+}
+
+static scope_t* pch_read_scope(pch_cursor_t* c)
+{
+    return (scope_t*)pch_get_record(c->pch, pch_read_word(c));
+}
+
+static const decl_context_t* pch_read_decl_context(pch_cursor_t* c)
+{
+    return (const decl_context_t*)pch_get_record(c->pch, pch_read_word(c));
+}
+
+static const locus_t* pch_read_locus(pch_cursor_t* c)
+{
+    const char* filename = pch_read_string(c);
+    unsigned int line = pch_read_word(c);
+    unsigned int column = pch_read_word(c);
+
+    if (filename == NULL && line == 0)
+        return NULL;
+
+    return make_locus(filename, line, column);
+}
+
+static uint32_t pch_record_kind(pch_file_t* pch, uint32_t id)
+{
+    pch_cursor_t c;
+    pch_init_cursor(pch, &c, id);
+    return pch_read_word(&c);
+}
+
+static void pch_fill_decl_context(pch_file_t* pch, uint32_t id);
+
+// Decl contexts are created before they are filled so types can refer to
+// them while their scopes are being rebuilt
+static decl_context_t* pch_reserve_decl_context(pch_file_t* pch, uint32_t id)
+{
+    if (id == 0)
+        return NULL;
+    if (pch_record_kind(pch, id) != PCH_RECORD_DECL_CONTEXT)
+        pch_corrupted(pch);
+
+    if (pch->objects[id] == NULL)
+        pch->objects[id] = decl_context_empty();
+
+    return (decl_context_t*)pch->objects[id];
+}
+
+#include "cxx-pch-entity-specs.h"
+
+static scope_entry_t* pch_read_predefined_symbol_record(pch_cursor_t* c)
+{
+    pch_file_t* pch = c->pch;
+
+    const char* name = pch_read_string(c);
+    enum cxx_symbol_kind kind = (enum cxx_symbol_kind)pch_read_word(c);
+
+    scope_entry_list_t* entry_list = query_in_scope_str(pch->global_decl_context, name, NULL);
+
+    scope_entry_t* result = NULL;
+    scope_entry_list_iterator_t* it = NULL;
+    for (it = entry_list_iterator_begin(entry_list);
+            !entry_list_iterator_end(it) && result == NULL;
+            entry_list_iterator_next(it))
+    {
+        scope_entry_t* entry = entry_list_iterator_current(it);
+        if (entry->kind == kind)
+            result = entry;
+    }
+    entry_list_iterator_free(it);
+    entry_list_free(entry_list);
+
+    if (result == NULL)
+    {
+        fatal_error("error: precompiled header '%s' uses '%s' which is not predefined by this compiler",
+                pch->filename, name);
+    }
+
+    return result;
+}
+
+static scope_entry_t* pch_read_symbol_record(pch_cursor_t* c, uint32_t id)
+{
+    pch_file_t* pch = c->pch;
+
+    scope_entry_t* entry = NEW0(scope_entry_t);
+    // Cache it first as it may be referenced by its own fields
+    pch->objects[id] = entry;
+
+    entry->symbol_name = pch_read_string(c);
+    entry->kind = (enum cxx_symbol_kind)pch_read_word(c);
+
+    uint32_t flags = pch_read_word(c);
+    entry->defined = flags & 1;
+    entry->do_not_print = (flags >> 1) & 1;
+
+    entry->decl_context = pch_read_decl_context(c);
+    entry->related_decl_context = pch_read_decl_context(c);
+    entry->locus = pch_read_locus(c);
+    entry->type_information = pch_read_type(c);
+    entry->value = pch_read_nodecl(c);
+
+    pch_read_entity_specs(c, entry);
+
+    symbol_entity_specs_set_is_from_pch(entry, 1);
+    symbol_entity_specs_set_is_defined_in_pch(entry, entry->defined);
+
+    num_loaded_symbols++;
+
+    return entry;
+}
+
+static void pch_read_gcc_attributes(pch_cursor_t* c, int* num_attrs, gcc_attribute_t** attrs)
+{
+    *num_attrs = pch_read_word(c);
+    *attrs = NULL;
+    if (*num_attrs > 0)
+        *attrs = NEW_VEC(gcc_attribute_t, *num_attrs);
+
+    int i;
+    for (i = 0; i < *num_attrs; i++)
+    {
+        (*attrs)[i].attribute_name = pch_read_string(c);
+        (*attrs)[i].expression_list = pch_read_nodecl(c);
+    }
+}
+
+static type_t* pch_read_type_record(pch_cursor_t* c, uint32_t id)
+{
+    pch_file_t* pch = c->pch;
+
+    type_t* result = NULL;
+    enum pch_type_kind kind = (enum pch_type_kind)pch_read_word(c);
+    int i;
+    switch (kind)
+    {
+        case PCH_TYPE_BUILTIN:
+            {
+                uint32_t n = pch_read_word(c);
+                if (n >= (uint32_t)PCH_NUM_BUILTIN_TYPES)
+                    pch_corrupted(pch);
+                result = (pch_builtin_types[n])();
+                if (result == NULL)
+                {
+                    fatal_error("error: precompiled header '%s' uses a type not available in this configuration",
+                            pch->filename);
+                }
+                break;
+            }
+        case PCH_TYPE_VARIANT:
+            {
+                result = pch_read_type(c);
+                cv_qualifier_t cv_qualif = (cv_qualifier_t)pch_read_word(c);
+
+                int num_attrs = 0;
+                gcc_attribute_t* attrs = NULL;
+                pch_read_gcc_attributes(c, &num_attrs, &attrs);
+                for (i = 0; i < num_attrs; i++)
+                    result = get_variant_type_add_gcc_attribute(result, attrs[i]);
+                DELETE(attrs);
+
+                pch_read_gcc_attributes(c, &num_attrs, &attrs);
+                for (i = 0; i < num_attrs; i++)
+                    result = get_variant_type_add_ms_attribute(result, attrs[i]);
+                DELETE(attrs);
+
+                if (pch_read_word(c))
+                    result = get_variant_type_atomic(result);
+
+                result = get_cv_qualified_type(result, cv_qualif);
+                break;
+            }
+        case PCH_TYPE_NAMED:
+            {
+                scope_entry_t* entry = pch_read_symbol(c);
+                switch (pch_read_word(c))
+                {
+                    case 0:
+                        result = get_user_defined_type(entry);
+                        break;
+                    case 1:
+                        result = get_immutable_indirect_type(entry);
+                        break;
+                    case 2:
+                        result = get_mutable_indirect_type(entry);
+                        break;
+                    default:
+                        pch_corrupted(pch);
+                }
+                break;
+            }
+        case PCH_TYPE_POINTER:
+            result = get_pointer_type(pch_read_type(c));
+            break;
+        case PCH_TYPE_LVALUE_REFERENCE:
+            result = get_lvalue_reference_type(pch_read_type(c));
+            break;
+        case PCH_TYPE_RVALUE_REFERENCE:
+            result = get_rvalue_reference_type(pch_read_type(c));
+            break;
+        case PCH_TYPE_REBINDABLE_REFERENCE:
+            result = get_rebindable_reference_type(pch_read_type(c));
+            break;
+        case PCH_TYPE_STRING_LITERAL:
+            {
+                type_t* element_type = pch_read_type(c);
+                int length = (int)pch_read_word(c);
+                result = reference_type_get_referenced_type(
+                        get_literal_string_type(length, element_type));
+                break;
+            }
+        case PCH_TYPE_ARRAY:
+            {
+                type_t* element_type = pch_read_type(c);
+                nodecl_t array_size = pch_read_nodecl(c);
+                const decl_context_t* decl_context = pch_read_decl_context(c);
+                result = get_array_type(element_type, array_size, decl_context);
+                break;
+            }
+        case PCH_TYPE_FUNCTION:
+            {
+                type_t* return_type = pch_read_type(c);
+                char lacking_prototype = pch_read_word(c);
+                char has_ellipsis = pch_read_word(c);
+                int num_parameters = (int)pch_read_word(c);
+
+                if (lacking_prototype)
+                {
+                    result = get_nonproto_function_type(return_type, num_parameters);
+                    break;
+                }
+
+                if (num_parameters < 0
+                        || (has_ellipsis && num_parameters == 0))
+                    pch_corrupted(pch);
+
+                parameter_info_t parameter_info[num_parameters + 1];
+                memset(parameter_info, 0, sizeof(parameter_info));
+
+                int num_proper_parameters = has_ellipsis ? num_parameters - 1 : num_parameters;
+                for (i = 0; i < num_proper_parameters; i++)
+                {
+                    parameter_info[i].type_info = pch_read_type(c);
+                    parameter_info[i].nonadjusted_type_info = pch_read_type(c);
+                }
+                if (has_ellipsis)
+                {
+                    parameter_info[num_proper_parameters].is_ellipsis = 1;
+                    parameter_info[num_proper_parameters].type_info = get_ellipsis_type();
+                    parameter_info[num_proper_parameters].nonadjusted_type_info = NULL;
+                }
+
+                result = get_new_function_type(return_type, parameter_info, num_parameters,
+                        REF_QUALIFIER_NONE);
+                break;
+            }
+        case PCH_TYPE_VECTOR:
+            {
+                type_t* element_type = pch_read_type(c);
+                unsigned int vector_size = pch_read_word(c);
+                result = get_vector_type_by_bytes(element_type, vector_size);
+                break;
+            }
+        case PCH_TYPE_COMPLEX:
+            result = get_complex_type(pch_read_type(c));
+            break;
+        case PCH_TYPE_CLASS:
+            {
+                enum type_tag_t class_kind = (enum type_tag_t)pch_read_word(c);
+                uint32_t decl_context_id = pch_read_word(c);
+
+                result = get_new_class_type(pch_reserve_decl_context(pch, decl_context_id), class_kind);
+                // Members refer to this type
+                pch->objects[id] = result;
+                pch_fill_decl_context(pch, decl_context_id);
+
+                class_type_set_inner_context(result, pch_read_decl_context(c));
+                set_is_complete_type(result, pch_read_word(c));
+                class_type_set_is_packed(result, pch_read_word(c));
+
+                int num_members = (int)pch_read_word(c);
+                for (i = 0; i < num_members; i++)
+                {
+                    scope_entry_t* member = pch_read_symbol(c);
+                    class_type_add_member(result, member, member->decl_context, /* is_definition */ 1);
+                }
+                break;
+            }
+        case PCH_TYPE_ENUM:
+            {
+                char is_scoped = pch_read_word(c);
+                uint32_t decl_context_id = pch_read_word(c);
+
+                result = get_new_enum_type(pch_reserve_decl_context(pch, decl_context_id), is_scoped);
+                // Enumerators refer to this type
+                pch->objects[id] = result;
+                pch_fill_decl_context(pch, decl_context_id);
+
+                enum_type_set_underlying_type(result, pch_read_type(c));
+                enum_type_set_underlying_type_is_fixed(result, pch_read_word(c));
+                set_is_complete_type(result, pch_read_word(c));
+
+                int num_enumerators = (int)pch_read_word(c);
+                for (i = 0; i < num_enumerators; i++)
+                {
+                    enum_type_add_enumerator(result, pch_read_symbol(c));
+                }
+                break;
+            }
+        default:
+            pch_corrupted(pch);
+    }
+
+    return result;
+}
+
+static AST pch_read_nodecl_record(pch_cursor_t* c)
+{
+    node_t kind = (node_t)pch_read_word(c);
+    const locus_t* locus = pch_read_locus(c);
+    const char* text = pch_read_string(c);
+    type_t* t = pch_read_type(c);
+    scope_entry_t* entry = pch_read_symbol(c);
+    const_value_t* const_value = pch_read_const_value(c);
+
+    const decl_context_t* decl_context = NULL;
+    if (kind == NODECL_CONTEXT
+            || kind == NODECL_PRAGMA_CONTEXT)
+        decl_context = pch_read_decl_context(c);
+
+    AST children[MCXX_MAX_AST_CHILDREN];
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        children[i] = (AST)pch_get_record(c->pch, pch_read_word(c));
+    }
+
+    AST a = ast_make(kind, MCXX_MAX_AST_CHILDREN,
+            children[0], children[1], children[2], children[3],
+            locus, text);
+
+    nodecl_t n = _nodecl_wrap(a);
+    if (t != NULL)
+        nodecl_set_type(n, t);
+    if (entry != NULL)
+        nodecl_set_symbol(n, entry);
+    if (const_value != NULL)
+        nodecl_set_constant(n, const_value);
+    if (decl_context != NULL)
+        nodecl_set_decl_context(n, decl_context);
+
+    return a;
+}
+
+static const_value_t* pch_read_const_value_record(pch_cursor_t* c)
+{
+    enum pch_const_value_kind kind = (enum pch_const_value_kind)pch_read_word(c);
+    if (kind == PCH_CONST_VALUE_INVALID)
+        return NULL;
+
+    if (kind == PCH_CONST_VALUE_SCALAR)
+    {
+        size_t size = const_value_get_raw_data_size();
+        uint32_t raw[(size + sizeof(uint32_t) - 1) / sizeof(uint32_t)];
+
+        unsigned int i;
+        for (i = 0; i < sizeof(raw) / sizeof(raw[0]); i++)
+        {
+            raw[i] = pch_read_word(c);
+        }
+        return const_value_build_from_raw_data((const char*)raw);
+    }
+
+    type_t* struct_type = NULL;
+    if (kind == PCH_CONST_VALUE_STRUCT)
+        struct_type = pch_read_type(c);
+
+    int num_elements = (int)pch_read_word(c);
+    if (num_elements < 0
+            || (kind == PCH_CONST_VALUE_COMPLEX && num_elements != 2)
+            || (kind == PCH_CONST_VALUE_RANGE && num_elements != 3))
+        pch_corrupted(c->pch);
+
+    const_value_t* elements[num_elements + 1];
+    int i;
+    for (i = 0; i < num_elements; i++)
+    {
+        elements[i] = pch_read_const_value(c);
+    }
+
+    switch (kind)
+    {
+        case PCH_CONST_VALUE_COMPLEX:
+            return const_value_make_complex(elements[0], elements[1]);
+        case PCH_CONST_VALUE_STRUCT:
+            return const_value_make_struct(num_elements, elements, struct_type);
+        case PCH_CONST_VALUE_ARRAY:
+            return const_value_make_array(num_elements, elements);
+        case PCH_CONST_VALUE_VECTOR:
+            return const_value_make_vector(num_elements, elements);
+        case PCH_CONST_VALUE_STRING:
+            return const_value_make_string_from_values(num_elements, elements);
+        case PCH_CONST_VALUE_RANGE:
+            return const_value_make_range(elements[0], elements[1], elements[2]);
+        default:
+            pch_corrupted(c->pch);
+    }
+}
+
+static scope_t* pch_read_scope_record(pch_cursor_t* c, uint32_t id)
+{
+    pch_file_t* pch = c->pch;
+
+    scope_t* sc = _new_scope();
+    pch->objects[id] = sc;
+
+    sc->kind = (enum scope_kind)pch_read_word(c);
+    sc->contained_in = pch_read_scope(c);
+    sc->related_entry = pch_read_symbol(c);
+
+    int num_names = (int)pch_read_word(c);
+    int i;
+    for (i = 0; i < num_names; i++)
+    {
+        const char* name = pch_read_string(c);
+        int num_entries = (int)pch_read_word(c);
+
+        int j;
+        for (j = 0; j < num_entries; j++)
+        {
+            insert_alias(sc, pch_read_symbol(c), name);
+        }
+    }
+
+    return sc;
+}
+
+static void pch_fill_decl_context(pch_file_t* pch, uint32_t id)
+{
+    if (id == 0 || pch->filled[id])
+        return;
+    pch->filled[id] = 1;
+
+    decl_context_t* decl_context = pch_reserve_decl_context(pch, id);
+
+    pch_cursor_t c;
+    pch_init_cursor(pch, &c, id);
+    pch_read_word(&c);
+
+    decl_context->decl_flags = (decl_flags_t)pch_read_word(&c);
+    decl_context->namespace_scope = pch_read_scope(&c);
+    decl_context->global_scope = pch_read_scope(&c);
+    decl_context->block_scope = pch_read_scope(&c);
+    decl_context->class_scope = pch_read_scope(&c);
+    decl_context->function_scope = pch_read_scope(&c);
+    decl_context->prototype_scope = pch_read_scope(&c);
+    decl_context->current_scope = pch_read_scope(&c);
+}
+
+static void* pch_get_record(pch_file_t* pch, uint32_t id)
+{
+    if (id == 0)
+        return NULL;
+    if (id > pch->header->num_records)
+        pch_corrupted(pch);
+
+    if (pch->objects[id] != NULL)
+    {
+        // A reserved decl context may be still unfilled
+        if (!pch->filled[id]
+                && pch_record_kind(pch, id) == PCH_RECORD_DECL_CONTEXT)
+            pch_fill_decl_context(pch, id);
+        return pch->objects[id];
+    }
+
+    pch_cursor_t c;
+    pch_init_cursor(pch, &c, id);
+
+    void* result = NULL;
+    enum pch_record_kind kind = (enum pch_record_kind)pch_read_word(&c);
+    switch (kind)
+    {
+        case PCH_RECORD_SYMBOL:
+            result = pch_read_symbol_record(&c, id);
+            break;
+        case PCH_RECORD_PREDEFINED_SYMBOL:
+            result = pch_read_predefined_symbol_record(&c);
+            break;
+        case PCH_RECORD_TYPE:
+            result = pch_read_type_record(&c, id);
+            break;
+        case PCH_RECORD_NODECL:
+            result = pch_read_nodecl_record(&c);
+            break;
+        case PCH_RECORD_CONST_VALUE:
+            result = pch_read_const_value_record(&c);
+            break;
+        case PCH_RECORD_SCOPE:
+            result = pch_read_scope_record(&c, id);
+            break;
+        case PCH_RECORD_GLOBAL_SCOPE:
+            result = pch->global_decl_context->global_scope;
+            break;
+        case PCH_RECORD_DECL_CONTEXT:
+            pch_reserve_decl_context(pch, id);
+            pch_fill_decl_context(pch, id);
+            return pch->objects[id];
+        default:
+            pch_corrupted(pch);
+    }
+
+    // Structural types may have been created while reading their
+    // components, keep the first one
+    if (pch->objects[id] == NULL)
+        pch->objects[id] = result;
+    pch->filled[id] = 1;
+
+    return pch->objects[id];
+}
+
+static char pch_lazy_symbols(const decl_context_t* decl_context, const char* name)
+{
+    pch_file_t* pch = current_pch;
+    if (pch == NULL
+            || decl_context->global_scope != pch->global_decl_context->global_scope)
+        return 0;
+
+    // Binary search of the first entry of this name
+    uint32_t lower = 0, upper = pch->header->num_names;
+    while (lower < upper)
+    {
+        uint32_t middle = lower + (upper - lower) / 2;
+        if (strcmp(pch_get_raw_string(pch, pch->names[2 * middle]), name) < 0)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    char signed_in = 0;
+    uint32_t i;
+    for (i = lower;
+            i < pch->header->num_names
+            && strcmp(pch_get_raw_string(pch, pch->names[2 * i]), name) == 0;
+            i++)
+    {
+        scope_entry_t* entry = (scope_entry_t*)pch_get_record(pch, pch->names[2 * i + 1]);
+        insert_alias(decl_context->global_scope, entry, uniquestr(name));
+        signed_in = 1;
+    }
+
+    return signed_in;
+}
+
+static char pch_check_info(pch_file_t* pch)
+{
+    pch_cursor_t c;
+    c.pch = pch;
+    c.current = pch->words + pch->header->info_offset;
+    c.end = pch->words + pch->header->num_words;
+
+    // The reader of strings is not usable yet
+#define READ_STRING(c) pch_get_raw_string(pch, pch_read_word(c))
+    pch->info.configuration_key = READ_STRING(&c);
+    if (pch->info.configuration_key == NULL)
+        return 0;
+
+    pch->info.num_includes = (int)pch_read_word(&c);
+    if (pch->info.num_includes < 0
+            || pch->info.num_includes > c.end - c.current)
+        return 0;
+    pch->info.includes = NEW_VEC(const char*, pch->info.num_includes);
+    int i;
+    for (i = 0; i < pch->info.num_includes; i++)
+    {
+        pch->info.includes[i] = READ_STRING(&c);
+        if (pch->info.includes[i] == NULL)
+            return 0;
+    }
+
+    pch->info.num_dependences = (int)pch_read_word(&c);
+    if (pch->info.num_dependences < 0
+            || pch->info.num_dependences > c.end - c.current)
+        return 0;
+    pch->info.dependences = NEW_VEC0(pch_dependence_t, pch->info.num_dependences);
+    for (i = 0; i < pch->info.num_dependences; i++)
+    {
+        pch->info.dependences[i].filename = READ_STRING(&c);
+        if (pch->info.dependences[i].filename == NULL)
+            return 0;
+        pch->info.dependences[i].size = pch_read_wide(&c);
+        pch->info.dependences[i].mtime = (int64_t)pch_read_wide(&c);
+        pch->info.dependences[i].hash = pch_read_wide(&c);
+    }
+#undef READ_STRING
+
+    return c.current == c.end;
+}
+
+pch_file_t* pch_open(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0
+            || (size_t)st.st_size < sizeof(pch_header_t))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    pch_file_t* pch = NEW0(pch_file_t);
+    pch->filename = uniquestr(filename);
+    pch->map = map;
+    pch->map_size = st.st_size;
+    pch->header = (const pch_header_t*)map;
+
+    const pch_header_t* header = pch->header;
+    if (memcmp(header->magic, PCH_MAGIC, sizeof(PCH_MAGIC)) != 0
+            || header->version != PCH_VERSION)
+    {
+        pch_close(pch);
+        return NULL;
+    }
+
+    uint64_t strings_size_padded = ((uint64_t)header->strings_size + 3) & ~(uint64_t)3;
+    uint64_t expected_size = sizeof(pch_header_t)
+        + sizeof(uint32_t) * ((uint64_t)header->num_strings + 1)
+        + strings_size_padded
+        + sizeof(uint32_t) * ((uint64_t)header->num_records + 2)
+        + sizeof(uint32_t) * (uint64_t)header->num_words
+        + 2 * sizeof(uint32_t) * (uint64_t)header->num_names;
+    if (expected_size != (uint64_t)pch->map_size)
+    {
+        pch_close(pch);
+        return NULL;
+    }
+
+    const char* p = (const char*)map + sizeof(pch_header_t);
+    pch->string_offsets = (const uint32_t*)p;
+    p += sizeof(uint32_t) * (header->num_strings + 1);
+    pch->strings = p;
+    p += strings_size_padded;
+    pch->record_offsets = (const uint32_t*)p;
+    p += sizeof(uint32_t) * (header->num_records + 2);
+    pch->words = (const uint32_t*)p;
+    p += sizeof(uint32_t) * header->num_words;
+    pch->names = (const uint32_t*)p;
+
+    char valid = header->num_strings == 0
+        || (header->strings_size > 0 && pch->strings[header->strings_size - 1] == '\0');
+    uint32_t i;
+    for (i = 1; i <= header->num_strings && valid; i++)
+    {
+        valid = pch->string_offsets[i] < header->strings_size;
+    }
+    for (i = 1; i <= header->num_records + 1 && valid; i++)
+    {
+        valid = pch->record_offsets[i] <= header->num_words
+            && (i == 1 || pch->record_offsets[i - 1] <= pch->record_offsets[i]);
+    }
+    valid = valid
+        && header->info_offset == pch->record_offsets[header->num_records + 1];
+    for (i = 0; i < header->num_names && valid; i++)
+    {
+        valid = pch->names[2 * i] != 0
+            && pch->names[2 * i] <= header->num_strings
+            && pch->names[2 * i + 1] != 0
+            && pch->names[2 * i + 1] <= header->num_records;
+    }
+
+    if (!valid
+            || !pch_check_info(pch))
+    {
+        pch_close(pch);
+        return NULL;
+    }
+
+    return pch;
+}
+
+const pch_info_t* pch_get_info(pch_file_t* pch)
+{
+    return &pch->info;
+}
+
+void pch_load(pch_file_t* pch, const decl_context_t* global_decl_context)
+{
+    ERROR_CONDITION(current_pch != NULL, "Only one precompiled header can be loaded", 0);
+
+    current_pch = pch;
+    num_loaded_symbols = 0;
+
+    pch->global_decl_context = global_decl_context;
+    pch->objects = NEW_VEC0(void*, pch->header->num_records + 1);
+    pch->filled = NEW_VEC0(char, pch->header->num_records + 1);
+    pch->unique_strings = NEW_VEC0(const char*, pch->header->num_strings + 1);
+
+    scope_add_lazy_symbols(global_decl_context, pch_lazy_symbols);
+}
+
+void pch_close(pch_file_t* pch)
+{
+    if (pch == NULL)
+        return;
+
+    if (current_pch == pch)
+        current_pch = NULL;
+
+    munmap(pch->map, pch->map_size);
+
+    DELETE(pch->info.includes);
+    DELETE(pch->info.dependences);
+    DELETE(pch->objects);
+    DELETE(pch->filled);
+    DELETE(pch->unique_strings);
+    DELETE(pch);
+}
+
+int pch_get_num_loaded_symbols(void)
+{
+    return num_loaded_symbols;
+}
@@ -0,0 +1,91 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2013 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+
+#ifndef CXX_PCH_H
+#define CXX_PCH_H
+
+#include "libmcxx-common.h"
+#include "cxx-macros.h"
+#include "cxx-scope-decls.h"
+
+#include <stdint.h>
+
+MCXX_BEGIN_DECLS
+
+// Precompiled headers (C only)
+//
+// A precompiled header keeps the global scope built after parsing a
+// sequence of #include directives. When it is used, the declarations it
+// contains are only rebuilt when their name is looked up in the global
+// scope of the translation unit
+
+typedef struct pch_dependence_tag
+{
+    const char* filename;
+    uint64_t size;
+    int64_t mtime;
+    // Hash of the contents, used if the modification time changed
+    uint64_t hash;
+} pch_dependence_t;
+
+typedef struct pch_info_tag
+{
+    // Configuration of the compiler used to create the precompiled header
+    const char* configuration_key;
+
+    // Files included by the translation unit, in order
+    int num_includes;
+    const char** includes;
+
+    // Every file read when the includes were preprocessed
+    int num_dependences;
+    pch_dependence_t* dependences;
+} pch_info_t;
+
+typedef struct pch_file_tag pch_file_t;
+
+LIBMCXX_EXTERN void pch_write(const char* filename,
+        const decl_context_t* global_decl_context,
+        const pch_info_t* info);
+
+// Returns NULL if filename is not a precompiled header of this compiler
+LIBMCXX_EXTERN pch_file_t* pch_open(const char* filename);
+LIBMCXX_EXTERN const pch_info_t* pch_get_info(pch_file_t* pch);
+LIBMCXX_EXTERN void pch_close(pch_file_t* pch);
+
+// From now on, names of the precompiled header looked up in
+// global_decl_context are signed in there
+LIBMCXX_EXTERN void pch_load(pch_file_t* pch, const decl_context_t* global_decl_context);
+
+// Number of symbols rebuilt from the loaded precompiled header
+LIBMCXX_EXTERN int pch_get_num_loaded_symbols(void);
+
+MCXX_END_DECLS
+
+#endif // CXX_PCH_H
@@ -71,7 +71,7 @@
 /*!ifnot FORTRAN2003*/
 unknown_pragma : UNKNOWN_PRAGMA
 {
-	$$ = ASTLeaf(AST_UNKNOWN_PRAGMA, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTLeaf(AST_UNKNOWN_PRAGMA, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -91,7 +91,7 @@ member_declaration : unknown_pragma
 /*!if FORTRAN2003*/
 unknown_pragma : UNKNOWN_PRAGMA eos
 {
-	$$ = ASTLeaf(AST_UNKNOWN_PRAGMA, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTLeaf(AST_UNKNOWN_PRAGMA, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 program_unit : unknown_pragma
@@ -157,7 +157,7 @@ program_unit : pragma_custom_construct_external_procedure
 
 pragma_custom_construct_external_procedure : PRAGMA_CUSTOM pragma_custom_line_construct pragma_custom_construct_external_procedure_0
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -175,37 +175,37 @@ explicit_external_procedure : explicit_main_program
 
 pragma_custom_directive : PRAGMA_CUSTOM pragma_custom_line_directive
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_DIRECTIVE, $2, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_DIRECTIVE, $2, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
 /*!ifnot FORTRAN2003*/
 pragma_custom_construct_declaration : PRAGMA_CUSTOM pragma_custom_line_construct declaration
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
 pragma_custom_construct_member_declaration : PRAGMA_CUSTOM pragma_custom_line_construct member_declaration
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
 pragma_custom_construct_statement : PRAGMA_CUSTOM pragma_custom_line_construct statement
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 /*!endif*/
 /*!if FORTRAN2003*/
 pragma_custom_construct_statement : PRAGMA_CUSTOM pragma_custom_line_construct pragma_custom_construct_range
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3[0], $3[1], make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3[0], $3[1], make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM pragma_custom_noend_line_construct pragma_custom_noend_construct_range
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3[0], $3[1], make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3[0], $3[1], make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -247,7 +247,7 @@ shared_term_do_construct : pragma_custom_shared_term_do_construct
 
 pragma_custom_shared_term_do_construct : PRAGMA_CUSTOM pragma_custom_noend_line_construct pragma_custom_noend_shared_term_do_range
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3[0], $3[1], make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3[0], $3[1], make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -265,28 +265,28 @@ pragma_custom_noend_shared_term_do_range : shared_term_do_construct pragma_custo
 
 pragma_custom_end_construct : PRAGMA_CUSTOM PRAGMA_CUSTOM_END_CONSTRUCT pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $3, NULL, make_locus(@2.first_filename, @2.first_line, @2.first_column), $2.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $3, NULL, make_locus_in_file(@2.first_file_id, @2.first_line, @2.first_column), $2.token_text);
 }
 | PRAGMA_CUSTOM PRAGMA_CUSTOM_END_CONSTRUCT pragma_custom_clause_opt_seq '(' pragma_clause_arg_list ')' PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $3, $5, make_locus(@2.first_filename, @2.first_line, @2.first_column), $2.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $3, $5, make_locus_in_file(@2.first_file_id, @2.first_line, @2.first_column), $2.token_text);
 }
 ;
 
 pragma_custom_end_construct_noend : PRAGMA_CUSTOM PRAGMA_CUSTOM_END_CONSTRUCT_NOEND pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $3, NULL, make_locus(@2.first_filename, @2.first_line, @2.first_column), $2.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $3, NULL, make_locus_in_file(@2.first_file_id, @2.first_line, @2.first_column), $2.token_text);
 }
 ;
 
 
 pragma_custom_noend_line_construct : PRAGMA_CUSTOM_CONSTRUCT_NOEND pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $2, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $2, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM_CONSTRUCT_NOEND '(' pragma_clause_arg_list ')' pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $5, $3, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $5, $3, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -299,7 +299,7 @@ pragma_custom_line_or_noend_construct : pragma_custom_line_construct
 
 pragma_custom_construct_module_subprogram_unit : PRAGMA_CUSTOM pragma_custom_line_or_noend_construct module_subprogram
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -308,7 +308,7 @@ internal_subprogram : pragma_custom_construct_internal_program_unit
 
 pragma_custom_construct_internal_program_unit : PRAGMA_CUSTOM pragma_custom_line_or_noend_construct internal_subprogram
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -317,18 +317,18 @@ interface_body : pragma_custom_construct_interface_body
 
 pragma_custom_construct_interface_body : PRAGMA_CUSTOM pragma_custom_line_or_noend_construct interface_body
 {
-	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake3(AST_PRAGMA_CUSTOM_CONSTRUCT, $2, $3, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 /*!endif*/
 
 pragma_custom_line_directive : PRAGMA_CUSTOM_DIRECTIVE pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $2, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $2, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM_DIRECTIVE '(' pragma_clause_arg_list ')' pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $5, $3, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $5, $3, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM_NEWLINE
 {
@@ -339,11 +339,11 @@ pragma_custom_line_directive : PRAGMA_CUSTOM_DIRECTIVE pragma_custom_clause_opt_
 
 pragma_custom_line_construct : PRAGMA_CUSTOM_CONSTRUCT pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $2, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $2, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM_CONSTRUCT '(' pragma_clause_arg_list ')' pragma_custom_clause_opt_seq PRAGMA_CUSTOM_NEWLINE
 {
-	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $5, $3, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake2(AST_PRAGMA_CUSTOM_LINE, $5, $3, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
@@ -373,21 +373,21 @@ pragma_custom_clause_seq : pragma_custom_clause
 
 pragma_custom_clause : PRAGMA_CUSTOM_CLAUSE '(' pragma_clause_arg_list ')'
 {
-	$$ = ASTMake1(AST_PRAGMA_CUSTOM_CLAUSE, $3, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake1(AST_PRAGMA_CUSTOM_CLAUSE, $3, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM_CLAUSE '(' ')'
 {
-	$$ = ASTMake1(AST_PRAGMA_CUSTOM_CLAUSE, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake1(AST_PRAGMA_CUSTOM_CLAUSE, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 | PRAGMA_CUSTOM_CLAUSE 
 {
-	$$ = ASTMake1(AST_PRAGMA_CUSTOM_CLAUSE, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+	$$ = ASTMake1(AST_PRAGMA_CUSTOM_CLAUSE, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 }
 ;
 
 pragma_clause_arg_list : pragma_clause_arg
 {
-    AST node = ASTLeaf(AST_PRAGMA_CLAUSE_ARG, make_locus(@1.first_filename, @1.first_line, @1.first_column), $1.token_text);
+    AST node = ASTLeaf(AST_PRAGMA_CLAUSE_ARG, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $1.token_text);
 
     $$ = ASTListLeaf(node);
 }
@@ -419,13 +419,13 @@ pragma_clause_arg_text : PRAGMA_CLAUSE_ARG_TEXT
 // Verbatim construct
 verbatim_construct : VERBATIM_PRAGMA VERBATIM_TYPE '(' identifier_token ')' VERBATIM_TEXT
 {
-    AST ident = ASTLeaf(AST_SYMBOL, make_locus(@4.first_filename, @4.first_line, @4.first_column), $4.token_text);
+    AST ident = ASTLeaf(AST_SYMBOL, make_locus_in_file(@4.first_file_id, @4.first_line, @4.first_column), $4.token_text);
 
-    $$ = ASTMake1(AST_VERBATIM, ident, make_locus(@1.first_filename, @1.first_line, @1.first_column), $6.token_text);
+    $$ = ASTMake1(AST_VERBATIM, ident, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $6.token_text);
 }
 | VERBATIM_PRAGMA VERBATIM_TEXT
 {
-    $$ = ASTMake1(AST_VERBATIM, NULL, make_locus(@1.first_filename, @1.first_line, @1.first_column), $2.token_text);
+    $$ = ASTMake1(AST_VERBATIM, NULL, make_locus_in_file(@1.first_file_id, @1.first_line, @1.first_column), $2.token_text);
 }
 ;
 
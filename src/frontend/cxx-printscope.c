@@ -133,7 +133,7 @@ static void print_scope_full(scope_t* st, int global_indent)
     print_context_data.scope_set[print_context_data.num_scopes] = st;
     print_context_data.num_scopes++;
 
-    dhash_ptr_walk(st->dhash, (dhash_ptr_walk_fn*)print_scope_full_aux, &global_indent);
+    ohash_ptr_walk(st->hash, (ohash_ptr_walk_fn*)print_scope_full_aux, &global_indent);
 
     print_context_data.num_scopes--;
     print_context_data.scope_set[print_context_data.num_scopes] = NULL;
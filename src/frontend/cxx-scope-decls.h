@@ -37,6 +37,7 @@
 
 #include "red_black_tree.h"
 #include "dhash_ptr.h"
+#include "ohash_ptr.h"
 #include "libmcxx-common.h"
 #include "cxx-macros.h"
 #include "cxx-ast-decls.h"
@@ -374,6 +375,10 @@ enum scope_kind
     CLASS_SCOPE, // Class scope
 };
 
+// Signs in symbols whose name was not found in a scope (e.g. builtins that
+// are only signed in when used). Returns nonzero if it signed in something
+typedef char (*scope_lazy_symbols_fun_t)(const decl_context_t* decl_context, const char* name);
+
 // This is the scope
 struct scope_tag
 {
@@ -382,7 +387,7 @@ struct scope_tag
 
     // Hash of scope_entry_list
     // rb_red_blk_tree *hash;
-    dhash_ptr_t* dhash;
+    ohash_ptr_t* hash;
 
     // Relationships with other scopes
     // Nesting relationship is expressed by "contained_in". This relationship is
@@ -399,6 +404,15 @@ struct scope_tag
     // they contain the namespace symbol, the class symbol
     // and the function symbol
     scope_entry_t* related_entry;
+
+    // Only valid for CLASS_SCOPE, results of class member lookup by name
+    // (see query_in_class). Allocated the first time it is needed
+    ohash_ptr_t* lookup_cache;
+
+    // Called when a name is not found in this scope
+    int num_lazy_symbols;
+    scope_lazy_symbols_fun_t* lazy_symbols;
+    const decl_context_t* lazy_symbols_context;
 };
 
 typedef const char* (*print_symbol_callback_t)(scope_entry_t*, const decl_context_t*, void*);
@@ -49,6 +49,7 @@
 #include "cxx-entrylist.h"
 #include "cxx-diagnostic.h"
 #include "dhash_ptr.h"
+#include "ohash_ptr.h"
 
 
 // Lookup of a simple name within a given declaration context
@@ -201,7 +202,7 @@ scope_t* _new_scope(void)
 {
     scope_t* result = NEW0(scope_t);
 
-    result->dhash = dhash_ptr_new(5);
+    result->hash = ohash_ptr_new(5);
 
     return result;
 }
@@ -432,6 +433,58 @@ decl_context_t* new_class_context(const decl_context_t* enclosing_context,
     return result;
 }
 
+// Memoization of class member lookup
+//
+// Looking up a name in a complete class only gives a different result if
+// that class or one of its bases (complete as well) changes, which seldom
+// happens once the class is complete. So results are kept in the scope of
+// the class tagged with a generation that is increased whenever a complete
+// class changes. Lookups in incomplete classes are never kept
+typedef
+struct class_lookup_cache_entry_tag
+{
+    type_t* type_of_conversion;
+    unsigned long generation;
+    scope_entry_list_t* entry_list;
+
+    struct class_lookup_cache_entry_tag* next;
+} class_lookup_cache_entry_t;
+
+// Entries not yet computed have generation 0
+static unsigned long class_lookup_generation = 1;
+static unsigned long class_lookup_cache_hits = 0;
+static unsigned long class_lookup_cache_misses = 0;
+
+void get_class_lookup_cache_stats(unsigned long* hits, unsigned long* misses)
+{
+    *hits = class_lookup_cache_hits;
+    *misses = class_lookup_cache_misses;
+}
+
+void class_lookup_cache_invalidate(void)
+{
+    class_lookup_generation++;
+}
+
+unsigned long get_class_lookup_generation(void)
+{
+    return class_lookup_generation;
+}
+
+static char class_scope_is_complete(scope_t* sc)
+{
+    return sc->kind == CLASS_SCOPE
+        && sc->related_entry != NULL
+        && sc->related_entry->type_information != NULL
+        && is_complete_type(sc->related_entry->type_information);
+}
+
+static void scope_changed(scope_t* sc)
+{
+    if (class_scope_is_complete(sc))
+        class_lookup_cache_invalidate();
+}
+
 void insert_alias(scope_t* sc, scope_entry_t* entry, const char* name)
 {
     ERROR_CONDITION(name == NULL ||
@@ -439,7 +492,7 @@ void insert_alias(scope_t* sc, scope_entry_t* entry, const char* name)
 
     const char* symbol_name = uniquestr(name);
 
-    scope_entry_list_t* result_set = (scope_entry_list_t*)dhash_ptr_query(sc->dhash, symbol_name);
+    scope_entry_list_t* result_set = (scope_entry_list_t*)ohash_ptr_query(sc->hash, symbol_name);
 
     if (result_set != NULL)
     {
@@ -450,7 +503,8 @@ void insert_alias(scope_t* sc, scope_entry_t* entry, const char* name)
         result_set = entry_list_new(entry);
     }
 
-    dhash_ptr_insert(sc->dhash, symbol_name, result_set);
+    ohash_ptr_insert(sc->hash, symbol_name, result_set);
+    scope_changed(sc);
 }
 
 static const char* scope_names[] =
@@ -463,6 +517,28 @@ static const char* scope_names[] =
     [CLASS_SCOPE] = "CLASS_SCOPE",
 };
 
+// Number of symbols created by new_symbol
+static unsigned long num_symbols_created = 0;
+
+unsigned long get_num_symbols_created(void)
+{
+    return num_symbols_created;
+}
+
+// Number of records of rarely used attributes of symbols
+static unsigned long num_entity_specs_cold_created = 0;
+
+unsigned long get_num_entity_specs_cold_created(void)
+{
+    return num_entity_specs_cold_created;
+}
+
+entity_specifiers_cold_t* symbol_entity_specs_new_cold(void)
+{
+    num_entity_specs_cold_created++;
+    return NEW0(entity_specifiers_cold_t);
+}
+
 scope_entry_t* new_symbol(const decl_context_t* decl_context, scope_t* sc, const char* name)
 {
     ERROR_CONDITION(name == NULL ||
@@ -471,6 +547,7 @@ scope_entry_t* new_symbol(const decl_context_t* decl_context, scope_t* sc, const
     // ERROR_CONDITION(name != uniquestr(name), "Invalid name", 0);
 
     scope_entry_t* result = NEW0(scope_entry_t);
+    num_symbols_created++;
 
     result->symbol_name = uniquestr(name);
     result->decl_context = decl_context;
@@ -480,9 +557,21 @@ scope_entry_t* new_symbol(const decl_context_t* decl_context, scope_t* sc, const
     return result;
 }
 
+void scope_add_lazy_symbols(const decl_context_t* decl_context, scope_lazy_symbols_fun_t fun)
+{
+    scope_t* sc = decl_context->current_scope;
+
+    ERROR_CONDITION(sc->lazy_symbols_context != NULL
+            && sc->lazy_symbols_context->current_scope != sc,
+            "Invalid context for lazy symbols", 0);
+
+    sc->lazy_symbols_context = decl_context;
+    P_LIST_ADD(sc->lazy_symbols, sc->num_lazy_symbols, fun);
+}
+
 char same_scope(scope_t* stA, scope_t* stB)
 {
-    return (stA->dhash == stB->dhash);
+    return (stA->hash == stB->hash);
 }
 
 static scope_entry_list_t* query_name_in_scope(scope_t* sc, const char* name)
@@ -506,7 +595,25 @@ static scope_entry_list_t* query_name_in_scope(scope_t* sc, const char* name)
         }
     }
 
-    scope_entry_list_t *result = (scope_entry_list_t*)dhash_ptr_query(sc->dhash, name);
+    scope_entry_list_t *result = (scope_entry_list_t*)ohash_ptr_query(sc->hash, name);
+
+    if (result == NULL
+            && sc->num_lazy_symbols > 0)
+    {
+        // Every function is called since all of them might sign in
+        // something with this name
+        char signed_in = 0;
+        int i;
+        for (i = 0; i < sc->num_lazy_symbols; i++)
+        {
+            signed_in = (sc->lazy_symbols[i])(sc->lazy_symbols_context, name) || signed_in;
+        }
+
+        if (signed_in)
+        {
+            result = (scope_entry_list_t*)ohash_ptr_query(sc->hash, name);
+        }
+    }
 
     // ERROR_CONDITION(name != uniquestr(name), "Invalid name", 0);
 
@@ -533,7 +640,7 @@ void insert_entry(scope_t* sc, scope_entry_t* entry)
     ERROR_CONDITION((entry->symbol_name == NULL), "Inserting a symbol entry without name!", 0);
     // ERROR_CONDITION(entry->symbol_name != uniquestr(entry->symbol_name), "Name of symbol not canonical", 0);
 
-    scope_entry_list_t* result_set = (scope_entry_list_t*)dhash_ptr_query(sc->dhash, entry->symbol_name);
+    scope_entry_list_t* result_set = (scope_entry_list_t*)ohash_ptr_query(sc->hash, entry->symbol_name);
 
     if (result_set != NULL)
     {
@@ -553,19 +660,20 @@ void insert_entry(scope_t* sc, scope_entry_t* entry)
         if (!do_not_add)
         {
             result_set = entry_list_prepend(result_set, entry);
-            dhash_ptr_insert(sc->dhash, entry->symbol_name, result_set);
+            ohash_ptr_insert(sc->hash, entry->symbol_name, result_set);
         }
     }
     else
     {
         result_set = entry_list_new(entry);
-        dhash_ptr_insert(sc->dhash, entry->symbol_name, result_set);
+        ohash_ptr_insert(sc->hash, entry->symbol_name, result_set);
     }
+    scope_changed(sc);
 }
 
 void remove_entry(scope_t* sc, scope_entry_t* entry)
 {
-    scope_entry_list_t* entry_list = dhash_ptr_query(sc->dhash, entry->symbol_name);
+    scope_entry_list_t* entry_list = ohash_ptr_query(sc->hash, entry->symbol_name);
     if (entry_list == NULL)
         return;
 
@@ -573,39 +681,45 @@ void remove_entry(scope_t* sc, scope_entry_t* entry)
 
     if (entry_list_size(entry_list) >= 1)
     {
-        dhash_ptr_insert(sc->dhash, entry->symbol_name, entry_list);
+        ohash_ptr_insert(sc->hash, entry->symbol_name, entry_list);
     }
     else
     {
-        dhash_ptr_remove(sc->dhash, entry->symbol_name);
+        ohash_ptr_remove(sc->hash, entry->symbol_name);
     }
+    scope_changed(sc);
 }
 
-scope_entry_list_t* filter_symbol_kind_set(scope_entry_list_t* entry_list, int num_kinds, enum cxx_symbol_kind* symbol_kind_set)
+typedef
+struct symbol_kind_set_tag
 {
-    scope_entry_list_t* result = NULL;
+    int num_kinds;
+    enum cxx_symbol_kind* kinds;
+} symbol_kind_set_t;
 
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(entry_list);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        scope_entry_t* entry = entry_list_iterator_current(it);
+static char symbol_kind_set_contains(scope_entry_t* entry, void* p)
+{
+    symbol_kind_set_t* kind_set = (symbol_kind_set_t*)p;
 
-        int i;
-        char found = 0;
-        for (i = 0; (i < num_kinds) && !found; i++)
-        {
-            if (entry->kind == symbol_kind_set[i])
-            {
-                result = entry_list_add(result, entry);
-                found = 1;
-            }
-        }
+    int i;
+    for (i = 0; i < kind_set->num_kinds; i++)
+    {
+        if (entry->kind == kind_set->kinds[i])
+            return 1;
     }
-    entry_list_iterator_free(it);
+    return 0;
+}
 
-    return result;
+static char symbol_kind_set_not_contains(scope_entry_t* entry, void* p)
+{
+    return !symbol_kind_set_contains(entry, p);
+}
+
+scope_entry_list_t* filter_symbol_kind_set(scope_entry_list_t* entry_list, int num_kinds, enum cxx_symbol_kind* symbol_kind_set)
+{
+    symbol_kind_set_t kind_set = { num_kinds, symbol_kind_set };
+
+    return entry_list_filter(entry_list, symbol_kind_set_contains, &kind_set);
 }
 
 scope_entry_list_t* filter_symbol_kind(scope_entry_list_t* entry_list, enum cxx_symbol_kind symbol_kind)
@@ -620,33 +734,9 @@ scope_entry_list_t* filter_symbol_kind(scope_entry_list_t* entry_list, enum cxx_
 
 scope_entry_list_t* filter_symbol_non_kind_set(scope_entry_list_t* entry_list, int num_kinds, enum cxx_symbol_kind* symbol_kind_set)
 {
-    scope_entry_list_t* result = NULL;
-
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(entry_list);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        scope_entry_t* entry = entry_list_iterator_current(it);
+    symbol_kind_set_t kind_set = { num_kinds, symbol_kind_set };
 
-        int i;
-        char found = 0;
-        for (i = 0; (i < num_kinds) && !found; i++)
-        {
-            if (entry->kind == symbol_kind_set[i])
-            {
-                found = 1;
-            }
-        }
-
-        if (!found)
-        {
-            result = entry_list_add(result, entry);
-        }
-    }
-    entry_list_iterator_free(it);
-
-    return result;
+    return entry_list_filter(entry_list, symbol_kind_set_not_contains, &kind_set);
 }
 
 scope_entry_list_t* filter_symbol_non_kind(scope_entry_list_t* entry_list, enum cxx_symbol_kind symbol_kind)
@@ -660,23 +750,7 @@ scope_entry_list_t* filter_symbol_non_kind(scope_entry_list_t* entry_list, enum
 
 scope_entry_list_t* filter_symbol_using_predicate(scope_entry_list_t* entry_list, char (*f)(scope_entry_t*, void*), void* p)
 {
-    scope_entry_list_t* result = NULL;
-
-    scope_entry_list_iterator_t* it = NULL;
-    for (it = entry_list_iterator_begin(entry_list);
-            !entry_list_iterator_end(it);
-            entry_list_iterator_next(it))
-    {
-        scope_entry_t* entry = entry_list_iterator_current(it);
-
-        if (f(entry, p))
-        {
-            result = entry_list_add(result, entry);
-        }
-    }
-    entry_list_iterator_free(it);
-
-    return result;
+    return entry_list_filter(entry_list, f, p);
 }
 
 // Attribute is_friend states that this symbol has been created to represent a friend declaration
@@ -1655,11 +1729,63 @@ static scope_entry_list_t* query_in_class(scope_t* current_class_scope,
         type_t* type_of_conversion, // Only used for conversions
         const locus_t* locus)
 {
+    // decl_flags do not influence class_scope_lookup_rec so the name and the
+    // conversion type identify the result
+    class_lookup_cache_entry_t* cache_entry = NULL;
+    if (!debug_options.disable_class_lookup_cache
+            && class_scope_is_complete(current_class_scope))
+    {
+        if (current_class_scope->lookup_cache == NULL)
+            current_class_scope->lookup_cache = ohash_ptr_new(5);
+
+        class_lookup_cache_entry_t* first_entry =
+            (class_lookup_cache_entry_t*)ohash_ptr_query(current_class_scope->lookup_cache, name);
+        cache_entry = first_entry;
+        while (cache_entry != NULL
+                && cache_entry->type_of_conversion != type_of_conversion)
+            cache_entry = cache_entry->next;
+
+        if (cache_entry != NULL
+                && cache_entry->generation == class_lookup_generation)
+        {
+            class_lookup_cache_hits++;
+            DEBUG_CODE()
+            {
+                fprintf(stderr, "SCOPE: Class scope lookup of '%s' in class '%s' found in the cache\n",
+                        name, current_class_scope->related_entry->symbol_name);
+            }
+            return entry_list_copy(cache_entry->entry_list);
+        }
+
+        class_lookup_cache_misses++;
+        if (cache_entry == NULL)
+        {
+            cache_entry = NEW0(class_lookup_cache_entry_t);
+            cache_entry->type_of_conversion = type_of_conversion;
+            cache_entry->next = first_entry;
+            ohash_ptr_insert(current_class_scope->lookup_cache, name, cache_entry);
+        }
+        else
+        {
+            entry_list_free(cache_entry->entry_list);
+            cache_entry->entry_list = NULL;
+        }
+    }
+
     class_scope_lookup_t result;
     memset(&result, 0, sizeof(result));
 
     class_scope_lookup_rec(current_class_scope, name, &result, 0, /* initial_lookup */ 1, decl_flags, type_of_conversion, locus);
 
+    if (cache_entry != NULL)
+    {
+        // Lazy symbols may have changed a class during the lookup, the
+        // result already includes them
+        entry_list_free(cache_entry->entry_list);
+        cache_entry->generation = class_lookup_generation;
+        cache_entry->entry_list = entry_list_copy(result.entry_list);
+    }
+
     if (result.entry_list != NULL)
     {
         int i;
@@ -6427,7 +6553,7 @@ void scope_for_each_entity(scope_t* sc, void *data, void (*fun)(scope_entry_list
 {
     struct fun_adaptor_data_tag fun_adaptor_data = { .data = data, .fun = fun };
 
-    dhash_ptr_walk(sc->dhash, (dhash_ptr_walk_fn*)for_each_fun_adaptor, &fun_adaptor_data);
+    ohash_ptr_walk(sc->hash, (ohash_ptr_walk_fn*)for_each_fun_adaptor, &fun_adaptor_data);
 }
 
 int get_template_nesting_of_context(const decl_context_t* decl_context)
@@ -58,10 +58,25 @@ LIBMCXX_EXTERN decl_context_t* decl_context_clone(const decl_context_t* t);
 // Functions to handle scopes
 LIBMCXX_EXTERN scope_entry_t* new_symbol(const decl_context_t* decl_context, 
         struct scope_tag* st, const char* name);
+// Number of symbols created by new_symbol so far, for statistics
+LIBMCXX_EXTERN unsigned long get_num_symbols_created(void);
+LIBMCXX_EXTERN unsigned long get_num_entity_specs_cold_created(void);
+// Hits and misses of the class member lookup cache so far, for statistics
+LIBMCXX_EXTERN void get_class_lookup_cache_stats(unsigned long* hits, unsigned long* misses);
+// Discards every result in the class member lookup cache. Needed when a
+// complete class changes in a way not visible to its scope
+LIBMCXX_EXTERN void class_lookup_cache_invalidate(void);
+// Increases every time a complete class changes, other caches depending on
+// the contents of classes use it to tell stale results
+LIBMCXX_EXTERN unsigned long get_class_lookup_generation(void);
 LIBMCXX_EXTERN void remove_entry(struct scope_tag* st, scope_entry_t* entry);
 LIBMCXX_EXTERN void insert_entry(struct scope_tag* st, scope_entry_t* entry);
 LIBMCXX_EXTERN void insert_alias(struct scope_tag* st, scope_entry_t* entry, const char* alias_name);
 
+// fun will be called whenever a name is not found in the current scope of
+// decl_context. Symbols it signs in must belong to this scope
+LIBMCXX_EXTERN void scope_add_lazy_symbols(const decl_context_t* decl_context, scope_lazy_symbols_fun_t fun);
+
 // Given a list of symbols, purge all those that are not of symbol_kind kind
 LIBMCXX_EXTERN scope_entry_list_t* filter_symbol_kind(scope_entry_list_t* entry_list, enum cxx_symbol_kind symbol_kind);
 // Similar but can be used to filter based on a kind set
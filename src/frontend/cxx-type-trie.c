@@ -31,200 +31,119 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "cxx-typeutils.h"
 
-typedef struct type_trie_element_tag
+// Despite its name this is an open addressing hash table keyed on the
+// whole sequence of types. Types are unique so their addresses identify
+// them
+
+typedef struct type_trie_entry_tag
 {
-    const type_t* elem;
-    // Only valid when next == NULL
-    const type_t *function_type;
-    type_trie_t* next;
-} type_trie_element_t;
+    uint32_t hash;
+    int num_types;
+    const type_t** type_seq;
+    // NULL if the slot is empty
+    const type_t* type;
+} type_trie_entry_t;
 
 struct type_trie_tag
 {
-    int capacity;
-    int num_elements;
-    type_trie_element_t* elements;
+    // Always a power of two
+    uint32_t capacity;
+    uint32_t num_entries;
+    type_trie_entry_t* entries;
 };
 
-static type_trie_element_t *lookup_element(const type_trie_t* type_trie, const type_t** type_seq);
-
-static const type_t* lookup_list(const type_trie_t* type_trie, const type_t** type_seq, int length)
+static uint32_t hash_type_seq(const type_t** type_seq, int num_types)
 {
-    if (length == 0)
-    {
-        if (type_trie->num_elements > 0
-                && type_trie->elements[0].elem == NULL)
-        {
-            return type_trie->elements[0].function_type;
-        }
-        return NULL;
-    }
-    else
+    uint64_t h = (uint64_t)num_types;
+    int i;
+    for (i = 0; i < num_types; i++)
     {
-        type_trie_element_t* elem = lookup_element(type_trie, type_seq);
-        if (elem == NULL)
-            return NULL;
-        else
-            return lookup_list(elem->next, type_seq + 1, length - 1);
+        h ^= (uint64_t)(uintptr_t)type_seq[i];
+        h *= UINT64_C(0x9e3779b97f4a7c15);
+        h ^= h >> 32;
     }
+    return (uint32_t)h;
 }
 
-static const type_t* create_elements(type_trie_t* type_trie, const type_t **type_seq, const type_t* function_type, int length);
-
-static const type_t* insert_list_rec(type_trie_t* type_trie, const type_t **type_seq, const type_t* function_type, int length)
+static type_trie_entry_t* find_slot(type_trie_t* trie,
+        const type_t** type_seq, int num_types, uint32_t hash)
 {
-    if (length == 0)
+    uint32_t mask = trie->capacity - 1;
+    uint32_t i = hash & mask;
+    for (;;)
     {
-        if ((type_trie->num_elements == 0)
-                || (type_trie->elements[0].elem != 0))
-        {
-            return create_elements(type_trie, type_seq, function_type, length);
-        }
-        return NULL;
-    }
-    else
-    {
-        type_trie_element_t* elem = lookup_element(type_trie, type_seq);
-        if (elem == NULL)
-        {
-            // Create all the remaining elements since they will not be found
-            // anymore
-            return create_elements(type_trie, type_seq, function_type, length);
-        }
-        else
-        {
-            return insert_list_rec(elem->next, type_seq + 1, function_type, length - 1);
-        }
-    }
-}
-
-static const type_t* insert_list(type_trie_t* type_trie, const type_t** type_seq, const type_t *function_type, int length)
-{
-    return insert_list_rec(type_trie, type_seq, function_type, length);
-}
-
-static int elements_compare_fun(const type_t* i1, const type_t* i2)
-{
-    if (i1 == i2)
-        return 0;
-    else if (i1 < i2)
-        return -1;
-    else 
-        return 1;
-}
+        type_trie_entry_t* entry = &trie->entries[i];
+        if (entry->type == NULL)
+            return entry;
 
-static type_trie_element_t *lookup_element_rec(const type_trie_t* type_trie, const type_t *entity, int lower, int upper)
-{
-    if (lower > upper)
-        return NULL;
-
-    int middle = (lower + upper) / 2;
-
-    const type_t* i_middle = type_trie->elements[middle].elem;
-    const type_t* i_entity = entity;
-
-    int cmp = elements_compare_fun(i_entity, i_middle);
-
-    if (cmp < 0)
-        return lookup_element_rec(type_trie, entity, lower, middle - 1);
-    else if (0 < cmp)
-        return lookup_element_rec(type_trie, entity, middle + 1, upper);
-    else 
-        return &(type_trie->elements[middle]);
-}
+        if (entry->hash == hash
+                && entry->num_types == num_types
+                && memcmp(entry->type_seq, type_seq, num_types * sizeof(*type_seq)) == 0)
+            return entry;
 
-static type_trie_element_t *lookup_element(const type_trie_t* type_trie, const type_t** type_seq)
-{
-    return lookup_element_rec(type_trie, *type_seq, 0, type_trie->num_elements - 1);
+        i = (i + 1) & mask;
+    }
 }
 
-static const type_t* create_elements(type_trie_t* type_trie, const type_t** type_seq, const type_t* function_type, int length)
+static void grow(type_trie_t* trie)
 {
-    type_trie->num_elements++;
-    if (type_trie->capacity == type_trie->num_elements)
-    {
-        type_trie->capacity *= 2;
-        type_trie->elements = NEW_REALLOC(type_trie_element_t, type_trie->elements, type_trie->capacity);
-    }
-
-    // Locate place where the element would go
-    int lower = 0;
-    int upper = type_trie->num_elements - 2;
-
-    const type_t* i_entity = NULL;
+    uint32_t old_capacity = trie->capacity;
+    type_trie_entry_t* old_entries = trie->entries;
 
-    if (length != 0)
-        i_entity = *type_seq;
+    trie->capacity *= 2;
+    trie->entries = NEW_VEC0(type_trie_entry_t, trie->capacity);
 
-    while (lower <= upper)
+    uint32_t i;
+    for (i = 0; i < old_capacity; i++)
     {
-        int middle = (lower + upper) / 2;
-        const type_t* i_middle = type_trie->elements[middle].elem;
-
-        int cmp = elements_compare_fun(i_entity, i_middle);
-        if (cmp < 0)
-        {
-            upper = middle - 1;
-        }
-        else if (0 < cmp)
-        {
-            lower = middle + 1;
-        }
-        // This should never happen
-        else 
-        {
-            abort();
-        }
-    }
+        if (old_entries[i].type == NULL)
+            continue;
 
-    // lower contains the position where the element should go
-    // shift all elements rightwards one position
-    int i;
-    for (i = type_trie->num_elements - 1; i > lower; i--)
-    {
-        type_trie->elements[i] = type_trie->elements[i - 1];
+        type_trie_entry_t* entry = find_slot(trie,
+                old_entries[i].type_seq, old_entries[i].num_types, old_entries[i].hash);
+        *entry = old_entries[i];
     }
 
-    if (length == 0)
-    {
-        type_trie->elements[lower].elem = 0;
-        // No next after the "end of list"
-        type_trie->elements[lower].next = NULL;
-        // Create the type itself
-        type_trie->elements[lower].function_type = function_type;
-
-        return type_trie->elements[lower].function_type;
-    }
-    else
-    {
-        type_trie->elements[lower].elem = *type_seq;
-        type_trie->elements[lower].next = allocate_type_trie();
-
-        const type_t* result =
-        create_elements(type_trie->elements[lower].next,
-                type_seq + 1,
-                function_type, length - 1);
-
-        return result;
-    }
+    DELETE(old_entries);
 }
 
 type_trie_t* allocate_type_trie(void)
 {
     type_trie_t* t = NEW0(type_trie_t);
-    t->capacity = 1;
-    t->elements = NEW_VEC0(type_trie_element_t, t->capacity);
+    t->capacity = 16;
+    t->entries = NEW_VEC0(type_trie_entry_t, t->capacity);
     return t;
 }
 
 void insert_type_trie(type_trie_t* trie, const type_t** type_seq, int num_types, const type_t* funct_type)
 {
-    insert_list(trie, type_seq, funct_type, num_types);
+    ERROR_CONDITION(funct_type == NULL, "Invalid type", 0);
+
+    // Keep the load factor below 3/4
+    if (4 * (trie->num_entries + 1) > 3 * trie->capacity)
+        grow(trie);
+
+    uint32_t hash = hash_type_seq(type_seq, num_types);
+    type_trie_entry_t* entry = find_slot(trie, type_seq, num_types, hash);
+
+    // Like before, an existing sequence keeps its type
+    if (entry->type != NULL)
+        return;
+
+    entry->hash = hash;
+    entry->num_types = num_types;
+    entry->type_seq = NEW_VEC(const type_t*, num_types > 0 ? num_types : 1);
+    memcpy(entry->type_seq, type_seq, num_types * sizeof(*type_seq));
+    entry->type = funct_type;
+
+    trie->num_entries++;
 }
 
 const type_t* lookup_type_trie(type_trie_t* trie, const type_t** type_seq, int num_types)
 {
-    return lookup_list(trie, type_seq, num_types);
+    uint32_t hash = hash_type_seq(type_seq, num_types);
+    return find_slot(trie, type_seq, num_types, hash)->type;
 }
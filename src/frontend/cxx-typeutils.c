@@ -29,6 +29,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include "cxx-buildscope.h"
 #include "cxx-typeutils.h"
 #include "cxx-typeenviron.h"
@@ -54,6 +55,7 @@
 #include "fortran03-scope.h"
 
 #include "dhash_ptr.h"
+#include "ohash_ptr.h"
 #include "red_black_tree.h"
 
 /*
@@ -318,6 +320,8 @@ struct simple_type_tag {
     //   All specialized types
     int num_all_specialized_types;
     type_t** all_specialized_types;
+    //   Leading all_specialized_types already in the specialization index
+    int num_indexed_specialized_types;
 
     // Template dependent types (STK_TEMPLATE_DEPENDENT_TYPE)
     scope_entry_t* dependent_entry;
@@ -582,9 +586,18 @@ static common_type_info_t* copy_common_type_info(common_type_info_t* t)
     return result;
 }
 
+// Number of type_t allocated so far
+static unsigned long num_types_created = 0;
+
+unsigned long get_num_types_created(void)
+{
+    return num_types_created;
+}
+
 static type_t* copy_type_for_class_alias(type_t* t)
 {
     type_t* result = NEW0(type_t);
+    num_types_created++;
     *result = *t;
 
     result->_advanced_type = NULL;
@@ -600,6 +613,7 @@ static type_t* copy_type_for_variant(type_t* t)
             "Invalid type to copy for variant: it must be unqualified", 0);
 
     type_t* result = NEW0(type_t);
+    num_types_created++;
     *result = *t;
 
     result->unqualified_type = result;
@@ -627,6 +641,7 @@ extern inline type_t* variant_type_get_nonvariant(type_t* t)
 static type_t* new_empty_type_without_info(void)
 {
     type_t* result = NEW0(type_t);
+    num_types_created++;
     return result;
 }
 
@@ -2159,11 +2174,15 @@ extern inline type_t* get_new_template_type(template_parameter_list_t* template_
     return type_info;
 }
 
+static void specialization_index_remove_template(type_t* t);
+
 extern inline void free_temporary_template_type(type_t* t)
 {
     ERROR_CONDITION(t->kind != TK_DIRECT
             || t->type->kind != STK_TEMPLATE_TYPE, "Invalid type", 0);
 
+    specialization_index_remove_template(t);
+
     type_t* primary_specialization_type = t->type->primary_specialization;
     scope_entry_t* primary_specialization = named_type_get_symbol(primary_specialization_type);
 
@@ -2540,19 +2559,239 @@ static int compare_identical_template_argument_list(const void* v1, const void*
     return 0;
 }
 
-static int compare_identical_template_argument_list_of_named_types(
-        const void *v1,
-        const void *v2)
+// Index of the specializations of every template keyed by a hash of the
+// template type and its template arguments. Specializations are indexed the
+// first time their template is searched, so the primary specializations
+// registered when the template is created need not be indexed explicitly.
+// Template arguments of a specialization never change once registered so
+// the index is never invalidated
+typedef
+struct specialization_index_entry_tag
 {
-    type_t* t1 = *(type_t**)v1;
-    type_t* t2 = *(type_t**)v2;
+    simple_type_t* template_type;
+    type_t* specialization;
 
-    t1 = named_type_get_symbol(t1)->type_information;
-    t2 = named_type_get_symbol(t2)->type_information;
+    struct specialization_index_entry_tag* next;
+} specialization_index_entry_t;
 
-    return compare_identical_template_argument_list(
-            template_specialized_type_get_template_arguments(t1),
-            template_specialized_type_get_template_arguments(t2));
+static ohash_u64_t* specialization_index = NULL;
+static unsigned long specialization_index_hits = 0;
+static unsigned long specialization_index_misses = 0;
+
+void get_specialization_index_stats(unsigned long* hits, unsigned long* misses)
+{
+    *hits = specialization_index_hits;
+    *misses = specialization_index_misses;
+}
+
+static uint64_t hash_combine(uint64_t h, uint64_t v)
+{
+    return h ^ (v + UINT64_C(0x9e3779b97f4a7c15) + (h << 6) + (h >> 2));
+}
+
+// Consistent with template_arg_value_type_identical_compare: values that
+// compare equal have the same hash
+static uint64_t template_arg_value_identical_hash(nodecl_t n)
+{
+    if (nodecl_is_null(n))
+        return 0;
+
+    uint64_t h = nodecl_get_kind(n);
+    h = hash_combine(h, (uintptr_t)nodecl_get_symbol(n));
+    h = hash_combine(h, (uintptr_t)nodecl_get_type(n));
+
+    const_value_t* cv = nodecl_get_constant(n);
+    if (cv != NULL
+            && !const_value_is_object(cv)
+            && !const_value_is_address(cv))
+    {
+        // Only integers are hashed by value, other constants just collide
+        // and are told apart by the comparison
+        h = hash_combine(h, 1);
+        if (const_value_is_integer(cv))
+            h = hash_combine(h, const_value_cast_to_8(cv));
+    }
+
+    int i;
+    for (i = 0; i < MCXX_MAX_AST_CHILDREN; i++)
+    {
+        h = hash_combine(h, template_arg_value_identical_hash(nodecl_get_child(n, i)));
+    }
+
+    return h;
+}
+
+static uint64_t specialization_index_key(type_t* t,
+        template_parameter_list_t* template_arguments)
+{
+    uint64_t h = (uintptr_t)t->type;
+    h = hash_combine(h, template_arguments->num_parameters);
+
+    int i;
+    for (i = 0; i < template_arguments->num_parameters; i++)
+    {
+        template_parameter_value_t* targ = template_arguments->arguments[i];
+        ERROR_CONDITION(targ == NULL, "Invalid parameter value", 0);
+
+        h = hash_combine(h, targ->kind);
+        switch (targ->kind)
+        {
+            case TPK_TYPE:
+            case TPK_TEMPLATE:
+                {
+                    h = hash_combine(h, (uintptr_t)targ->type);
+                    break;
+                }
+            case TPK_NONTYPE:
+                {
+                    h = hash_combine(h, template_arg_value_identical_hash(targ->value));
+                    break;
+                }
+            default:
+                {
+                    internal_error("Invalid template argument kind", 0);
+                }
+        }
+    }
+
+    return h;
+}
+
+static template_parameter_list_t* specialization_get_template_arguments(type_t* specialization)
+{
+    return template_specialized_type_get_template_arguments(
+            named_type_get_symbol(specialization)->type_information);
+}
+
+static void specialization_index_insert(type_t* t, type_t* specialization)
+{
+    if (specialization_index == NULL)
+        specialization_index = ohash_u64_new(5);
+
+    uint64_t key = specialization_index_key(t,
+            specialization_get_template_arguments(specialization));
+
+    specialization_index_entry_t* entry = NEW0(specialization_index_entry_t);
+    entry->template_type = t->type;
+    entry->specialization = specialization;
+
+    entry->next = (specialization_index_entry_t*)ohash_u64_push(specialization_index, key, entry);
+}
+
+static void specialization_index_remove_template(type_t* t)
+{
+    int i;
+    for (i = 0; i < t->type->num_indexed_specialized_types; i++)
+    {
+        uint64_t key = specialization_index_key(t,
+                specialization_get_template_arguments(t->type->all_specialized_types[i]));
+
+        specialization_index_entry_t* first =
+            (specialization_index_entry_t*)ohash_u64_query(specialization_index, key);
+        specialization_index_entry_t* entry = first;
+        specialization_index_entry_t* previous = NULL;
+        while (entry != NULL
+                && entry->specialization != t->type->all_specialized_types[i])
+        {
+            previous = entry;
+            entry = entry->next;
+        }
+        ERROR_CONDITION(entry == NULL, "Specialization not found in the index", 0);
+
+        if (previous != NULL)
+        {
+            previous->next = entry->next;
+        }
+        else if (entry->next != NULL)
+        {
+            ohash_u64_insert(specialization_index, key, entry->next);
+        }
+        else
+        {
+            ohash_u64_remove(specialization_index, key);
+        }
+        DELETE(entry);
+    }
+    t->type->num_indexed_specialized_types = 0;
+}
+
+static type_t* specialization_index_find(type_t* t,
+        template_parameter_list_t* template_parameters)
+{
+    while (t->type->num_indexed_specialized_types < t->type->num_all_specialized_types)
+    {
+        specialization_index_insert(t,
+                t->type->all_specialized_types[t->type->num_indexed_specialized_types]);
+        t->type->num_indexed_specialized_types++;
+    }
+
+    if (specialization_index == NULL)
+        return NULL;
+
+    specialization_index_entry_t* entry = (specialization_index_entry_t*)ohash_u64_query(
+            specialization_index,
+            specialization_index_key(t, template_parameters));
+    while (entry != NULL
+            && (entry->template_type != t->type
+                || compare_identical_template_argument_list(
+                    template_parameters,
+                    specialization_get_template_arguments(entry->specialization)) != 0))
+        entry = entry->next;
+
+    if (entry == NULL)
+        return NULL;
+
+    return entry->specialization;
+}
+
+static type_t* specialization_index_query(type_t* t,
+        template_parameter_list_t* template_parameters)
+{
+    type_t* specialization = specialization_index_find(t, template_parameters);
+    if (specialization == NULL)
+        specialization_index_misses++;
+    else
+        specialization_index_hits++;
+
+    return specialization;
+}
+
+// A template never has two specializations with identical template
+// arguments, otherwise the index would return any of them. Without the
+// index this is only checked when debugging, as it is a linear search
+static void specialization_check_unique(type_t* t, type_t* specialization)
+{
+    template_parameter_list_t* template_arguments =
+        specialization_get_template_arguments(specialization);
+
+    type_t* duplicate = NULL;
+    if (!debug_options.disable_specialization_index)
+    {
+        duplicate = specialization_index_find(t, template_arguments);
+    }
+    else
+    {
+        DEBUG_CODE()
+        {
+            int i;
+            for (i = 0; i < t->type->num_all_specialized_types && duplicate == NULL; i++)
+            {
+                if (compare_identical_template_argument_list(
+                            template_arguments,
+                            specialization_get_template_arguments(
+                                t->type->all_specialized_types[i])) == 0)
+                    duplicate = t->type->all_specialized_types[i];
+            }
+        }
+    }
+
+    if (duplicate != NULL)
+    {
+        internal_error("This cannot happen %p\nnew %s\nold %s",
+                t->type,
+                print_declarator(specialization),
+                print_declarator(duplicate));
+    }
 }
 
 static type_t* template_type_get_identical_specialized_type(type_t* t,
@@ -2561,52 +2800,35 @@ static type_t* template_type_get_identical_specialized_type(type_t* t,
 {
     ERROR_CONDITION(!is_template_type(t), "This is not a template type", 0);
 
-    type_t* specialization = NULL;
+    if (!debug_options.disable_specialization_index)
+        return specialization_index_query(t, template_parameters);
 
-    int lower = 0;
-    int upper = t->type->num_all_specialized_types - 1;
+    type_t* specialization = NULL;
 
-    while (lower <= upper)
+    int i;
+    for (i = 0; i < t->type->num_all_specialized_types; i++)
     {
-        int middle = (lower + upper) / 2;
-
-        type_t* current_specialization = t->type->all_specialized_types[middle];
-
-        scope_entry_t* entry = named_type_get_symbol(current_specialization);
-        template_parameter_list_t* specialization_template_parameters =
-            template_specialized_type_get_template_arguments(entry->type_information);
+        type_t* current_specialization = t->type->all_specialized_types[i];
 
         DEBUG_CODE()
         {
-            fprintf(stderr, "TYPEUTILS: Checking with specialization %p: #%d in [%d<=%d, %d<=%d] '%s' (%p) at '%s'\n",
+            scope_entry_t* entry = named_type_get_symbol(current_specialization);
+            fprintf(stderr, "TYPEUTILS: Checking with specialization %p: #%d of %d '%s' (%p) at '%s'\n",
                     t->type,
-                    middle,
-                    0,
-                    lower,
-                    upper,
-                    t->type->num_all_specialized_types - 1,
+                    i,
+                    t->type->num_all_specialized_types,
                     print_type_str(current_specialization, entry->decl_context),
                     entry->type_information,
                     locus_to_str(entry->locus));
         }
 
-        int cmp = compare_identical_template_argument_list(
-                template_parameters,
-                specialization_template_parameters);
-
-        if (cmp == 0)
+        if (compare_identical_template_argument_list(
+                    template_parameters,
+                    specialization_get_template_arguments(current_specialization)) == 0)
         {
             specialization = current_specialization;
             break;
         }
-        else if (cmp < 0)
-        {
-            upper = middle - 1;
-        }
-        else if (cmp > 0)
-        {
-            lower = middle + 1;
-        }
     }
 
     return specialization;
@@ -3976,49 +4198,12 @@ static type_t* template_type_get_specialized_type_(
         }
     }
 
-    // Register this specialization in the all specializations set
-    {
-        P_LIST_ADD(template_type->type->all_specialized_types,
-                template_type->type->num_all_specialized_types,
-                result);
-        int lower = 0;
-        int upper = template_type->type->num_all_specialized_types - 2;
-
-        // Binary insertion
-        while (lower <= upper)
-        {
-            int middle = (lower + upper) / 2;
-
-            int cmp = compare_identical_template_argument_list_of_named_types(
-                    &result,
-                    &template_type->type->all_specialized_types[middle]);
-
-            if (cmp < 0)
-            {
-                upper = middle - 1;
-            }
-            else if (cmp > 0)
-            {
-                lower = middle + 1;
-            }
-            else
-            {
-                internal_error("This cannot happen %p\nnew %s\n%03d: %s",
-                        template_type->type,
-                        print_declarator(result),
-                        middle, print_declarator(template_type->type->all_specialized_types[middle]));
-            }
-        }
-
-        int j;
-        // Shift all items right
-        for (j = template_type->type->num_all_specialized_types - 1; j >= lower + 1; j--)
-        {
-            template_type->type->all_specialized_types[j] =
-                template_type->type->all_specialized_types[j-1];
-        }
-        template_type->type->all_specialized_types[lower] = result;
-    }
+    // Register this specialization in the all specializations set. It is
+    // indexed the next time this template is searched
+    specialization_check_unique(template_type, result);
+    P_LIST_ADD(template_type->type->all_specialized_types,
+            template_type->type->num_all_specialized_types,
+            result);
 
     return result;
 }
@@ -5434,6 +5619,7 @@ static type_t* _get_duplicated_class_type(type_t* class_type)
     ERROR_CONDITION(!is_unnamed_class_type(class_type), "This is not a class type!", 0);
 
     type_t* result = NEW0(type_t);
+    num_types_created++;
     *result = *class_type;
 
     result->unqualified_type = result;
@@ -6937,6 +7123,9 @@ extern inline void class_type_add_base_class(type_t* class_type, scope_entry_t*
     class_info_t* class_info = class_type->type->class_info;
     // Only add once
     P_LIST_ADD_ONCE(class_info->base_classes_list, class_info->num_bases, new_base_class);
+
+    if (is_complete_type(class_type))
+        class_lookup_cache_invalidate();
 }
 
 void class_type_set_inner_context(type_t* class_type, const decl_context_t* decl_context)
@@ -6945,6 +7134,9 @@ void class_type_set_inner_context(type_t* class_type, const decl_context_t* decl
     class_type = get_actual_class_type(class_type);
 
     class_type->type->class_info->inner_decl_context = decl_context;
+
+    if (is_complete_type(class_type))
+        class_lookup_cache_invalidate();
 }
 
 extern inline const decl_context_t* class_type_get_inner_context(type_t* class_type)
@@ -7096,6 +7288,116 @@ extern inline scope_entry_list_t* class_type_get_all_conversions(type_t* class_t
     return this_class_conversors;
 }
 
+// Key of the caches indexed by a pair of types
+static uint64_t type_pair_cache_key(type_t* t1, type_t* t2)
+{
+    uint64_t h = (uint64_t)(uintptr_t)t1;
+    h ^= (uint64_t)(uintptr_t)t2 + UINT64_C(0x9e3779b97f4a7c15) + (h << 6) + (h >> 2);
+    return h;
+}
+
+// Results of comparing function and pointer to member types in the current
+// translation unit, keyed by the pair of types once typedefs have been
+// skipped. These comparisons walk the whole signature and are repeated many
+// times during overload resolution and redeclaration checks
+typedef
+struct equivalent_types_cache_entry_tag
+{
+    type_t* t1;
+    type_t* t2;
+    char result;
+
+    struct equivalent_types_cache_entry_tag* next;
+} equivalent_types_cache_entry_t;
+
+static ohash_u64_t* equivalent_types_cache = NULL;
+static translation_unit_t* equivalent_types_cache_translation_unit = NULL;
+static unsigned long equivalent_types_cache_hits = 0;
+static unsigned long equivalent_types_cache_misses = 0;
+
+void get_equivalent_types_cache_stats(unsigned long* hits, unsigned long* misses)
+{
+    *hits = equivalent_types_cache_hits;
+    *misses = equivalent_types_cache_misses;
+}
+
+static void equivalent_types_cache_free_entries(uint64_t key UNUSED_PARAMETER,
+        void* info, void* walk_info UNUSED_PARAMETER)
+{
+    equivalent_types_cache_entry_t* entry = (equivalent_types_cache_entry_t*)info;
+    while (entry != NULL)
+    {
+        equivalent_types_cache_entry_t* next = entry->next;
+        DELETE(entry);
+        entry = next;
+    }
+}
+
+static char equivalent_types_can_be_cached(type_t* t1, type_t* t2)
+{
+    // Fortran types are mutated after being created and dependent types may
+    // be completed with information from their enclosing template
+    return !debug_options.disable_overload_cache
+        && compilation_process.current_file_process != NULL
+        && !IS_FORTRAN_LANGUAGE
+        && (t1->kind == TK_FUNCTION
+                || t1->kind == TK_POINTER_TO_MEMBER)
+        && !is_dependent_type(t1)
+        && !is_dependent_type(t2);
+}
+
+static equivalent_types_cache_entry_t* equivalent_types_cache_query(
+        type_t* t1, type_t* t2, uint64_t* key)
+{
+    if (equivalent_types_cache_translation_unit != CURRENT_COMPILED_FILE)
+    {
+        if (equivalent_types_cache != NULL)
+        {
+            ohash_u64_walk(equivalent_types_cache, equivalent_types_cache_free_entries, NULL);
+            ohash_u64_destroy(equivalent_types_cache);
+        }
+        equivalent_types_cache = ohash_u64_new(5);
+        equivalent_types_cache_translation_unit = CURRENT_COMPILED_FILE;
+    }
+
+    // The relation is symmetric so the pair is ordered first
+    if ((uintptr_t)t1 > (uintptr_t)t2)
+    {
+        type_t* tmp = t1;
+        t1 = t2;
+        t2 = tmp;
+    }
+    *key = type_pair_cache_key(t1, t2);
+
+    equivalent_types_cache_entry_t* entry =
+        (equivalent_types_cache_entry_t*)ohash_u64_query(equivalent_types_cache, *key);
+    while (entry != NULL
+            && (entry->t1 != t1
+                || entry->t2 != t2))
+        entry = entry->next;
+
+    return entry;
+}
+
+static void equivalent_types_cache_insert(type_t* t1, type_t* t2, uint64_t key, char result)
+{
+    if ((uintptr_t)t1 > (uintptr_t)t2)
+    {
+        type_t* tmp = t1;
+        t1 = t2;
+        t2 = tmp;
+    }
+
+    equivalent_types_cache_entry_t* entry = NEW0(equivalent_types_cache_entry_t);
+    entry->t1 = t1;
+    entry->t2 = t2;
+    entry->result = result;
+
+    entry->next = (equivalent_types_cache_entry_t*)ohash_u64_push(equivalent_types_cache, key, entry);
+}
+
+static char equivalent_types_structurally(type_t* t1, type_t* t2);
+
 /*
  * States if two types are equivalent. This means that they are the same
  * (ignoring typedefs). Just plain comparison, no standard conversion is
@@ -7118,6 +7420,44 @@ extern inline char equivalent_types(type_t* t1, type_t* t2)
 
     char result = 0;
 
+    if (t1 == t2
+            && t1->kind != TK_OVERLOAD)
+    {
+        // Types are unique so the same type is always equivalent to itself
+        result = 1;
+    }
+    else if (equivalent_types_can_be_cached(t1, t2))
+    {
+        uint64_t key = 0;
+        equivalent_types_cache_entry_t* entry = equivalent_types_cache_query(t1, t2, &key);
+        if (entry != NULL)
+        {
+            equivalent_types_cache_hits++;
+            result = entry->result;
+        }
+        else
+        {
+            equivalent_types_cache_misses++;
+            result = equivalent_types_structurally(t1, t2);
+            equivalent_types_cache_insert(t1, t2, key, result);
+        }
+    }
+    else
+    {
+        result = equivalent_types_structurally(t1, t2);
+    }
+
+    result &= equivalent_cv_qualification(cv_qualifier_t1, cv_qualifier_t2);
+
+    return result;
+}
+
+// Compares two types once typedefs have been skipped, ignoring their
+// cv-qualification
+static char equivalent_types_structurally(type_t* t1, type_t* t2)
+{
+    char result = 0;
+
     switch (t1->kind)
     {
         case TK_DIRECT :
@@ -7163,8 +7503,6 @@ extern inline char equivalent_types(type_t* t1, type_t* t2)
             internal_error("Unknown type kind (%d)\n", t1->kind);
     }
 
-    result &= equivalent_cv_qualification(cv_qualifier_t1, cv_qualifier_t2);
-
     return result;
 }
 
@@ -12711,8 +13049,157 @@ extern inline char pointer_types_can_be_converted(type_t* orig, type_t* dest)
     return 1;
 }
 
+extern inline char type_conversions_can_be_cached(type_t* t)
+{
+    if (t == NULL)
+        return 1;
+
+    if (is_dependent_type(t)
+            || is_braced_list_type(t))
+        return 0;
+
+    // Conversions involving an incomplete class change once it is completed
+    for (;;)
+    {
+        t = no_ref(t);
+        if (is_pointer_to_member_type(t))
+        {
+            type_t* class_type = pointer_to_member_type_get_class_type(t);
+            if (is_incomplete_type(class_type))
+                return 0;
+            t = pointer_type_get_pointee_type(t);
+        }
+        else if (is_pointer_type(t))
+        {
+            t = pointer_type_get_pointee_type(t);
+        }
+        else if (is_array_type(t))
+        {
+            t = array_type_get_element_type(t);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return !is_class_type(t)
+        || is_complete_type(t);
+}
+
+// Results of standard_conversion_between_types of the current translation
+// unit, keyed by the pair of types. A result is only valid for the
+// generation of class lookup it was computed in because changes in complete
+// classes may change their bases
+typedef
+struct standard_conversion_cache_entry_tag
+{
+    type_t* orig;
+    type_t* dest;
+    unsigned long generation;
+
+    char is_valid;
+    standard_conversion_t scs;
+
+    struct standard_conversion_cache_entry_tag* next;
+} standard_conversion_cache_entry_t;
+
+static ohash_u64_t* standard_conversion_cache = NULL;
+static translation_unit_t* standard_conversion_cache_translation_unit = NULL;
+static unsigned long standard_conversion_cache_hits = 0;
+static unsigned long standard_conversion_cache_misses = 0;
+
+void get_standard_conversion_cache_stats(unsigned long* hits, unsigned long* misses)
+{
+    *hits = standard_conversion_cache_hits;
+    *misses = standard_conversion_cache_misses;
+}
+
+static void standard_conversion_cache_free_entries(uint64_t key UNUSED_PARAMETER,
+        void* info, void* walk_info UNUSED_PARAMETER)
+{
+    standard_conversion_cache_entry_t* entry = (standard_conversion_cache_entry_t*)info;
+    while (entry != NULL)
+    {
+        standard_conversion_cache_entry_t* next = entry->next;
+        DELETE(entry);
+        entry = next;
+    }
+}
+
+static standard_conversion_cache_entry_t* standard_conversion_cache_query(
+        type_t* orig, type_t* dest, uint64_t key)
+{
+    // Results may depend on the language and the configuration of the
+    // translation unit
+    if (standard_conversion_cache_translation_unit != CURRENT_COMPILED_FILE)
+    {
+        if (standard_conversion_cache != NULL)
+        {
+            ohash_u64_walk(standard_conversion_cache, standard_conversion_cache_free_entries, NULL);
+            ohash_u64_destroy(standard_conversion_cache);
+        }
+        standard_conversion_cache = ohash_u64_new(5);
+        standard_conversion_cache_translation_unit = CURRENT_COMPILED_FILE;
+    }
+
+    standard_conversion_cache_entry_t* entry =
+        (standard_conversion_cache_entry_t*)ohash_u64_query(standard_conversion_cache, key);
+    while (entry != NULL
+            && (entry->orig != orig
+                || entry->dest != dest))
+        entry = entry->next;
+
+    return entry;
+}
+
+static char standard_conversion_between_types_uncached(standard_conversion_t *result,
+        type_t* t_orig, type_t* t_dest,
+        const locus_t* locus);
+
 extern inline char standard_conversion_between_types(standard_conversion_t *result, type_t* t_orig, type_t* t_dest,
         const locus_t* locus)
+{
+    if (debug_options.disable_overload_cache
+            || compilation_process.current_file_process == NULL
+            || !type_conversions_can_be_cached(t_orig)
+            || !type_conversions_can_be_cached(t_dest))
+    {
+        return standard_conversion_between_types_uncached(result, t_orig, t_dest, locus);
+    }
+
+    uint64_t key = type_pair_cache_key(t_orig, t_dest);
+    standard_conversion_cache_entry_t* entry = standard_conversion_cache_query(t_orig, t_dest, key);
+    if (entry != NULL
+            && entry->generation == get_class_lookup_generation())
+    {
+        standard_conversion_cache_hits++;
+        *result = entry->scs;
+        return entry->is_valid;
+    }
+    standard_conversion_cache_misses++;
+
+    char is_valid = standard_conversion_between_types_uncached(result, t_orig, t_dest, locus);
+
+    // The computation may have added entries to the table
+    entry = standard_conversion_cache_query(t_orig, t_dest, key);
+    if (entry == NULL)
+    {
+        entry = NEW0(standard_conversion_cache_entry_t);
+        entry->orig = t_orig;
+        entry->dest = t_dest;
+        entry->next = (standard_conversion_cache_entry_t*)ohash_u64_push(standard_conversion_cache, key, entry);
+    }
+    entry->generation = get_class_lookup_generation();
+    entry->is_valid = is_valid;
+    entry->scs = *result;
+
+    return is_valid;
+}
+
+static char standard_conversion_between_types_uncached(standard_conversion_t *result,
+        type_t* t_orig, type_t* t_dest,
+        const locus_t* locus)
 {
     DEBUG_CODE()
     {
@@ -14352,6 +14839,9 @@ extern inline char is_complete_type(type_t* t)
 extern inline void set_is_incomplete_type(type_t* t, char is_incomplete)
 {
     t = canonical_type(t);
+    // Lookups in complete classes may have been cached
+    if (is_incomplete && !t->info->is_incomplete)
+        class_lookup_cache_invalidate();
     t->info->is_incomplete = is_incomplete;
 }
 
@@ -51,6 +51,14 @@ LIBMCXX_EXTERN char standard_conversion_is_invalid(standard_conversion_t);
 LIBMCXX_EXTERN type_t* standard_conversion_get_orig_type(standard_conversion_t scs);
 LIBMCXX_EXTERN type_t* standard_conversion_get_dest_type(standard_conversion_t scs);
 
+// States whether the conversions from or to t can be remembered: it is not
+// dependent and does not involve incomplete classes
+LIBMCXX_EXTERN char type_conversions_can_be_cached(type_t* t);
+// Hits and misses of the cache of standard_conversion_between_types so far,
+// for statistics
+LIBMCXX_EXTERN void get_standard_conversion_cache_stats(unsigned long* hits, unsigned long* misses);
+LIBMCXX_EXTERN void get_equivalent_types_cache_stats(unsigned long* hits, unsigned long* misses);
+LIBMCXX_EXTERN void get_specialization_index_stats(unsigned long* hits, unsigned long* misses);
 LIBMCXX_EXTERN char standard_conversion_between_types(standard_conversion_t *result, 
         type_t* orig, type_t* dest, const locus_t* locus);
 
@@ -854,6 +862,8 @@ LIBMCXX_EXTERN void class_type_get_virtual_base_with_offset_num(type_t* t, int n
         _size_t* offset);
 
 LIBMCXX_EXTERN size_t get_type_t_size(void);
+// Number of types allocated so far, for statistics
+LIBMCXX_EXTERN unsigned long get_num_types_created(void);
 
 LIBMCXX_EXTERN const char* print_decl_type_str(type_t* t, const decl_context_t* decl_context, const char* name);
 LIBMCXX_EXTERN const char* print_type_str(type_t* t, const decl_context_t* decl_context);
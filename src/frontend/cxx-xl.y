@@ -6,7 +6,7 @@
 
 nontype_specifier_without_attribute : XL_BUILTIN_SPEC
 {
-    $$ = ASTLeaf(AST_XL_BUILTIN_SPEC, make_locus(@1.first_filename, @1.first_line, 0), $1.token_text);
+    $$ = ASTLeaf(AST_XL_BUILTIN_SPEC, make_locus_in_file(@1.first_file_id, @1.first_line, 0), $1.token_text);
 }
 ;
 
@@ -10314,6 +10314,7 @@ scope_entry_t* insert_symbol_from_module(scope_entry_t* entry,
     // Copy everything and restore the name
     *current_symbol = *entry;
     symbol_clear_indirect_types(current_symbol);
+    symbol_entity_specs_copy_cold_from(current_symbol, entry);
 
     // Restore original context
     current_symbol->decl_context = decl_context;
@@ -67,6 +67,8 @@ typedef
 struct token_location_tag
 {
     const char* filename;
+    // See locus_file_id
+    unsigned int file_id;
     int line;
     int column;
 } token_location_t;
@@ -232,6 +234,7 @@ extern int mf03_open_file_for_scanning(const char* scanned_filename,
         = lexer_state.current_file->buffer = mmapped_addr;
 
     lexer_state.current_file->current_location.filename = input_filename;
+    lexer_state.current_file->current_location.file_id = locus_file_id(input_filename);
     lexer_state.current_file->current_location.line = 1;
     lexer_state.current_file->current_location.column = 1;
 
@@ -317,6 +320,7 @@ extern int mf03_prepare_string_for_scanning(const char* str)
         = lexer_state.current_file->buffer = str;
 
     lexer_state.current_file->current_location.filename = filename;
+    lexer_state.current_file->current_location.file_id = locus_file_id(filename);
     lexer_state.current_file->current_location.line = 1;
     lexer_state.current_file->current_location.column = 1;
 
@@ -686,6 +690,7 @@ static char handle_preprocessor_line(void)
         }
 
         lexer_state.current_file->current_location.filename = uniquestr(filename);
+        lexer_state.current_file->current_location.file_id = locus_file_id(filename);
         lexer_state.current_file->current_location.line = linenum;
         lexer_state.current_file->current_location.column = 1;
 
@@ -2048,6 +2053,7 @@ static int commit_text(int token_id, const char* str,
 
     mf03lval.token_atrib.token_text = uniquestr(str);
     mf03lloc.first_filename = loc.filename;
+    mf03lloc.first_file_id = loc.file_id;
     mf03lloc.first_line = loc.line;
     mf03lloc.first_column = loc.column;
 
@@ -2470,6 +2476,7 @@ static char is_include_line(void)
         = lexer_state.current_file->buffer = mmapped_addr;
 
     lexer_state.current_file->current_location.filename = include_filename;
+    lexer_state.current_file->current_location.file_id = locus_file_id(include_filename);
     lexer_state.current_file->current_location.line = 1;
     lexer_state.current_file->current_location.column = 1;
 
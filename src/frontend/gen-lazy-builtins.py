@@ -0,0 +1,165 @@
+#!/usr/bin/python
+
+#  (C) Copyright 2006-2015 Barcelona Supercomputing Center
+#                          Centro Nacional de Supercomputacion
+#
+#  This file is part of Mercurium C/C++ source-to-source compiler.
+#
+#  See AUTHORS file in the top level directory for information
+#  regarding developers and contributors.
+#
+#  This library is free software; you can redistribute it and/or
+#  modify it under the terms of the GNU Lesser General Public
+#  License as published by the Free Software Foundation; either
+#  version 3 of the License, or (at your option) any later version.
+#
+#  Mercurium C/C++ source-to-source compiler is distributed in the hope
+#  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+#  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+#  PURPOSE.  See the GNU Lesser General Public License for more
+#  details.
+#
+#  You should have received a copy of the GNU Lesser General Public
+#  License along with Mercurium C/C++ source-to-source compiler; if
+#  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+#  Cambridge, MA 02139, USA.
+
+# Splits a file of builtin declarations (like cxx-gccbuiltins-ia32.h) into
+# one function per builtin name and emits a perfect hash of the names, so
+# builtins can be signed in the first time they are looked up.
+#
+#   gen-lazy-builtins.py <table-name> <builtins-file>
+#
+# The perfect hash uses hash and displace: the name is first hashed into a
+# bucket and then rehashed, with the displacement of the bucket as a seed,
+# into a slot. The hash is lazy_builtin_hash in cxx-lazybuiltins.c
+
+from __future__ import print_function
+
+import sys
+import re
+
+def lazy_builtin_hash(name, seed):
+    # 32-bit FNV-1a seeded with the displacement
+    h = (2166136261 ^ seed) & 0xffffffff
+    for c in bytearray(name.encode("ascii")):
+        h ^= c
+        h = (h * 16777619) & 0xffffffff
+    return h
+
+def split_declarations(lines):
+    """Returns the top-level statements of the file along with the name of
+    the builtin they declare"""
+    new_symbol_re = re.compile(r'new_symbol\([^,]*,[^,]*, *uniquestr\("([^"]+)"\)\)')
+
+    declarations = []
+    current = []
+    depth = 0
+    for line in lines:
+        if depth == 0 and line.strip() == "":
+            continue
+        current.append(line)
+        depth += line.count("{") - line.count("}")
+        if depth < 0:
+            sys.stderr.write("error: unbalanced braces\n")
+            sys.exit(1)
+        if depth == 0:
+            statement = "".join(current)
+            m = new_symbol_re.search(statement)
+            if m is None:
+                sys.stderr.write("error: statement does not declare a builtin:\n%s" % statement)
+                sys.exit(1)
+            declarations.append((m.group(1), statement))
+            current = []
+    if depth != 0:
+        sys.stderr.write("error: unbalanced braces at the end of the file\n")
+        sys.exit(1)
+    return declarations
+
+def compute_perfect_hash(names):
+    num_slots = max(1, (len(names) * 5) // 4)
+    num_buckets = max(1, len(names) // 4)
+
+    buckets = [[] for i in range(num_buckets)]
+    for name in names:
+        buckets[lazy_builtin_hash(name, 0) % num_buckets].append(name)
+
+    displacements = [0] * num_buckets
+    slots = [None] * num_slots
+
+    # Place the largest buckets first, while there is room for them
+    order = sorted(range(num_buckets), key=lambda b: -len(buckets[b]))
+    for b in order:
+        if not buckets[b]:
+            break
+        seed = 1
+        while True:
+            candidate = [lazy_builtin_hash(name, seed) % num_slots for name in buckets[b]]
+            if len(set(candidate)) == len(candidate) \
+                    and all(slots[s] is None for s in candidate):
+                break
+            seed += 1
+        displacements[b] = seed
+        for (name, s) in zip(buckets[b], candidate):
+            slots[s] = name
+
+    return (slots, displacements)
+
+if len(sys.argv) != 3:
+    sys.stderr.write("usage: %s table-name builtins-file\n" % sys.argv[0])
+    sys.exit(1)
+
+table_name = sys.argv[1]
+builtins_file = sys.argv[2]
+
+f = open(builtins_file)
+declarations = split_declarations(f.readlines())
+f.close()
+
+# A builtin may be declared several times (e.g. overloads), keep them together
+names = []
+statements = {}
+for (name, statement) in declarations:
+    if name not in statements:
+        names.append(name)
+        statements[name] = []
+    statements[name].append(statement)
+
+(slots, displacements) = compute_perfect_hash(names)
+
+print("/* This file has been generated by gen-lazy-builtins.py from %s. Do not modify it */" % builtins_file.split("/")[-1])
+print("")
+
+function_names = {}
+for (i, name) in enumerate(names):
+    function_name = "%s_%d" % (table_name, i)
+    function_names[name] = function_name
+    print("static void %s(const decl_context_t* decl_context, const locus_t* builtins_locus)" % function_name)
+    print("{")
+    for statement in statements[name]:
+        sys.stdout.write(statement)
+    print("}")
+    print("")
+
+print("static const lazy_builtin_t %s_slots[] =" % table_name)
+print("{")
+for name in slots:
+    if name is None:
+        print("    { NULL, NULL },")
+    else:
+        print("    { \"%s\", %s }," % (name, function_names[name]))
+print("};")
+print("")
+
+print("static const unsigned int %s_displacements[] =" % table_name)
+print("{")
+for i in range(0, len(displacements), 8):
+    print("    " + " ".join("%d," % d for d in displacements[i:i+8]))
+print("};")
+print("")
+
+print("static const lazy_builtin_table_t %s =" % table_name)
+print("{")
+print("    %s_slots, %d," % (table_name, len(slots)))
+print("    %s_displacements, %d," % (table_name, len(displacements)))
+print("};")
@@ -43,6 +43,10 @@ else:
     op = "entity_specifiers"
 
 
+# Names of the attributes stored in the side record of entity_specifiers_t
+cold_attributes = set()
+
+
 def loadlines(f):
     lines = f.readlines()
     result = []
@@ -50,10 +54,30 @@ def loadlines(f):
         l = l.strip(" \n")
         if l[0] == '#':
             continue
+        fields = l.split("|")
+        if len(fields) == 5:
+            if fields[4].strip(" \n") != "cold":
+                raise Exception("Invalid storage '%s'" % (fields[4]))
+            cold_attributes.add(fields[2].lstrip("*"))
+            l = "|".join(fields[0:4])
         result.append(l)
     return result
 
 
+def is_cold(name):
+    return name.lstrip("*") in cold_attributes
+
+
+def specs_of(s, name, write=False):
+    """Expression that designates the record holding attribute 'name' of symbol 's'."""
+    if not is_cold(name):
+        return "%s->_entity_specs." % (s)
+    elif write:
+        return "symbol_entity_specs_get_cold_rw(%s)->" % (s)
+    else:
+        return "symbol_entity_specs_get_cold(%s)->" % (s)
+
+
 def check_file(lines):
     for l in lines:
         fields = l.split("|")
@@ -145,6 +169,7 @@ def print_entity_specifiers(lines):
     indent = " " * 4
     current_language = "all"
     decls = []
+    cold_decls = []
     for l in lines:
         fields = l.split("|")
         (_type, language, name, description) = fields
@@ -155,7 +180,10 @@ def print_entity_specifiers(lines):
         if (language != current_language):
             current_language = language
         descr = description.strip(" \n")
-        decls += print_type_and_name(_type, name)
+        if is_cold(name):
+            cold_decls += print_type_and_name(_type, name)
+        else:
+            decls += print_type_and_name(_type, name)
 
     print("""
 #ifndef CXX_ENTITY_SPECIFIERS_H
@@ -165,21 +193,42 @@ def print_entity_specifiers(lines):
 
 // Include this file only from cxx-scope-decls.h and not from anywhere else
 
-typedef struct entity_specifiers_tag\n{""")
+// Attributes that few symbols have. They are allocated the first time any of
+// them is set
+typedef struct entity_specifiers_cold_tag\n{""")
 
-    for tk in [
-            TypeKind.OTHER, TypeKind.POINTER, TypeKind.INTEGER, TypeKind.BIT
-    ]:
-        for d in decls:
-            (typename, name, suffix, k) = d
-            if k == tk:
-                print(indent + typename + " " + name + suffix + ";")
+    def print_fields(decls):
+        for tk in [
+                TypeKind.OTHER, TypeKind.POINTER, TypeKind.INTEGER, TypeKind.BIT
+        ]:
+            for d in decls:
+                (typename, name, suffix, k) = d
+                if k == tk:
+                    print(indent + typename + " " + name + suffix + ";")
 
+    print_fields(cold_decls)
+    print("} entity_specifiers_cold_t;")
+    print("")
+    print("typedef struct entity_specifiers_tag\n{")
+    print(indent + "entity_specifiers_cold_t* cold;")
+    print_fields(decls)
     print("} entity_specifiers_t;")
     print("")
     print("#endif")
 
 
+def array_field_names(name):
+    field_names = name.split(",")
+    if (len(field_names) == 1):
+        return ("num_" + name, name)
+    elif (len(field_names) == 2):
+        return (field_names[0], field_names[1])
+    else:
+        raise Exception(
+            "Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed"
+        )
+
+
 def print_getters_setters(lines):
     print("""
 #ifndef CXX_ENTITY_SPECIFIERS_OPS_H
@@ -195,6 +244,41 @@ def print_getters_setters(lines):
 
 // Include this file only from cxx-scope-decls.h and not from anywhere else
 
+LIBMCXX_EXTERN entity_specifiers_cold_t* symbol_entity_specs_new_cold(void);
+
+// Rarely used attributes of a symbol. Symbols without them share an empty record
+static inline const entity_specifiers_cold_t* symbol_entity_specs_get_cold(scope_entry_t* s)
+{
+    static entity_specifiers_cold_t empty_cold;
+    if (s->_entity_specs.cold == NULL)
+        return &empty_cold;
+    return s->_entity_specs.cold;
+}
+
+static inline entity_specifiers_cold_t* symbol_entity_specs_get_cold_rw(scope_entry_t* s)
+{
+    if (s->_entity_specs.cold == NULL)
+        s->_entity_specs.cold = symbol_entity_specs_new_cold();
+    return s->_entity_specs.cold;
+}
+
+static inline char symbol_entity_specs_has_cold(scope_entry_t* s)
+{
+    return s->_entity_specs.cold != NULL;
+}
+
+// Gives dest its own copy of the rarely used attributes of source. Use this
+// after copying a whole scope_entry_t
+static inline void symbol_entity_specs_copy_cold_from(scope_entry_t* dest, scope_entry_t* source)
+{
+    dest->_entity_specs.cold = NULL;
+    if (source->_entity_specs.cold != NULL)
+    {
+        dest->_entity_specs.cold = symbol_entity_specs_new_cold();
+        *(dest->_entity_specs.cold) = *(source->_entity_specs.cold);
+    }
+}
+
 """)
     current_language = "all"
     decls = []
@@ -204,6 +288,9 @@ def print_getters_setters(lines):
         if name[0] == "*":
             name = name[1:]
 
+        get = specs_of("s", name)
+        put = specs_of("s", name, write=True)
+
         # Atomic types
         if (_type in
             ["integer", "bool", "string", "AST", "nodecl", "type", "symbol"]
@@ -214,26 +301,32 @@ def print_getters_setters(lines):
             (typename, name, suffix, k) = decls[0]
             print("// Single value attribute: '%s' " % (name))
             print(
-                "static inline %s symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return s->_entity_specs.%s;\n}"
-                % (typename, name, name))
-            print(
-                "static inline void symbol_entity_specs_set_%s(scope_entry_t* s, %s v)\n{\n    s->_entity_specs.%s = v;\n}"
-                % (name, typename, name))
+                "static inline %s symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return %s%s;\n}"
+                % (typename, name, get, name))
+            if is_cold(name) and k in [TypeKind.BIT, TypeKind.INTEGER, TypeKind.POINTER]:
+                # Do not allocate the cold record just to keep a zero
+                if typename == "nodecl_t":
+                    is_zero = "v.tree == NULL"
+                else:
+                    is_zero = "v == 0"
+                print(
+                    "static inline void symbol_entity_specs_set_%s(scope_entry_t* s, %s v)\n{\n    if (%s && !symbol_entity_specs_has_cold(s))\n        return;\n    %s%s = v;\n}"
+                    % (name, typename, is_zero, put, name))
+            else:
+                print(
+                    "static inline void symbol_entity_specs_set_%s(scope_entry_t* s, %s v)\n{\n    %s%s = v;\n}"
+                    % (name, typename, put, name))
             print("")
         # Compound types
         elif _type.startswith("array"):
             type_name = get_up_to_matching_paren(_type[len("array"):])
-            field_names = name.split(",")
-            if (len(field_names) == 1):
-                num_name = "num_" + name
-                list_name = name
-            elif (len(field_names) == 2):
-                num_name = field_names[0]
-                list_name = field_names[1]
-            else:
-                raise Exception(
-                    "Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed"
-                )
+            (num_name, list_name) = array_field_names(name)
+
+            # Mutators of cold lists get the record once
+            pro = ""
+            if is_cold(name):
+                pro = "    entity_specifiers_cold_t* cold = symbol_entity_specs_get_cold_rw(s);\n"
+                put = "cold->"
 
             decls = print_type_and_name(type_name, "")
             if len(decls) != 1:
@@ -252,46 +345,57 @@ def print_getters_setters(lines):
                     % (num_name))
 
             print(
-                "static inline int symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return s->_entity_specs.%s;\n}"
-                % (num_name, num_name))
+                "static inline int symbol_entity_specs_get_%s(scope_entry_t* s)\n{\n    return %s%s;\n}"
+                % (num_name, get, num_name))
             print(
-                "static inline %s symbol_entity_specs_get_%s_num(scope_entry_t* s, int i)\n{\n    ERROR_CONDITION(i >= s->_entity_specs.%s,\n        \"Invalid index %%d >= %%d\",\n        i, s->_entity_specs.%s);\n    return s->_entity_specs.%s[i];\n}"
-                % (type_name, list_name, num_name, num_name, list_name))
+                "static inline %s symbol_entity_specs_get_%s_num(scope_entry_t* s, int i)\n{\n    ERROR_CONDITION(i >= %s%s,\n        \"Invalid index %%d >= %%d\",\n        i, %s%s);\n    return %s%s[i];\n}"
+                % (type_name, list_name, get, num_name, get, num_name, get, list_name))
             print(
-                "static inline void symbol_entity_specs_set_%s_num(scope_entry_t* s, int i, %s v)\n{\n    ERROR_CONDITION(i >= s->_entity_specs.%s,\n        \"Invalid index %%d >= %%d\",\n         i, s->_entity_specs.%s);\n    s->_entity_specs.%s[i] = v;\n}"
-                % (list_name, type_name, num_name, num_name, list_name))
+                "static inline void symbol_entity_specs_set_%s_num(scope_entry_t* s, int i, %s v)\n{\n%s    ERROR_CONDITION(i >= %s%s,\n        \"Invalid index %%d >= %%d\",\n         i, %s%s);\n    %s%s[i] = v;\n}"
+                % (list_name, type_name, pro, put, num_name, put, num_name, put, list_name))
             print(
-                "static inline void symbol_entity_specs_append_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_ADD(s->_entity_specs.%s, s->_entity_specs.%s, item);\n}"
-                % (list_name, type_name, list_name, num_name))
+                "static inline void symbol_entity_specs_append_%s(scope_entry_t* s, %s item)\n{\n%s    P_LIST_ADD(%s%s, %s%s, item);\n}"
+                % (list_name, type_name, pro, put, list_name, put, num_name))
             if type_name not in cannot_be_compared:
                 print(
-                    "static inline void symbol_entity_specs_remove_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_REMOVE(s->_entity_specs.%s, s->_entity_specs.%s, item);\n}"
-                    % (list_name, type_name, list_name, num_name))
+                    "static inline void symbol_entity_specs_remove_%s(scope_entry_t* s, %s item)\n{\n%s    P_LIST_REMOVE(%s%s, %s%s, item);\n}"
+                    % (list_name, type_name, pro, put, list_name, put, num_name))
                 print(
-                    "static inline void symbol_entity_specs_insert_%s(scope_entry_t* s, %s item)\n{\n    P_LIST_ADD_ONCE(s->_entity_specs.%s, s->_entity_specs.%s, item);\n}"
-                    % (list_name, type_name, list_name, num_name))
+                    "static inline void symbol_entity_specs_insert_%s(scope_entry_t* s, %s item)\n{\n%s    P_LIST_ADD_ONCE(%s%s, %s%s, item);\n}"
+                    % (list_name, type_name, pro, put, list_name, put, num_name))
             print(
-                "static inline void symbol_entity_specs_remove_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n    P_LIST_REMOVE_FUN(s->_entity_specs.%s, s->_entity_specs.%s, item, cmp);\n}"
-                % (list_name, type_name, type_name, type_name, list_name,
-                   num_name))
+                "static inline void symbol_entity_specs_remove_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n%s    P_LIST_REMOVE_FUN(%s%s, %s%s, item, cmp);\n}"
+                % (list_name, type_name, type_name, type_name, pro, put, list_name,
+                   put, num_name))
             print(
-                "static inline void symbol_entity_specs_insert_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n    P_LIST_ADD_ONCE_FUN(s->_entity_specs.%s, s->_entity_specs.%s, item, cmp);\n}"
-                % (list_name, type_name, type_name, type_name, list_name,
-                   num_name))
+                "static inline void symbol_entity_specs_insert_%s_cmp(scope_entry_t* s, %s item,\n        char (*cmp)(%s, %s))\n{\n%s    P_LIST_ADD_ONCE_FUN(%s%s, %s%s, item, cmp);\n}"
+                % (list_name, type_name, type_name, type_name, pro, put, list_name,
+                   put, num_name))
             print(
                 "static inline void symbol_entity_specs_add_%s(scope_entry_t* s, %s item)\n{\n    symbol_entity_specs_append_%s(s, item);\n}"
                 % (list_name, type_name, list_name))
             print(
-                "static inline void symbol_entity_specs_reserve_%s(scope_entry_t* s, int num)\n{\n    s->_entity_specs.%s = num;\n    s->_entity_specs.%s = NEW_VEC0(%s, num);\n}"
-                % (list_name, num_name, list_name, type_name))
-            # print "static inline void symbol_entity_specs_clear_%s(scope_entry_t* s)\n{\n    s->_entity_specs.%s = NULL;\n    s->_entity_specs.%s = 0;\n}" % (list_name, list_name, num_name)
-            print(
-                "static inline void symbol_entity_specs_free_%s(scope_entry_t* s)\n{\n    s->_entity_specs.%s = 0;\n    DELETE(s->_entity_specs.%s);\n    s->_entity_specs.%s = NULL;\n}"
-                % (list_name, num_name, list_name, list_name))
-            print(
-                "static inline void symbol_entity_specs_copy_%s_from(scope_entry_t* dest, scope_entry_t* source)\n{\n    symbol_entity_specs_reserve_%s(dest, source->_entity_specs.%s);\n    memcpy(dest->_entity_specs.%s,\n        source->_entity_specs.%s,\n        dest->_entity_specs.%s\n        * (sizeof (*(dest->_entity_specs.%s))));\n} "
-                % (list_name, list_name, num_name, list_name, list_name,
-                   num_name, list_name))
+                "static inline void symbol_entity_specs_reserve_%s(scope_entry_t* s, int num)\n{\n%s    %s%s = num;\n    %s%s = NEW_VEC0(%s, num);\n}"
+                % (list_name, pro, put, num_name, put, list_name, type_name))
+            if is_cold(name):
+                print(
+                    "static inline void symbol_entity_specs_free_%s(scope_entry_t* s)\n{\n    if (!symbol_entity_specs_has_cold(s))\n        return;\n    s->_entity_specs.cold->%s = 0;\n    DELETE(s->_entity_specs.cold->%s);\n    s->_entity_specs.cold->%s = NULL;\n}"
+                    % (list_name, num_name, list_name, list_name))
+                print(
+                    "static inline void symbol_entity_specs_copy_%s_from(scope_entry_t* dest, scope_entry_t* source)\n{\n    if (!symbol_entity_specs_has_cold(source)\n            && !symbol_entity_specs_has_cold(dest))\n        return;\n    symbol_entity_specs_reserve_%s(dest, %s%s);\n    memcpy(%s%s,\n        %s%s,\n        %s%s\n        * (sizeof (*(%s%s))));\n} "
+                    % (list_name, list_name, specs_of("source", name), num_name,
+                        specs_of("dest", name, write=True), list_name,
+                        specs_of("source", name), list_name,
+                        specs_of("dest", name), num_name,
+                        specs_of("dest", name), list_name))
+            else:
+                print(
+                    "static inline void symbol_entity_specs_free_%s(scope_entry_t* s)\n{\n    s->_entity_specs.%s = 0;\n    DELETE(s->_entity_specs.%s);\n    s->_entity_specs.%s = NULL;\n}"
+                    % (list_name, num_name, list_name, list_name))
+                print(
+                    "static inline void symbol_entity_specs_copy_%s_from(scope_entry_t* dest, scope_entry_t* source)\n{\n    symbol_entity_specs_reserve_%s(dest, source->_entity_specs.%s);\n    memcpy(dest->_entity_specs.%s,\n        source->_entity_specs.%s,\n        dest->_entity_specs.%s\n        * (sizeof (*(dest->_entity_specs.%s))));\n} "
+                    % (list_name, list_name, num_name, list_name, list_name,
+                       num_name, list_name))
             print("")
 
     print(
@@ -299,6 +403,7 @@ def print_getters_setters(lines):
     )
     print("{")
     print("    dest->_entity_specs = source->_entity_specs;")
+    print("    symbol_entity_specs_copy_cold_from(dest, source);")
     # Now copy every list
     for l in lines:
         fields = l.split("|")
@@ -306,44 +411,24 @@ def print_getters_setters(lines):
         if name[0] == "*":
             name = name[1:]
         if _type.startswith("array"):
-            type_name = get_up_to_matching_paren(_type[len("array"):])
-            field_names = name.split(",")
-            if (len(field_names) == 1):
-                num_name = "num_" + name
-                list_name = name
-            elif (len(field_names) == 2):
-                num_name = field_names[0]
-                list_name = field_names[1]
-            else:
-                raise Exception(
-                    "Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed"
-                )
+            (num_name, list_name) = array_field_names(name)
             print("    symbol_entity_specs_copy_%s_from(dest, source);" %
                   (list_name))
     print("}")
     print("")
     print("static inline void symbol_entity_specs_free(scope_entry_t* symbol)")
     print("{")
-    # Now copy every list
+    # Now free every list
     for l in lines:
         fields = l.split("|")
         (_type, language, name, description) = fields
         if name[0] == "*":
             name = name[1:]
         if _type.startswith("array"):
-            type_name = get_up_to_matching_paren(_type[len("array"):])
-            field_names = name.split(",")
-            if (len(field_names) == 1):
-                num_name = "num_" + name
-                list_name = name
-            elif (len(field_names) == 2):
-                num_name = field_names[0]
-                list_name = field_names[1]
-            else:
-                raise Exception(
-                    "Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed"
-                )
+            (num_name, list_name) = array_field_names(name)
             print("    symbol_entity_specs_free_%s(symbol);" % (list_name))
+    print("    DELETE(symbol->_entity_specs.cold);")
+    print("    symbol->_entity_specs.cold = NULL;")
     print("}")
 
     print("#endif")
@@ -868,6 +953,10 @@ def print_deep_copy_entity_specs(lines):
         if name == "function_code":
             print("// We do not copy function code!")
             continue
+        if is_cold(name):
+            # Leave the cold record of dest unallocated if source has none
+            print("if (symbol_entity_specs_has_cold(source))")
+        print("{")
         if _type in ["bool", "integer"]:
             print(
                 "symbol_entity_specs_set_%s(dest, symbol_entity_specs_get_%s(source));"
@@ -982,11 +1071,230 @@ def print_deep_copy_entity_specs(lines):
         else:
             sys.stderr.write("%s:%d: warning: not handling type '%s'\n" %
                              (sys.argv[0], lineno(), _type))
+        print("}")
     print("""
     }
     """)
 
 
+def print_pch_entity_specs(lines):
+    print("// DO NOT MODIFY THIS FILE.")
+    print(
+        "// It will be overwritten when gen-symbols-attrs.py or cxx-entity_specs.def are modified"
+    )
+    print("// Include this file only from cxx-pch.c")
+
+    # Fortran attributes are never written in a precompiled header and
+    # neither are the ones that are not stored in modules
+    fields = []
+    for l in lines:
+        (_type, language, name, description) = l.split("|")
+        if name[0] == "*" or language == "fortran":
+            continue
+        fields.append((_type, name))
+
+    bools = [name for (_type, name) in fields if _type == "bool"]
+    others = [(_type, name) for (_type, name) in fields if _type != "bool"]
+
+    def array_names(name):
+        field_names = name.split(",")
+        if (len(field_names) == 1):
+            return ("num_" + name, name)
+        elif (len(field_names) == 2):
+            return (field_names[0], field_names[1])
+        raise Exception(
+            "Invalid number of fields in array name. Only 1 or 2 comma-separated are allowed"
+        )
+
+    print(
+        "static void pch_write_entity_specs(pch_writer_t* w, scope_entry_t* symbol)"
+    )
+    print("{")
+    for i in range(0, len(bools), 32):
+        print("pch_write_word(w, 0")
+        for (j, name) in enumerate(bools[i:i + 32]):
+            print("    | ((uint32_t)symbol_entity_specs_get_%s(symbol) << %d)" %
+                  (name, j))
+        print("    );")
+    for (_type, name) in others:
+        if _type == "integer":
+            print(
+                "pch_write_word(w, (uint32_t)symbol_entity_specs_get_%s(symbol));"
+                % (name))
+        elif _type == "symbol":
+            print(
+                "pch_write_word(w, pch_symbol_id(w, symbol_entity_specs_get_%s(symbol)));"
+                % (name))
+        elif _type == "type":
+            print(
+                "pch_write_word(w, pch_type_id(w, symbol_entity_specs_get_%s(symbol)));"
+                % (name))
+        elif _type == "nodecl":
+            print(
+                "pch_write_word(w, pch_nodecl_id(w, symbol_entity_specs_get_%s(symbol)));"
+                % (name))
+        elif _type == "string":
+            print(
+                "pch_write_word(w, pch_string_id(w, symbol_entity_specs_get_%s(symbol)));"
+                % (name))
+        elif _type.startswith("typeof"):
+            type_name = get_up_to_matching_paren(
+                _type[len("typeof"):]).split(",")[0].strip()
+            if type_name == "_size_t":
+                print(
+                    "pch_write_wide(w, (uint64_t)symbol_entity_specs_get_%s(symbol));"
+                    % (name))
+            elif type_name == "access_specifier_t":
+                print(
+                    "pch_write_word(w, (uint32_t)symbol_entity_specs_get_%s(symbol));"
+                    % (name))
+            elif type_name == "simplify_function_t":
+                print("// '%s' is only used by builtins" % (name))
+            else:
+                sys.stderr.write("%s:%d: warning: not handling typeof '%s'\n" %
+                                 (sys.argv[0], lineno(), type_name))
+        elif _type.startswith("array"):
+            type_name = get_up_to_matching_paren(_type[len("array"):])
+            if type_name.startswith("typeof"):
+                type_name = get_up_to_matching_paren(
+                    type_name[len("typeof"):]).split(",")[0].strip()
+            (num_name, list_name) = array_names(name)
+            print("{")
+            print("int i, N = symbol_entity_specs_get_%s(symbol);" % (num_name))
+            print("pch_write_word(w, N);")
+            print("for (i = 0; i < N; i++)")
+            print("{")
+            if type_name == "symbol":
+                print(
+                    "pch_write_word(w, pch_symbol_id(w, symbol_entity_specs_get_%s_num(symbol, i)));"
+                    % (list_name))
+            elif type_name == "type":
+                print(
+                    "pch_write_word(w, pch_type_id(w, symbol_entity_specs_get_%s_num(symbol, i)));"
+                    % (list_name))
+            elif type_name == "default_argument_info_t*":
+                print(
+                    "default_argument_info_t* default_arg = symbol_entity_specs_get_%s_num(symbol, i);"
+                    % (list_name))
+                print("pch_write_word(w, default_arg != NULL);")
+                print("if (default_arg != NULL)")
+                print("{")
+                print(
+                    "  pch_write_word(w, pch_nodecl_id(w, default_arg->argument));")
+                print("  pch_write_word(w, default_arg->is_hidden);")
+                print("}")
+            elif type_name == "gcc_attribute_t":
+                print(
+                    "gcc_attribute_t gcc_attr = symbol_entity_specs_get_%s_num(symbol, i);"
+                    % (list_name))
+                print(
+                    "pch_write_word(w, pch_string_id(w, gcc_attr.attribute_name));")
+                print(
+                    "pch_write_word(w, pch_nodecl_id(w, gcc_attr.expression_list));"
+                )
+            elif type_name == "function_parameter_info_t":
+                print(
+                    "function_parameter_info_t param_info = symbol_entity_specs_get_%s_num(symbol, i);"
+                    % (list_name))
+                print(
+                    "pch_write_word(w, pch_symbol_id(w, param_info.function));")
+                print("pch_write_word(w, param_info.nesting);")
+                print("pch_write_word(w, param_info.position);")
+            else:
+                sys.stderr.write(
+                    "%s:%d: warning: not handling type array of type '%s'\n" %
+                    (sys.argv[0], lineno(), _type))
+            print("}")
+            print("}")
+        else:
+            sys.stderr.write("%s:%d: warning: not handling type '%s'\n" %
+                             (sys.argv[0], lineno(), _type))
+    print("}")
+    print("")
+
+    print(
+        "static void pch_read_entity_specs(pch_cursor_t* c, scope_entry_t* symbol)"
+    )
+    print("{")
+    for i in range(0, len(bools), 32):
+        print("{")
+        print("uint32_t bits = pch_read_word(c);")
+        for (j, name) in enumerate(bools[i:i + 32]):
+            print("symbol_entity_specs_set_%s(symbol, (bits >> %d) & 1);" %
+                  (name, j))
+        print("}")
+    for (_type, name) in others:
+        if _type == "integer":
+            print("symbol_entity_specs_set_%s(symbol, (int)pch_read_word(c));" %
+                  (name))
+        elif _type == "symbol":
+            print("symbol_entity_specs_set_%s(symbol, pch_read_symbol(c));" %
+                  (name))
+        elif _type == "type":
+            print("symbol_entity_specs_set_%s(symbol, pch_read_type(c));" %
+                  (name))
+        elif _type == "nodecl":
+            print("symbol_entity_specs_set_%s(symbol, pch_read_nodecl(c));" %
+                  (name))
+        elif _type == "string":
+            print("symbol_entity_specs_set_%s(symbol, pch_read_string(c));" %
+                  (name))
+        elif _type.startswith("typeof"):
+            type_name = get_up_to_matching_paren(
+                _type[len("typeof"):]).split(",")[0].strip()
+            if type_name == "_size_t":
+                print(
+                    "symbol_entity_specs_set_%s(symbol, (_size_t)pch_read_wide(c));"
+                    % (name))
+            elif type_name == "access_specifier_t":
+                print(
+                    "symbol_entity_specs_set_%s(symbol, (access_specifier_t)pch_read_word(c));"
+                    % (name))
+        elif _type.startswith("array"):
+            type_name = get_up_to_matching_paren(_type[len("array"):])
+            if type_name.startswith("typeof"):
+                type_name = get_up_to_matching_paren(
+                    type_name[len("typeof"):]).split(",")[0].strip()
+            (num_name, list_name) = array_names(name)
+            print("{")
+            print("int i, N = (int)pch_read_word(c);")
+            print("for (i = 0; i < N; i++)")
+            print("{")
+            if type_name == "symbol":
+                print("symbol_entity_specs_add_%s(symbol, pch_read_symbol(c));" %
+                      (list_name))
+            elif type_name == "type":
+                print("symbol_entity_specs_add_%s(symbol, pch_read_type(c));" %
+                      (list_name))
+            elif type_name == "default_argument_info_t*":
+                print("default_argument_info_t* default_arg = NULL;")
+                print("if (pch_read_word(c))")
+                print("{")
+                print("  default_arg = NEW0(default_argument_info_t);")
+                print("  default_arg->argument = pch_read_nodecl(c);")
+                print("  default_arg->is_hidden = pch_read_word(c);")
+                print("  default_arg->context = symbol->decl_context;")
+                print("}")
+                print("symbol_entity_specs_add_%s(symbol, default_arg);" %
+                      (list_name))
+            elif type_name == "gcc_attribute_t":
+                print("gcc_attribute_t gcc_attr;")
+                print("gcc_attr.attribute_name = pch_read_string(c);")
+                print("gcc_attr.expression_list = pch_read_nodecl(c);")
+                print("symbol_entity_specs_add_%s(symbol, gcc_attr);" %
+                      (list_name))
+            elif type_name == "function_parameter_info_t":
+                print("function_parameter_info_t param_info;")
+                print("param_info.function = pch_read_symbol(c);")
+                print("param_info.nesting = (int)pch_read_word(c);")
+                print("param_info.position = (int)pch_read_word(c);")
+                print("symbol_entity_specs_add_%s(symbol, param_info);" %
+                      (list_name))
+            print("}")
+            print("}")
+    print("}")
+
+
 lines = loadlines(f)
 check_file(lines)
 
@@ -1001,5 +1309,7 @@ elif op == "fortran_modules":
     print_fortran_modules_functions(lines)
 elif op == "c_deep_copy_entity_specs":
     print_deep_copy_entity_specs(lines)
+elif op == "pch_entity_specs":
+    print_pch_entity_specs(lines)
 else:
     raise Exception("Invalid operation %s" % (op))
@@ -429,14 +429,12 @@ def generate_check_routines(rule_map):
     print("{")
     print(
         "   ERROR_CONDITION(!nodecl_is_list(n), \"Node must be a list\", 0);")
-    print("   int num_items = 0;")
-    print("   nodecl_t* list = nodecl_unpack_list(n, &num_items);")
-    print("   int i;")
-    print("   for (i = 0; i < num_items; i++)")
+    print("   // Walk the list in place, unpacking it would allocate")
+    print("   AST list = nodecl_get_ast(n), it;")
+    print("   for_each_element(list, it)")
     print("   {")
-    print("      fun(list[i]);")
+    print("      fun(_nodecl_wrap(ASTSon1(it)));")
     print("   }")
-    print("   DELETE(list);")
     print("}")
     print(
         "static inline void nodecl_check_nullable_list_rule(nodecl_t n, void (*fun)(nodecl_t))"
@@ -176,8 +176,14 @@ namespace TL
                         fprintf(stderr, "COMPILERPHASES: Running phase '%s'\n", phase->get_phase_name().c_str());
                     }
 
+                    if (compilation_process.report_phase_begin != NULL)
+                        compilation_process.report_phase_begin(translation_unit, phase->get_phase_name().c_str());
+
                     phase->run(dto);
 
+                    if (compilation_process.report_phase_end != NULL)
+                        compilation_process.report_phase_end(translation_unit, phase->get_phase_name().c_str());
+
                     if (phase->get_phase_status() != CompilerPhase::PHASE_STATUS_OK)
                     {
                         // Ideas to improve this are welcome :)
@@ -626,6 +632,23 @@ extern "C"
         return new_phase;
     }
 
+    void preload_compiler_phase_library(const char* library_name)
+    {
+#ifndef WIN32_BUILD
+        library_name = add_dso_extension(library_name);
+
+        // No phase object is created. The library will be found already
+        // loaded when the phase is actually loaded. Failures are diagnosed then
+        void* handle = dlopen(library_name, RTLD_NOW | RTLD_GLOBAL);
+
+        DEBUG_CODE()
+        {
+            fprintf(stderr, "COMPILERPHASES: Preloading '%s' %s\n", library_name,
+                    handle != NULL ? "succeeded" : "failed");
+        }
+#endif
+    }
+
 
 	// This function will change the DTO adding an abstract information that will contain
 	// I'm waiting something like 'variable:type:text'
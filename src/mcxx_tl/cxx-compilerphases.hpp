@@ -58,6 +58,9 @@ LIBMCXXTL_EXTERN void compiler_regular_phase_loader(compilation_configuration_t*
 LIBMCXXTL_EXTERN void compiler_special_phase_set_dto(compilation_configuration_t* config, const char* data);
 LIBMCXXTL_EXTERN void compiler_special_phase_set_codegen(compilation_configuration_t* config, const char* data);
 
+// Only maps the library of a phase in memory (used by the compile server)
+LIBMCXXTL_EXTERN void preload_compiler_phase_library(const char* library_name);
+
 LIBMCXXTL_EXTERN void run_codegen_phase(FILE *out_file,
         translation_unit_t* translation_unit,
         const char* output_filename);
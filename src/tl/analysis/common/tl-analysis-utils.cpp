@@ -475,16 +475,14 @@ ptd_nodecl_found:   ;
     
     bool nodecl_set_equivalence(const NodeclSet& s1, const NodeclSet& s2)
     {
-        if(s1.size() == s2.size())
-        {
-            NodeclSet intersection;
-            std::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(),
-                                  std::inserter(intersection, intersection.begin()), 
-                                  Nodecl::Utils::Nodecl_structural_less());
-            if(intersection.size() == s1.size())
-                return true;
-        }
-        return false;
+        if(s1.size() != s2.size())
+            return false;
+
+        NodeclHashSet hashed_s1(s1.begin(), s1.end());
+        for(NodeclSet::const_iterator it = s2.begin(); it != s2.end(); ++it)
+            if(hashed_s1.find(*it) == hashed_s1.end())
+                return false;
+        return true;
     }
     
     bool nodecl_map_equivalence(const NodeclMap& m1, const NodeclMap& m2)
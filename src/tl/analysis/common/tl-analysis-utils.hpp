@@ -35,6 +35,8 @@
 
 #include <set>
 #include <map>
+#include <tr1/unordered_set>
+#include <tr1/unordered_map>
 
 #define VERBOSE (debug_options.analysis_verbose || \
                  debug_options.enable_debug_code)
@@ -55,6 +57,15 @@ namespace Analysis {
     typedef std::multimap<NBase, NodeclPair, Nodecl::Utils::Nodecl_structural_less> NodeclMap; 
     typedef std::map<Nodecl::NodeclBase, tribool, Nodecl::Utils::Nodecl_structural_less> NodeclTriboolMap;
 
+    // Unordered counterparts of NodeclSet and NodeclMap. Lookups use the structural
+    // hash cached in the nodes and only compare whole trees on collisions
+    typedef std::tr1::unordered_set<NBase,
+                                    Nodecl::Utils::Nodecl_structural_hash,
+                                    Nodecl::Utils::Nodecl_structural_equal_skip_conversions> NodeclHashSet;
+    typedef std::tr1::unordered_multimap<NBase, NodeclPair,
+                                         Nodecl::Utils::Nodecl_structural_hash,
+                                         Nodecl::Utils::Nodecl_structural_equal_skip_conversions> NodeclHashMap;
+
 namespace Utils {
 
     // ******************************************************************************************* //
@@ -8178,6 +8178,15 @@ codegen_status_t CxxBase::get_codegen_status(TL::Symbol sym)
 
     if (it == _codegen_status.end())
     {
+        // Code of symbols of a precompiled header has already been emitted
+        scope_entry_t* entry = sym.get_internal_symbol();
+        if (entry != NULL
+                && symbol_entity_specs_get_is_from_pch(entry))
+        {
+            return symbol_entity_specs_get_is_defined_in_pch(entry)
+                ? CODEGEN_STATUS_DEFINED
+                : CODEGEN_STATUS_DECLARED;
+        }
         return CODEGEN_STATUS_NONE;
     }
     else
@@ -778,6 +778,13 @@ namespace Nodecl
         }
         */
 
+        // Trees with a different structural hash cannot be equal
+        if (!nodecl_is_null(n1_)
+                && !nodecl_is_null(n2_)
+                && nodecl_get_ast(n1_) != nodecl_get_ast(n2_)
+                && nodecl_structural_hash(n1_) != nodecl_structural_hash(n2_))
+            return false;
+
         bool equals = equal_trees_rec(n1_, n2_, skip_conversion_nodecls);
         return equals;
     }
@@ -813,6 +820,16 @@ namespace Nodecl
         return structurally_less_nodecls(n1, n2, /*skip_conversion_nodes*/true);
     }
 
+    size_t Utils::Nodecl_structural_hash::operator() (const Nodecl::NodeclBase& n) const
+    {
+        return nodecl_structural_hash(n.get_internal_nodecl());
+    }
+
+    bool Utils::Nodecl_structural_equal_skip_conversions::operator() (const Nodecl::NodeclBase& n1, const Nodecl::NodeclBase& n2) const
+    {
+        return structurally_equal_nodecls(n1, n2, /*skip_conversion_nodecls*/true);
+    }
+
     Nodecl::List Utils::get_all_list_from_list_node(Nodecl::List n)
     {
         while (n.get_parent().is<Nodecl::List>())
@@ -88,6 +88,17 @@ namespace Utils {
         bool operator() (const Nodecl::NodeclBase& n1, const Nodecl::NodeclBase& n2) const;
     };
 
+    // Hash and equality for hashed containers of nodecls. Both skip
+    // conversions and only the hash of the nodes is compared unless they
+    // collide. The hash is cached in the nodes so this is cheap
+    struct Nodecl_structural_hash {
+        size_t operator() (const Nodecl::NodeclBase& n) const;
+    };
+
+    struct Nodecl_structural_equal_skip_conversions {
+        bool operator() (const Nodecl::NodeclBase& n1, const Nodecl::NodeclBase& n2) const;
+    };
+
     // Basic replacement
     //
     // After this operation dest will be updated to have the same contents
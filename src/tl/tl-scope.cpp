@@ -193,7 +193,7 @@ namespace TL
         ObjectList<Symbol> result;
 
         walk_scope_data_t walk_data(result, include_hidden);
-        dhash_ptr_walk(_decl_context->current_scope->dhash, (dhash_ptr_walk_fn*)walk_scope, &walk_data);
+        ohash_ptr_walk(_decl_context->current_scope->hash, (ohash_ptr_walk_fn*)walk_scope, &walk_data);
 
         return result;
     }
@@ -0,0 +1,35 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+
+// The lookups of class members are cached once the class is complete. N
+// is looked up through D before and after the definition of B::N
+struct B
+{
+    struct N;
+    N* p;
+
+    static char f(N*);
+};
+
+struct D : B
+{
+};
+
+typedef char check_1[sizeof(D::f(0)) == 1 ? 1 : -1];
+
+struct B::N
+{
+    int x;
+    static int g();
+};
+
+typedef char check_2[sizeof(D::N) == sizeof(int) ? 1 : -1];
+typedef char check_3[sizeof(D::N::g()) == sizeof(int) ? 1 : -1];
+
+int h(D& d)
+{
+    return d.p->x + D::N::g();
+}
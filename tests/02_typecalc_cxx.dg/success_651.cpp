@@ -0,0 +1,37 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+
+// The lookups of class members are cached once the class is complete. The
+// definition of A::f adds a default argument to it, so f must be found
+// again through D and the call with one argument becomes valid
+struct A
+{
+    static char f(int, int);
+    static int f(int, int, int);
+};
+
+struct D : A
+{
+};
+
+typedef char check_1[sizeof(D::f(1, 2)) == 1 ? 1 : -1];
+
+char A::f(int a, int b = 0)
+{
+    return a + b;
+}
+
+typedef char check_2[sizeof(D::f(1)) == 1 ? 1 : -1];
+
+int g(D& d)
+{
+    return d.f(1) + d.f(1, 2) + d.f(1, 2, 3);
+}
+
+int A::f(int a, int b, int c)
+{
+    return a + b + c;
+}
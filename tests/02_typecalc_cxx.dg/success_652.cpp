@@ -0,0 +1,40 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+
+// Overload resolutions are cached. The redeclaration of f adds a default
+// argument, so f(int, int) becomes viable for the same call and is better
+// than f(double)
+char f(int, int);
+int f(double);
+
+typedef char check_1[sizeof(f(1)) == sizeof(int) ? 1 : -1];
+
+char f(int, int = 0);
+
+typedef char check_2[sizeof(f(1)) == sizeof(char) ? 1 : -1];
+
+struct A
+{
+    static char g(int, int);
+    static int g(double);
+};
+
+typedef char check_3[sizeof(A::g(1)) == sizeof(int) ? 1 : -1];
+
+char A::g(int a, int b = 0)
+{
+    return a + b;
+}
+
+typedef char check_4[sizeof(A::g(1)) == sizeof(char) ? 1 : -1];
+
+void h()
+{
+    int x = f(1.0);
+    char c = f(1);
+    (void)x;
+    (void)c;
+}
@@ -0,0 +1,62 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+
+// A parenthesized name that does not name a type is not a cast. These
+// interpretations are rejected by a lookup of the name before the casted
+// expression is checked
+int f(int);
+char g(int);
+
+struct F
+{
+    long operator()(int) const;
+};
+
+typedef double D;
+
+void h(int x)
+{
+    F fo;
+    char (*pg)(int) = g;
+
+    typedef char check_1[sizeof((f)(x)) == sizeof(int) ? 1 : -1];
+    typedef char check_2[sizeof((pg)(x)) == sizeof(char) ? 1 : -1];
+    typedef char check_3[sizeof((fo)(x)) == sizeof(long) ? 1 : -1];
+    typedef char check_4[sizeof((D)(x)) == sizeof(double) ? 1 : -1];
+
+    (f)(x);
+    (pg)(x);
+    (fo)(x);
+
+    long r = (f)(x) + (pg)(x) + (fo)(x) + (long)(D)(x);
+    (void)r;
+}
+
+// A name brought by a dependent using typename names a type
+template <typename T>
+struct Base
+{
+    typedef T type;
+};
+
+template <typename T>
+struct Derived : Base<T>
+{
+    using typename Base<T>::type;
+
+    type f(int x)
+    {
+        typedef char check_5[sizeof((type)(x)) == sizeof(T) ? 1 : -1];
+        return (type)(x);
+    }
+};
+
+double k(int x)
+{
+    Derived<double> d;
+    typedef char check_6[sizeof(d.f(x)) == sizeof(double) ? 1 : -1];
+    return d.f(x);
+}
@@ -0,0 +1,35 @@
+/*
+<testinfo>
+test_generator=config/mercurium
+</testinfo>
+*/
+
+// The cast (T)(x) is a nested ambiguity shared by both interpretations of
+// S(a)(...), so it is checked twice for every statement. Verdicts of nested
+// ambiguities are remembered only while the outermost one is being solved:
+// the second statement has the same shape but T names a variable there
+char f(int);
+typedef long T;
+
+struct S
+{
+    S(long);
+    S(char);
+    long v;
+};
+
+void g(int x)
+{
+    S(a)((T)(x));
+    typedef char check_1[sizeof((T)(x)) == sizeof(long) ? 1 : -1];
+    {
+        char (*T)(int) = f;
+        S(b)((T)(x));
+        typedef char check_2[sizeof((T)(x)) == sizeof(char) ? 1 : -1];
+        (void)b;
+    }
+    S(c)((T)(x));
+    typedef char check_3[sizeof((T)(x)) == sizeof(long) ? 1 : -1];
+    (void)a;
+    (void)c;
+}
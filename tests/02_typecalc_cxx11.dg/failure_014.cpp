@@ -0,0 +1,16 @@
+/*
+<testinfo>
+test_generator=config/mercurium-fe-only
+test_CXXFLAGS="-std=c++11 --constexpr-steps=1000"
+test_compile_fail=yes
+</testinfo>
+*/
+
+// The evaluation needs more steps than allowed, so it must be diagnosed
+// instead of going on
+constexpr int count(int n)
+{
+    return n == 0 ? 0 : 1 + count(n - 1);
+}
+
+static_assert(count(100000) == 100000, "");
@@ -0,0 +1,29 @@
+/*
+<testinfo>
+test_generator="config/mercurium-cxx11"
+</testinfo>
+*/
+
+// Recursive constexpr functions. Without remembering the calls fib(30)
+// would exceed the limit of steps of a constant evaluation
+constexpr unsigned long long factorial(unsigned int n)
+{
+    return n == 0 ? 1 : n * factorial(n - 1);
+}
+
+constexpr unsigned long long fib(unsigned int n)
+{
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+static_assert(factorial(0) == 1, "");
+static_assert(factorial(5) == 120, "");
+static_assert(factorial(20) == 2432902008176640000ULL, "");
+
+static_assert(fib(0) == 0, "");
+static_assert(fib(1) == 1, "");
+static_assert(fib(10) == 55, "");
+static_assert(fib(30) == 832040, "");
+
+int a[fib(6)];
+static_assert(sizeof(a) == 8 * sizeof(int), "");
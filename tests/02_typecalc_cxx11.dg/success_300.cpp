@@ -0,0 +1,45 @@
+/*
+<testinfo>
+test_generator="config/mercurium-cxx11"
+</testinfo>
+*/
+
+// Calls of constexpr functions are remembered by the function and the
+// values of the arguments. Different tuples, or the same values in another
+// order, must not reuse the value of another call
+constexpr int sub(int a, int b)
+{
+    return a - b;
+}
+
+constexpr int sub3(int a, int b, int c)
+{
+    return a - b - c;
+}
+
+constexpr int twice(int a)
+{
+    return sub(a, -a);
+}
+
+static_assert(sub(1, 2) == -1, "");
+static_assert(sub(2, 1) == 1, "");
+static_assert(sub(1, 2) == -1, "");
+static_assert(sub(2, 1) == 1, "");
+
+static_assert(sub3(1, 2, 3) == -4, "");
+static_assert(sub3(3, 2, 1) == 0, "");
+static_assert(sub3(1, 2, 3) == -4, "");
+
+static_assert(twice(4) == 8, "");
+static_assert(sub(4, -4) == 8, "");
+static_assert(twice(-4) == -8, "");
+
+struct A
+{
+    static constexpr int f(int a, long b) { return a * 10 + b; }
+};
+
+static_assert(A::f(1, 2) == 12, "");
+static_assert(A::f(2, 1) == 21, "");
+static_assert(A::f(1, 2L) == 12, "");
@@ -0,0 +1,49 @@
+/*--------------------------------------------------------------------
+  (C) Copyright 2006-2012 Barcelona Supercomputing Center
+                          Centro Nacional de Supercomputacion
+  
+  This file is part of Mercurium C/C++ source-to-source compiler.
+  
+  See AUTHORS file in the top level directory for information
+  regarding developers and contributors.
+  
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 3 of the License, or (at your option) any later version.
+  
+  Mercurium C/C++ source-to-source compiler is distributed in the hope
+  that it will be useful, but WITHOUT ANY WARRANTY; without even the
+  implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+  PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+  
+  You should have received a copy of the GNU Lesser General Public
+  License along with Mercurium C/C++ source-to-source compiler; if
+  not, write to the Free Software Foundation, Inc., 675 Mass Ave,
+  Cambridge, MA 02139, USA.
+--------------------------------------------------------------------*/
+
+
+
+/*
+<testinfo>
+test_generator=config/mercurium
+compile_versions="create use"
+test_CFLAGS_create="--pch-create=success_pch_01.pch"
+test_CFLAGS_use="--pch=success_pch_01.pch -Werror"
+test_nolink=no
+</testinfo>
+*/
+
+// A precompiled header is only used when the file starts with the same
+// #include directives. The comments above and the include guard must not
+// hide them. In the version 'use' -Werror makes an unused header fail
+
+#ifndef SUCCESS_PCH_01_C
+#define SUCCESS_PCH_01_C
+
+#include <stdlib.h>
+#include "success_pch_01.h" /* main */
+
+#endif // SUCCESS_PCH_01_C